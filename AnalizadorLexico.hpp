@@ -0,0 +1,210 @@
+#ifndef ANALIZADOR_LEXICO_HPP
+#define ANALIZADOR_LEXICO_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+#include "TablaOpcodes.hpp"
+
+// -----------------------------------------------------------------------------
+// Analizador léxico sin copias
+// -----------------------------------------------------------------------------
+// Cada token es una vista (string_view) al buffer original de la línea: no se
+// recorta, no se pasa a mayúsculas y no se reserva memoria. Los registros y
+// los números se resuelven aquí mismo, una sola vez. Todo es constexpr: el
+// mismo analizador lee el texto de ensamblar_constante() al compilar.
+
+enum TipoToken : uint8_t {
+    T_IDENT,            // mnemónico, directiva o etiqueta
+    T_NUMERO,           // 10, 0x80, 0FFh, 'A'
+    T_REG32,            // EAX .. EDI
+    T_REG8,             // AL .. BH
+    T_COMA,             // ,
+    T_DOS_PUNTOS,       // :
+    T_CORCHETE_ABRE,    // [
+    T_CORCHETE_CIERRA,  // ]
+    T_MAS,              // +
+    T_MENOS,            // -
+    T_POR,              // *
+    T_DIV,              // /
+    T_PAREN_ABRE,       // (
+    T_PAREN_CIERRA,     // )
+    T_DESPL_IZQ,        // <<
+    T_DESPL_DER,        // >>
+    T_Y,                // &
+    T_O,                // |
+    T_OTRO              // carácter o número inválido (se reporta al procesar)
+};
+
+struct Token {
+    TipoToken        tipo;
+    uint8_t          reg;     // código de registro (T_REG32 / T_REG8)
+    uint32_t         valor;   // valor numérico (T_NUMERO)
+    std::string_view texto;   // vista al texto original
+};
+
+// Tope de tokens por línea; con él la línea léxica vive en un arreglo fijo
+inline constexpr size_t MAX_TOKENS_LINEA = 64;
+
+struct LineaLexica {
+    Token  tokens[MAX_TOKENS_LINEA];
+    size_t num_tokens = 0;
+};
+
+// -----------------------------------------------------------------------------
+// Clasificación de caracteres (sin locale, tabla ASCII directa)
+// -----------------------------------------------------------------------------
+
+constexpr bool es_espacio(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\v' || c == '\f';
+}
+
+constexpr bool es_digito(char c) {
+    return c >= '0' && c <= '9';
+}
+
+constexpr bool es_letra(char c) {
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z');
+}
+
+// Caracteres válidos al inicio de un identificador NASM
+constexpr bool es_inicio_ident(char c) {
+    return es_letra(c) || c == '_' || c == '.' || c == '$' || c == '?' || c == '@';
+}
+
+constexpr bool es_cuerpo_ident(char c) {
+    return es_inicio_ident(c) || es_digito(c) || c == '#' || c == '~';
+}
+
+constexpr int valor_hex(char c) {
+    if (es_digito(c)) return c - '0';
+    c = a_mayuscula(c);
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// -----------------------------------------------------------------------------
+// Números
+// -----------------------------------------------------------------------------
+
+// Número NASM: decimal, 0x.. / ..h hexadecimal o 'c' carácter.
+constexpr bool leer_numero(std::string_view texto, uint32_t& valor) {
+    // Carácter entre comillas: 'A'
+    if (texto.size() == 3 && texto.front() == '\'' && texto.back() == '\'') {
+        valor = static_cast<uint8_t>(texto[1]);
+        return true;
+    }
+
+    // Un número empieza con dígito; así "ADDH" o "FACEH" siguen siendo etiquetas
+    if (texto.empty() || !es_digito(texto[0])) return false;
+
+    uint32_t base = 10;
+    // Sufijo H (NASM style: 0FFFFH) o prefijo 0X (C style: 0X80)
+    if (a_mayuscula(texto.back()) == 'H') {
+        texto.remove_suffix(1);
+        base = 16;
+    } else if (texto.size() > 2 && texto[0] == '0' && a_mayuscula(texto[1]) == 'X') {
+        texto.remove_prefix(2);
+        base = 16;
+    }
+    if (texto.empty()) return false;
+
+    uint64_t acumulado = 0;
+    for (char c : texto) {
+        int d = (base == 16) ? valor_hex(c) : (es_digito(c) ? c - '0' : -1);
+        if (d < 0) return false;
+        acumulado = acumulado * base + static_cast<uint32_t>(d);
+        if (acumulado > 0xFFFFFFFFull) return false;   // fuera de rango
+    }
+    valor = static_cast<uint32_t>(acumulado);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Tokenizador
+// -----------------------------------------------------------------------------
+
+constexpr bool buscar_registro(std::string_view texto, const std::string_view (&nombres)[8], uint8_t& codigo) {
+    for (uint8_t i = 0; i < 8; ++i) {
+        if (iguales_sin_mayusculas(texto, nombres[i])) {
+            codigo = i;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Divide la línea en tokens (el comentario ';' se descarta).
+// Devuelve false si la línea excede MAX_TOKENS_LINEA.
+constexpr bool tokenizar_linea(std::string_view linea, LineaLexica& salida) {
+    salida.num_tokens = 0;
+    const size_t n = linea.size();
+    size_t i = 0;
+
+    while (i < n) {
+        char c = linea[i];
+
+        if (es_espacio(c)) { ++i; continue; }
+        if (c == ';') break;   // Quitar comentarios
+
+        if (salida.num_tokens == MAX_TOKENS_LINEA) return false;
+        Token& t = salida.tokens[salida.num_tokens++];
+        t.reg   = 0;
+        t.valor = 0;
+        size_t inicio = i;
+
+        if (es_inicio_ident(c)) {
+            while (i < n && es_cuerpo_ident(linea[i])) ++i;
+            t.texto = linea.substr(inicio, i - inicio);
+            t.tipo  = T_IDENT;
+            if (t.texto.size() == 3 && buscar_registro(t.texto, NOMBRES_REG32, t.reg)) t.tipo = T_REG32;
+            else if (t.texto.size() == 2 && buscar_registro(t.texto, NOMBRES_REG8, t.reg)) t.tipo = T_REG8;
+            continue;
+        }
+
+        if (es_digito(c)) {
+            while (i < n && (es_digito(linea[i]) || es_letra(linea[i]) || linea[i] == '_')) ++i;
+            t.texto = linea.substr(inicio, i - inicio);
+            t.tipo  = leer_numero(t.texto, t.valor) ? T_NUMERO : T_OTRO;
+            continue;
+        }
+
+        if (c == '\'' && i + 2 < n && linea[i + 2] == '\'') {
+            i += 3;
+            t.texto = linea.substr(inicio, 3);
+            t.tipo  = T_NUMERO;
+            t.valor = static_cast<uint8_t>(linea[inicio + 1]);
+            continue;
+        }
+
+        // Desplazamientos: "<<" y ">>" (un '<' o '>' suelto es inválido)
+        if ((c == '<' || c == '>') && i + 1 < n && linea[i + 1] == c) {
+            i += 2;
+            t.texto = linea.substr(inicio, 2);
+            t.tipo  = (c == '<') ? T_DESPL_IZQ : T_DESPL_DER;
+            continue;
+        }
+
+        ++i;
+        t.texto = linea.substr(inicio, 1);
+        switch (c) {
+            case ',': t.tipo = T_COMA;              break;
+            case ':': t.tipo = T_DOS_PUNTOS;        break;
+            case '[': t.tipo = T_CORCHETE_ABRE;     break;
+            case ']': t.tipo = T_CORCHETE_CIERRA;   break;
+            case '+': t.tipo = T_MAS;               break;
+            case '-': t.tipo = T_MENOS;             break;
+            case '*': t.tipo = T_POR;               break;
+            case '/': t.tipo = T_DIV;               break;
+            case '(': t.tipo = T_PAREN_ABRE;        break;
+            case ')': t.tipo = T_PAREN_CIERRA;      break;
+            case '&': t.tipo = T_Y;                 break;
+            case '|': t.tipo = T_O;                 break;
+            default:  t.tipo = T_OTRO;              break;
+        }
+    }
+    return true;
+}
+
+#endif // ANALIZADOR_LEXICO_HPP
@@ -0,0 +1,702 @@
+#include "AnalizadorRendimiento.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Costos por mnemónico
+// -----------------------------------------------------------------------------
+// Forma registro de 32 bits en un núcleo tipo Skylake (tablas de Agner Fog y
+// uops.info, redondeadas). Las uops de memoria no están aquí: un operando
+// que se lee suma un load (P2/P3, LAT_CARGA ciclos) y uno que se escribe un
+// store (dirección en P2/P3/P7, dato en P4), igual para cualquier mnemónico.
+
+static constexpr uint8_t P0 = 1 << PUERTO_0, P1 = 1 << PUERTO_1, P2 = 1 << PUERTO_2, P3 = 1 << PUERTO_3;
+static constexpr uint8_t P4 = 1 << PUERTO_4, P5 = 1 << PUERTO_5, P6 = 1 << PUERTO_6, P7 = 1 << PUERTO_7;
+static constexpr uint8_t P_ALU   = P0 | P1 | P5 | P6;
+static constexpr uint8_t P_06    = P0 | P6;      // saltos condicionales
+static constexpr uint8_t P_15    = P1 | P5;      // LEA, MUL
+static constexpr uint8_t P_CARGA = P2 | P3;
+static constexpr uint8_t P_DIR   = P2 | P3 | P7; // dirección de un store
+static constexpr uint8_t P_DATO  = P4;           // dato de un store
+
+static constexpr uint32_t LAT_CARGA = 5;   // load que acierta en L1; reenviar un store cuesta lo mismo
+
+enum MemoriaImplicita : uint8_t {
+    MEM_NINGUNA,
+    MEM_CARGA,        // POP, RET, LEAVE leen la pila
+    MEM_ESCRITURA     // PUSH, CALL escriben la pila
+};
+
+enum FormaCosto : uint8_t { FORMA_TODAS, FORMA_REG, FORMA_MEM };
+
+struct CostoInstruccion {
+    string_view      mnem;            // "Jcc" = cualquier salto condicional
+    FormaCosto       forma;           // FORMA_MEM: solo con operando de memoria
+    uint8_t          latencia;        // ciclos hasta el resultado
+    uint8_t          uops;            // uops de cálculo, sin las de memoria
+    uint8_t          puertos;         // dónde puede ir cada una (0 = solo ocupa el front-end)
+    uint8_t          recurso;         // UNIDAD_DIV / MICROCODIGO, o NUM_RECURSOS
+    uint8_t          ocupacion;       // ciclos que cada instrucción retiene 'recurso'
+    MemoriaImplicita memoria;
+    bool             transferencia;   // con memoria no hay uop de cálculo (MOV r,m es solo el load)
+};
+
+static constexpr CostoInstruccion COSTOS_INSTRUCCION[] = {
+    {"MOV",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   true},
+    {"ADD",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"SUB",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"CMP",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"AND",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"OR",    FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"XOR",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"TEST",  FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"XCHG",  FORMA_REG,   2,  3,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"XCHG",  FORMA_MEM,   20, 6,  P_ALU, MICROCODIGO,  18, MEM_NINGUNA,   false},   // LOCK implícito
+    {"IMUL",  FORMA_TODAS, 3,  1,  P1,    NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"MOVZX", FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   true},
+    {"LEA",   FORMA_TODAS, 1,  1,  P_15,  NUM_RECURSOS, 0,  MEM_NINGUNA,   false},   // 3 componentes: ver analizar_bucle
+    {"INC",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"DEC",   FORMA_TODAS, 1,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"MUL",   FORMA_TODAS, 4,  3,  P_15,  NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"DIV",   FORMA_TODAS, 26, 10, P_ALU, UNIDAD_DIV,   6,  MEM_NINGUNA,   false},
+    {"IDIV",  FORMA_TODAS, 26, 10, P_ALU, UNIDAD_DIV,   6,  MEM_NINGUNA,   false},
+    {"PUSH",  FORMA_TODAS, 0,  0,  0,     NUM_RECURSOS, 0,  MEM_ESCRITURA, true},
+    {"POP",   FORMA_TODAS, 0,  0,  0,     NUM_RECURSOS, 0,  MEM_CARGA,     true},
+    {"INT",   FORMA_TODAS, 0,  1,  P_ALU, NUM_RECURSOS, 0,  MEM_NINGUNA,   false},   // el núcleo no se cuenta
+    {"LEAVE", FORMA_TODAS, 1,  2,  P_ALU, NUM_RECURSOS, 0,  MEM_CARGA,     false},
+    {"RET",   FORMA_TODAS, 0,  1,  P6,    NUM_RECURSOS, 0,  MEM_CARGA,     false},
+    {"NOP",   FORMA_TODAS, 0,  1,  0,     NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"CALL",  FORMA_TODAS, 0,  1,  P6,    NUM_RECURSOS, 0,  MEM_ESCRITURA, false},
+    {"LOOP",  FORMA_TODAS, 1,  7,  P_ALU, MICROCODIGO,  5,  MEM_NINGUNA,   false},
+    {"JMP",   FORMA_TODAS, 0,  1,  P6,    NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+    {"Jcc",   FORMA_TODAS, 0,  1,  P_06,  NUM_RECURSOS, 0,  MEM_NINGUNA,   false},
+};
+
+static constexpr string_view nombre_costo(const FilaOpcode& fila) {
+    return (fila.cod == C_SALTO && fila.mnem != "JMP") ? string_view("Jcc") : fila.mnem;
+}
+
+static constexpr bool costos_completos() {
+    for (const FilaOpcode& fila : TABLA_OPCODES) {
+        bool hay = false;
+        for (const CostoInstruccion& c : COSTOS_INSTRUCCION) hay = hay || c.mnem == nombre_costo(fila);
+        if (!hay) return false;
+    }
+    return true;
+}
+
+static_assert(costos_completos(), "cada mnemonico de TABLA_OPCODES necesita su fila en COSTOS_INSTRUCCION");
+
+static const CostoInstruccion& costo_de(const FilaOpcode& fila, bool con_memoria) {
+    const string_view mnem = nombre_costo(fila);
+    const FormaCosto forma = con_memoria ? FORMA_MEM : FORMA_REG;
+    for (const CostoInstruccion& c : COSTOS_INSTRUCCION) {
+        if (c.mnem == mnem && (c.forma == FORMA_TODAS || c.forma == forma)) return c;
+    }
+    return COSTOS_INSTRUCCION[0];   // inalcanzable: costos_completos()
+}
+
+// -----------------------------------------------------------------------------
+// Qué lee y qué escribe cada instrucción
+// -----------------------------------------------------------------------------
+// Lugares de la cadena de dependencias: 0-7 los registros (AL..BH son el de
+// 32 bits que los contiene), LUGAR_EFLAGS y desde NUM_LUGARES_REG una
+// dirección de memoria distinta por cada operando [..] del bucle. ESP no
+// encadena PUSH/POP/CALL/RET: el stack engine lo actualiza al decodificar.
+
+static constexpr int LUGAR_EFLAGS    = 8;
+static constexpr int NUM_LUGARES_REG = 9;
+
+static constexpr uint16_t bit_reg(int reg) { return static_cast<uint16_t>(1u << reg); }
+static constexpr uint16_t BIT_EFLAGS = 1u << LUGAR_EFLAGS;
+
+struct Efectos {
+    uint16_t lee = 0;           // registros y EFLAGS que entran al cálculo
+    uint16_t escribe = 0;
+    uint16_t lee_dir = 0;       // base e índice del operando de memoria (load o store)
+    bool carga = false;         // lee el operando de memoria
+    bool escritura = false;     // escribe el operando de memoria
+    bool sin_dependencia = false;   // XOR/SUB r,r: el resultado no depende de r
+};
+
+static uint16_t bits_operando(const InstruccionIR& ir, int k) {
+    if (ir.tipo_op[k] == OP_R32) return bit_reg(ir.reg[k]);
+    if (ir.tipo_op[k] == OP_R8)  return bit_reg(ir.reg[k] & 3);   // AH..BH = registros 0..3
+    return 0;
+}
+
+static uint16_t bits_direccion(const DireccionIR& mem) {
+    uint16_t bits = 0;
+    if (mem.base != SIN_REG)   bits |= bit_reg(mem.base);
+    if (mem.indice != SIN_REG) bits |= bit_reg(mem.indice);
+    return bits;
+}
+
+static Efectos efectos(const InstruccionIR& ir) {
+    const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+    const string_view m = fila.mnem;
+    Efectos e;
+
+    // Papel de cada operando: [k][0] = se lee, [k][1] = se escribe
+    bool papel[2][2] = {};
+    bool escribe_banderas = false;
+    if (m == "MOV" || m == "MOVZX" || m == "LEA") {
+        papel[0][1] = true;
+        papel[1][0] = true;
+    } else if (m == "CMP" || m == "TEST") {
+        papel[0][0] = papel[1][0] = true;
+        escribe_banderas = true;
+    } else if (m == "XCHG") {
+        papel[0][0] = papel[0][1] = papel[1][0] = papel[1][1] = true;
+    } else if (m == "ADD" || m == "SUB" || m == "AND" || m == "OR" || m == "XOR" || m == "IMUL") {
+        papel[0][0] = papel[0][1] = papel[1][0] = true;
+        escribe_banderas = true;
+        e.sin_dependencia = (m == "XOR" || m == "SUB") && ir.tipo_op[0] == OP_R32 &&
+                            ir.tipo_op[1] == OP_R32 && ir.reg[0] == ir.reg[1];
+    } else if (m == "INC" || m == "DEC") {
+        papel[0][0] = papel[0][1] = true;
+        escribe_banderas = true;
+    } else if (m == "MUL" || m == "DIV" || m == "IDIV") {
+        papel[0][0] = true;
+        e.lee |= bit_reg(0) | (m == "MUL" ? 0 : bit_reg(2));   // EDX:EAX / r/m32
+        e.escribe |= bit_reg(0) | bit_reg(2);
+        escribe_banderas = true;
+    } else if (m == "PUSH") {
+        papel[0][0] = true;
+    } else if (m == "POP") {
+        papel[0][1] = true;
+    } else if (m == "INT") {
+        e.lee |= bit_reg(0) | bit_reg(1) | bit_reg(2) | bit_reg(3);
+        e.escribe |= bit_reg(0);
+    } else if (m == "LEAVE") {
+        e.lee |= bit_reg(5);
+        e.escribe |= bit_reg(4) | bit_reg(5);
+    } else if (m == "LOOP") {
+        e.lee |= bit_reg(1);
+        e.escribe |= bit_reg(1);
+    } else if (fila.cod == C_SALTO && m != "JMP") {
+        e.lee |= BIT_EFLAGS;
+    }
+    if (escribe_banderas) e.escribe |= BIT_EFLAGS;
+
+    for (int k = 0; k < 2; ++k) {
+        if (ir.tipo_op[k] == OP_MEM) {
+            if (m == "LEA") {
+                e.lee |= bits_direccion(ir.mem);   // solo calcula la dirección
+                continue;
+            }
+            e.lee_dir |= bits_direccion(ir.mem);
+            e.carga     = e.carga || papel[k][0];
+            e.escritura = e.escritura || papel[k][1];
+        } else {
+            if (papel[k][0]) e.lee |= bits_operando(ir, k);
+            if (papel[k][1]) e.escribe |= bits_operando(ir, k);
+        }
+    }
+    if (e.sin_dependencia) e.lee = 0;
+    return e;
+}
+
+// Lo que la cadena y el costo necesitan de cada instrucción del bucle
+struct Descripcion {
+    Efectos  ef;
+    uint32_t latencia = 0;     // sin la carga
+    uint8_t  uops = 0;         // de cálculo
+    uint8_t  puertos = 0;
+    uint8_t  recurso = NUM_RECURSOS;
+    uint8_t  ocupacion = 0;
+    bool     carga = false;    // explícita o implícita
+    bool     escritura = false;
+    int      lugar_memoria = -1;   // lugar de la dirección [..], -1 = pila o sin memoria
+};
+
+// CMP/TEST/ADD/SUB/AND/INC/DEC sin memoria + Jcc: una sola uop en P0/P6
+static bool fusiona_con_salto(const InstruccionIR& ir) {
+    if (ir.tipo != IR_INSTRUCCION || ir.tipo_op[0] == OP_MEM || ir.tipo_op[1] == OP_MEM) return false;
+    const string_view m = TABLA_OPCODES[ir.fila].mnem;
+    return m == "CMP" || m == "TEST" || m == "ADD" || m == "SUB" || m == "AND" || m == "INC" || m == "DEC";
+}
+
+static bool misma_direccion(const DireccionIR& a, const DireccionIR& b) {
+    return a.base == b.base && a.indice == b.indice && a.escala == b.escala &&
+           a.disp == b.disp && a.simbolo == b.simbolo;
+}
+
+// -----------------------------------------------------------------------------
+// Bloques básicos y bucles
+// -----------------------------------------------------------------------------
+
+static bool cierra_bloque(const InstruccionIR& ir) {
+    const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+    return fila.cod == C_SALTO || fila.cod == C_REL8 || fila.mnem == "RET";
+}
+
+bool AnalizadorRendimiento::analizar(const EnsambladorIA32& e) {
+    ens = &e;
+    lista_bloques.clear();
+    lista_bucles.clear();
+    if (e.programa_ir.empty()) return false;
+
+    armar_bloques();
+    buscar_bucles();
+    for (AnalisisBucle& b : lista_bucles) analizar_bucle(b);
+    return true;
+}
+
+void AnalizadorRendimiento::armar_bloques() {
+    const vector<InstruccionIR>& ir = ens->programa_ir;
+    const uint32_t base = ens->secciones[SEC_TEXT].base;
+    vector<int> bloque_simbolo(ens->tabla_simbolos.size(), -1);
+
+    uint32_t posicion = 0;
+    bool abierto = false;        // el último bloque sigue recibiendo entradas
+    bool con_instrucciones = false;
+    auto abrir = [&](size_t i) {
+        BloqueBasico b;
+        b.primera = b.fin = i;
+        b.direccion = base + posicion;
+        lista_bloques.push_back(b);
+        abierto = true;
+        con_instrucciones = false;
+    };
+
+    for (size_t i = 0; i < ir.size(); ++i) {
+        const InstruccionIR& e = ir[i];
+        if (e.seccion != SEC_TEXT) {
+            abierto = false;
+            continue;
+        }
+        if (e.tipo == IR_ETIQUETA) {
+            if (!abierto || con_instrucciones) abrir(i);
+            BloqueBasico& b = lista_bloques.back();
+            if (b.etiqueta == SIN_SIMBOLO) b.etiqueta = e.valor[0];
+            bloque_simbolo[e.valor[0]] = static_cast<int>(lista_bloques.size() - 1);
+        } else if (e.tipo == IR_INSTRUCCION) {
+            if (!abierto) abrir(i);
+            con_instrucciones = true;
+        }
+        if (!abierto) continue;   // ALIGN o datos en .text entre dos bloques
+        posicion += static_cast<uint32_t>(tamano_ir(e));
+        lista_bloques.back().fin = i + 1;
+        if (e.tipo == IR_INSTRUCCION && cierra_bloque(e)) abierto = false;
+    }
+
+    // Aristas: la instrucción que cierra el bloque es su última entrada
+    for (size_t b = 0; b < lista_bloques.size(); ++b) {
+        BloqueBasico& bloque = lista_bloques[b];
+        const InstruccionIR& ultima = ir[bloque.fin - 1];
+        const bool salta = ultima.tipo == IR_INSTRUCCION && cierra_bloque(ultima);
+        const string_view m = salta ? TABLA_OPCODES[ultima.fila].mnem : string_view();
+        if (b + 1 < lista_bloques.size() && m != "JMP" && m != "RET") bloque.sucesor[0] = static_cast<int>(b + 1);
+        if (salta && m != "RET") bloque.sucesor[1] = bloque_simbolo[ultima.valor[0]];
+    }
+}
+
+// Un salto hacia atrás (o al propio bloque) cierra un bucle. Varios saltos a
+// la misma cabecera son un solo bucle hasta el último de ellos
+void AnalizadorRendimiento::buscar_bucles() {
+    for (size_t b = 0; b < lista_bloques.size(); ++b) {
+        const int h = lista_bloques[b].sucesor[1];
+        if (h < 0 || static_cast<size_t>(h) > b) continue;
+
+        bool unido = false;
+        for (AnalisisBucle& bucle : lista_bucles) {
+            if (bucle.primer_bloque == static_cast<size_t>(h)) {
+                bucle.ultimo_bloque = b;
+                unido = true;
+            }
+        }
+        if (unido) continue;
+        AnalisisBucle bucle;
+        bucle.cabecera = lista_bloques[h].etiqueta;
+        bucle.primer_bloque = static_cast<size_t>(h);
+        bucle.ultimo_bloque = b;
+        lista_bucles.push_back(bucle);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Costo de un bucle
+// -----------------------------------------------------------------------------
+
+void AnalizadorRendimiento::analizar_bucle(AnalisisBucle& bucle) const {
+    const vector<InstruccionIR>& ir = ens->programa_ir;
+    const size_t desde = lista_bloques[bucle.primer_bloque].primera;
+    const size_t hasta = lista_bloques[bucle.ultimo_bloque].fin;
+
+    // Instrucciones del cuerpo con su descripción
+    vector<Descripcion> desc;
+    vector<DireccionIR> direcciones;   // lugar NUM_LUGARES_REG + k
+    uint32_t direccion = lista_bloques[bucle.primer_bloque].direccion;
+    bucle.desde = direccion;
+    for (size_t i = desde; i < hasta; ++i) {
+        const InstruccionIR& e = ir[i];
+        if (e.seccion != SEC_TEXT) continue;
+        const uint32_t dir_entrada = direccion;
+        direccion += static_cast<uint32_t>(tamano_ir(e));
+        if (e.tipo != IR_INSTRUCCION) continue;
+
+        Descripcion d;
+        d.ef = efectos(e);
+        const bool con_memoria = d.ef.carga || d.ef.escritura;
+        const CostoInstruccion& c = costo_de(TABLA_OPCODES[e.fila], con_memoria);
+        d.latencia  = c.latencia;
+        d.uops      = c.uops;
+        d.puertos   = c.puertos;
+        d.recurso   = c.recurso;
+        d.ocupacion = c.ocupacion;
+        d.carga     = d.ef.carga || c.memoria == MEM_CARGA;
+        d.escritura = d.ef.escritura || c.memoria == MEM_ESCRITURA;
+        if (c.transferencia && con_memoria) {
+            d.uops = 0;
+            d.latencia = 0;
+        }
+        if (d.ef.sin_dependencia) {   // se resuelve al renombrar: no ocupa puerto
+            d.puertos = 0;
+            d.latencia = 0;
+        }
+        if (TABLA_OPCODES[e.fila].mnem == "LEA" && e.mem.base != SIN_REG && e.mem.indice != SIN_REG &&
+            (e.mem.disp != 0 || e.mem.simbolo != SIN_SIMBOLO)) {
+            d.latencia = 3;           // base + índice + desplazamiento: LEA lenta, solo P1
+            d.puertos = P1;
+        }
+        if (con_memoria) {
+            size_t k = 0;
+            while (k < direcciones.size() && !misma_direccion(direcciones[k], e.mem)) ++k;
+            if (k == direcciones.size()) direcciones.push_back(e.mem);
+            d.lugar_memoria = NUM_LUGARES_REG + static_cast<int>(k);
+        }
+
+        CostoEnBucle costo;
+        costo.entrada = i;
+        costo.direccion = dir_entrada;
+        costo.texto = texto_instruccion(e);
+
+        // Fusión macro con la instrucción inmediatamente anterior
+        const bool es_jcc = TABLA_OPCODES[e.fila].cod == C_SALTO && TABLA_OPCODES[e.fila].mnem != "JMP";
+        if (es_jcc && i > desde && !bucle.instrucciones.empty() &&
+            bucle.instrucciones.back().entrada == i - 1 && fusiona_con_salto(ir[i - 1])) {
+            costo.fusion_macro = true;
+            d.uops = 0;
+            desc.back().puertos = P_06;
+        }
+        desc.push_back(d);
+        bucle.instrucciones.push_back(costo);
+    }
+    bucle.hasta = direccion;
+
+    // Uops y presión por recurso (cada uop se reparte entre sus puertos)
+    auto repartir = [](double* presion, uint8_t puertos, double uops) {
+        int n = 0;
+        for (int p = 0; p < 8; ++p) n += (puertos >> p) & 1;
+        for (int p = 0; p < 8 && n > 0; ++p) {
+            if ((puertos >> p) & 1) presion[p] += uops / n;
+        }
+    };
+    for (size_t k = 0; k < desc.size(); ++k) {
+        const Descripcion& d = desc[k];
+        CostoEnBucle& c = bucle.instrucciones[k];
+        c.latencia = d.latencia + (d.carga ? LAT_CARGA : 0);
+        c.uops = d.uops + (d.carga ? 1 : 0) + (d.escritura ? 2 : 0);
+        c.uops_fusionadas = d.uops + ((d.carga && d.uops == 0) ? 1 : 0) + (d.escritura ? 1 : 0);
+        repartir(c.presion, d.puertos, d.uops);
+        if (d.carga) repartir(c.presion, P_CARGA, 1);
+        if (d.escritura) {
+            repartir(c.presion, P_DIR, 1);
+            repartir(c.presion, P_DATO, 1);
+        }
+        if (d.recurso != NUM_RECURSOS) c.presion[d.recurso] += d.ocupacion;
+
+        bucle.uops += c.uops;
+        bucle.uops_fusionadas += c.uops_fusionadas;
+        for (int r = 0; r < NUM_RECURSOS; ++r) bucle.presion[r] += c.presion[r];
+    }
+    for (int r = 0; r < NUM_RECURSOS; ++r) {
+        if (bucle.recurso_limite < 0 || bucle.presion[r] > bucle.presion[bucle.recurso_limite]) {
+            bucle.recurso_limite = r;
+            bucle.ciclos_puertos = bucle.presion[r];
+        }
+    }
+    bucle.ciclos_frontend = bucle.uops_fusionadas / ANCHO_EMISION;
+
+    // Cadena entre iteraciones: se simulan 2 * VUELTAS vueltas solo con
+    // latencias (recursos infinitos). Lo que un lugar crece por vuelta en la
+    // segunda mitad es la recurrencia más lenta que pasa por él. Cada
+    // ejecución (vuelta * n + k) recuerda qué entrada la hizo esperar
+    constexpr int VUELTAS = 32;
+    const size_t n = desc.size();
+    const size_t lugares = NUM_LUGARES_REG + direcciones.size();
+    vector<uint64_t> listo(lugares, 0), a_la_mitad(lugares, 0);
+    vector<int64_t> escritor(lugares, -1);          // última ejecución que escribió el lugar
+    vector<int64_t> causa(2 * VUELTAS * n, -1);     // ejecución de la que esperó, -1 = ninguna
+    vector<int> lugar_causa(2 * VUELTAS * n, -1);
+    vector<uint32_t> aporte(2 * VUELTAS * n, 0);
+
+    for (int vuelta = 0; vuelta < 2 * VUELTAS; ++vuelta) {
+        if (vuelta == VUELTAS) a_la_mitad = listo;
+        for (size_t k = 0; k < n; ++k) {
+            const Descripcion& d = desc[k];
+            const int64_t ejecucion = static_cast<int64_t>(vuelta * n + k);
+            uint64_t t = 0;
+            int lugar = -1;
+            auto entrada = [&](int l, uint64_t valor) {
+                if (lugar < 0 || valor > t) {
+                    t = valor;
+                    lugar = l;
+                }
+            };
+            for (uint32_t bits = d.ef.lee; bits != 0; bits &= bits - 1) {
+                const int l = __builtin_ctz(bits);
+                entrada(l, listo[l]);
+            }
+            if (d.carga) {
+                // El load espera la dirección y, si el bucle la escribe, el store
+                for (uint32_t bits = d.ef.lee_dir; bits != 0; bits &= bits - 1) {
+                    const int l = __builtin_ctz(bits);
+                    entrada(l, listo[l] + LAT_CARGA);
+                }
+                if (d.lugar_memoria >= 0) entrada(d.lugar_memoria, listo[d.lugar_memoria] + LAT_CARGA);
+                if (lugar < 0) t = LAT_CARGA;
+            }
+            const uint64_t resultado = t + d.latencia;
+
+            if (lugar >= 0) {
+                lugar_causa[ejecucion] = lugar;
+                causa[ejecucion] = escritor[lugar];
+                aporte[ejecucion] = static_cast<uint32_t>(resultado - listo[lugar]);
+            }
+            for (uint32_t bits = d.ef.escribe; bits != 0; bits &= bits - 1) {
+                const int l = __builtin_ctz(bits);
+                listo[l] = resultado;
+                escritor[l] = ejecucion;
+            }
+            if (d.escritura && d.lugar_memoria >= 0) {
+                listo[d.lugar_memoria] = resultado;
+                escritor[d.lugar_memoria] = ejecucion;
+            }
+        }
+    }
+
+    int critico = -1;
+    for (size_t l = 0; l < lugares; ++l) {
+        const double crecimiento = static_cast<double>(listo[l] - a_la_mitad[l]) / VUELTAS;
+        if (crecimiento > bucle.ciclos_dependencias) {
+            bucle.ciclos_dependencias = crecimiento;
+            critico = static_cast<int>(l);
+        }
+    }
+
+    // La cadena: desde el último que escribió el lugar crítico hacia atrás
+    // hasta repetir una instrucción; entre las dos apariciones está el ciclo
+    // (puede abarcar varias vueltas: A <- B de la anterior <- A de la otra)
+    if (critico >= 0) {
+        vector<int64_t> camino;
+        vector<int> visto(n, -1);   // instrucción -> posición en camino
+        for (int64_t e = escritor[critico]; e >= 0; e = causa[e]) {
+            const size_t k = static_cast<size_t>(e) % n;
+            if (visto[k] >= 0) {
+                const size_t desde_ciclo = static_cast<size_t>(visto[k]);
+                const int64_t primera = camino.back() / static_cast<int64_t>(n);
+                bucle.iteraciones = static_cast<int>(camino[desde_ciclo] / static_cast<int64_t>(n) -
+                                                     e / static_cast<int64_t>(n));
+                string via;
+                for (size_t c = camino.size(); c-- > desde_ciclo;) {
+                    const int64_t x = camino[c];
+                    const int l = lugar_causa[x];
+                    bucle.cadena.push_back(EslabonCadena{ static_cast<size_t>(x) % n, aporte[x],
+                                                          static_cast<int>(x / static_cast<int64_t>(n) - primera) });
+                    if (causa[x] / static_cast<int64_t>(n) != x / static_cast<int64_t>(n)) {
+                        const string nombre = (l < 8) ? string(NOMBRES_REG32[l])
+                                            : (l == LUGAR_EFLAGS) ? string("EFLAGS")
+                                            : texto_memoria(direcciones[l - NUM_LUGARES_REG]);
+                        if (via.find(nombre) == string::npos) via += (via.empty() ? "" : ", ") + nombre;
+                    }
+                }
+                bucle.via = via;
+                break;
+            }
+            visto[k] = static_cast<int>(camino.size());
+            camino.push_back(e);
+        }
+    }
+
+    bucle.ciclos = bucle.ciclos_puertos;
+    bucle.limite = "puertos";
+    if (bucle.ciclos_frontend > bucle.ciclos) {
+        bucle.ciclos = bucle.ciclos_frontend;
+        bucle.limite = "front-end";
+    }
+    if (bucle.ciclos_dependencias > bucle.ciclos) {
+        bucle.ciclos = bucle.ciclos_dependencias;
+        bucle.limite = "dependencias";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Texto
+// -----------------------------------------------------------------------------
+
+// Los símbolos ocultos del ensamblador llevan un espacio: "$ 12" y
+// "$$ .text" se muestran como en el fuente y un EQU de una expresión, así
+static string nombre_visible(string_view nombre) {
+    const size_t espacio = nombre.find(' ');
+    if (espacio == string_view::npos) return string(nombre);
+    if (nombre[0] == '=') return "(expresion)";
+    return string(nombre.substr(0, espacio));
+}
+
+string AnalizadorRendimiento::texto_memoria(const DireccionIR& mem) const {
+    string t = "[";
+    auto sumar = [&t](const string& parte) {
+        if (t.size() > 1) t += " + ";
+        t += parte;
+    };
+    if (mem.simbolo != SIN_SIMBOLO) sumar(nombre_visible(ens->simbolos.nombre(mem.simbolo)));
+    if (mem.base != SIN_REG) sumar(string(NOMBRES_REG32[mem.base]));
+    if (mem.indice != SIN_REG) {
+        sumar(string(NOMBRES_REG32[mem.indice]) + (mem.escala > 1 ? "*" + to_string(mem.escala) : ""));
+    }
+    if (mem.disp != 0 || t.size() == 1) {
+        if (t.size() == 1) {
+            t += to_string(mem.disp);
+        } else {
+            t += (mem.disp < 0 ? " - " : " + ");
+            t += to_string(mem.disp < 0 ? -static_cast<int64_t>(mem.disp) : mem.disp);
+        }
+    }
+    return t + "]";
+}
+
+string AnalizadorRendimiento::texto_instruccion(const InstruccionIR& ir) const {
+    const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+    string t(fila.mnem);
+    const PatronOperando patron[2] = { fila.op0, fila.op1 };
+    for (int k = 0; k < 2 && ir.tipo_op[k] != OP_NINGUNO; ++k) {
+        t += (k == 0) ? " " : ", ";
+        switch (ir.tipo_op[k]) {
+            case OP_R32:      t += NOMBRES_REG32[ir.reg[k]]; break;
+            case OP_R8:       t += NOMBRES_REG8[ir.reg[k]]; break;
+            case OP_ETIQUETA:
+            case OP_IMM_SIMBOLO: t += nombre_visible(ens->simbolos.nombre(ir.valor[k])); break;
+            case OP_MEM:
+                if (patron[k] == P_M8) t += "BYTE ";
+                t += texto_memoria(ir.mem);
+                break;
+            case OP_IMM: {
+                char buf[16];
+                const int32_t v = static_cast<int32_t>(ir.valor[k]);
+                if (v > -65536 && v < 65536) snprintf(buf, sizeof(buf), "%d", v);
+                else                   snprintf(buf, sizeof(buf), "0x%X", ir.valor[k]);
+                t += buf;
+                break;
+            }
+            default: break;
+        }
+    }
+    return t;
+}
+
+// Como "%6.2f" (o "     -" si es 0) sin snprintf: el informe de un programa
+// grande tiene millones de columnas
+static void columna(char* p, double valor) {
+    memset(p, ' ', 6);
+    if (valor <= 0) {
+        p[5] = '-';
+        return;
+    }
+    uint32_t centesimos = static_cast<uint32_t>(valor * 100 + 0.5);
+    if (centesimos > 99999) centesimos = 99999;
+    int i = 5;
+    for (int cifras = 0; cifras < 3 || centesimos > 0; ++cifras) {
+        if (cifras == 2) p[i--] = '.';
+        p[i--] = static_cast<char>('0' + centesimos % 10);
+        centesimos /= 10;
+    }
+}
+
+void AnalizadorRendimiento::escribir_informe(ostream& salida) const {
+    char buf[256];
+    size_t instrucciones = 0;
+    for (const BloqueBasico& b : lista_bloques) {
+        for (size_t i = b.primera; i < b.fin; ++i) instrucciones += ens->programa_ir[i].tipo == IR_INSTRUCCION;
+    }
+    salida << "Analisis de rendimiento (estimacion estatica, nucleo tipo Skylake)\n";
+    snprintf(buf, sizeof(buf), "  Instrucciones en .text: %zu   bloques basicos: %zu   bucles: %zu\n",
+             instrucciones, lista_bloques.size(), lista_bucles.size());
+    salida << buf;
+
+    for (const AnalisisBucle& b : lista_bucles) {
+        const string cabecera = (b.cabecera != SIN_SIMBOLO) ? nombre_visible(ens->simbolos.nombre(b.cabecera)) : "?";
+        snprintf(buf, sizeof(buf), "\nBucle %s [0x%08X, 0x%08X): %zu instrucciones, %.0f uops (%.0f fusionadas)\n",
+                 cabecera.c_str(), b.desde, b.hasta, b.instrucciones.size(), b.uops, b.uops_fusionadas);
+        salida << buf;
+        const bool por_puertos = b.limite == string_view("puertos");
+        snprintf(buf, sizeof(buf), "  Ciclos por iteracion: %.2f (limite: %s%s%s)   IPC %.2f\n",
+                 b.ciclos, b.limite, por_puertos ? " en " : "",
+                 por_puertos ? NOMBRES_RECURSOS[b.recurso_limite] : "",
+                 b.ciclos > 0 ? b.instrucciones.size() / b.ciclos : 0.0);
+        salida << buf;
+        snprintf(buf, sizeof(buf), "    puertos %.2f   front-end %.2f   dependencias %.2f\n",
+                 b.ciclos_puertos, b.ciclos_frontend, b.ciclos_dependencias);
+        salida << buf;
+
+        // Presión por recurso, total y por instrucción
+        salida << "  Presion por recurso (ciclos por iteracion):\n    ";
+        for (int r = 0; r < NUM_RECURSOS; ++r) {
+            snprintf(buf, sizeof(buf), "%6s", NOMBRES_RECURSOS[r]);
+            salida << buf;
+        }
+        salida << "\n    ";
+        for (int r = 0; r < NUM_RECURSOS; ++r) {
+            snprintf(buf, sizeof(buf), "%6.2f", b.presion[r]);
+            salida << buf;
+        }
+        salida << "\n  Instrucciones:\n    direccion   uops  lat";
+        for (int r = 0; r < NUM_RECURSOS; ++r) {
+            snprintf(buf, sizeof(buf), "%6s", NOMBRES_RECURSOS[r]);
+            salida << buf;
+        }
+        salida << "  instruccion\n";
+        for (const CostoEnBucle& c : b.instrucciones) {
+            snprintf(buf, sizeof(buf), "    0x%08X %5.0f %4u", c.direccion, c.uops, c.latencia);
+            salida << buf;
+            char columnas[6 * NUM_RECURSOS];
+            for (int r = 0; r < NUM_RECURSOS; ++r) columna(columnas + 6 * r, c.presion[r]);
+            salida.write(columnas, sizeof(columnas));
+            salida << "  " << c.texto << (c.fusion_macro ? "   (fusionada con la anterior)" : "") << '\n';
+        }
+
+        if (b.cadena.empty()) {
+            salida << "  Cadena critica: ninguna pasa de una iteracion a la siguiente\n";
+        } else {
+            snprintf(buf, sizeof(buf), "  Cadena critica (%.2f ciclos por iteracion, ciclo de %d %s, pasa por %s):\n",
+                     b.ciclos_dependencias, b.iteraciones, b.iteraciones == 1 ? "vuelta" : "vueltas",
+                     b.via.c_str());
+            salida << buf;
+            for (const EslabonCadena& e : b.cadena) {
+                const CostoEnBucle& c = b.instrucciones[e.instruccion];
+                snprintf(buf, sizeof(buf), "    0x%08X  +%-3u ", c.direccion, e.ciclos);
+                salida << buf;
+                if (b.iteraciones > 1) {
+                    snprintf(buf, sizeof(buf), "%-28s (vuelta %d)", c.texto.c_str(), e.vuelta + 1);
+                    salida << buf << '\n';
+                } else {
+                    salida << c.texto << '\n';
+                }
+            }
+        }
+
+        for (const CostoEnBucle& c : b.instrucciones) {
+            const string_view m = TABLA_OPCODES[ens->programa_ir[c.entrada].fila].mnem;
+            if (m == "LOOP" && por_puertos && b.recurso_limite == MICROCODIGO) {
+                salida << "  Nota: LOOP es microcodigo (7 uops, una cada 5 ciclos); "
+                          "DEC ECX + JNZ se fusionan en una sola uop\n";
+            } else if (m == "INT") {
+                salida << "  Nota: lo que cuesta la llamada al sistema (INT) no entra en la estimacion\n";
+            }
+        }
+    }
+}
@@ -0,0 +1,121 @@
+#ifndef ANALIZADOR_RENDIMIENTO_HPP
+#define ANALIZADOR_RENDIMIENTO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Análisis estático de rendimiento (informe al estilo de llvm-mca)
+// -----------------------------------------------------------------------------
+// Trabaja sobre la IR que deja ensamblar(), sin ejecutar nada. Corta .text en
+// bloques básicos (una etiqueta abre uno; JMP, Jcc, LOOP y RET lo cierran;
+// CALL no, porque vuelve) y toma como bucle cada salto a una etiqueta
+// anterior: el cuerpo son los bloques entre la etiqueta y el salto. Para
+// cada bucle los ciclos por iteración son el mayor de tres límites:
+//   - puertos: las uops de cada instrucción repartidas por igual entre los
+//     puertos que pueden ejecutarlas, más el divisor y el secuenciador de
+//     microcódigo, que no están segmentados
+//   - front-end: uops del dominio fusionado / ANCHO_EMISION
+//   - dependencias: la cadena que pasa de una iteración a la siguiente por
+//     registros, EFLAGS o memoria (un store y un load a la misma dirección)
+// Las latencias y puertos salen de una tabla por mnemónico (núcleo tipo
+// Skylake, L1 que siempre acierta, saltos bien predichos). Es una estimación
+// para comparar variantes de un bucle, no una medida: dentro del bucle se
+// cuentan todas las instrucciones del rango, también las de caminos que no
+// se recorren en cada vuelta. Sin IR (una pasada o acierto de caché) no hay
+// nada que analizar.
+
+enum RecursoEjecucion : uint8_t {
+    PUERTO_0, PUERTO_1, PUERTO_2, PUERTO_3, PUERTO_4, PUERTO_5, PUERTO_6, PUERTO_7,
+    UNIDAD_DIV,       // divisor: ocupado varios ciclos por DIV/IDIV
+    MICROCODIGO,      // secuenciador de microcódigo (LOOP, XCHG con memoria)
+    NUM_RECURSOS
+};
+
+inline constexpr const char* NOMBRES_RECURSOS[NUM_RECURSOS] = {
+    "P0", "P1", "P2", "P3", "P4", "P5", "P6", "P7", "DIV", "MS"
+};
+
+inline constexpr int ANCHO_EMISION = 4;   // uops fusionadas por ciclo del front-end
+
+// Rango de la IR de .text sin saltos hacia adentro ni hacia afuera
+struct BloqueBasico {
+    size_t   primera = 0;             // entradas de programa_ir [primera, fin)
+    size_t   fin = 0;
+    uint32_t direccion = 0;           // dirección absoluta de la primera instrucción
+    uint32_t etiqueta = SIN_SIMBOLO;  // primera etiqueta que lo nombra
+    int      sucesor[2] = {-1, -1};   // siguiente en orden y destino del salto (-1 = no hay)
+};
+
+// Una instrucción del cuerpo de un bucle con su costo
+struct CostoEnBucle {
+    size_t   entrada = 0;             // índice en programa_ir
+    uint32_t direccion = 0;
+    std::string texto;                // "ADD EDX, EBX"
+    uint32_t latencia = 0;            // ciclos hasta el resultado (con la carga, si hay)
+    double   uops = 0;                // dominio no fusionado (ejecución)
+    double   uops_fusionadas = 0;     // dominio fusionado (front-end)
+    double   presion[NUM_RECURSOS] = {};
+    bool     fusion_macro = false;    // Jcc unido a la CMP/TEST/ADD... anterior
+};
+
+// Paso de la cadena crítica: 'ciclos' es lo que agrega a la cadena
+struct EslabonCadena {
+    size_t   instruccion = 0;         // índice en CostoEnBucle
+    uint32_t ciclos = 0;
+    int      vuelta = 0;              // 0 = primera iteración que toca la cadena
+};
+
+struct AnalisisBucle {
+    uint32_t cabecera = SIN_SIMBOLO;  // etiqueta a la que vuelve el salto
+    size_t   primer_bloque = 0, ultimo_bloque = 0;
+    uint32_t desde = 0, hasta = 0;    // direcciones [desde, hasta)
+    std::vector<CostoEnBucle> instrucciones;
+
+    double presion[NUM_RECURSOS] = {};   // ciclos por iteración de cada recurso
+    double uops = 0, uops_fusionadas = 0;
+    double ciclos_puertos = 0;
+    double ciclos_frontend = 0;
+    double ciclos_dependencias = 0;
+    double ciclos = 0;                   // el mayor de los tres
+    const char* limite = "";             // "puertos", "front-end" o "dependencias"
+    int recurso_limite = -1;             // RecursoEjecucion más cargado
+
+    std::string via;                     // por dónde pasa a la vuelta siguiente: "EBX", "EFLAGS", "[x]"
+    std::vector<EslabonCadena> cadena;   // un ciclo completo, en orden de ejecución
+    int iteraciones = 0;                 // vueltas que abarca el ciclo (ciclos / iteraciones = recurrencia)
+};
+
+class AnalizadorRendimiento {
+public:
+    // Bloques y bucles del último ensamblado de 'ens'; false si no tiene IR.
+    // 'ens' tiene que seguir vivo (y sin reensamblar) mientras se use el informe
+    bool analizar(const EnsambladorIA32& ens);
+
+    const std::vector<BloqueBasico>& bloques() const { return lista_bloques; }
+    const std::vector<AnalisisBucle>& bucles() const { return lista_bucles; }
+
+    // Informe de texto: resumen, y por bucle los límites, la presión por
+    // recurso, cada instrucción y la cadena crítica
+    void escribir_informe(std::ostream& salida) const;
+
+    // Instrucción de la IR como texto de ensamblador ("MOV EAX, [fib0]")
+    std::string texto_instruccion(const InstruccionIR& ir) const;
+
+private:
+    const EnsambladorIA32* ens = nullptr;
+    std::vector<BloqueBasico> lista_bloques;
+    std::vector<AnalisisBucle> lista_bucles;
+
+    void armar_bloques();
+    void buscar_bucles();
+    void analizar_bucle(AnalisisBucle& bucle) const;   // costos, límites y cadena
+    std::string texto_memoria(const DireccionIR& mem) const;
+};
+
+#endif // ANALIZADOR_RENDIMIENTO_HPP
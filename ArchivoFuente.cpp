@@ -0,0 +1,118 @@
+#include "ArchivoFuente.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+
+ArchivoFuente::~ArchivoFuente() {
+    cerrar();
+}
+
+void ArchivoFuente::cerrar() {
+    if (mapeado && datos != nullptr) {
+        munmap(const_cast<char*>(datos), tamano);
+    }
+    datos = nullptr;
+    tamano = 0;
+    mapeado = false;
+    respaldo.clear();
+    inicios_linea.clear();
+}
+
+bool ArchivoFuente::abrir(const string& ruta) {
+    cerrar();
+
+    int fd = open(ruta.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        return false;
+    }
+
+    tamano = static_cast<size_t>(info.st_size);
+    if (tamano > numeric_limits<uint32_t>::max()) {
+        cerr << "Archivo demasiado grande (max 4 GiB): " << ruta << endl;
+        close(fd);
+        tamano = 0;
+        return false;
+    }
+
+    if (tamano > 0 && S_ISREG(info.st_mode)) {
+        void* p = mmap(nullptr, tamano, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            madvise(p, tamano, MADV_SEQUENTIAL);   // ambas pasadas leen en orden
+            datos = static_cast<const char*>(p);
+            mapeado = true;
+        }
+    }
+    close(fd);
+
+    // Respaldo (tuberías, sistemas sin mmap): una sola lectura completa
+    if (!mapeado) {
+        ifstream f(ruta, ios::binary);
+        if (!f.is_open()) return false;
+        respaldo.assign(istreambuf_iterator<char>(f), istreambuf_iterator<char>());
+        datos = respaldo.data();
+        tamano = respaldo.size();
+    }
+
+    indexar_lineas();
+    return true;
+}
+
+bool ArchivoFuente::usar_texto(string_view texto) {
+    cerrar();
+    if (texto.size() > numeric_limits<uint32_t>::max()) {
+        cerr << "Texto demasiado grande (max 4 GiB)" << endl;
+        return false;
+    }
+    respaldo.assign(texto.begin(), texto.end());
+    datos = respaldo.data();
+    tamano = respaldo.size();
+    indexar_lineas();
+    return true;
+}
+
+// Busca los '\n' de 16 en 16 bytes con SSE2; cada bit de la máscara es un
+// fin de línea y la siguiente línea empieza justo después.
+void ArchivoFuente::indexar_lineas() {
+    inicios_linea.clear();
+    if (tamano == 0) return;
+
+    inicios_linea.reserve(tamano / 24 + 1);   // ~24 bytes por línea típica
+    inicios_linea.push_back(0);
+
+    size_t i = 0;
+#if defined(__SSE2__)
+    const __m128i salto = _mm_set1_epi8('\n');
+    for (; i + 16 <= tamano; i += 16) {
+        __m128i bloque = _mm_loadu_si128(reinterpret_cast<const __m128i*>(datos + i));
+        unsigned mascara = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(bloque, salto)));
+        while (mascara != 0) {
+            size_t pos = i + static_cast<size_t>(__builtin_ctz(mascara));
+            if (pos + 1 < tamano) inicios_linea.push_back(static_cast<uint32_t>(pos + 1));
+            mascara &= mascara - 1;
+        }
+    }
+#endif
+    for (; i < tamano; ++i) {
+        const void* p = memchr(datos + i, '\n', tamano - i);
+        if (p == nullptr) break;
+        i = static_cast<size_t>(static_cast<const char*>(p) - datos);
+        if (i + 1 < tamano) inicios_linea.push_back(static_cast<uint32_t>(i + 1));
+    }
+}
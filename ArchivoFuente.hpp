@@ -0,0 +1,55 @@
+#ifndef ARCHIVO_FUENTE_HPP
+#define ARCHIVO_FUENTE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Archivo fuente mapeado en memoria con índice de líneas
+// -----------------------------------------------------------------------------
+// El archivo se mapea de solo lectura (mmap) y se guarda únicamente el
+// desplazamiento donde empieza cada línea (4 bytes por línea). Las líneas se
+// entregan como string_view al mapeo: no hay una reserva de memoria por línea
+// y ambas pasadas leen directamente las páginas del archivo.
+
+class ArchivoFuente {
+public:
+    ArchivoFuente() = default;
+    ~ArchivoFuente();
+
+    ArchivoFuente(const ArchivoFuente&) = delete;
+    ArchivoFuente& operator=(const ArchivoFuente&) = delete;
+
+    // Mapea el archivo y construye el índice; false si no se pudo abrir
+    bool abrir(const std::string& ruta);
+
+    // Fuente en memoria: se copia el texto (el llamador puede liberarlo)
+    bool usar_texto(std::string_view texto);
+    void cerrar();
+
+    size_t num_lineas() const { return inicios_linea.size(); }
+
+    // Todo el texto tal como se leyó
+    std::string_view contenido() const { return std::string_view(datos, tamano); }
+
+    // Línea i sin el '\n' final
+    std::string_view linea(size_t i) const {
+        size_t inicio = inicios_linea[i];
+        size_t fin = (i + 1 < inicios_linea.size()) ? inicios_linea[i + 1] - 1 : tamano;
+        return std::string_view(datos + inicio, fin - inicio);
+    }
+
+private:
+    const char* datos = nullptr;
+    size_t tamano = 0;
+    bool mapeado = false;                 // true = mmap, false = copia en respaldo
+    std::vector<char> respaldo;           // solo si mmap no está disponible
+    std::vector<uint32_t> inicios_linea;  // desplazamiento de cada línea
+
+    void indexar_lineas();
+};
+
+#endif // ARCHIVO_FUENTE_HPP
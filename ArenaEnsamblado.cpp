@@ -0,0 +1,29 @@
+#include "ArenaEnsamblado.hpp"
+
+#include <algorithm>
+
+using namespace std;
+
+// El bloque actual no alcanza: el siguiente que sirva (los que ya existían se
+// recorren en el mismo orden en cada ensamblado) o uno nuevo al final, del
+// tamaño de todo lo anterior para que la capacidad se duplique. Los bloques
+// vienen de new[], alineados para cualquier tipo: se empieza en 0
+void* ArenaEnsamblado::reservar_en_otro_bloque(size_t n, size_t /*alineacion*/) {
+    size_t i = actual;
+    if (usado > 0) {
+        antes_de_actual += bloques[i].tamano;
+        ++i;
+    }
+    for (; i < bloques.size() && bloques[i].tamano < n; ++i) antes_de_actual += bloques[i].tamano;
+    if (i == bloques.size()) {
+        const size_t tamano = max({ TAM_BLOQUE_MIN, total_bloques, n });
+        bloques.push_back(Bloque{ unique_ptr<uint8_t[]>(new uint8_t[tamano]), tamano });
+        total_bloques += tamano;
+        ++bloques_nuevos;
+    }
+
+    actual = i;
+    usado = n;
+    if (en_uso() > max_en_uso) max_en_uso = en_uso();
+    return bloques[actual].datos.get();
+}
@@ -0,0 +1,126 @@
+#ifndef ARENA_ENSAMBLADO_HPP
+#define ARENA_ENSAMBLADO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Arena de un ensamblado
+// -----------------------------------------------------------------------------
+// Reserva por desplazamiento sobre bloques grandes: reservar() solo avanza un
+// puntero y nada se libera por separado. reiniciar() vuelve al primer bloque
+// sin devolver ninguno, así que desde el segundo ensamblado del mismo tamaño
+// no se pide memoria al sistema. Lo que se reservó antes de reiniciar() deja
+// de ser válido. Una MarcaArena libera de golpe lo reservado dentro de una
+// función (generar_elf, la resolución...), para que llamarla muchas veces
+// sobre el mismo ensamblado no haga crecer la arena. No es segura entre
+// hilos: cada ensamblador tiene la suya.
+
+class ArenaEnsamblado {
+public:
+    ArenaEnsamblado() = default;
+    ArenaEnsamblado(const ArenaEnsamblado&) = delete;
+    ArenaEnsamblado& operator=(const ArenaEnsamblado&) = delete;
+
+    void* reservar(size_t n, size_t alineacion) {
+        ++num_reservas;
+        size_t inicio = (usado + alineacion - 1) & ~(alineacion - 1);
+        if (actual < bloques.size() && inicio + n <= bloques[actual].tamano) {
+            usado = inicio + n;
+            if (en_uso() > max_en_uso) max_en_uso = en_uso();
+            return bloques[actual].datos.get() + inicio;
+        }
+        return reservar_en_otro_bloque(n, alineacion);
+    }
+
+    // Si p es lo último que se reservó, su espacio vuelve a estar libre
+    // (un vector que crece al final de la arena no deja huecos)
+    void devolver(void* p, size_t n) {
+        if (actual < bloques.size() && static_cast<uint8_t*>(p) + n == bloques[actual].datos.get() + usado) {
+            usado -= n;
+        }
+    }
+
+    // O(1): todo lo reservado queda libre, los bloques se conservan
+    void reiniciar() {
+        actual = 0;
+        usado = 0;
+        antes_de_actual = 0;
+        num_reservas = 0;
+        max_en_uso = 0;
+        bloques_nuevos = 0;
+    }
+
+    // Contadores desde el último reiniciar()
+    uint64_t reservas() const { return num_reservas; }
+    size_t pico() const { return max_en_uso; }                // bytes ocupados a la vez, como máximo
+    uint64_t bloques_pedidos() const { return bloques_nuevos; }   // reservas al sistema
+    size_t capacidad() const { return total_bloques; }
+
+private:
+    struct Bloque {
+        std::unique_ptr<uint8_t[]> datos;
+        size_t tamano;
+    };
+    static constexpr size_t TAM_BLOQUE_MIN = 64 * 1024;
+
+    std::vector<Bloque> bloques;
+    size_t actual = 0;            // bloque en uso
+    size_t usado = 0;             // bytes ocupados del bloque actual
+    size_t antes_de_actual = 0;   // bytes de los bloques anteriores (se cuentan enteros)
+    size_t total_bloques = 0;
+    uint64_t num_reservas = 0;
+    size_t max_en_uso = 0;
+    uint64_t bloques_nuevos = 0;
+
+    size_t en_uso() const { return antes_de_actual + usado; }
+    void* reservar_en_otro_bloque(size_t n, size_t alineacion);
+
+    friend class MarcaArena;
+};
+
+// Al destruirse, la arena vuelve a como estaba al crearla
+class MarcaArena {
+public:
+    explicit MarcaArena(ArenaEnsamblado& a)
+        : arena(a), actual(a.actual), usado(a.usado), antes_de_actual(a.antes_de_actual) {}
+    ~MarcaArena() {
+        arena.actual = actual;
+        arena.usado = usado;
+        arena.antes_de_actual = antes_de_actual;
+    }
+
+    MarcaArena(const MarcaArena&) = delete;
+    MarcaArena& operator=(const MarcaArena&) = delete;
+
+private:
+    ArenaEnsamblado& arena;
+    size_t actual, usado, antes_de_actual;
+};
+
+// Asignador STL sobre una arena: deallocate solo recupera la última reserva
+template <class T>
+struct AsignadorArena {
+    using value_type = T;
+
+    ArenaEnsamblado* arena;
+
+    explicit AsignadorArena(ArenaEnsamblado& a) : arena(&a) {}
+    template <class U>
+    AsignadorArena(const AsignadorArena<U>& otro) : arena(otro.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->reservar(n * sizeof(T), alignof(T))); }
+    void deallocate(T* p, size_t n) { arena->devolver(p, n * sizeof(T)); }
+
+    template <class U>
+    bool operator==(const AsignadorArena<U>& otro) const { return arena == otro.arena; }
+    template <class U>
+    bool operator!=(const AsignadorArena<U>& otro) const { return arena != otro.arena; }
+};
+
+template <class T>
+using VectorArena = std::vector<T, AsignadorArena<T>>;
+
+#endif // ARENA_ENSAMBLADO_HPP
@@ -0,0 +1,184 @@
+#include "CacheEnsamblado.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+static constexpr char FIRMA[8] = { 'E', 'I', 'A', '3', '2', 'C', 'A', 'C' };
+static constexpr uint32_t VERSION_CACHE = 2;   // cambiarla invalida todas las entradas
+
+// -----------------------------------------------------------------------------
+// Clave
+// -----------------------------------------------------------------------------
+
+static uint64_t rotar(uint64_t x, int n) {
+    return (x << n) | (x >> (64 - n));
+}
+
+// Avalancha final de MurmurHash3
+static uint64_t mezclar(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDull;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ull;
+    x ^= x >> 33;
+    return x;
+}
+
+// Dos cadenas independientes de multiplicar y rotar, de 8 en 8 bytes
+static void agregar(uint64_t (&h)[2], string_view datos) {
+    const char* p = datos.data();
+    size_t n = datos.size();
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t w;
+        memcpy(&w, p, 8);
+        h[0] = rotar((h[0] ^ w) * 0x9E3779B97F4A7C15ull, 31);
+        h[1] = rotar((h[1] ^ w) * 0xC2B2AE3D27D4EB4Full, 29);
+    }
+    uint64_t w = 0;
+    memcpy(&w, p, n);
+    h[0] = rotar((h[0] ^ w ^ n) * 0x9E3779B97F4A7C15ull, 31);
+    h[1] = rotar((h[1] ^ w ^ n) * 0xC2B2AE3D27D4EB4Full, 29);
+}
+
+ClaveCache calcular_clave_cache(string_view fuente, string_view opciones) {
+    uint64_t h[2] = { 0x243F6A8885A308D3ull, 0x13198A2E03707344ull };
+    agregar(h, opciones);
+    agregar(h, fuente);
+    ClaveCache c;
+    c.h[0] = mezclar(h[0] ^ fuente.size());
+    c.h[1] = mezclar(h[1] ^ rotar(h[0], 17));
+    return c;
+}
+
+const string& identidad_ejecutable() {
+    static const string identidad = [] {
+        string id = __DATE__ " " __TIME__;   // si no se puede leer el ejecutable
+        int fd = open("/proc/self/exe", O_RDONLY);
+        if (fd < 0) return id;
+        struct stat info;
+        if (fstat(fd, &info) == 0 && info.st_size > 0) {
+            const size_t n = static_cast<size_t>(info.st_size);
+            void* p = mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                id = calcular_clave_cache(string_view(static_cast<const char*>(p), n), "").texto();
+                munmap(p, n);
+            }
+        }
+        close(fd);
+        return id;
+    }();
+    return identidad;
+}
+
+string ClaveCache::texto() const {
+    char buf[33];
+    snprintf(buf, sizeof(buf), "%016llx%016llx",
+             static_cast<unsigned long long>(h[0]), static_cast<unsigned long long>(h[1]));
+    return buf;
+}
+
+static string ruta_entrada(const string& directorio, const ClaveCache& clave) {
+    return directorio + "/" + clave.texto() + ".eia";
+}
+
+static void escribir_u64(EscritorCache& e, uint64_t v) {
+    e.u32(static_cast<uint32_t>(v));
+    e.u32(static_cast<uint32_t>(v >> 32));
+}
+
+static void cabecera(EscritorCache& e, const ClaveCache& clave, const uint8_t* contenido, size_t tamano) {
+    e.bytes(FIRMA, sizeof(FIRMA));
+    e.u32(VERSION_CACHE);
+    escribir_u64(e, clave.h[0]);
+    escribir_u64(e, clave.h[1]);
+    escribir_u64(e, tamano);
+    escribir_u64(e, calcular_clave_cache(string_view(reinterpret_cast<const char*>(contenido), tamano), "").h[0]);
+}
+
+// -----------------------------------------------------------------------------
+// Lectura
+// -----------------------------------------------------------------------------
+
+EntradaCache::~EntradaCache() {
+    cerrar();
+}
+
+void EntradaCache::cerrar() {
+    if (datos != nullptr) munmap(const_cast<uint8_t*>(datos), tamano);
+    datos = nullptr;
+    tamano = 0;
+}
+
+bool EntradaCache::abrir(const string& directorio, const ClaveCache& clave) {
+    cerrar();
+    int fd = open(ruta_entrada(directorio, clave).c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < TAM_CABECERA) {
+        close(fd);
+        return false;
+    }
+    const size_t n = static_cast<size_t>(info.st_size);
+    void* p = mmap(nullptr, n, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (p == MAP_FAILED) return false;
+    datos  = static_cast<const uint8_t*>(p);
+    tamano = n;
+
+    // La cabecera tiene que ser exactamente la que se escribiría hoy
+    EscritorCache esperada;
+    cabecera(esperada, clave, datos + TAM_CABECERA, n - TAM_CABECERA);
+    if (memcmp(datos, esperada.datos.data(), TAM_CABECERA) != 0) {
+        cerrar();
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Escritura
+// -----------------------------------------------------------------------------
+
+static bool escribir_todo(int fd, const uint8_t* p, size_t n) {
+    while (n > 0) {
+        ssize_t escritos = write(fd, p, n);
+        if (escritos < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        p += escritos;
+        n -= static_cast<size_t>(escritos);
+    }
+    return true;
+}
+
+bool escribir_entrada_cache(const string& directorio, const ClaveCache& clave,
+                            const vector<uint8_t>& contenido) {
+    if (mkdir(directorio.c_str(), 0755) != 0 && errno != EEXIST) return false;
+
+    const string destino  = ruta_entrada(directorio, clave);
+    static atomic<unsigned> escrituras{0};   // varios hilos del proceso pueden escribir la misma clave
+    const string temporal = destino + ".tmp." + to_string(getpid()) + "." + to_string(escrituras++);
+    int fd = open(temporal.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return false;
+
+    EscritorCache c;
+    cabecera(c, clave, contenido.data(), contenido.size());
+    bool ok = escribir_todo(fd, c.datos.data(), c.datos.size()) &&
+              escribir_todo(fd, contenido.data(), contenido.size()) &&
+              fsync(fd) == 0;   // que el rename no pueda dejar un archivo vacío tras un corte
+    ok = (close(fd) == 0) && ok;
+    if (ok) ok = rename(temporal.c_str(), destino.c_str()) == 0;
+    if (!ok) unlink(temporal.c_str());
+    return ok;
+}
@@ -0,0 +1,111 @@
+#ifndef CACHE_ENSAMBLADO_HPP
+#define CACHE_ENSAMBLADO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Caché en disco direccionada por contenido
+// -----------------------------------------------------------------------------
+// La clave es un hash de 128 bits del fuente, de las opciones que cambian la
+// salida y del propio ejecutable (no criptográfico: protege de cambios
+// accidentales, no de alguien que fabrique colisiones). Cada entrada es el
+// archivo <clave>.eia del
+// directorio, con una cabecera (firma, versión, clave, tamaño) y el contenido
+// que arma el ensamblador.
+//
+// Leer una entrada es un mmap. Escribirla es un temporal propio (proceso y
+// escritura) que se renombra al final: rename() es atómico dentro del mismo
+// sistema de archivos, así que nadie ve una entrada a medias y si dos
+// procesos o hilos la escriben a la vez queda una de las dos, completa.
+
+struct ClaveCache {
+    uint64_t h[2] = {};
+    std::string texto() const;   // 32 dígitos hexadecimales
+};
+
+ClaveCache calcular_clave_cache(std::string_view fuente, std::string_view opciones);
+
+// Hash del ejecutable en curso (/proc/self/exe), calculado una vez: va en
+// las opciones para que otra versión del ensamblador no use estas entradas
+const std::string& identidad_ejecutable();
+
+// Entrada mapeada de solo lectura; contenido() es lo que se guardó
+class EntradaCache {
+public:
+    EntradaCache() = default;
+    ~EntradaCache();
+
+    EntradaCache(const EntradaCache&) = delete;
+    EntradaCache& operator=(const EntradaCache&) = delete;
+
+    // false si no existe, la cabecera no corresponde a 'clave' o el
+    // contenido no coincide con su hash (archivo dañado)
+    bool abrir(const std::string& directorio, const ClaveCache& clave);
+    void cerrar();
+
+    const uint8_t* contenido() const { return datos + TAM_CABECERA; }
+    size_t tamano_contenido() const { return tamano - TAM_CABECERA; }
+
+    static constexpr size_t TAM_CABECERA = 8 + 4 + 16 + 8 + 8;   // firma, versión, clave, tamaño, hash
+
+private:
+    const uint8_t* datos = nullptr;
+    size_t tamano = 0;
+};
+
+// Escribe la entrada de 'clave' (crea el directorio si falta); false si no se pudo
+bool escribir_entrada_cache(const std::string& directorio, const ClaveCache& clave,
+                            const std::vector<uint8_t>& contenido);
+
+// -----------------------------------------------------------------------------
+// Contenido: enteros little-endian y bloques de bytes
+// -----------------------------------------------------------------------------
+
+class EscritorCache {
+public:
+    void u8(uint8_t v) { datos.push_back(v); }
+    void u32(uint32_t v) {
+        for (int i = 0; i < 4; ++i) datos.push_back(static_cast<uint8_t>((v >> (8 * i)) & 0xFF));
+    }
+    void bytes(const void* p, size_t n) {
+        const uint8_t* b = static_cast<const uint8_t*>(p);
+        datos.insert(datos.end(), b, b + n);
+    }
+
+    std::vector<uint8_t> datos;
+};
+
+// Cada lectura verifica que quede lo que pide; false = entrada truncada
+class LectorCache {
+public:
+    LectorCache(const uint8_t* datos, size_t tamano) : p(datos), fin(datos + tamano) {}
+
+    bool u8(uint8_t& v) {
+        if (fin - p < 1) return false;
+        v = *p++;
+        return true;
+    }
+    bool u32(uint32_t& v) {
+        if (fin - p < 4) return false;
+        v = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        p += 4;
+        return true;
+    }
+    bool bytes(size_t n, const uint8_t*& inicio) {
+        if (static_cast<size_t>(fin - p) < n) return false;
+        inicio = p;
+        p += n;
+        return true;
+    }
+    bool terminado() const { return p == fin; }
+
+private:
+    const uint8_t* p;
+    const uint8_t* fin;
+};
+
+#endif // CACHE_ENSAMBLADO_HPP
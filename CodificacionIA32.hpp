@@ -0,0 +1,388 @@
+#ifndef CODIFICACION_IA32_HPP
+#define CODIFICACION_IA32_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "TablaOpcodes.hpp"
+#include "AnalizadorLexico.hpp"
+#include "RepresentacionIntermedia.hpp"
+#include "ExpresionIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Núcleo de codificación (constexpr)
+// -----------------------------------------------------------------------------
+// Elegir la fila de TABLA_OPCODES para unos operandos, normalizar un
+// direccionamiento y pasar una instrucción de la IR a bytes. Todo es
+// constexpr y no depende del estado del ensamblador: lo usan la PASADA 1 y
+// la PASADA 2 de EnsambladorIA32 y también ensamblar_constante(), que hace
+// lo mismo al compilar. Así los dos codificadores no pueden diferir.
+//
+// Las funciones de codificación escriben en un Emisor con:
+//   void byte(uint8_t b);
+//   void dword(uint32_t d);                     // little-endian
+//   void referencia(uint32_t simbolo, int tamano, int tipo_salto);
+// referencia() se llama justo antes del campo (rel8 / rel32 / dirección
+// absoluta) que hay que parchear con la dirección del símbolo; tipo_salto
+// 1 = relativo al fin del campo, 0 = absoluto (el campo lleva el sumando).
+
+// Operando ya clasificado para buscar su forma en TABLA_OPCODES
+enum TipoOperando : uint8_t {
+    OP_NINGUNO, OP_R32, OP_R8, OP_IMM, OP_MEM, OP_ETIQUETA,
+    OP_IMM_SIMBOLO    // inmediato = dirección o valor de un símbolo (etiqueta o EQU): siempre imm32
+};
+
+struct Operando {
+    TipoOperando tipo = OP_NINGUNO;
+    uint8_t  reg = 0;          // código de registro (OP_R32 / OP_R8)
+    uint32_t inmediato = 0;    // valor (OP_IMM) o id de símbolo (OP_ETIQUETA / OP_IMM_SIMBOLO)
+    uint8_t  tam_mem = 0;      // pista de tamaño (OP_MEM): 0 = sin pista, 1 = BYTE, 4 = DWORD
+    std::string_view texto;    // texto original del operando (etiqueta o mensajes)
+    DireccionIR  mem;          // OP_MEM ya analizado
+};
+
+// std::swap es constexpr recién en C++20
+template <typename T>
+constexpr void intercambiar(T& a, T& b) {
+    const T t = a;
+    a = b;
+    b = t;
+}
+
+constexpr uint8_t generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm) {
+    return static_cast<uint8_t>((mod << 6) | (reg << 3) | rm);
+}
+
+// -----------------------------------------------------------------------------
+// Elección de la fila
+// -----------------------------------------------------------------------------
+
+constexpr bool coincide_patron(PatronOperando patron, const Operando& op) {
+    switch (patron) {
+        case P_NADA:  return op.tipo == OP_NINGUNO;
+        case P_R32:   return op.tipo == OP_R32;
+        case P_EAX:   return op.tipo == OP_R32 && op.reg == 0b000;
+        case P_R8:    return op.tipo == OP_R8;
+        case P_M32:   return op.tipo == OP_MEM && op.tam_mem != 1;
+        case P_M8:    return op.tipo == OP_MEM && op.tam_mem != 4;
+        case P_RM32:  return op.tipo == OP_R32 || (op.tipo == OP_MEM && op.tam_mem != 1);
+        case P_IMM:   return op.tipo == OP_IMM || op.tipo == OP_IMM_SIMBOLO;   // el símbolo no cabe en imm8
+        case P_IMM8S: return op.tipo == OP_IMM &&
+                             static_cast<int32_t>(op.inmediato) >= -128 &&
+                             static_cast<int32_t>(op.inmediato) <= 127;
+        case P_IMM8U: return op.tipo == OP_IMM && op.inmediato <= 0xFF;
+        case P_ETIQ:  return op.tipo == OP_ETIQUETA;
+        case P_MOFFS: return op.tipo == OP_MEM && op.tam_mem != 1 &&
+                             op.mem.base == SIN_REG && op.mem.indice == SIN_REG;
+    }
+    return false;
+}
+
+constexpr bool coincide_fila(const FilaOpcode& fila, const Operando* ops, int num_ops) {
+    const Operando ninguno;
+    const int ops_fila = (fila.op0 != P_NADA) + (fila.op1 != P_NADA);
+    return ops_fila == num_ops &&
+           coincide_patron(fila.op0, num_ops > 0 ? ops[0] : ninguno) &&
+           coincide_patron(fila.op1, num_ops > 1 ? ops[1] : ninguno);
+}
+
+// Índice de la primera de 'filas' (las de un mnemónico, en orden de
+// preferencia) cuya firma coincide con los operandos; num_filas si ninguna.
+// Sin comparar punteros con nullptr: con -fsanitize=undefined GCC deja de
+// aceptar esa comparación en una expresión constante (EnsambladoConstante.hpp)
+constexpr size_t indice_fila(const FilaOpcode* filas, size_t num_filas,
+                             const Operando* ops, int num_ops) {
+    for (size_t i = 0; i < num_filas; ++i) {
+        if (coincide_fila(filas[i], ops, num_ops)) return i;
+    }
+    return num_filas;
+}
+
+// La fila de indice_fila(); nullptr si ninguna
+constexpr const FilaOpcode* elegir_fila(const FilaOpcode* filas, size_t num_filas,
+                                        const Operando* ops, int num_ops) {
+    size_t i = indice_fila(filas, num_filas, ops, num_ops);
+    return i < num_filas ? &filas[i] : nullptr;
+}
+
+// La IR de una instrucción con la fila ya elegida (sin la decisión de salto)
+constexpr InstruccionIR armar_ir(const FilaOpcode& fila, const Operando* ops, int num_ops) {
+    InstruccionIR ir{};
+    ir.tipo = IR_INSTRUCCION;
+    ir.fila = static_cast<uint16_t>(&fila - TABLA_OPCODES);
+    for (int k = 0; k < num_ops; ++k) {
+        ir.tipo_op[k] = ops[k].tipo;
+        ir.reg[k]     = ops[k].reg;
+        ir.valor[k]   = ops[k].inmediato;
+        if (ops[k].tipo == OP_MEM) ir.mem = ops[k].mem;
+    }
+    return ir;
+}
+
+// -----------------------------------------------------------------------------
+// Direccionamientos de memoria
+// -----------------------------------------------------------------------------
+
+// Términos de un [..] tal como se escribieron
+struct TerminosMemoria {
+    uint8_t  regs[2]    = {SIN_REG, SIN_REG};
+    uint32_t escalas[2] = {1, 1};
+    int      num_regs   = 0;
+    ValorExpresion desplazamiento;   // números, etiquetas y expresiones, ya sumados
+};
+
+inline constexpr const char* MEMORIA_NO_SOPORTADA = "direccionamiento de memoria no soportado";
+
+// Suma de términos separados por + / -: registro, registro*escala (o
+// escala*registro) y expresiones (ExpresionIA32.hpp). Las etiquetas que
+// queden en el desplazamiento las resuelve quien llama. Devuelve nullptr o
+// el mensaje de error
+template <typename Resolver>
+constexpr const char* analizar_terminos(const Token* t, size_t n, TerminosMemoria& m, Resolver& resolver) {
+    m = TerminosMemoria();
+    size_t i = 0;
+    while (i < n) {
+        bool negativo = false;
+        if (t[i].tipo == T_MAS || t[i].tipo == T_MENOS) {
+            negativo = (t[i].tipo == T_MENOS);
+            ++i;
+        } else if (i != 0) {
+            return MEMORIA_NO_SOPORTADA;   // términos sin operador entre ellos
+        }
+        if (i == n) return MEMORIA_NO_SOPORTADA;
+
+        // REG, REG*N o N*REG
+        const Token* reg = nullptr;
+        uint32_t escala = 1;
+        if (t[i].tipo == T_REG32) {
+            reg = &t[i++];
+            if (i + 1 < n && t[i].tipo == T_POR) {
+                if (t[i + 1].tipo != T_NUMERO) return MEMORIA_NO_SOPORTADA;
+                escala = t[i + 1].valor;
+                if (escala == 0 || escala > 9) return MEMORIA_NO_SOPORTADA;
+                i += 2;
+            }
+        } else if (t[i].tipo == T_NUMERO && i + 2 < n && t[i + 1].tipo == T_POR && t[i + 2].tipo == T_REG32) {
+            escala = t[i].valor;
+            if (escala == 0 || escala > 9) return MEMORIA_NO_SOPORTADA;
+            reg = &t[i + 2];
+            i += 3;
+        }
+        if (reg != nullptr) {
+            if (negativo || m.num_regs == 2) return MEMORIA_NO_SOPORTADA;
+            m.regs[m.num_regs] = reg->reg;
+            m.escalas[m.num_regs++] = escala;
+            continue;
+        }
+
+        // Número o identificador suelto (lo de siempre) o una expresión
+        const bool suelto = i + 1 == n || t[i + 1].tipo == T_MAS || t[i + 1].tipo == T_MENOS;
+        const size_t fin = suelto ? i + 1 : fin_termino(t, i, n);
+        ValorExpresion v;
+        if (fin == i + 1 && t[i].tipo == T_NUMERO) {
+            v.constante = t[i].valor;
+        } else if (fin == i + 1 && t[i].tipo == T_IDENT) {
+            if (const char* error = resolver.simbolo(t[i].texto, v)) return error;
+        } else if (fin == i + 1) {
+            return MEMORIA_NO_SOPORTADA;
+        } else if (const char* error = evaluar_expresion(t + i, fin - i, resolver, v)) {
+            return error;
+        }
+        if (const char* error = operar(negativo ? T_MENOS : T_MAS, m.desplazamiento, v, resolver)) return error;
+        i = fin;
+    }
+    return nullptr;
+}
+
+// [etiqueta + regs[0]*escalas[0] + regs[1]*escalas[1] + disp] en la forma
+// que codificar_direccion() emite más corta (sin el id de la etiqueta, que
+// pone quien llama). false si no hay codificación (dos escalas, ESP índice...)
+//   - un registro sin escala es base; con escala, o el segundo, es índice
+//   - ESP no puede ser índice: con escala 1 pasa a base
+//   - sin base, INDICE*2/3/5/9 = INDICE + INDICE*1/2/4/8 (sin disp32)
+//   - EBP como base pide disp8: con INDICE*1 y sin desplazamiento se invierten
+constexpr bool armar_direccion(const uint8_t* r, const uint32_t* e, int num_regs, bool con_etiqueta,
+                               uint32_t disp, DireccionIR& mem) {
+    uint8_t regs[2] = {SIN_REG, SIN_REG};
+    uint32_t escalas[2] = {1, 1};
+    for (int k = 0; k < num_regs; ++k) {
+        regs[k] = r[k];
+        escalas[k] = e[k];
+    }
+    mem = DireccionIR();
+
+    // El registro con escala (o el segundo) es el índice
+    if (num_regs == 2 && escalas[0] != 1) {
+        intercambiar(regs[0], regs[1]);
+        intercambiar(escalas[0], escalas[1]);
+    }
+    if (num_regs == 2 && escalas[0] != 1) return false;   // dos registros con escala
+    if (num_regs == 1 && escalas[0] == 1) {
+        mem.base = regs[0];
+    } else if (num_regs == 1) {
+        mem.indice = regs[0];
+        mem.escala = static_cast<uint8_t>(escalas[0]);
+    } else if (num_regs == 2) {
+        mem.base   = regs[0];
+        mem.indice = regs[1];
+        mem.escala = static_cast<uint8_t>(escalas[1]);
+    }
+
+    if (mem.base == SIN_REG && mem.indice != SIN_REG &&
+        (mem.escala == 2 || mem.escala == 3 || mem.escala == 5 || mem.escala == 9)) {
+        mem.base = mem.indice;
+        mem.escala -= 1;
+    }
+    if (mem.indice == 0b100 && mem.escala == 1 && mem.base != 0b100) intercambiar(mem.base, mem.indice);
+    if (mem.base == 0b101 && mem.indice != SIN_REG && mem.indice != 0b100 && mem.escala == 1 &&
+        disp == 0 && !con_etiqueta) {
+        intercambiar(mem.base, mem.indice);
+    }
+
+    if (mem.indice == 0b100) return false;   // ESP no puede ser índice
+    if (mem.indice != SIN_REG && mem.escala != 1 && mem.escala != 2 && mem.escala != 4 && mem.escala != 8) {
+        return false;
+    }
+    if (mem.indice == SIN_REG) mem.escala = 1;
+
+    mem.disp = static_cast<int32_t>(disp);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// IR -> bytes
+// -----------------------------------------------------------------------------
+
+// ModR/M [+ SIB] + desplazamiento con la forma más corta:
+//   - sin base: MOD=00 con R/M=101 (o base=101 en el SIB) y disp32
+//   - con base: MOD=00 sin desplazamiento, 01 con disp8, 10 con disp32;
+//     EBP no tiene la forma MOD=00 (es la de disp32): [EBP] va con disp8 = 0
+//   - con índice, o con base ESP (R/M=100 es "sigue un SIB"), va SIB; sin
+//     índice el SIB lleva 100
+// Con etiqueta el disp32 es su dirección: el desplazamiento queda escrito en
+// el hueco y la resolución lo suma.
+template <typename Emisor>
+constexpr void codificar_direccion(Emisor& e, const DireccionIR& mem, uint8_t reg_field) {
+    const bool con_etiqueta = mem.simbolo != SIN_SIMBOLO;
+    const bool disp8 = mem.disp >= -128 && mem.disp <= 127;
+
+    uint8_t mod = 0b10;
+    if (mem.base == SIN_REG)                                 mod = 0b00;   // disp32 sin base
+    else if (con_etiqueta)                                   mod = 0b10;
+    else if (mem.disp == 0 && mem.base != 0b101)             mod = 0b00;
+    else if (disp8)                                          mod = 0b01;
+
+    const uint8_t base = (mem.base == SIN_REG) ? 0b101 : mem.base;
+    if (mem.indice == SIN_REG && base != 0b100) {
+        e.byte(generar_modrm(mod, reg_field, base));   // REG = registro o extensión /digit
+    } else {
+        e.byte(generar_modrm(mod, reg_field, 0b100));
+        const uint8_t scale = (mem.escala == 8) ? 0b11 : (mem.escala == 4) ? 0b10 : (mem.escala == 2) ? 0b01 : 0b00;
+        const uint8_t indice = (mem.indice == SIN_REG) ? 0b100 : mem.indice;
+        e.byte(static_cast<uint8_t>((scale << 6) | (indice << 3) | base));
+    }
+
+    if (mod == 0b01) {
+        e.byte(static_cast<uint8_t>(mem.disp & 0xFF));
+    } else if (mod == 0b10 || mem.base == SIN_REG) {
+        if (con_etiqueta) e.referencia(mem.simbolo, 4, 0);   // absoluto (dirección)
+        e.dword(static_cast<uint32_t>(mem.disp));
+    }
+}
+
+template <typename Emisor>
+constexpr void codificar_rm(Emisor& e, const InstruccionIR& ir, int num_op, uint8_t reg_field) {
+    if (ir.tipo_op[num_op] == OP_MEM) {
+        codificar_direccion(e, ir.mem, reg_field);
+    } else {
+        e.byte(generar_modrm(0b11, reg_field, ir.reg[num_op])); // MOD=11 (registro)
+    }
+}
+
+// JMP/Jcc: rel8 si ir.salto_corto (el desplazamiento ya viene en valor[1]);
+// si no, la forma near (rel32), que siempre alcanza
+template <typename Emisor>
+constexpr void codificar_salto(Emisor& e, const FilaOpcode& fila, const InstruccionIR& ir) {
+    if (ir.salto_corto) {
+        e.byte(fila.opcode); // EB / 7x rel8
+        e.byte(static_cast<uint8_t>(ir.valor[1] & 0xFF));
+        return;
+    }
+    if (fila.prefijo != 0) e.byte(fila.prefijo); // 0F en Jcc
+    e.byte(fila.ext);                            // E9 / 8x
+    e.referencia(ir.valor[0], 4, 1);             // relativo
+    e.dword(0); // placeholder rel32
+}
+
+// Bytes de una entrada IR_INSTRUCCION
+template <typename Emisor>
+constexpr void codificar_instruccion(Emisor& e, const InstruccionIR& ir) {
+    const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+
+    switch (fila.cod) {
+        case C_SALTO:
+            codificar_salto(e, fila, ir);
+            return;
+
+        case C_REL8:
+        case C_REL32: {
+            const int tamano = (fila.cod == C_REL8) ? 1 : 4;
+            e.byte(fila.opcode);
+            e.referencia(ir.valor[0], tamano, 1); // relativo
+            if (tamano == 1) e.byte(0x00); else e.dword(0); // placeholder
+            return;
+        }
+
+        case C_MOFFS:
+            // [RESULTADO + 4]: la dirección absoluta va tras el opcode (con
+            // etiqueta, el desplazamiento queda en el hueco como sumando)
+            e.byte(fila.opcode);
+            if (ir.mem.simbolo != SIN_SIMBOLO) e.referencia(ir.mem.simbolo, 4, 0); // absoluto (dirección)
+            e.dword(static_cast<uint32_t>(ir.mem.disp));
+            return;
+
+        default:
+            break;
+    }
+
+    if (fila.prefijo != 0) e.byte(fila.prefijo);
+
+    switch (fila.cod) {
+        case C_SOLO_OPCODE:
+            e.byte(fila.opcode);
+            break;
+        case C_MAS_REG:
+            e.byte(static_cast<uint8_t>(fila.opcode + ir.reg[0]));
+            break;
+        case C_MODRM_RM_REG:
+            e.byte(fila.opcode);
+            codificar_rm(e, ir, 0, ir.reg[1]);
+            break;
+        case C_MODRM_REG_RM:
+            e.byte(fila.opcode);
+            codificar_rm(e, ir, 1, ir.reg[0]);
+            break;
+        case C_MODRM_EXT:
+            e.byte(fila.opcode);
+            codificar_rm(e, ir, 0, fila.ext);
+            break;
+        default:
+            break;
+    }
+
+    // Inmediato al final (siempre es el último operando)
+    if (fila.tam_imm != 0) {
+        const int k = (ir.tipo_op[1] == OP_IMM || ir.tipo_op[1] == OP_IMM_SIMBOLO) ? 1 : 0;
+        if (ir.tipo_op[k] == OP_IMM_SIMBOLO) {
+            e.referencia(ir.valor[k], 4, 0);   // absoluto: dirección (o valor del EQU)
+            e.dword(0);
+        } else if (fila.tam_imm == 1) {
+            e.byte(static_cast<uint8_t>(ir.valor[k] & 0xFF));
+        } else {
+            e.dword(ir.valor[k]);
+        }
+    }
+}
+
+#endif // CODIFICACION_IA32_HPP
@@ -0,0 +1,91 @@
+#include "CodigoJIT.hpp"
+
+#include <cstring>
+#include <iostream>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+using namespace std;
+
+static size_t redondear(size_t valor, size_t multiplo) {
+    return (valor + multiplo - 1) / multiplo * multiplo;
+}
+
+CodigoJIT::CodigoJIT() {
+    ens.usar_salida_detallada(false);
+}
+
+CodigoJIT::~CodigoJIT() {
+    liberar();
+}
+
+void CodigoJIT::liberar() {
+    if (mapeo != nullptr) munmap(mapeo, tamano);
+    mapeo  = nullptr;
+    tamano = 0;
+}
+
+bool CodigoJIT::cargar(string_view codigo) {
+    liberar();
+
+    ens.ensamblar_texto(codigo);
+    if (ens.num_errores() != 0) {
+        cerr << "JIT: " << ens.num_errores() << " error(es) de ensamblado" << endl;
+        return false;
+    }
+
+    // .text en sus propias páginas (RX); .data y .bss juntos a continuación (RW)
+    const size_t pagina     = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t tam_texto  = redondear(max<size_t>(ens.tamano_seccion(SEC_TEXT), 1), pagina);
+    const size_t inicio_bss = redondear(ens.tamano_seccion(SEC_DATA), 4);
+    const size_t tam_datos  = redondear(inicio_bss + ens.tamano_seccion(SEC_BSS), pagina);
+    tamano = tam_texto + tam_datos;
+
+    int banderas = MAP_PRIVATE | MAP_ANONYMOUS;
+#if defined(__x86_64__) && defined(MAP_32BIT)
+    banderas |= MAP_32BIT;   // disp32/imm32 absolutos: la zona debe quedar bajo 4 GiB
+#endif
+    void* p = mmap(nullptr, tamano, PROT_READ | PROT_WRITE, banderas, -1, 0);
+    if (p == MAP_FAILED) {
+        cerr << "JIT: mmap fallo" << endl;
+        tamano = 0;
+        return false;
+    }
+    mapeo = p;
+
+    const uintptr_t base = reinterpret_cast<uintptr_t>(p);
+    if (static_cast<uint64_t>(base) + tamano > 0xFFFFFFFFull) {   // en 64 bits, sin MAP_32BIT
+        cerr << "JIT: la zona no queda en los primeros 4 GiB" << endl;
+        liberar();
+        return false;
+    }
+
+    // Las referencias absolutas pasan a la dirección real de la zona
+    const uint32_t bases[NUM_SECCIONES] = {
+        static_cast<uint32_t>(base),
+        static_cast<uint32_t>(base + tam_texto),
+        static_cast<uint32_t>(base + tam_texto + inicio_bss)
+    };
+    ens.reubicar(bases);
+
+    uint8_t* zona = static_cast<uint8_t*>(p);
+    const vector<uint8_t>& texto = ens.bytes_seccion(SEC_TEXT);
+    const vector<uint8_t>& datos = ens.bytes_seccion(SEC_DATA);
+    if (!texto.empty()) memcpy(zona, texto.data(), texto.size());
+    if (!datos.empty()) memcpy(zona + tam_texto, datos.data(), datos.size());
+    // .bss ya está en ceros (mapeo anónimo)
+
+    if (mprotect(p, tam_texto, PROT_READ | PROT_EXEC) != 0) {
+        cerr << "JIT: mprotect fallo" << endl;
+        liberar();
+        return false;
+    }
+    return true;
+}
+
+void* CodigoJIT::direccion(string_view etiqueta) const {
+    uint32_t dir = 0;
+    if (mapeo == nullptr || !ens.buscar_simbolo(etiqueta, dir)) return nullptr;
+    return reinterpret_cast<void*>(static_cast<uintptr_t>(dir));
+}
@@ -0,0 +1,58 @@
+#ifndef CODIGO_JIT_HPP
+#define CODIGO_JIT_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "EnsambladorIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Ejecución en memoria (JIT)
+// -----------------------------------------------------------------------------
+// Ensambla un texto, reserva con mmap una zona para .text | .data | .bss,
+// reubica el programa a esa dirección real (EnsambladorIA32::reubicar) y deja
+// .text como PROT_READ | PROT_EXEC y los datos como PROT_READ | PROT_WRITE.
+//
+// El código es IA-32: solo se puede llamar desde un proceso de 32 bits
+// (g++ -m32 en un host x86-64). En x86-64 la zona se pide con MAP_32BIT para
+// que las direcciones absolutas quepan en 32 bits, pero funcion() devuelve
+// nullptr.
+
+#if defined(__i386__)
+inline constexpr bool EJECUCION_NATIVA_IA32 = true;
+#else
+inline constexpr bool EJECUCION_NATIVA_IA32 = false;
+#endif
+
+class CodigoJIT {
+public:
+    CodigoJIT();
+    ~CodigoJIT();
+
+    CodigoJIT(const CodigoJIT&) = delete;
+    CodigoJIT& operator=(const CodigoJIT&) = delete;
+
+    // Ensambla y carga; false si hubo errores de ensamblado o de mmap
+    bool cargar(std::string_view codigo);
+    void liberar();
+
+    // Dirección real de una etiqueta en la zona cargada (nullptr si no existe)
+    void* direccion(std::string_view etiqueta) const;
+
+    // Puntero a función listo para llamar, p. ej. funcion<int (*)()>("suma")
+    template <typename F>
+    F funcion(std::string_view etiqueta) const {
+        if (!EJECUCION_NATIVA_IA32) return nullptr;
+        return reinterpret_cast<F>(direccion(etiqueta));
+    }
+
+    const EnsambladorIA32& ensamblador() const { return ens; }
+
+private:
+    EnsambladorIA32 ens;
+    void*  mapeo  = nullptr;
+    size_t tamano = 0;
+};
+
+#endif // CODIGO_JIT_HPP
@@ -0,0 +1,209 @@
+#include "ConstructorIA32.hpp"
+
+#include <array>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Filas de cada mnemónico (una búsqueda por mnemónico en todo el programa)
+// -----------------------------------------------------------------------------
+
+static constexpr string_view NOMBRES_MNEMONICOS[] = {
+    "MOV", "ADD", "SUB", "CMP", "AND", "OR", "XOR", "TEST", "XCHG", "IMUL", "MOVZX", "LEA",
+    "INC", "DEC", "MUL", "DIV", "IDIV", "PUSH", "POP", "INT",
+    "LEAVE", "RET", "NOP", "CALL", "LOOP", "JMP",
+    "JE", "JNE", "JLE", "JL", "JG", "JGE", "JA", "JAE", "JB", "JBE",
+};
+
+struct FilasMnemonico {
+    const FilaOpcode* filas = nullptr;
+    size_t cantidad = 0;
+};
+
+static const FilasMnemonico* filas_mnemonicos() {
+    static const auto tabla = [] {
+        constexpr size_t n = sizeof(NOMBRES_MNEMONICOS) / sizeof(NOMBRES_MNEMONICOS[0]);
+        array<FilasMnemonico, n> t{};
+        for (size_t i = 0; i < n; ++i) t[i].filas = buscar_filas_opcode(NOMBRES_MNEMONICOS[i], t[i].cantidad);
+        return t;
+    }();
+    return tabla.data();
+}
+
+// "r32", "imm"... para los mensajes de error (no hay texto que citar)
+static const char* nombre_operando(const Operando& op) {
+    switch (op.tipo) {
+        case OP_R32:      return "r32";
+        case OP_R8:       return "r8";
+        case OP_IMM:      return "imm";
+        case OP_MEM:      return op.tam_mem == 1 ? "BYTE [m]" : op.tam_mem == 4 ? "DWORD [m]" : "[m]";
+        case OP_ETIQUETA: return "etiqueta";
+        default:          return "[direccion invalida]";
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Inicio y fin
+// -----------------------------------------------------------------------------
+
+ConstructorIA32::ConstructorIA32(EnsambladorIA32& e) : ens(e) {
+    ens.errores = 0;
+    ens.tiempos = TiemposFases();
+    ens.fuente.usar_texto("");   // sin líneas: nada de una sesión o caché anterior
+    ens.reiniciar_estado();
+    inicio = chrono::steady_clock::now();
+}
+
+int ConstructorIA32::terminar() {
+    if (terminado) return ens.errores;
+    terminado = true;
+    ens.cambiar_seccion(SEC_TEXT);   // guarda el contador de la última sección
+    ens.tiempos.pasada1 = chrono::duration<double>(chrono::steady_clock::now() - inicio).count();
+    ens.terminar_ensamblado();
+    return ens.errores;
+}
+
+// -----------------------------------------------------------------------------
+// Operandos e instrucciones
+// -----------------------------------------------------------------------------
+
+Operando ConstructorIA32::operando(const Memoria& m) {
+    Operando op;
+    if (!armar_direccion(m.regs, m.escalas, m.num_regs, m.simbolo != SIN_SIMBOLO, m.disp, op.mem)) {
+        return op;   // OP_NINGUNO: ninguna fila coincide y se informa el error
+    }
+    op.tipo = OP_MEM;
+    op.tam_mem = m.tam;
+    op.mem.simbolo = m.simbolo;
+    return op;
+}
+
+void ConstructorIA32::instruccion(Mnemonico m, const Operando* ops, int num_ops) {
+    static_assert(size(NOMBRES_MNEMONICOS) == NUM_MNEMONICOS, "un nombre por Mnemonico");
+    const FilasMnemonico& f = filas_mnemonicos()[m];
+    const char* error = nullptr;
+    if (terminado) {
+        error = "instruccion despues de terminar()";
+    } else if (ens.seccion_actual == SEC_BSS) {
+        error = "instruccion en .bss";
+    } else {
+        for (int k = 0; k < num_ops && error == nullptr; ++k) {
+            const uint32_t id = ops[k].tipo == OP_ETIQUETA ? ops[k].inmediato
+                              : ops[k].tipo == OP_MEM      ? ops[k].mem.simbolo : SIN_SIMBOLO;
+            if ((ops[k].tipo == OP_ETIQUETA || id != SIN_SIMBOLO) && id >= ens.tabla_simbolos.size()) {
+                error = "etiqueta que no es de este ensamblado";
+            }
+        }
+        if (error == nullptr && ens.agregar_instruccion(f.filas, f.cantidad, ops, num_ops)) return;
+        if (error == nullptr) error = "forma no soportada";
+    }
+
+    ++ens.errores;
+    *ens.salida_errores << "Error: " << error << ": " << NOMBRES_MNEMONICOS[m];
+    for (int k = 0; k < num_ops; ++k) *ens.salida_errores << (k ? ", " : " ") << nombre_operando(ops[k]);
+    *ens.salida_errores << endl;
+}
+
+// -----------------------------------------------------------------------------
+// Etiquetas y directivas (lo mismo que procesar_* deja en la IR)
+// -----------------------------------------------------------------------------
+
+void ConstructorIA32::entrada(InstruccionIR& ir) {
+    if (terminado) {
+        ++ens.errores;
+        *ens.salida_errores << "Error: directiva despues de terminar()" << endl;
+        return;
+    }
+    ens.agregar_ir(ir);
+}
+
+bool ConstructorIA32::etiqueta_valida(Etiqueta e) {
+    if (e.id < ens.tabla_simbolos.size()) return true;
+    ++ens.errores;
+    *ens.salida_errores << "Error: etiqueta que no es de este ensamblado" << endl;
+    return false;
+}
+
+Etiqueta ConstructorIA32::etiqueta(string_view nombre) {
+    return Etiqueta{ens.id_simbolo(nombre)};
+}
+
+Etiqueta ConstructorIA32::nueva_etiqueta() {
+    char nombre[16] = ".C";
+    size_t n = 2;
+    char digitos[10];
+    size_t d = 0;
+    uint32_t v = anonimas++;
+    do {
+        digitos[d++] = static_cast<char>('0' + v % 10);
+        v /= 10;
+    } while (v != 0);
+    while (d > 0) nombre[n++] = digitos[--d];
+    return etiqueta(string_view(nombre, n));
+}
+
+void ConstructorIA32::definir(Etiqueta e) {
+    if (!etiqueta_valida(e)) return;
+    InstruccionIR ir{};
+    ir.tipo     = IR_ETIQUETA;
+    ir.valor[0] = e.id;
+    entrada(ir);
+}
+
+// Como procesar_ambito(): la IR guarda la declaración, ambito_simbolo el efecto
+void ConstructorIA32::ambito(Etiqueta e, AmbitoSimbolo a) {
+    if (!etiqueta_valida(e)) return;
+    InstruccionIR ir{};
+    ir.tipo     = IR_AMBITO;
+    ir.valor[0] = e.id;
+    ir.reg[0]   = a;
+    ens.ambito_simbolo[e.id] = a;
+    entrada(ir);
+}
+
+void ConstructorIA32::seccion(IdSeccion s) {
+    InstruccionIR ir{};
+    ir.tipo     = IR_SECCION;
+    ir.valor[0] = s;
+    entrada(ir);
+}
+
+void ConstructorIA32::datos(int tamano, const uint32_t* valores, size_t cantidad) {
+    InstruccionIR ir{};
+    ir.tipo     = IR_DATOS;
+    ir.reg[0]   = static_cast<uint8_t>(tamano);
+    ir.valor[0] = static_cast<uint32_t>(ens.datos_ir.size());
+    ir.valor[1] = static_cast<uint32_t>(cantidad);
+    ens.datos_ir.insert(ens.datos_ir.end(), valores, valores + cantidad);
+
+    // Igual que procesar_datos(): en .bss queda como reserva en ceros
+    if (ens.seccion_actual == SEC_BSS) {
+        *ens.salida_errores << "Advertencia: datos inicializados en .bss (se reserva espacio en ceros)" << endl;
+        ens.datos_ir.resize(ir.valor[0]);
+        ir.tipo     = IR_RESERVA;
+        ir.valor[0] = ir.valor[1] * static_cast<uint32_t>(tamano);
+        ir.valor[1] = 0;
+    }
+    entrada(ir);
+}
+
+void ConstructorIA32::reservar_bytes(uint32_t bytes) {
+    InstruccionIR ir{};
+    ir.tipo     = IR_RESERVA;
+    ir.valor[0] = bytes;
+    entrada(ir);
+}
+
+void ConstructorIA32::alinear(uint32_t alineacion, bool con_nop) {
+    if (alineacion == 0 || alineacion > 4096 || (alineacion & (alineacion - 1)) != 0) {
+        ++ens.errores;
+        *ens.salida_errores << "Error en ALIGN: la alineacion debe ser una potencia de 2 hasta 4096: "
+                            << alineacion << endl;
+        return;
+    }
+    InstruccionIR ir{};
+    ir.tipo     = IR_ALINEACION;
+    ir.valor[0] = alineacion;
+    ir.reg[0]   = (con_nop || ens.seccion_actual == SEC_TEXT) ? RELLENO_NOP : RELLENO_CEROS;
+    entrada(ir);
+}
@@ -0,0 +1,196 @@
+#ifndef CONSTRUCTOR_IA32_HPP
+#define CONSTRUCTOR_IA32_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+
+#include "EnsambladorIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Constructor de programas desde C++ (sin texto)
+// -----------------------------------------------------------------------------
+// Hace la PASADA 1 con llamadas en lugar de líneas:
+//
+//     ConstructorIA32 a(ens);
+//     Etiqueta bucle = a.nueva_etiqueta();
+//     a.definir(bucle);
+//     a.mov(EAX, mem(EBP, -8));
+//     a.dec(ECX);
+//     a.jcc(CC_NE, bucle);
+//     a.terminar();             // -Os, relajación, PASADA 2 y referencias
+//
+// Los operandos ya vienen tipados, así que no hay tokenizar ni clasificar:
+// cada llamada arma los Operando y entra por agregar_instruccion(), el mismo
+// punto que usa el texto. Las filas, la IR, la relajación y la codificación
+// son las de siempre y el resultado es el mismo que el del texto equivalente
+// (bytes, símbolos, referencias; generar_* sobre 'ens' funciona igual).
+//
+// Ninguna instrucción pide memoria: los operandos van en la pila y la IR
+// crece en programa_ir (reservar() evita también esas realocaciones). Las
+// etiquetas son ids de símbolo; solo nombrarlas cuesta un internado.
+//
+// Las opciones (una pasada, -Os, --alinear-bucles, hilos de la PASADA 2)
+// son las de 'ens'. Un error (p. ej. una forma que no está en TABLA_OPCODES)
+// va a la salida de errores de 'ens' y cuenta en num_errores().
+
+struct Reg32 { uint8_t codigo; };
+struct Reg8  { uint8_t codigo; };
+
+inline constexpr Reg32 EAX{0}, ECX{1}, EDX{2}, EBX{3}, ESP{4}, EBP{5}, ESI{6}, EDI{7};
+inline constexpr Reg8  AL{0}, CL{1}, DL{2}, BL{3}, AH{4}, CH{5}, DH{6}, BH{7};
+
+// Id de símbolo de 'ens' (no sirve con otro ensamblador)
+struct Etiqueta { uint32_t id = SIN_SIMBOLO; };
+
+// [etiqueta + regs[0]*escalas[0] + regs[1]*escalas[1] + disp] tal como se
+// escribió; armar_direccion() lo normaliza igual que a un [..] del texto
+struct Memoria {
+    uint8_t  regs[2]    = {SIN_REG, SIN_REG};
+    uint32_t escalas[2] = {1, 1};
+    uint8_t  num_regs   = 0;
+    uint32_t disp       = 0;
+    uint32_t simbolo    = SIN_SIMBOLO;
+    uint8_t  tam        = 0;   // pista de tamaño: 0, 1 = BYTE, 4 = DWORD
+};
+
+constexpr Memoria mem(uint32_t disp) {
+    Memoria m;
+    m.disp = disp;
+    return m;
+}
+constexpr Memoria mem(Reg32 base, int32_t disp = 0) {
+    Memoria m = mem(static_cast<uint32_t>(disp));
+    m.regs[0] = base.codigo;
+    m.num_regs = 1;
+    return m;
+}
+constexpr Memoria mem(Reg32 base, Reg32 indice, uint32_t escala, int32_t disp = 0) {
+    Memoria m = mem(base, disp);
+    m.regs[1] = indice.codigo;
+    m.escalas[1] = escala;
+    m.num_regs = 2;
+    return m;
+}
+constexpr Memoria mem(Etiqueta e, int32_t disp = 0) {
+    Memoria m = mem(static_cast<uint32_t>(disp));
+    m.simbolo = e.id;
+    return m;
+}
+constexpr Memoria mem(Etiqueta e, Reg32 indice, uint32_t escala, int32_t disp = 0) {
+    Memoria m = mem(e, disp);
+    m.regs[0] = indice.codigo;
+    m.escalas[0] = escala;
+    m.num_regs = 1;
+    return m;
+}
+
+// "BYTE [..]" / "DWORD [..]"
+constexpr Memoria byte_ptr(Memoria m)  { m.tam = 1; return m; }
+constexpr Memoria dword_ptr(Memoria m) { m.tam = 4; return m; }
+
+// Condición de Jcc (mismo orden que MN_JE.. en ConstructorIA32)
+enum CondicionSalto : uint8_t {
+    CC_E, CC_NE, CC_LE, CC_L, CC_G, CC_GE, CC_A, CC_AE, CC_B, CC_BE,
+    CC_Z = CC_E, CC_NZ = CC_NE
+};
+
+class ConstructorIA32 {
+public:
+    // Empieza un ensamblado nuevo en 'ens' (descarta el anterior), en .text
+    explicit ConstructorIA32(EnsambladorIA32& ens);
+    ConstructorIA32(const ConstructorIA32&) = delete;
+    ConstructorIA32& operator=(const ConstructorIA32&) = delete;
+
+    // Entradas de IR que se esperan (evita realocar programa_ir)
+    void reservar(size_t entradas) { ens.programa_ir.reserve(entradas); }
+
+    // Lo que sigue a la PASADA 1; devuelve num_errores(). Después ya no se
+    // puede agregar nada
+    int terminar();
+
+    // --- Etiquetas y directivas ---
+    Etiqueta etiqueta(string_view nombre);   // por nombre (la misma si ya existe)
+    Etiqueta nueva_etiqueta();               // anónima: ".C0", ".C1"...
+    void definir(Etiqueta e);                // "nombre:" en la posición actual
+    void global(Etiqueta e)  { ambito(e, AMBITO_GLOBAL); }
+    void externa(Etiqueta e) { ambito(e, AMBITO_EXTERNO); }
+    void seccion(IdSeccion s);
+    void dd(initializer_list<uint32_t> valores) { datos(4, valores.begin(), valores.size()); }
+    void db(initializer_list<uint32_t> valores) { datos(1, valores.begin(), valores.size()); }
+    void datos(int tamano, const uint32_t* valores, size_t cantidad);   // DD (4) / DB (1)
+    void reservar_bytes(uint32_t bytes);     // RESB
+    void alinear(uint32_t alineacion, bool con_nop = false);
+
+    // --- Instrucciones (las formas de TABLA_OPCODES) ---
+    template <typename A, typename B> void mov(A a, B b)   { dos(MN_MOV, a, b); }
+    template <typename A, typename B> void add(A a, B b)   { dos(MN_ADD, a, b); }
+    template <typename A, typename B> void sub(A a, B b)   { dos(MN_SUB, a, b); }
+    template <typename A, typename B> void cmp(A a, B b)   { dos(MN_CMP, a, b); }
+    template <typename A, typename B> void and_(A a, B b)  { dos(MN_AND, a, b); }
+    template <typename A, typename B> void or_(A a, B b)   { dos(MN_OR, a, b); }
+    template <typename A, typename B> void xor_(A a, B b)  { dos(MN_XOR, a, b); }
+    template <typename A, typename B> void test(A a, B b)  { dos(MN_TEST, a, b); }
+    template <typename A, typename B> void xchg(A a, B b)  { dos(MN_XCHG, a, b); }
+    template <typename A, typename B> void imul(A a, B b)  { dos(MN_IMUL, a, b); }
+    template <typename A, typename B> void movzx(A a, B b) { dos(MN_MOVZX, a, b); }
+    template <typename A, typename B> void lea(A a, B b)   { dos(MN_LEA, a, b); }
+
+    template <typename A> void inc(A a)  { uno(MN_INC, a); }
+    template <typename A> void dec(A a)  { uno(MN_DEC, a); }
+    template <typename A> void mul(A a)  { uno(MN_MUL, a); }
+    template <typename A> void div(A a)  { uno(MN_DIV, a); }
+    template <typename A> void idiv(A a) { uno(MN_IDIV, a); }
+    template <typename A> void push(A a) { uno(MN_PUSH, a); }
+    template <typename A> void pop(A a)  { uno(MN_POP, a); }
+    void int_(uint32_t numero)           { uno(MN_INT, numero); }
+
+    void leave() { instruccion(MN_LEAVE, nullptr, 0); }
+    void ret()   { instruccion(MN_RET, nullptr, 0); }
+    void nop()   { instruccion(MN_NOP, nullptr, 0); }
+
+    void call(Etiqueta e)                    { uno(MN_CALL, e); }
+    void loop(Etiqueta e)                    { uno(MN_LOOP, e); }
+    void jmp(Etiqueta e)                     { uno(MN_JMP, e); }
+    void jcc(CondicionSalto cc, Etiqueta e)  { uno(static_cast<Mnemonico>(MN_JE + static_cast<int>(cc)), e); }
+
+private:
+    // Mnemónicos que usa el constructor; las filas de cada uno se buscan una
+    // sola vez (NOMBRES_MNEMONICOS en el mismo orden)
+    enum Mnemonico : uint8_t {
+        MN_MOV, MN_ADD, MN_SUB, MN_CMP, MN_AND, MN_OR, MN_XOR, MN_TEST, MN_XCHG, MN_IMUL, MN_MOVZX, MN_LEA,
+        MN_INC, MN_DEC, MN_MUL, MN_DIV, MN_IDIV, MN_PUSH, MN_POP, MN_INT,
+        MN_LEAVE, MN_RET, MN_NOP, MN_CALL, MN_LOOP, MN_JMP,
+        MN_JE, MN_JNE, MN_JLE, MN_JL, MN_JG, MN_JGE, MN_JA, MN_JAE, MN_JB, MN_JBE,
+        NUM_MNEMONICOS
+    };
+
+    EnsambladorIA32& ens;
+    uint32_t anonimas = 0;
+    bool terminado = false;
+    chrono::steady_clock::time_point inicio;
+
+    static Operando operando(Reg32 r)    { Operando op; op.tipo = OP_R32; op.reg = r.codigo; return op; }
+    static Operando operando(Reg8 r)     { Operando op; op.tipo = OP_R8;  op.reg = r.codigo; return op; }
+    static Operando operando(int32_t v)  { Operando op; op.tipo = OP_IMM; op.inmediato = static_cast<uint32_t>(v); return op; }
+    static Operando operando(uint32_t v) { Operando op; op.tipo = OP_IMM; op.inmediato = v; return op; }
+    static Operando operando(Etiqueta e) { Operando op; op.tipo = OP_ETIQUETA; op.inmediato = e.id; return op; }
+    static Operando operando(const Memoria& m);
+
+    template <typename A> void uno(Mnemonico m, A a) {
+        const Operando ops[1] = {operando(a)};
+        instruccion(m, ops, 1);
+    }
+    template <typename A, typename B> void dos(Mnemonico m, A a, B b) {
+        const Operando ops[2] = {operando(a), operando(b)};
+        instruccion(m, ops, 2);
+    }
+    void instruccion(Mnemonico m, const Operando* ops, int num_ops);
+    void entrada(InstruccionIR& ir);   // directiva -> IR (como procesar_*)
+    void ambito(Etiqueta e, AmbitoSimbolo a);
+    bool etiqueta_valida(Etiqueta e);  // error si no es un id de 'ens'
+};
+
+#endif // CONSTRUCTOR_IA32_HPP
@@ -0,0 +1,1187 @@
+#include "EmuladorIA32.hpp"
+
+#include <cstdio>
+#include <cstring>
+
+using namespace std;
+
+// La memoria se lee y escribe con memcpy de 4 bytes: el anfitrión tiene que
+// ser little-endian como IA-32
+static_assert(__BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__, "el emulador supone un anfitrión little-endian");
+
+// -----------------------------------------------------------------------------
+// Operaciones decodificadas
+// -----------------------------------------------------------------------------
+// Sufijos de forma: RR = reg, reg; RI = reg, imm; RM = reg, [mem];
+// MR = [mem], reg; MI = [mem], imm. Las binarias van en grupos de cinco en
+// ese orden, así que OP_X_RR + FORMA_... elige la forma.
+//
+// En las de un operando r/m (TEST, XCHG, IMUL, MOVZX, MUL, DIV, IDIV) r0 es el
+// registro del campo REG y r1 el de R/M; r1 = REG_CERO quiere decir memoria.
+
+enum OperacionEmulada : uint8_t {
+    OP_ENLACE,     // no es del programa: sigue en 'destino' (el tramo llegó a código ya decodificado)
+    OP_FUERA,      // no es del programa: el flujo sale de .text hacia 'inmediato'
+    OP_INVALIDA,   // bytes fuera del subconjunto
+    OP_MOV_RR, OP_MOV_RI, OP_MOV_RM, OP_MOV_MR, OP_MOV_MI,
+    OP_ADD_RR, OP_ADD_RI, OP_ADD_RM, OP_ADD_MR, OP_ADD_MI,
+    OP_SUB_RR, OP_SUB_RI, OP_SUB_RM, OP_SUB_MR, OP_SUB_MI,
+    OP_AND_RR, OP_AND_RI, OP_AND_RM, OP_AND_MR, OP_AND_MI,
+    OP_OR_RR,  OP_OR_RI,  OP_OR_RM,  OP_OR_MR,  OP_OR_MI,
+    OP_XOR_RR, OP_XOR_RI, OP_XOR_RM, OP_XOR_MR, OP_XOR_MI,
+    OP_CMP_RR, OP_CMP_RI, OP_CMP_RM, OP_CMP_MR, OP_CMP_MI,
+    OP_TEST, OP_XCHG, OP_IMUL, OP_MOVZX, OP_LEA,
+    OP_INC_R, OP_INC_M, OP_DEC_R, OP_DEC_M,
+    OP_MUL, OP_DIV, OP_IDIV,
+    OP_PUSH_R, OP_PUSH_I, OP_PUSH_M, OP_POP_R, OP_POP_M,
+    OP_INT, OP_LEAVE, OP_RET, OP_NOP,
+    OP_CALL, OP_LOOP, OP_JMP, OP_JCC,
+    NUM_OPERACIONES
+};
+
+enum FormaBinaria : uint8_t { FORMA_RR, FORMA_RI, FORMA_RM, FORMA_MR, FORMA_MI };
+
+// Qué hay guardado en Banderas para sacar CF y OF
+enum TipoBanderas : uint8_t {
+    B_LOGICA,   // AND, OR, XOR, TEST: CF = OF = 0
+    B_SUMA,     // ADD
+    B_RESTA,    // SUB, CMP
+    B_INC,      // CF no cambia (queda en 'cf')
+    B_DEC,
+    B_MUL       // MUL, IMUL: CF = OF = 'cf'
+};
+
+static constexpr bool tiene_destino(uint8_t op) {
+    return op == OP_CALL || op == OP_LOOP || op == OP_JMP || op == OP_JCC;
+}
+
+// Después de estas el flujo no sigue en la instrucción siguiente
+static constexpr bool corta_tramo(uint8_t op) {
+    return op == OP_JMP || op == OP_RET || op == OP_INVALIDA;
+}
+
+// Números de errno de Linux que devuelve INT 0x80
+static constexpr uint32_t ERRNO_EBADF  = 9;
+static constexpr uint32_t ERRNO_EFAULT = 14;
+static constexpr uint32_t ERRNO_ENOSYS = 38;
+
+// -----------------------------------------------------------------------------
+// Decodificación
+// -----------------------------------------------------------------------------
+
+// ModR/M (+ SIB + desplazamiento) de 32 bits
+struct ModRM {
+    uint8_t  reg = 0;        // campo REG (registro o /digit)
+    uint8_t  rm = 0;         // registro si es_registro
+    bool     es_registro = false;
+    uint8_t  base = 8, indice = 8, escala = 0;   // 8 = REG_CERO
+    uint32_t disp = 0;
+};
+
+static bool leer_modrm(const uint8_t*& p, const uint8_t* fin, ModRM& m) {
+    if (p >= fin) return false;
+    const uint8_t b = *p++;
+    const uint8_t mod = b >> 6;
+    m.reg = (b >> 3) & 7;
+    const uint8_t rm = b & 7;
+    if (mod == 3) {
+        m.es_registro = true;
+        m.rm = rm;
+        return true;
+    }
+
+    bool disp32_solo = false;   // [disp32] sin base
+    if (rm == 4) {
+        if (p >= fin) return false;
+        const uint8_t sib = *p++;
+        const uint8_t idx = (sib >> 3) & 7;
+        if (idx != 4) {
+            m.indice = idx;
+            m.escala = sib >> 6;
+        }
+        if ((sib & 7) == 5 && mod == 0) disp32_solo = true;
+        else m.base = sib & 7;
+    } else if (rm == 5 && mod == 0) {
+        disp32_solo = true;
+    } else {
+        m.base = rm;
+    }
+
+    if (mod == 1) {
+        if (p >= fin) return false;
+        m.disp = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(*p++)));
+    } else if (mod == 2 || disp32_solo) {
+        if (fin - p < 4) return false;
+        m.disp = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        p += 4;
+    }
+    return true;
+}
+
+// Fila de las formas decodificables que el ensamblador no emite (JO, JS...)
+static constexpr uint16_t SIN_FILA = static_cast<uint16_t>(NUM_FILAS_OPCODES + 1);
+
+// Fila de TABLA_OPCODES que emite estos bytes (SIN_FILA si ninguna)
+static uint16_t fila_de(bool dos_bytes, uint8_t opcode, int ext) {
+    for (size_t i = 0; i < NUM_FILAS_OPCODES; ++i) {
+        const FilaOpcode& f = TABLA_OPCODES[i];
+        const bool mismo_prefijo = (f.prefijo == 0x0F) == dos_bytes;
+        bool coincide;
+        switch (f.cod) {
+            case C_MAS_REG:
+                coincide = !dos_bytes && opcode >= f.opcode && opcode < f.opcode + 8;
+                break;
+            case C_MODRM_EXT:
+                coincide = !dos_bytes && opcode == f.opcode && ext == f.ext;
+                break;
+            case C_SALTO:
+                coincide = (!dos_bytes && opcode == f.opcode) || (mismo_prefijo && opcode == f.ext);
+                break;
+            default:
+                coincide = mismo_prefijo && opcode == f.opcode;
+                break;
+        }
+        if (coincide) return static_cast<uint16_t>(i);
+    }
+    return SIN_FILA;
+}
+
+// Grupo 1 (/digit de 81 y 83, y opcode >> 3 de las formas 01/03/05): el
+// primer OP_X_RR de esa operación, o 0 si no es del subconjunto
+static uint8_t binaria_de(uint8_t ext) {
+    switch (ext) {
+        case 0: return OP_ADD_RR;
+        case 1: return OP_OR_RR;
+        case 4: return OP_AND_RR;
+        case 5: return OP_SUB_RR;
+        case 6: return OP_XOR_RR;
+        case 7: return OP_CMP_RR;
+        default: return 0;
+    }
+}
+
+// Decodifica la instrucción en 'direccion' (dentro de .text). Si no es del
+// subconjunto queda OP_INVALIDA de un byte y devuelve false
+bool EmuladorIA32::decodificar_una(uint32_t direccion, Decodificada& d) const {
+    const uint8_t* texto = memoria.data() + (base_texto - inicio);
+    const uint8_t* const comienzo = texto + (direccion - base_texto);
+    const uint8_t* const fin = texto + tam_texto;
+    const uint8_t* p = comienzo;
+
+    d = Decodificada{};
+    d.direccion = direccion;
+    d.r0 = d.r1 = d.base = d.indice = REG_CERO;
+    d.fila = static_cast<uint16_t>(NUM_FILAS_OPCODES);
+
+    auto invalida = [&]() {
+        d.op = OP_INVALIDA;
+        d.longitud = 1;
+        return false;
+    };
+    auto imm32 = [&](uint32_t& v) {
+        if (fin - p < 4) return false;
+        v = p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+        p += 4;
+        return true;
+    };
+    auto imm8s = [&](uint32_t& v) {
+        if (p >= fin) return false;
+        v = static_cast<uint32_t>(static_cast<int32_t>(static_cast<int8_t>(*p++)));
+        return true;
+    };
+    auto memoria_de = [&](const ModRM& m) {
+        d.base = m.base;
+        d.indice = m.indice;
+        d.escala = m.escala;
+        d.disp = m.disp;
+    };
+    // r1 = registro de R/M, o REG_CERO y el operando de memoria
+    auto rm_de = [&](const ModRM& m) {
+        if (m.es_registro) d.r1 = m.rm;
+        else memoria_de(m);
+    };
+    // Destino de un salto relativo: ya leído el desplazamiento, p está al final
+    auto relativo = [&](uint32_t rel) {
+        d.inmediato = direccion + static_cast<uint32_t>(p - comienzo) + rel;
+    };
+
+    ModRM m;
+    const uint8_t b = *p++;
+    bool dos_bytes = false;
+    uint8_t opcode = b;
+    int ext = -1;
+
+    if (b == 0x66) {
+        // Solo los NOP de relleno de ALIGN: 66 90 y 66 0F 1F /0
+        if (p < fin && *p == 0x90) {
+            ++p;
+            d.op = OP_NOP;
+        } else if (fin - p >= 2 && p[0] == 0x0F && p[1] == 0x1F) {
+            p += 2;
+            if (!leer_modrm(p, fin, m) || m.reg != 0) return invalida();
+            d.op = OP_NOP;
+        } else {
+            return invalida();
+        }
+        d.longitud = static_cast<uint8_t>(p - comienzo);
+        return true;
+    }
+
+    if (b < 0x40 && binaria_de(b >> 3) != 0 && (b & 7) <= 5 && (b & 1)) {
+        // 01/09/21/29/31/39 (r/m32, r32), 03/0B/... (r32, r/m32), 05/0D/... (EAX, imm32)
+        const uint8_t op = binaria_de(b >> 3);
+        if ((b & 7) == 5) {
+            if (!imm32(d.inmediato)) return invalida();
+            d.op = op + FORMA_RI;
+            d.r0 = 0;
+        } else {
+            if (!leer_modrm(p, fin, m)) return invalida();
+            const bool rm_reg = (b & 7) == 1;
+            if (m.es_registro) {
+                d.op = op + FORMA_RR;
+                d.r0 = rm_reg ? m.rm : m.reg;
+                d.r1 = rm_reg ? m.reg : m.rm;
+            } else if (rm_reg) {
+                d.op = op + FORMA_MR;
+                d.r1 = m.reg;
+                memoria_de(m);
+            } else {
+                d.op = op + FORMA_RM;
+                d.r0 = m.reg;
+                memoria_de(m);
+            }
+        }
+    } else if (b >= 0x40 && b <= 0x5F) {
+        // 40+r INC, 48+r DEC, 50+r PUSH, 58+r POP
+        static constexpr uint8_t OPS[4] = {OP_INC_R, OP_DEC_R, OP_PUSH_R, OP_POP_R};
+        d.op = OPS[(b - 0x40) >> 3];
+        d.r0 = b & 7;
+    } else if (b >= 0x70 && b <= 0x7F) {
+        uint32_t rel;
+        if (!imm8s(rel)) return invalida();
+        d.op = OP_JCC;
+        d.cond = b & 0xF;
+        relativo(rel);
+    } else if (b >= 0xB8 && b <= 0xBF) {
+        if (!imm32(d.inmediato)) return invalida();
+        d.op = OP_MOV_RI;
+        d.r0 = b & 7;
+    } else {
+        switch (b) {
+            case 0x81:
+            case 0x83: {
+                if (!leer_modrm(p, fin, m)) return invalida();
+                const uint8_t op = binaria_de(m.reg);
+                if (op == 0) return invalida();
+                if (!(b == 0x81 ? imm32(d.inmediato) : imm8s(d.inmediato))) return invalida();
+                ext = m.reg;
+                if (m.es_registro) {
+                    d.op = op + FORMA_RI;
+                    d.r0 = m.rm;
+                } else {
+                    d.op = op + FORMA_MI;
+                    memoria_de(m);
+                }
+                break;
+            }
+            case 0x89:
+            case 0x8B:
+                if (!leer_modrm(p, fin, m)) return invalida();
+                if (m.es_registro) {
+                    d.op = OP_MOV_RR;
+                    d.r0 = (b == 0x89) ? m.rm : m.reg;
+                    d.r1 = (b == 0x89) ? m.reg : m.rm;
+                } else if (b == 0x89) {
+                    d.op = OP_MOV_MR;
+                    d.r1 = m.reg;
+                    memoria_de(m);
+                } else {
+                    d.op = OP_MOV_RM;
+                    d.r0 = m.reg;
+                    memoria_de(m);
+                }
+                break;
+            case 0xC7:
+                if (!leer_modrm(p, fin, m) || m.reg != 0 || !imm32(d.inmediato)) return invalida();
+                ext = 0;
+                if (m.es_registro) {
+                    d.op = OP_MOV_RI;
+                    d.r0 = m.rm;
+                } else {
+                    d.op = OP_MOV_MI;
+                    memoria_de(m);
+                }
+                break;
+            case 0xA1:
+            case 0xA3:
+                if (!imm32(d.disp)) return invalida();
+                d.op = (b == 0xA1) ? OP_MOV_RM : OP_MOV_MR;
+                d.r0 = d.r1 = 0;
+                break;
+            case 0x85:
+            case 0x87:
+                if (!leer_modrm(p, fin, m)) return invalida();
+                d.op = (b == 0x85) ? OP_TEST : OP_XCHG;
+                d.r0 = m.reg;
+                rm_de(m);
+                break;
+            case 0x8D:
+                if (!leer_modrm(p, fin, m) || m.es_registro) return invalida();
+                d.op = OP_LEA;
+                d.r0 = m.reg;
+                memoria_de(m);
+                break;
+            case 0xFF:
+                if (!leer_modrm(p, fin, m)) return invalida();
+                ext = m.reg;
+                if (m.reg == 0 || m.reg == 1 || m.reg == 6) {
+                    static constexpr uint8_t OPS_R[7] = {OP_INC_R, OP_DEC_R, 0, 0, 0, 0, OP_PUSH_R};
+                    static constexpr uint8_t OPS_M[7] = {OP_INC_M, OP_DEC_M, 0, 0, 0, 0, OP_PUSH_M};
+                    d.op = m.es_registro ? OPS_R[m.reg] : OPS_M[m.reg];
+                    if (m.es_registro) d.r0 = m.rm;
+                    else memoria_de(m);
+                } else {
+                    return invalida();
+                }
+                break;
+            case 0x8F:
+                if (!leer_modrm(p, fin, m) || m.reg != 0) return invalida();
+                ext = 0;
+                d.op = m.es_registro ? OP_POP_R : OP_POP_M;
+                if (m.es_registro) d.r0 = m.rm;
+                else memoria_de(m);
+                break;
+            case 0xF7:
+                if (!leer_modrm(p, fin, m)) return invalida();
+                ext = m.reg;
+                if (m.reg == 4) d.op = OP_MUL;
+                else if (m.reg == 6) d.op = OP_DIV;
+                else if (m.reg == 7) d.op = OP_IDIV;
+                else return invalida();
+                rm_de(m);
+                break;
+            case 0x68:
+                if (!imm32(d.inmediato)) return invalida();
+                d.op = OP_PUSH_I;
+                break;
+            case 0x6A:
+                if (!imm8s(d.inmediato)) return invalida();
+                d.op = OP_PUSH_I;
+                break;
+            case 0xCD:
+                if (p >= fin) return invalida();
+                d.inmediato = *p++;
+                d.op = OP_INT;
+                break;
+            case 0xC9: d.op = OP_LEAVE; break;
+            case 0xC3: d.op = OP_RET; break;
+            case 0x90: d.op = OP_NOP; break;
+            case 0xE8:
+            case 0xE9:
+            case 0xE2:
+            case 0xEB: {
+                uint32_t rel;
+                if (!((b == 0xE8 || b == 0xE9) ? imm32(rel) : imm8s(rel))) return invalida();
+                d.op = (b == 0xE8) ? OP_CALL : (b == 0xE2) ? OP_LOOP : OP_JMP;
+                relativo(rel);
+                break;
+            }
+            case 0x0F: {
+                if (p >= fin) return invalida();
+                dos_bytes = true;
+                opcode = *p++;
+                if (opcode >= 0x80 && opcode <= 0x8F) {
+                    uint32_t rel;
+                    if (!imm32(rel)) return invalida();
+                    d.op = OP_JCC;
+                    d.cond = opcode & 0xF;
+                    relativo(rel);
+                } else if (opcode == 0xAF || opcode == 0xB6) {
+                    if (!leer_modrm(p, fin, m)) return invalida();
+                    d.op = (opcode == 0xAF) ? OP_IMUL : OP_MOVZX;
+                    d.r0 = m.reg;
+                    rm_de(m);
+                } else if (opcode == 0x1F) {
+                    if (!leer_modrm(p, fin, m) || m.reg != 0) return invalida();
+                    d.op = OP_NOP;
+                    d.longitud = static_cast<uint8_t>(p - comienzo);
+                    return true;   // NOP de relleno: sin fila
+                } else {
+                    return invalida();
+                }
+                break;
+            }
+            default:
+                return invalida();
+        }
+    }
+
+    d.longitud = static_cast<uint8_t>(p - comienzo);
+    d.fila = fila_de(dos_bytes, opcode, ext);
+    return true;
+}
+
+uint32_t EmuladorIA32::agregar_fuera(uint32_t direccion) {
+    Decodificada d;
+    d.op = OP_FUERA;
+    d.direccion = direccion;
+    d.inmediato = direccion;
+    d.fila = static_cast<uint16_t>(NUM_FILAS_OPCODES);
+    programa.push_back(d);
+    return static_cast<uint32_t>(programa.size() - 1);
+}
+
+// Decodifica seguido desde 'direccion' hasta un JMP/RET, una instrucción
+// inválida, el final de .text o código ya decodificado (al que se enlaza)
+void EmuladorIA32::decodificar_tramo(uint32_t direccion, vector<uint32_t>& pendientes,
+                                     vector<pair<uint32_t, uint32_t>>& saltos) {
+    for (;;) {
+        const uint32_t off = direccion - base_texto;
+        if (off >= tam_texto) {
+            agregar_fuera(direccion);
+            return;
+        }
+        if (indice[off] != SIN_INDICE) {
+            Decodificada e;
+            e.op = OP_ENLACE;
+            e.direccion = direccion;
+            e.destino = indice[off];
+            e.fila = static_cast<uint16_t>(NUM_FILAS_OPCODES);
+            programa.push_back(e);
+            return;
+        }
+
+        Decodificada d;
+        decodificar_una(direccion, d);
+        const uint32_t i = static_cast<uint32_t>(programa.size());
+        indice[off] = i;
+        programa.push_back(d);
+
+        if (tiene_destino(d.op)) {
+            if (d.inmediato - base_texto < tam_texto) pendientes.push_back(d.inmediato);
+            saltos.push_back({i, d.inmediato});
+        }
+        if (corta_tramo(d.op)) return;
+        direccion += d.longitud;
+    }
+}
+
+// Todo lo alcanzable desde 'direccion' que no estaba decodificado; devuelve
+// el índice de la instrucción en 'direccion'
+uint32_t EmuladorIA32::decodificar(uint32_t direccion) {
+    if (direccion - base_texto >= tam_texto) return agregar_fuera(direccion);
+
+    vector<uint32_t> pendientes{direccion};
+    vector<pair<uint32_t, uint32_t>> saltos;   // (índice del salto, dirección de destino)
+    while (!pendientes.empty()) {
+        const uint32_t a = pendientes.back();
+        pendientes.pop_back();
+        if (indice[a - base_texto] == SIN_INDICE) decodificar_tramo(a, pendientes, saltos);
+    }
+
+    for (const auto& [i, destino] : saltos) {
+        const uint32_t off = destino - base_texto;
+        programa[i].destino = (off < tam_texto) ? indice[off] : agregar_fuera(destino);
+    }
+    return indice[direccion - base_texto];
+}
+
+// -----------------------------------------------------------------------------
+// Carga
+// -----------------------------------------------------------------------------
+
+bool EmuladorIA32::cargar(const EnsambladorIA32& ens, const string& nombre_entrada, uint32_t bytes_pila) {
+    programa.clear();
+    indice.clear();
+    etiquetas_texto.clear();
+    memoria.clear();
+    imagen_inicial.clear();
+    if (ens.num_errores() > 0) return false;
+
+    // Memoria plana desde la sección más baja hasta el final de la más alta,
+    // y la pila detrás. Las secciones vacías (salvo .text) no cuentan
+    uint64_t desde = ens.secciones[SEC_TEXT].base;
+    uint64_t hasta = desde + ens.secciones[SEC_TEXT].contador;
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        const SeccionEnsamblado& sec = ens.secciones[s];
+        if (sec.contador == 0) continue;
+        desde = min<uint64_t>(desde, sec.base);
+        hasta = max<uint64_t>(hasta, uint64_t(sec.base) + sec.contador);
+    }
+    const uint64_t tope = ((hasta + 15) & ~uint64_t(15)) + ((uint64_t(bytes_pila) + 15) & ~uint64_t(15));
+    if (tope >= DIRECCION_RETORNO || tope - desde < 4) {
+        cerr << "Emulador: las secciones y la pila no caben en 32 bits" << endl;
+        return false;
+    }
+
+    inicio = static_cast<uint32_t>(desde);
+    tope_pila = static_cast<uint32_t>(tope);
+    memoria.assign(static_cast<size_t>(tope - desde), 0);
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        const SeccionEnsamblado& sec = ens.secciones[s];
+        if (!sec.bytes.empty()) memcpy(memoria.data() + (sec.base - inicio), sec.bytes.data(), sec.bytes.size());
+    }
+    imagen_inicial = memoria;
+    memoria_usada = false;
+
+    base_texto = ens.secciones[SEC_TEXT].base;
+    tam_texto = static_cast<uint32_t>(ens.secciones[SEC_TEXT].bytes.size());
+    indice.assign(tam_texto, SIN_INDICE);
+
+    for (uint32_t id = 0; id < ens.tabla_simbolos.size(); ++id) {
+        if (ens.tabla_simbolos[id] == SIN_DIRECCION || ens.seccion_simbolo[id] != SEC_TEXT) continue;
+        if (ens.simbolo_interno(id)) continue;   // '$' de una línea: la etiqueta del fuente basta
+        etiquetas_texto.push_back({ens.direccion_simbolo(id), string(ens.simbolos.nombre(id))});
+    }
+    stable_sort(etiquetas_texto.begin(), etiquetas_texto.end(),
+                [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    if (!ens.buscar_simbolo(nombre_entrada, entrada)) entrada = base_texto;
+    primera = decodificar(entrada);
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Banderas
+// -----------------------------------------------------------------------------
+
+static inline bool cf_de(uint32_t a, uint32_t b, uint32_t res, uint8_t tipo, uint8_t cf) {
+    switch (tipo) {
+        case B_SUMA:   return res < a;
+        case B_RESTA:  return a < b;
+        case B_LOGICA: return false;
+        default:       return cf;
+    }
+}
+
+static inline bool of_de(uint32_t a, uint32_t b, uint32_t res, uint8_t tipo, uint8_t cf) {
+    switch (tipo) {
+        case B_SUMA:  return ((a ^ res) & (b ^ res)) >> 31;
+        case B_RESTA: return ((a ^ b) & (a ^ res)) >> 31;
+        case B_INC:   return res == 0x80000000u;
+        case B_DEC:   return res == 0x7FFFFFFFu;
+        case B_MUL:   return cf;
+        default:      return false;
+    }
+}
+
+// Condición de un Jcc: los 3 bits altos de 'cc' eligen la prueba, el bajo la niega
+static inline bool condicion(uint8_t cc, uint32_t a, uint32_t b, uint32_t res, uint8_t tipo, uint8_t cf) {
+    bool r;
+    switch (cc >> 1) {
+        case 0:  r = of_de(a, b, res, tipo, cf); break;                                     // JO
+        case 1:  r = cf_de(a, b, res, tipo, cf); break;                                     // JB
+        case 2:  r = res == 0; break;                                                       // JE
+        case 3:  r = cf_de(a, b, res, tipo, cf) || res == 0; break;                         // JBE
+        case 4:  r = res >> 31; break;                                                      // JS
+        case 5:  r = !__builtin_parity(res & 0xFF); break;                                  // JP
+        case 6:  r = (res >> 31) != of_de(a, b, res, tipo, cf); break;                      // JL
+        default: r = res == 0 || (res >> 31) != of_de(a, b, res, tipo, cf); break;          // JLE
+    }
+    return r != (cc & 1);
+}
+
+uint32_t EmuladorIA32::eflags() const {
+    const Banderas& f = banderas;
+    uint32_t r = 0x2;   // bit 1: siempre 1
+    if (cf_de(f.a, f.b, f.res, f.tipo, f.cf)) r |= 1u << 0;
+    if (!__builtin_parity(f.res & 0xFF))      r |= 1u << 2;
+    if (f.res == 0)                           r |= 1u << 6;
+    if (f.res >> 31)                          r |= 1u << 7;
+    if (of_de(f.a, f.b, f.res, f.tipo, f.cf)) r |= 1u << 11;
+    return r;
+}
+
+// -----------------------------------------------------------------------------
+// Llamadas al sistema (INT 0x80, convención de Linux i386)
+// -----------------------------------------------------------------------------
+
+void EmuladorIA32::llamada_sistema(uint64_t& sin_soporte, bool& salir) {
+    switch (regs[0]) {
+        case 1:   // exit(EBX)
+            salir = true;
+            return;
+        case 4: { // write(EBX = fd, ECX = buffer, EDX = bytes)
+            ostream* destino = (regs[3] == 1) ? salida_programa : (regs[3] == 2) ? errores_programa : nullptr;
+            if (destino == nullptr) {
+                regs[0] = static_cast<uint32_t>(-ERRNO_EBADF);
+                return;
+            }
+            const uint32_t off = regs[1] - inicio;
+            if (off > memoria.size() || regs[2] > memoria.size() - off) {
+                regs[0] = static_cast<uint32_t>(-ERRNO_EFAULT);
+                return;
+            }
+            destino->write(reinterpret_cast<const char*>(memoria.data() + off), regs[2]);
+            regs[0] = regs[2];
+            return;
+        }
+        default:
+            ++sin_soporte;
+            regs[0] = static_cast<uint32_t>(-ERRNO_ENOSYS);
+            return;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Ejecución
+// -----------------------------------------------------------------------------
+// Un manejador por OperacionEmulada; cada uno termina saltando directo al
+// de la instrucción siguiente (DESPACHAR), sin volver a un switch central.
+// Las banderas viven en variables locales para que queden en registros.
+
+ResultadoEmulacion EmuladorIA32::ejecutar(uint64_t limite) {
+    static const void* const MANEJADORES[] = {
+        &&op_enlace, &&op_fuera, &&op_invalida,
+        &&op_mov_rr, &&op_mov_ri, &&op_mov_rm, &&op_mov_mr, &&op_mov_mi,
+        &&op_add_rr, &&op_add_ri, &&op_add_rm, &&op_add_mr, &&op_add_mi,
+        &&op_sub_rr, &&op_sub_ri, &&op_sub_rm, &&op_sub_mr, &&op_sub_mi,
+        &&op_and_rr, &&op_and_ri, &&op_and_rm, &&op_and_mr, &&op_and_mi,
+        &&op_or_rr,  &&op_or_ri,  &&op_or_rm,  &&op_or_mr,  &&op_or_mi,
+        &&op_xor_rr, &&op_xor_ri, &&op_xor_rm, &&op_xor_mr, &&op_xor_mi,
+        &&op_cmp_rr, &&op_cmp_ri, &&op_cmp_rm, &&op_cmp_mr, &&op_cmp_mi,
+        &&op_test, &&op_xchg, &&op_imul, &&op_movzx, &&op_lea,
+        &&op_inc_r, &&op_inc_m, &&op_dec_r, &&op_dec_m,
+        &&op_mul, &&op_div, &&op_idiv,
+        &&op_push_r, &&op_push_i, &&op_push_m, &&op_pop_r, &&op_pop_m,
+        &&op_int, &&op_leave, &&op_ret, &&op_nop,
+        &&op_call, &&op_loop, &&op_jmp, &&op_jcc,
+    };
+    static_assert(sizeof(MANEJADORES) / sizeof(MANEJADORES[0]) == NUM_OPERACIONES,
+                  "un manejador por OperacionEmulada");
+
+    ResultadoEmulacion resultado;
+    if (programa.empty()) {
+        resultado.mensaje = "no hay programa cargado";
+        return resultado;
+    }
+
+    if (memoria_usada) memoria = imagen_inicial;
+    memoria_usada = true;
+    for (Decodificada& e : programa) e.veces = 0;
+    memset(regs, 0, sizeof(regs));
+    banderas = Banderas{};
+    banderas.res = 1;   // como Linux al arrancar: ZF = SF = PF = CF = OF = 0
+
+    uint32_t* const r = regs;
+    uint8_t* const mem = memoria.data();
+    const uint32_t ini = inicio;
+    const uint32_t tam_mem = static_cast<uint32_t>(memoria.size());
+    const uint32_t texto_desde = base_texto - inicio;
+    const uint32_t texto_solapa = tam_texto ? tam_texto + 3 : 0;   // ver ESCRIBIR32
+
+    r[4] = tope_pila - 4;
+    const uint32_t retorno = DIRECCION_RETORNO;
+    memcpy(mem + (r[4] - ini), &retorno, 4);
+
+    uint32_t fa = banderas.a, fb = banderas.b, fres = banderas.res;   // Banderas en locales
+    uint8_t ftipo = banderas.tipo, fcf = banderas.cf;
+
+    const uint64_t tope = limite ? limite : UINT64_MAX;
+    uint64_t pasos = 0;
+    uint64_t sin_soporte = 0;
+    uint32_t fallo = 0;   // dirección del acceso que falló
+
+    Decodificada* base = programa.data();
+    Decodificada* d = base + primera;
+    const auto t0 = chrono::steady_clock::now();
+
+// Dirección efectiva del operando de memoria (r[REG_CERO] es siempre 0)
+#define DIR() (r[d->base] + (r[d->indice] << d->escala) + d->disp)
+#define LEER32(dir, v) do { \
+        const uint32_t o_ = (dir) - ini; \
+        if (o_ > tam_mem - 4) { fallo = (dir); goto fin_memoria; } \
+        memcpy(&(v), mem + o_, 4); \
+    } while (0)
+#define LEER8(dir, v) do { \
+        const uint32_t o_ = (dir) - ini; \
+        if (o_ >= tam_mem) { fallo = (dir); goto fin_memoria; } \
+        (v) = mem[o_]; \
+    } while (0)
+// Además de estar en rango, los 4 bytes no pueden tocar .text
+#define ESCRIBIR32(dir, v) do { \
+        const uint32_t o_ = (dir) - ini; \
+        const uint32_t v_ = (v); \
+        if (o_ > tam_mem - 4) { fallo = (dir); goto fin_memoria; } \
+        if (o_ + 3 - texto_desde < texto_solapa) { fallo = (dir); goto fin_texto; } \
+        memcpy(mem + o_, &v_, 4); \
+    } while (0)
+#define LEER_RM(v) do { if (d->r1 != REG_CERO) (v) = r[d->r1]; else LEER32(DIR(), v); } while (0)
+#define BANDERAS(a_, b_, res_, tipo_) do { fa = (a_); fb = (b_); fres = (res_); ftipo = (tipo_); } while (0)
+#define DESPACHAR() do { ++d->veces; goto *MANEJADORES[d->op]; } while (0)
+#define SIGUIENTE() do { ++d; ++pasos; DESPACHAR(); } while (0)
+#define SALTAR(i) do { \
+        d = base + (i); \
+        if (++pasos >= tope) goto fin_limite; \
+        DESPACHAR(); \
+    } while (0)
+
+// Las cinco formas de una binaria; ESCRIBE = false en CMP
+#define BINARIA(nombre, EXPR, TIPO, ESCRIBE) \
+    op_##nombre##_rr: { \
+        const uint32_t a = r[d->r0], b = r[d->r1], res = (EXPR); \
+        BANDERAS(a, b, res, TIPO); \
+        if (ESCRIBE) r[d->r0] = res; \
+        SIGUIENTE(); \
+    } \
+    op_##nombre##_ri: { \
+        const uint32_t a = r[d->r0], b = d->inmediato, res = (EXPR); \
+        BANDERAS(a, b, res, TIPO); \
+        if (ESCRIBE) r[d->r0] = res; \
+        SIGUIENTE(); \
+    } \
+    op_##nombre##_rm: { \
+        uint32_t b; \
+        LEER32(DIR(), b); \
+        const uint32_t a = r[d->r0], res = (EXPR); \
+        BANDERAS(a, b, res, TIPO); \
+        if (ESCRIBE) r[d->r0] = res; \
+        SIGUIENTE(); \
+    } \
+    op_##nombre##_mr: { \
+        const uint32_t dir = DIR(); \
+        uint32_t a; \
+        LEER32(dir, a); \
+        const uint32_t b = r[d->r1], res = (EXPR); \
+        BANDERAS(a, b, res, TIPO); \
+        if (ESCRIBE) ESCRIBIR32(dir, res); \
+        SIGUIENTE(); \
+    } \
+    op_##nombre##_mi: { \
+        const uint32_t dir = DIR(); \
+        uint32_t a; \
+        LEER32(dir, a); \
+        const uint32_t b = d->inmediato, res = (EXPR); \
+        BANDERAS(a, b, res, TIPO); \
+        if (ESCRIBE) ESCRIBIR32(dir, res); \
+        SIGUIENTE(); \
+    }
+
+    DESPACHAR();
+
+op_enlace:
+    d = base + d->destino;
+    DESPACHAR();
+
+op_fuera:
+    resultado.fin = FIN_FUERA_DE_TEXTO;
+    resultado.eip = d->inmediato;
+    if (d->inmediato != base_texto + tam_texto) {
+        char texto[64];
+        snprintf(texto, sizeof(texto), "salto fuera de .text a 0x%08X", d->inmediato);
+        resultado.mensaje = texto;
+    }
+    goto fin;
+
+op_invalida: {
+    char texto[96];
+    const uint8_t* bytes = mem + (d->direccion - ini);
+    const uint32_t quedan = base_texto + tam_texto - d->direccion;
+    int n = snprintf(texto, sizeof(texto), "instruccion no soportada en 0x%08X:", d->direccion);
+    for (uint32_t k = 0; k < min<uint32_t>(quedan, 4); ++k) {
+        n += snprintf(texto + n, sizeof(texto) - n, " %02X", bytes[k]);
+    }
+    resultado.fin = FIN_ERROR;
+    resultado.eip = d->direccion;
+    resultado.mensaje = texto;
+    goto fin;
+}
+
+op_mov_rr: r[d->r0] = r[d->r1]; SIGUIENTE();
+op_mov_ri: r[d->r0] = d->inmediato; SIGUIENTE();
+op_mov_rm: LEER32(DIR(), r[d->r0]); SIGUIENTE();
+op_mov_mr: ESCRIBIR32(DIR(), r[d->r1]); SIGUIENTE();
+op_mov_mi: ESCRIBIR32(DIR(), d->inmediato); SIGUIENTE();
+
+    BINARIA(add, a + b, B_SUMA, true)
+    BINARIA(sub, a - b, B_RESTA, true)
+    BINARIA(and, a & b, B_LOGICA, true)
+    BINARIA(or,  a | b, B_LOGICA, true)
+    BINARIA(xor, a ^ b, B_LOGICA, true)
+    BINARIA(cmp, a - b, B_RESTA, false)
+
+op_test: {
+    uint32_t a;
+    LEER_RM(a);
+    BANDERAS(a, r[d->r0], a & r[d->r0], B_LOGICA);
+    SIGUIENTE();
+}
+
+op_xchg:
+    if (d->r1 != REG_CERO) {
+        swap(r[d->r0], r[d->r1]);
+    } else {
+        const uint32_t dir = DIR();
+        uint32_t v;
+        LEER32(dir, v);
+        ESCRIBIR32(dir, r[d->r0]);
+        r[d->r0] = v;
+    }
+    SIGUIENTE();
+
+op_imul: {
+    uint32_t b;
+    LEER_RM(b);
+    const int64_t p = int64_t(int32_t(r[d->r0])) * int32_t(b);
+    const uint32_t res = static_cast<uint32_t>(p);
+    BANDERAS(r[d->r0], b, res, B_MUL);
+    fcf = p != int64_t(int32_t(res));
+    r[d->r0] = res;
+    SIGUIENTE();
+}
+
+op_movzx: {
+    // R/M de 8 bits: AL..BL son el byte bajo de EAX..EBX, AH..BH el segundo
+    uint32_t v;
+    if (d->r1 != REG_CERO) v = (r[d->r1 & 3] >> ((d->r1 & 4) << 1)) & 0xFF;
+    else LEER8(DIR(), v);
+    r[d->r0] = v;
+    SIGUIENTE();
+}
+
+op_lea: r[d->r0] = DIR(); SIGUIENTE();
+
+op_inc_r:
+    fcf = cf_de(fa, fb, fres, ftipo, fcf);
+    BANDERAS(r[d->r0], 1, r[d->r0] + 1, B_INC);
+    r[d->r0] = fres;
+    SIGUIENTE();
+op_dec_r:
+    fcf = cf_de(fa, fb, fres, ftipo, fcf);
+    BANDERAS(r[d->r0], 1, r[d->r0] - 1, B_DEC);
+    r[d->r0] = fres;
+    SIGUIENTE();
+op_inc_m:
+op_dec_m: {
+    const uint32_t dir = DIR();
+    uint32_t a;
+    LEER32(dir, a);
+    const bool inc = d->op == OP_INC_M;
+    const uint32_t res = inc ? a + 1 : a - 1;
+    ESCRIBIR32(dir, res);
+    fcf = cf_de(fa, fb, fres, ftipo, fcf);
+    BANDERAS(a, 1, res, inc ? B_INC : B_DEC);
+    SIGUIENTE();
+}
+
+op_mul: {
+    uint32_t v;
+    LEER_RM(v);
+    const uint64_t p = uint64_t(r[0]) * v;
+    r[0] = static_cast<uint32_t>(p);
+    r[2] = static_cast<uint32_t>(p >> 32);
+    BANDERAS(r[0], v, r[0], B_MUL);
+    fcf = r[2] != 0;
+    SIGUIENTE();
+}
+
+op_div: {
+    uint32_t v;
+    LEER_RM(v);
+    const uint64_t n = (uint64_t(r[2]) << 32) | r[0];
+    if (v == 0 || n / v > 0xFFFFFFFFu) goto fin_division;
+    r[0] = static_cast<uint32_t>(n / v);
+    r[2] = static_cast<uint32_t>(n % v);
+    SIGUIENTE();
+}
+
+op_idiv: {
+    uint32_t v;
+    LEER_RM(v);
+    const int64_t n = static_cast<int64_t>((uint64_t(r[2]) << 32) | r[0]);
+    const int64_t dv = int32_t(v);
+    if (dv == 0 || (n == INT64_MIN && dv == -1)) goto fin_division;
+    const int64_t q = n / dv;
+    if (q < INT32_MIN || q > INT32_MAX) goto fin_division;
+    r[0] = static_cast<uint32_t>(q);
+    r[2] = static_cast<uint32_t>(n % dv);
+    SIGUIENTE();
+}
+
+op_push_r: {
+    const uint32_t v = r[d->r0];   // PUSH ESP guarda el valor de antes
+    r[4] -= 4;
+    ESCRIBIR32(r[4], v);
+    SIGUIENTE();
+}
+op_push_i:
+    r[4] -= 4;
+    ESCRIBIR32(r[4], d->inmediato);
+    SIGUIENTE();
+op_push_m: {
+    uint32_t v;
+    LEER32(DIR(), v);
+    r[4] -= 4;
+    ESCRIBIR32(r[4], v);
+    SIGUIENTE();
+}
+op_pop_r: {
+    uint32_t v;
+    LEER32(r[4], v);
+    r[4] += 4;
+    r[d->r0] = v;
+    SIGUIENTE();
+}
+op_pop_m: {
+    // La dirección se calcula con ESP ya incrementado
+    uint32_t v;
+    LEER32(r[4], v);
+    r[4] += 4;
+    ESCRIBIR32(DIR(), v);
+    SIGUIENTE();
+}
+
+op_int: {
+    if (d->inmediato != 0x80) {
+        char texto[64];
+        snprintf(texto, sizeof(texto), "INT 0x%02X no soportada en 0x%08X", d->inmediato, d->direccion);
+        resultado.fin = FIN_ERROR;
+        resultado.eip = d->direccion;
+        resultado.mensaje = texto;
+        goto fin;
+    }
+    bool salir = false;
+    llamada_sistema(sin_soporte, salir);
+    if (salir) {
+        resultado.fin = FIN_EXIT;
+        resultado.estado = r[3];
+        resultado.eip = d->direccion;
+        goto fin;
+    }
+    SIGUIENTE();
+}
+
+op_leave: {
+    r[4] = r[5];
+    uint32_t v;
+    LEER32(r[4], v);
+    r[4] += 4;
+    r[5] = v;
+    SIGUIENTE();
+}
+
+op_ret: {
+    uint32_t v;
+    LEER32(r[4], v);
+    r[4] += 4;
+    if (v == DIRECCION_RETORNO) {
+        resultado.fin = FIN_RETORNO;
+        resultado.estado = r[0];
+        resultado.eip = d->direccion;
+        goto fin;
+    }
+    const uint32_t off = v - base_texto;
+    if (off < tam_texto && indice[off] != SIN_INDICE) SALTAR(indice[off]);
+    // Dirección de vuelta que no salió de un CALL: decodificar desde ahí
+    // ('programa' puede reubicarse)
+    const uint32_t i = decodificar(v);
+    base = programa.data();
+    SALTAR(i);
+}
+
+op_nop: SIGUIENTE();
+
+op_call: {
+    r[4] -= 4;
+    ESCRIBIR32(r[4], d->direccion + d->longitud);
+    SALTAR(d->destino);
+}
+
+op_loop:
+    if (--r[1] != 0) SALTAR(d->destino);
+    SIGUIENTE();
+
+op_jmp: SALTAR(d->destino);
+
+op_jcc:
+    if (condicion(d->cond, fa, fb, fres, ftipo, fcf)) SALTAR(d->destino);
+    SIGUIENTE();
+
+fin_memoria: {
+    char texto[96];
+    snprintf(texto, sizeof(texto), "acceso a memoria fuera de rango: 0x%08X en 0x%08X", fallo, d->direccion);
+    resultado.fin = FIN_ERROR;
+    resultado.eip = d->direccion;
+    resultado.mensaje = texto;
+    goto fin;
+}
+
+fin_texto: {
+    char texto[96];
+    snprintf(texto, sizeof(texto), "escritura en .text (0x%08X) en 0x%08X: codigo automodificable no soportado",
+             fallo, d->direccion);
+    resultado.fin = FIN_ERROR;
+    resultado.eip = d->direccion;
+    resultado.mensaje = texto;
+    goto fin;
+}
+
+fin_division: {
+    char texto[80];
+    snprintf(texto, sizeof(texto), "division por cero o cociente fuera de rango en 0x%08X", d->direccion);
+    resultado.fin = FIN_ERROR;
+    resultado.eip = d->direccion;
+    resultado.mensaje = texto;
+    goto fin;
+}
+
+fin_limite:
+    // 'd' todavía no se ejecutó: no cuenta
+    resultado.fin = FIN_LIMITE;
+    resultado.eip = (d->op == OP_ENLACE) ? programa[d->destino].direccion : d->direccion;
+
+fin:
+#undef DIR
+#undef LEER32
+#undef LEER8
+#undef ESCRIBIR32
+#undef LEER_RM
+#undef BANDERAS
+#undef DESPACHAR
+#undef SIGUIENTE
+#undef SALTAR
+#undef BINARIA
+
+    resultado.segundos = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    banderas.a = fa;
+    banderas.b = fb;
+    banderas.res = fres;
+    banderas.tipo = ftipo;
+    banderas.cf = fcf;
+    resultado.llamadas_sin_soporte = sin_soporte;
+    for (const Decodificada& e : programa) {
+        if (e.op != OP_ENLACE && e.op != OP_FUERA && e.op != OP_INVALIDA) resultado.instrucciones += e.veces;
+    }
+    return resultado;
+}
+
+// -----------------------------------------------------------------------------
+// Conteos e informes
+// -----------------------------------------------------------------------------
+
+vector<ConteoEtiqueta> EmuladorIA32::por_etiqueta() const {
+    // Una entrada por etiqueta + una para lo que está antes de la primera
+    vector<ConteoEtiqueta> conteos(etiquetas_texto.size() + 1);
+    conteos[0].etiqueta = "(antes de la primera etiqueta)";
+    conteos[0].direccion = base_texto;
+    for (size_t k = 0; k < etiquetas_texto.size(); ++k) {
+        conteos[k + 1].direccion = etiquetas_texto[k].first;
+        conteos[k + 1].etiqueta = etiquetas_texto[k].second;
+    }
+
+    for (const Decodificada& e : programa) {
+        if (e.veces == 0 || e.op == OP_ENLACE || e.op == OP_FUERA || e.op == OP_INVALIDA) continue;
+        auto it = upper_bound(etiquetas_texto.begin(), etiquetas_texto.end(), e.direccion,
+                              [](uint32_t dir, const auto& et) { return dir < et.first; });
+        conteos[it - etiquetas_texto.begin()].instrucciones += e.veces;
+    }
+
+    conteos.erase(remove_if(conteos.begin(), conteos.end(),
+                            [](const ConteoEtiqueta& c) { return c.instrucciones == 0; }),
+                  conteos.end());
+    stable_sort(conteos.begin(), conteos.end(),
+                [](const ConteoEtiqueta& a, const ConteoEtiqueta& b) { return a.instrucciones > b.instrucciones; });
+    return conteos;
+}
+
+// "ADD r/m32, imm8" para una fila de TABLA_OPCODES
+static string nombre_forma(uint16_t fila) {
+    static constexpr const char* PATRONES[] = {
+        "", "r32", "EAX", "r8", "m32", "m8", "r/m32", "imm32", "imm8", "imm8", "rel", "moffs32"
+    };
+    if (fila == SIN_FILA) return "(forma que el ensamblador no emite)";
+    if (fila >= NUM_FILAS_OPCODES) return "NOP (relleno)";
+    const FilaOpcode& f = TABLA_OPCODES[fila];
+    string s(f.mnem);
+    if (f.op0 != P_NADA) s += string(" ") + PATRONES[f.op0];
+    if (f.op1 != P_NADA) s += string(", ") + PATRONES[f.op1];
+    return s;
+}
+
+vector<ConteoOpcode> EmuladorIA32::por_opcode() const {
+    vector<uint64_t> veces(SIN_FILA + 1, 0);
+    for (const Decodificada& e : programa) {
+        if (e.op != OP_ENLACE && e.op != OP_FUERA && e.op != OP_INVALIDA) veces[e.fila] += e.veces;
+    }
+
+    vector<ConteoOpcode> conteos;
+    for (size_t f = 0; f < veces.size(); ++f) {
+        if (veces[f] > 0) conteos.push_back({nombre_forma(static_cast<uint16_t>(f)), veces[f]});
+    }
+    stable_sort(conteos.begin(), conteos.end(),
+                [](const ConteoOpcode& a, const ConteoOpcode& b) { return a.instrucciones > b.instrucciones; });
+    return conteos;
+}
+
+void EmuladorIA32::escribir_informe(ostream& salida, const ResultadoEmulacion& r) const {
+    char linea[160];
+    snprintf(linea, sizeof(linea), "Emulacion: fin = %s, estado = %u, EIP = 0x%08X\n",
+             NOMBRES_FIN_EMULACION[r.fin], r.estado, r.eip);
+    salida << linea;
+    if (!r.mensaje.empty()) salida << "  " << r.mensaje << "\n";
+    snprintf(linea, sizeof(linea), "  %llu instrucciones en %.6f s (%.1f M instrucciones/s), %zu decodificadas\n",
+             static_cast<unsigned long long>(r.instrucciones), r.segundos,
+             r.segundos > 0 ? r.instrucciones / r.segundos / 1e6 : 0.0, programa.size());
+    salida << linea;
+    if (r.llamadas_sin_soporte > 0) {
+        salida << "  " << r.llamadas_sin_soporte << " llamadas al sistema sin soporte (devolvieron -ENOSYS)\n";
+    }
+
+    salida << " ";
+    for (int k = 0; k < 8; ++k) {
+        snprintf(linea, sizeof(linea), " %s=%08X", string(NOMBRES_REG32[k]).c_str(), regs[k]);
+        salida << linea;
+    }
+    snprintf(linea, sizeof(linea), " EFLAGS=%08X\n", eflags());
+    salida << linea;
+
+    const double total = r.instrucciones > 0 ? double(r.instrucciones) : 1.0;
+    salida << "\nPor etiqueta:\n";
+    for (const ConteoEtiqueta& c : por_etiqueta()) {
+        snprintf(linea, sizeof(linea), "  %14llu %6.2f%%  0x%08X  ", static_cast<unsigned long long>(c.instrucciones),
+                 100.0 * c.instrucciones / total, c.direccion);
+        salida << linea << c.etiqueta << "\n";
+    }
+    salida << "\nPor opcode:\n";
+    for (const ConteoOpcode& c : por_opcode()) {
+        snprintf(linea, sizeof(linea), "  %14llu %6.2f%%  ", static_cast<unsigned long long>(c.instrucciones),
+                 100.0 * c.instrucciones / total);
+        salida << linea << c.forma << "\n";
+    }
+}
+
+void EmuladorIA32::escribir_json(ostream& salida, const ResultadoEmulacion& r) const {
+    auto cadena = [](const string& s) {
+        string t = "\"";
+        for (char c : s) {
+            if (c == '"' || c == '\\') t += '\\';
+            t += (static_cast<unsigned char>(c) < 0x20) ? ' ' : c;
+        }
+        return t + "\"";
+    };
+
+    char texto[96];
+    salida << "{\"fin\":\"" << NOMBRES_FIN_EMULACION[r.fin] << "\",\"estado\":" << r.estado
+           << ",\"eip\":" << r.eip << ",\"instrucciones\":" << r.instrucciones;
+    snprintf(texto, sizeof(texto), ",\"segundos\":%.6f,\"minstr_por_s\":%.1f", r.segundos,
+             r.segundos > 0 ? r.instrucciones / r.segundos / 1e6 : 0.0);
+    salida << texto << ",\"llamadas_sin_soporte\":" << r.llamadas_sin_soporte
+           << ",\"mensaje\":" << cadena(r.mensaje) << ",\"registros\":{";
+    for (int k = 0; k < 8; ++k) {
+        salida << (k ? "," : "") << '"' << NOMBRES_REG32[k] << "\":" << regs[k];
+    }
+    salida << ",\"EFLAGS\":" << eflags() << "},\"por_etiqueta\":[";
+    bool primero = true;
+    for (const ConteoEtiqueta& c : por_etiqueta()) {
+        salida << (primero ? "" : ",") << "{\"etiqueta\":" << cadena(c.etiqueta) << ",\"direccion\":" << c.direccion
+               << ",\"instrucciones\":" << c.instrucciones << "}";
+        primero = false;
+    }
+    salida << "],\"por_opcode\":[";
+    primero = true;
+    for (const ConteoOpcode& c : por_opcode()) {
+        salida << (primero ? "" : ",") << "{\"forma\":" << cadena(c.forma) << ",\"instrucciones\":" << c.instrucciones << "}";
+        primero = false;
+    }
+    salida << "]}\n";
+}
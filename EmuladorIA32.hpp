@@ -0,0 +1,154 @@
+#ifndef EMULADOR_IA32_HPP
+#define EMULADOR_IA32_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Emulador IA-32 del subconjunto que emite el ensamblador
+// -----------------------------------------------------------------------------
+// Ejecuta el programa ya ensamblado sin un proceso de 32 bits: copia .text y
+// .data a una memoria plana (con .bss en cero y una pila detrás), decodifica
+// los bytes de .text una sola vez y los ejecuta con un bucle de despacho por
+// hilos (goto computado: cada manejador salta directo al siguiente).
+//
+// La decodificación sigue el flujo desde la entrada (saltos, CALL y lo que
+// viene detrás de cada CALL), así que datos dentro de .text no molestan
+// mientras nadie salte a ellos. Una instrucción que no es del subconjunto
+// solo es un error si se ejecuta.
+//
+// Registros: los 8 de NOMBRES_REG32. EFLAGS se calcula de forma perezosa
+// (se guardan operandos y resultado de la última operación y CF, ZF, SF y
+// OF salen de ahí cuando un Jcc los pide). INT 0x80 atiende exit (1) y write
+// (4) a stdout/stderr; las demás llamadas devuelven -ENOSYS. No se admite
+// código que se modifica a sí mismo: escribir en .text detiene la ejecución.
+//
+// Cada instrucción decodificada cuenta sus ejecuciones; por_etiqueta() y
+// por_opcode() las agrupan por la etiqueta de .text que la precede y por
+// fila de TABLA_OPCODES.
+
+enum FinEmulacion : uint8_t {
+    FIN_EXIT,            // INT 0x80 con EAX = 1 (estado = EBX)
+    FIN_RETORNO,         // RET de la entrada (estado = EAX)
+    FIN_FUERA_DE_TEXTO,  // el flujo salió de .text (p. ej. tras la última instrucción)
+    FIN_LIMITE,          // se alcanzó el límite de instrucciones
+    FIN_ERROR            // opcode no soportado, memoria fuera de rango, división por cero...
+};
+
+inline constexpr const char* NOMBRES_FIN_EMULACION[] = {
+    "exit", "retorno", "fuera_de_texto", "limite", "error"
+};
+
+struct ResultadoEmulacion {
+    FinEmulacion fin = FIN_ERROR;
+    uint32_t estado = 0;               // código de exit o EAX al volver
+    uint32_t eip = 0;                  // dirección donde se detuvo
+    uint64_t instrucciones = 0;        // ejecutadas
+    uint64_t llamadas_sin_soporte = 0; // INT 0x80 que devolvieron -ENOSYS
+    double segundos = 0;
+    string mensaje;                    // motivo, si fin = FIN_ERROR / FIN_FUERA_DE_TEXTO
+};
+
+struct ConteoEtiqueta {
+    string etiqueta;                   // "(antes de la primera etiqueta)" si no hay ninguna
+    uint32_t direccion = 0;
+    uint64_t instrucciones = 0;
+};
+
+struct ConteoOpcode {
+    string forma;                      // "ADD r/m32, imm8" o "NOP (relleno)"
+    uint64_t instrucciones = 0;
+};
+
+class EmuladorIA32 {
+public:
+    EmuladorIA32() = default;
+    EmuladorIA32(const EmuladorIA32&) = delete;
+    EmuladorIA32& operator=(const EmuladorIA32&) = delete;
+
+    // Carga el resultado de 'ens' y decodifica desde 'entrada' (si no existe
+    // esa etiqueta, desde el inicio de .text). false si 'ens' tuvo errores
+    bool cargar(const EnsambladorIA32& ens, const string& entrada = "_start", uint32_t bytes_pila = 1u << 20);
+
+    // Dónde escribe el programa con write(1/2, ...) (por omisión cout / cerr)
+    void usar_salida(ostream& salida, ostream& errores) { salida_programa = &salida; errores_programa = &errores; }
+
+    // Ejecuta hasta exit, el RET de la entrada, salir de .text, un error o
+    // 'limite' instrucciones (0 = sin límite; se comprueba en cada salto)
+    ResultadoEmulacion ejecutar(uint64_t limite = 0);
+
+    uint32_t registro(int r) const { return regs[r]; }
+    uint32_t eflags() const;           // CF, PF, ZF, SF y OF de la última operación
+
+    // Ejecuciones de la última ejecutar(), ordenadas de más a menos
+    vector<ConteoEtiqueta> por_etiqueta() const;
+    vector<ConteoOpcode> por_opcode() const;
+
+    // Resultado y conteos: texto legible o una línea JSON
+    void escribir_informe(ostream& salida, const ResultadoEmulacion& r) const;
+    void escribir_json(ostream& salida, const ResultadoEmulacion& r) const;
+
+    size_t instrucciones_decodificadas() const { return programa.size(); }
+
+private:
+    // Una instrucción ya decodificada; 'op' elige el manejador
+    struct Decodificada {
+        uint64_t veces = 0;
+        uint32_t direccion = 0;
+        uint32_t inmediato = 0;      // inmediato, o dirección de destino de un salto
+        uint32_t disp = 0;           // desplazamiento del operando de memoria
+        uint32_t destino = 0;        // índice en 'programa' del destino de salto / ENLACE
+        uint16_t fila = 0;           // TABLA_OPCODES; NUM_FILAS_OPCODES = NOP de relleno
+        uint8_t  op = 0;             // OperacionEmulada
+        uint8_t  r0 = 0, r1 = 0;     // registros (REG_CERO = ninguno)
+        uint8_t  base = 0, indice = 0, escala = 0;   // escala como desplazamiento (0..3)
+        uint8_t  longitud = 0;
+        uint8_t  cond = 0;           // Jcc: los 4 bits bajos del opcode
+    };
+
+    // Registro 8: siempre 0, hace de base o índice ausente
+    static constexpr uint8_t REG_CERO = 8;
+    static constexpr uint32_t SIN_INDICE = 0xFFFFFFFFu;
+    static constexpr uint32_t DIRECCION_RETORNO = 0xFFFFFFF0u;   // el RET de la entrada vuelve aquí
+
+    // EFLAGS perezoso: operandos y resultado de la última operación que las
+    // escribe; 'cf' guarda CF donde no sale de ellos (INC/DEC lo conservan)
+    struct Banderas {
+        uint32_t a = 0, b = 0, res = 0;
+        uint8_t  tipo = 0;           // TipoBanderas
+        uint8_t  cf = 0;
+    };
+
+    uint32_t regs[9] = {};
+    Banderas banderas;
+
+    vector<uint8_t> memoria;
+    vector<uint8_t> imagen_inicial;  // memoria tras cargar(): ejecutar() empieza siempre desde aquí
+    bool memoria_usada = false;
+    uint32_t inicio = 0;             // dirección de memoria[0]
+    uint32_t base_texto = 0, tam_texto = 0;
+    uint32_t entrada = 0;
+    uint32_t primera = 0;            // índice de la entrada en 'programa'
+    uint32_t tope_pila = 0;          // ESP inicial + 4 (debajo queda DIRECCION_RETORNO)
+
+    vector<Decodificada> programa;
+    vector<uint32_t> indice;         // desplazamiento en .text -> índice en programa
+    vector<pair<uint32_t, string>> etiquetas_texto;   // (dirección, nombre), ordenadas
+
+    ostream* salida_programa = &cout;
+    ostream* errores_programa = &cerr;
+
+    uint32_t decodificar(uint32_t direccion);                 // índice de la instrucción en 'direccion'
+    void decodificar_tramo(uint32_t direccion, vector<uint32_t>& pendientes,
+                           vector<pair<uint32_t, uint32_t>>& saltos);
+    bool decodificar_una(uint32_t direccion, Decodificada& d) const;
+    uint32_t agregar_fuera(uint32_t direccion);
+    void llamada_sistema(uint64_t& sin_soporte, bool& salir);
+};
+
+#endif // EMULADOR_IA32_HPP
@@ -0,0 +1,410 @@
+#ifndef ENSAMBLADO_CONSTANTE_HPP
+#define ENSAMBLADO_CONSTANTE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string_view>
+#if __cplusplus >= 202002L
+#include <array>
+#endif
+
+#include "CodificacionIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Ensamblado en tiempo de compilación
+// -----------------------------------------------------------------------------
+// Para secuencias fijas (stubs, trampolines) que hoy se escribirían a mano
+// como bytes:
+//
+//     constexpr auto stub = ensamblar_constante<16>("MOV EAX, 1\nRET");
+//     static_assert(stub.error == nullptr, "stub");
+//     // stub.bytes[0 .. stub.tamano) = B8 01 00 00 00 C3
+//
+// y en C++20, con el tamaño justo:
+//
+//     constexpr auto stub = asm_ia32<"MOV EAX, 1\nRET">();   // std::array<uint8_t, 6>
+//
+// Usa el analizador léxico, TABLA_OPCODES, elegir_fila(), armar_direccion()
+// y codificar_instruccion() de siempre (CodificacionIA32.hpp): los bytes son
+// los de la PASADA 2 para el mismo texto. Solo hay instrucciones y etiquetas
+// locales ("nombre:") y el código no tiene dirección de carga, así que no se
+// admiten directivas, etiquetas dentro de [..] o en un inmediato (serían
+// direcciones absolutas) ni etiquetas sin definir. Las expresiones
+// constantes ("4*2", "[EBP - 2*4]") sí, con las mismas formas imm8/disp8.
+// Los saltos empiezan cortos y se agrandan a near los que no alcanzan, como
+// en relajar_saltos(), también con destino etiqueta + constante.
+//
+// Un error no se lanza: queda en 'error' y 'linea' (desde 1); asm_ia32()
+// lo convierte en un static_assert.
+
+template <size_t MAX_BYTES>
+struct CodigoConstante {
+    uint8_t     bytes[MAX_BYTES] = {};
+    size_t      tamano = 0;
+    const char* error  = nullptr;   // nullptr si ensambló
+    size_t      linea  = 0;         // línea del error (desde 1)
+};
+
+inline constexpr size_t MAX_ETIQUETAS_CONSTANTE = 32;
+
+// Emisor que solo cuenta: el tamaño de una instrucción con la decisión de
+// salto actual
+struct EmisorConteo {
+    int bytes = 0;
+    constexpr void byte(uint8_t) { ++bytes; }
+    constexpr void dword(uint32_t) { bytes += 4; }
+    constexpr void referencia(uint32_t, int, int) {}
+};
+
+template <size_t MAX_BYTES>
+class EnsambladorConstante {
+public:
+    constexpr CodigoConstante<MAX_BYTES> ensamblar(std::string_view texto) {
+        size_t inicio = 0;
+        while (inicio <= texto.size() && resultado.error == nullptr) {
+            size_t fin = texto.find('\n', inicio);
+            if (fin == std::string_view::npos) fin = texto.size();
+            ++linea_actual;
+            procesar_linea(texto.substr(inicio, fin - inicio));
+            inicio = fin + 1;
+        }
+        if (resultado.error == nullptr) verificar_etiquetas();
+        if (resultado.error == nullptr) disponer();
+        if (resultado.error == nullptr) emitir();
+        if (resultado.error != nullptr) resultado.tamano = 0;
+        return resultado;
+    }
+
+    // --- Emisor de codificar_instruccion() ---
+    constexpr void byte(uint8_t b) {
+        if (resultado.tamano == MAX_BYTES) {
+            fallar("el codigo no cabe en la capacidad pedida");
+            return;
+        }
+        resultado.bytes[resultado.tamano++] = b;
+    }
+    constexpr void dword(uint32_t d) {
+        for (int k = 0; k < 4; ++k) byte(static_cast<uint8_t>((d >> (8 * k)) & 0xFF));
+    }
+    constexpr void referencia(uint32_t simbolo, int tamano, int tipo_salto) {
+        if (tipo_salto == 0) {
+            fallar("direccion absoluta de una etiqueta (no hay direccion de carga)");
+            return;
+        }
+        pendiente = Pendiente{true, simbolo, tamano, resultado.tamano};
+    }
+
+    // --- Resolver de evaluar_expresion(): todo identificador es una etiqueta ---
+    constexpr const char* simbolo(std::string_view nombre, ValorExpresion& v) {
+        v = ValorExpresion();
+        if (nombre == "$" || nombre == "$$") return "'$' no se admite (no hay direccion de carga)";
+        v.suma = etiqueta(nombre);
+        return resultado.error;
+    }
+    // Sin disposición que esperar: una etiqueta solo va sola o sumada
+    constexpr const char* diferir(TipoToken, const ValorExpresion&, const ValorExpresion&, ValorExpresion&) {
+        return "una etiqueta solo admite + y -";
+    }
+
+private:
+    // Cada instrucción ocupa al menos un byte: MAX_BYTES instrucciones y las etiquetas
+    static constexpr size_t MAX_IR = MAX_BYTES + MAX_ETIQUETAS_CONSTANTE;
+
+    // Referencia relativa de la instrucción que se está emitiendo (a lo sumo una)
+    struct Pendiente {
+        bool     hay     = false;
+        uint32_t simbolo = 0;
+        int      tamano  = 0;
+        size_t   campo   = 0;
+    };
+
+    CodigoConstante<MAX_BYTES> resultado;
+    InstruccionIR programa[MAX_IR] = {};
+    size_t        lineas[MAX_IR] = {};   // línea de cada entrada (errores después de la lectura)
+    uint32_t      sumandos[MAX_IR] = {}; // constante del destino relativo ("JMP fin + 1")
+    uint32_t      sumando_actual = 0;    // el de la instrucción que se está leyendo
+    size_t        num_ir = 0;
+    size_t        linea_actual = 0;
+
+    std::string_view nombres[MAX_ETIQUETAS_CONSTANTE] = {};
+    int              posiciones[MAX_ETIQUETAS_CONSTANTE] = {};
+    bool             definidas[MAX_ETIQUETAS_CONSTANTE] = {};
+    size_t           linea_uso[MAX_ETIQUETAS_CONSTANTE] = {};   // primera línea que la nombra
+    size_t           num_etiquetas = 0;
+
+    Pendiente pendiente;
+
+    constexpr bool fallar(const char* mensaje, size_t linea = 0) {
+        if (resultado.error == nullptr) {
+            resultado.error = mensaje;
+            resultado.linea = linea != 0 ? linea : linea_actual;
+        }
+        return false;
+    }
+
+    // Id local de la etiqueta (sensible a mayúsculas, como id_simbolo())
+    constexpr uint32_t etiqueta(std::string_view nombre) {
+        for (size_t i = 0; i < num_etiquetas; ++i) {
+            if (nombres[i] == nombre) return static_cast<uint32_t>(i);
+        }
+        if (num_etiquetas == MAX_ETIQUETAS_CONSTANTE) {
+            fallar("demasiadas etiquetas");
+            return 0;
+        }
+        nombres[num_etiquetas] = nombre;
+        linea_uso[num_etiquetas] = linea_actual;
+        return static_cast<uint32_t>(num_etiquetas++);
+    }
+
+    constexpr bool agregar(const InstruccionIR& ir) {
+        if (num_ir == MAX_IR) return fallar("demasiadas instrucciones para la capacidad pedida");
+        lineas[num_ir] = linea_actual;
+        sumandos[num_ir] = sumando_actual;
+        programa[num_ir++] = ir;
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // Lectura (lo que hace la PASADA 1 con una línea)
+    // -------------------------------------------------------------------------
+
+    // Registro, número, -número, etiqueta (más una constante, que queda en
+    // sumando_actual), expresión constante o [..] sin etiqueta; nullptr si
+    // es válido
+    constexpr const char* clasificar(const Token* t, size_t n, Operando& op) {
+        op = Operando();
+        if (n == 1) {
+            switch (t[0].tipo) {
+                case T_REG32:  op.tipo = OP_R32; op.reg = t[0].reg; return nullptr;
+                case T_REG8:   op.tipo = OP_R8;  op.reg = t[0].reg; return nullptr;
+                case T_NUMERO: op.tipo = OP_IMM; op.inmediato = t[0].valor; return nullptr;
+                case T_IDENT:
+                    op.tipo = OP_ETIQUETA;
+                    op.inmediato = etiqueta(t[0].texto);
+                    return nullptr;
+                default:
+                    return "operando invalido";
+            }
+        }
+
+        if (n == 2 && (t[0].tipo == T_MENOS || t[0].tipo == T_MAS) && t[1].tipo == T_NUMERO) {
+            op.tipo = OP_IMM;
+            op.inmediato = (t[0].tipo == T_MENOS) ? (0u - t[1].valor) : t[1].valor;
+            return nullptr;
+        }
+
+        if (n > 0 && t[0].tipo == T_IDENT && iguales_sin_mayusculas(t[0].texto, "BYTE"))  { op.tam_mem = 1; ++t; --n; }
+        else if (n > 0 && t[0].tipo == T_IDENT && iguales_sin_mayusculas(t[0].texto, "DWORD")) { op.tam_mem = 4; ++t; --n; }
+
+        if (n >= 3 && t[0].tipo == T_CORCHETE_ABRE && t[n - 1].tipo == T_CORCHETE_CIERRA) {
+            TerminosMemoria m;
+            if (const char* error = analizar_terminos(t + 1, n - 2, m, *this)) return error;
+            if (!m.desplazamiento.es_constante()) return "etiqueta dentro de [..] (no hay direccion de carga)";
+            if (!armar_direccion(m.regs, m.escalas, m.num_regs, false, m.desplazamiento.constante, op.mem)) {
+                return MEMORIA_NO_SOPORTADA;
+            }
+            op.tipo = OP_MEM;
+            return nullptr;
+        }
+        if (op.tam_mem != 0 || n == 0) return "operando invalido";
+
+        ValorExpresion v;
+        if (const char* error = evaluar_expresion(t, n, *this, v)) return error;
+        if (v.suma != SIN_SIMBOLO && v.resta == SIN_SIMBOLO) {
+            op.tipo = OP_ETIQUETA;   // solo destino de un salto, CALL o LOOP (como la etiqueta sola)
+            op.inmediato = v.suma;
+            sumando_actual = v.constante;
+            return nullptr;
+        }
+        if (!v.es_constante()) return "etiqueta en un inmediato (no hay direccion de carga)";
+        op.tipo = OP_IMM;
+        op.inmediato = v.constante;
+        return nullptr;
+    }
+
+    constexpr bool procesar_linea(std::string_view texto) {
+        LineaLexica lx{};
+        if (!tokenizar_linea(texto, lx)) return fallar("linea demasiado larga");
+        sumando_actual = 0;
+        const Token* t = lx.tokens;
+        size_t n = lx.num_tokens;
+
+        if (n >= 2 && t[0].tipo == T_IDENT && t[1].tipo == T_DOS_PUNTOS) {
+            const uint32_t id = etiqueta(t[0].texto);
+            if (resultado.error != nullptr) return false;
+            if (definidas[id]) return fallar("etiqueta repetida");
+            definidas[id] = true;
+            InstruccionIR ir{};
+            ir.tipo     = IR_ETIQUETA;
+            ir.valor[0] = id;
+            if (!agregar(ir)) return false;
+            t += 2;
+            n -= 2;
+        }
+        if (n == 0) return true;
+
+        size_t num_filas = 0;
+        const FilaOpcode* filas = t[0].tipo == T_IDENT ? buscar_filas_opcode(t[0].texto, num_filas) : nullptr;
+        if (num_filas == 0) return fallar("se esperaba una instruccion (no hay directivas)");
+
+        Operando ops[2];
+        int num_ops = 0;
+        for (size_t i = 1; i < n;) {
+            size_t fin = i;
+            while (fin < n && t[fin].tipo != T_COMA) ++fin;
+            if (num_ops == 2) return fallar("demasiados operandos");
+            if (fin + 1 == n) return fallar("falta un operando despues de ','");
+            if (const char* error = clasificar(t + i, fin - i, ops[num_ops++])) return fallar(error);
+            if (resultado.error != nullptr) return false;
+            i = fin + 1;
+        }
+
+        // Por índice y no por puntero: ver indice_fila() (CodificacionIA32.hpp)
+        size_t i_fila = indice_fila(filas, num_filas, ops, num_ops);
+        if (i_fila == num_filas) return fallar("forma no soportada");
+        const FilaOpcode& fila = filas[i_fila];
+        InstruccionIR ir = armar_ir(fila, ops, num_ops);
+        ir.salto_corto = (fila.cod == C_SALTO);   // disponer() agranda los que no alcanzan
+        return agregar(ir);
+    }
+
+    constexpr bool verificar_etiquetas() {
+        for (size_t i = 0; i < num_etiquetas; ++i) {
+            if (!definidas[i]) return fallar("etiqueta no definida", linea_uso[i]);
+        }
+        return true;
+    }
+
+    // -------------------------------------------------------------------------
+    // Disposición y emisión
+    // -------------------------------------------------------------------------
+
+    // Posición de cada etiqueta con la decisión de salto actual; los saltos
+    // cortos que no alcanzan pasan a near y se repite hasta que nada cambia
+    constexpr void disponer() {
+        for (bool cambio = true; cambio;) {
+            int posicion = 0;
+            for (size_t k = 0; k < num_ir; ++k) {
+                InstruccionIR& ir = programa[k];
+                if (ir.tipo == IR_ETIQUETA) {
+                    posiciones[ir.valor[0]] = posicion;
+                    continue;
+                }
+                EmisorConteo conteo;
+                codificar_instruccion(conteo, ir);
+                ir.tamano = static_cast<uint8_t>(conteo.bytes);
+                posicion += conteo.bytes;
+            }
+
+            cambio = false;
+            posicion = 0;
+            for (size_t k = 0; k < num_ir; ++k) {
+                InstruccionIR& ir = programa[k];
+                if (ir.tipo == IR_ETIQUETA) continue;
+                if (ir.salto_corto) {
+                    const int offset_short = posiciones[ir.valor[0]] + static_cast<int32_t>(sumandos[k]) -
+                                             (posicion + 2);
+                    if (offset_short >= -128 && offset_short <= 127) {
+                        ir.valor[1] = static_cast<uint32_t>(offset_short);
+                    } else {
+                        ir.salto_corto = 0;
+                        cambio = true;
+                    }
+                }
+                posicion += ir.tamano;
+            }
+        }
+    }
+
+    // Bytes de cada instrucción; la referencia relativa (CALL, LOOP, salto
+    // near) se resuelve en el momento porque todas las posiciones se conocen
+    constexpr void emitir() {
+        for (size_t k = 0; k < num_ir && resultado.error == nullptr; ++k) {
+            if (programa[k].tipo == IR_ETIQUETA) continue;
+            linea_actual = lineas[k];
+            pendiente = Pendiente();
+            codificar_instruccion(*this, programa[k]);
+            if (!pendiente.hay || resultado.error != nullptr) continue;
+
+            const int32_t relativo = posiciones[pendiente.simbolo] + static_cast<int32_t>(sumandos[k]) -
+                                     static_cast<int32_t>(pendiente.campo + static_cast<size_t>(pendiente.tamano));
+            if (pendiente.tamano == 1 && (relativo < -128 || relativo > 127)) {
+                fallar("salto rel8 fuera de rango");
+                return;
+            }
+            for (int b = 0; b < pendiente.tamano; ++b) {
+                resultado.bytes[pendiente.campo + static_cast<size_t>(b)] =
+                    static_cast<uint8_t>((static_cast<uint32_t>(relativo) >> (8 * b)) & 0xFF);
+            }
+        }
+    }
+};
+
+template <size_t MAX_BYTES>
+constexpr CodigoConstante<MAX_BYTES> ensamblar_constante(std::string_view texto) {
+    EnsambladorConstante<MAX_BYTES> e;
+    return e.ensamblar(texto);
+}
+
+template <size_t MAX_BYTES>
+constexpr bool mismos_bytes(const CodigoConstante<MAX_BYTES>& c, std::initializer_list<uint8_t> esperados) {
+    if (c.error != nullptr || c.tamano != esperados.size()) return false;
+    size_t i = 0;
+    for (uint8_t b : esperados) {
+        if (c.bytes[i++] != b) return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// asm_ia32<"..">() (C++20: el texto como parámetro de plantilla)
+// -----------------------------------------------------------------------------
+
+#if __cplusplus >= 202002L
+template <size_t N>
+struct TextoConstante {
+    char texto[N] = {};
+    constexpr TextoConstante(const char (&s)[N]) {
+        for (size_t i = 0; i < N; ++i) texto[i] = s[i];
+    }
+    constexpr std::string_view vista() const { return std::string_view(texto, N - 1); }
+};
+
+template <TextoConstante TEXTO, size_t MAX_BYTES = 256>
+consteval auto asm_ia32() {
+    constexpr CodigoConstante<MAX_BYTES> c = ensamblar_constante<MAX_BYTES>(TEXTO.vista());
+    static_assert(c.error == nullptr, "asm_ia32: el texto no ensambla (ver error y linea de ensamblar_constante)");
+    std::array<uint8_t, c.tamano> bytes{};
+    for (size_t i = 0; i < c.tamano; ++i) bytes[i] = c.bytes[i];
+    return bytes;
+}
+#endif
+
+// -----------------------------------------------------------------------------
+// Comprobaciones del núcleo compartido (se evalúan al compilar)
+// -----------------------------------------------------------------------------
+
+static_assert(mismos_bytes(ensamblar_constante<8>("MOV EAX, 1\nRET"), {0xB8, 0x01, 0x00, 0x00, 0x00, 0xC3}),
+              "MOV r32, imm32 / RET");
+static_assert(mismos_bytes(ensamblar_constante<8>("mov eax, [ebp - 8]\nlea ecx, [ebx+esi*4+8]"),
+                           {0x8B, 0x45, 0xF8, 0x8D, 0x4C, 0xB3, 0x08}),
+              "ModR/M con disp8 y SIB");
+static_assert(mismos_bytes(ensamblar_constante<8>("  JMP fin\n  NOP\nfin: RET"), {0xEB, 0x01, 0x90, 0xC3}),
+              "salto corto hacia adelante");
+static_assert(mismos_bytes(ensamblar_constante<8>("bucle: DEC ECX\nJNZ bucle"), {0x49, 0x75, 0xFD}),
+              "Jcc corto hacia atras");
+static_assert(mismos_bytes(ensamblar_constante<16>("ini: NOP\nMOV EAX, 1\nJMP ini + 1\nJZ fin - 1\nNOP\nfin: RET"),
+                           {0x90, 0xB8, 0x01, 0x00, 0x00, 0x00, 0xEB, 0xF9, 0x74, 0x00, 0x90, 0xC3}),
+              "salto corto a etiqueta + constante (hacia atras y adelante)");
+static_assert(mismos_bytes(ensamblar_constante<16>("ADD ESP, 4*2\nMOV EAX, (1 << 4) | 3\nmov ecx, [ebp - 2*4]"),
+                           {0x83, 0xC4, 0x08, 0xB8, 0x13, 0x00, 0x00, 0x00, 0x8B, 0x4D, 0xF8}),
+              "expresiones constantes con imm8 y disp8");
+static_assert(ensamblar_constante<16>("MOV EAX, 1/0").error != nullptr &&
+              ensamblar_constante<16>("x: MOV EAX, x + 4").error != nullptr,
+              "division por cero y etiquetas en un inmediato son errores");
+static_assert(ensamblar_constante<16>("MOV EAX, [dato]").error != nullptr &&
+              ensamblar_constante<16>("JMP falta").linea == 1,
+              "etiquetas absolutas y sin definir son errores");
+
+#endif // ENSAMBLADO_CONSTANTE_HPP
@@ -1,1478 +1,2445 @@
-#include "EnsambladorIA32.hpp"
-#include <cstdint>
-#include <cctype>
-#include <sstream>
-#include <algorithm>
-#include <iostream>
-#include <iomanip>
-
-using namespace std;
-
-// -----------------------------------------------------------------------------
-// Inicialización
-// -----------------------------------------------------------------------------
-
-//Se inicializa bandera para dos pasadas
-EnsambladorIA32::EnsambladorIA32() : contador_posicion(0), primera_pasada(true){
-    inicializar_mapas();
-}
-
-//Nueva función para dos pasadas
-void EnsambladorIA32::leer_fuente(const string& archivo) {
-    lineas_fuente.clear();
-    ifstream f(archivo);
-    if (!f.is_open()) {
-        cerr << "No se pudo abrir el archivo: " << archivo << endl;
-        return;
-    }
-    string linea;
-    while (getline(f, linea)) {
-        lineas_fuente.push_back(linea);
-    }
-    f.close();
-}
-
-
-void EnsambladorIA32::inicializar_mapas() {
-    // Registros de 32 bits
-    reg32_map = {
-        {"EAX", 0b000}, {"ECX", 0b001}, {"EDX", 0b010}, {"EBX", 0b011},
-        {"ESP", 0b100}, {"EBP", 0b101}, {"ESI", 0b110}, {"EDI", 0b111}
-    };
-
-    // Registros de 8 bits
-    reg8_map = {
-        {"AL", 0b000}, {"CL", 0b001}, {"DL", 0b010}, {"BL", 0b011},
-        {"AH", 0b100}, {"CH", 0b101}, {"DH", 0b110}, {"BH", 0b111}
-    };
-}
-
-// -----------------------------------------------------------------------------
-// Utilidades
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::limpiar_linea(string& linea) {
-    // Quitar comentarios
-    size_t pos = linea.find(';');
-    if (pos != string::npos) linea = linea.substr(0, pos);
-
-    // Trim
-    auto no_espacio = [](int ch) { return !isspace(ch); };
-    if (!linea.empty()) {
-        linea.erase(linea.begin(), find_if(linea.begin(), linea.end(), no_espacio));
-        linea.erase(find_if(linea.rbegin(), linea.rend(), no_espacio).base(), linea.end());
-    }
-
-    // Mayúsculas
-    transform(linea.begin(), linea.end(), linea.begin(), ::toupper);
-}
-
-bool EnsambladorIA32::separar_operandos(const string& linea_operandos, string& dest_str, string& src_str) {
-    stringstream ss(linea_operandos);
-    
-    // Leer el destino hasta la primera coma
-    if (!getline(ss, dest_str, ',')) return false;
-
-    // Leer el resto como fuente, ignorando espacios iniciales
-    ss >> ws;
-    if (!getline(ss, src_str)) return false;
-
-    // Limpiar espacios en ambos
-    limpiar_linea(dest_str);
-    limpiar_linea(src_str);
-
-    // Verificar que la fuente no esté vacía (es decir, que había un src después de la coma)
-    return !dest_str.empty() && !src_str.empty();
-}
-
-void EnsambladorIA32::agregar_dword(uint32_t dword) {
-    agregar_byte(static_cast<uint8_t>(dword & 0xFF));
-    agregar_byte(static_cast<uint8_t>((dword >> 8) & 0xFF));
-    agregar_byte(static_cast<uint8_t>((dword >> 16) & 0xFF));
-    agregar_byte(static_cast<uint8_t>((dword >> 24) & 0xFF));
-}
-
-bool EnsambladorIA32::obtener_reg8(const string& op, uint8_t& reg_code) {
-    auto it = reg8_map.find(op);
-    if (it != reg8_map.end()) {
-        reg_code = it->second;
-        return true;
-    }
-    return false;
-}
-
-
-// Direccionamiento simple [ETIQUETA]
-bool EnsambladorIA32::procesar_mem_sib(const string& operando,
-                                       uint8_t& modrm_byte,
-                                       const uint8_t reg_code,
-                                       bool /*es_destino*/) 
-{
-    string op = operando;
-
-    // Debe venir entre corchetes: [ ... ]
-    if (op.size() < 2 || op.front() != '[' || op.back() != ']')
-        return false;
-
-    // Quitar corchetes
-    op = op.substr(1, op.size() - 2);
-
-   // Limpiar espacios internos y externos
-    limpiar_linea(op);
-    op.erase(
-        remove_if(op.begin(), op.end(),
-                [](unsigned char c){ return isspace(c); }),
-        op.end()
-    );
-
-    // Patrón esperado: <etiqueta> + ESI*4 (+ disp)
-    // Buscamos "ESI*4"
-    size_t idxESI = op.find("ESI*4");
-    if (idxESI == string::npos)
-        return false;
-
-    // --- 1. Obtener la etiqueta antes de "ESI*4" ---
-    // Ej: "ARRAY+ESI*4+4" -> etiqueta parcial "ARRAY+"
-    string etiqueta = op.substr(0, idxESI);
-
-    // Si termina en '+', se lo quitamos: "ARRAY+" -> "ARRAY"
-    if (!etiqueta.empty() && etiqueta.back() == '+')
-        etiqueta.pop_back();
-    limpiar_linea(etiqueta); //Cambio
-
-    // Si por alguna razón quedó vacía, no es un patrón válido
-    if (etiqueta.empty())
-        return false;
-
-    // --- 2. Obtener desplazamiento opcional (disp8) después de ESI*4 ---
-    //   op = "ARRAY+ESI*4+4"
-    //          ^     ^   ^
-    //        idxEt  idxESI  plusAfter
-    uint8_t disp8 = 0;
-    size_t plusAfter = op.find('+', idxESI + 5); // 5 = longitud de "ESI*4"
-
-    if (plusAfter != string::npos) {
-        string dispStr = op.substr(plusAfter + 1);  // lo que va después del '+'
-        if (!dispStr.empty()) {
-            try {
-                int d = stoi(dispStr);  // soporta "+4", "4", etc.
-                disp8 = static_cast<uint8_t>(d & 0xFF);
-            } catch (...) {
-                // Si falla el parseo, dejamos disp8 = 0 y seguimos
-            }
-        }
-    }
-
-    // --- 3. Codificar ModR/M ---
-    // MOD = 00 si no hay disp8
-    // MOD = 01 si hay disp8
-    // R/M = 100 para indicar que viene byte SIB
-    uint8_t mod = (disp8 == 0) ? 0b00 : 0b01;
-    uint8_t rm  = 0b100;
-    uint8_t reg_field = reg_code;  // el registro del operando (REG en ModR/M)
-
-    modrm_byte = generar_modrm(mod, reg_field, rm);
-    agregar_byte(modrm_byte);
-
-    // --- 4. Codificar SIB ---
-    // SCALE = 10 (x4)
-    // INDEX = 110 (ESI)
-    // BASE  = 101 (usaremos disp32 como base absoluta)
-    uint8_t scale = 0b10;   // *4
-    uint8_t index = 0b110;  // ESI
-    uint8_t base  = 0b101;  // base "disp32"
-    uint8_t sib   = (scale << 6) | (index << 3) | base;
-    agregar_byte(sib);
-
-    // --- 5. Si MOD = 01, agregamos disp8 ---
-    if (mod == 0b01) {
-        agregar_byte(disp8);
-    }
-
-    // Ahora la posición del disp32 (absolute base) es contador_posicion
-    if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion; // primer byte del disp32
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto       = 0; // absoluto (dirección)
-        referencias_pendientes[etiqueta].push_back(ref);
-    }
-
-
-    agregar_dword(0);  // placeholder disp32
-
-    return true;
-}
-
-
-bool EnsambladorIA32::obtener_inmediato32(const string& str, uint32_t& immediate) {
-    string temp_str = str;
-    int base = 10;
-
-    if (temp_str.size() == 3 && temp_str.front() == '\'' && temp_str.back() == '\'') {
-        // Asumimos que es un solo carácter entre comillas
-        if (temp_str.size() == 3) {
-            // El valor es el código ASCII del carácter central
-            immediate = static_cast<uint32_t>(temp_str[1]);
-            return true;
-        }
-    }
-
-    // Manejar sufijo H (NASM style: FFFFH)
-    if (!temp_str.empty() && temp_str.back() == 'H') {
-        temp_str.pop_back();
-        base = 16;
-    }
-    // Manejar prefijo 0X (C/C++ style: 0X80)
-    else if (temp_str.size() > 2 && (temp_str.substr(0, 2) == "0X")) {
-        temp_str = temp_str.substr(2); // Eliminar "0X"
-        base = 16;
-    }
-    
-    // Pre-chequeo simple: si es solo "H" o "0X", es inválido
-    if (temp_str.empty() && base == 16) return false;
-
-    try {
-        size_t pos;
-        immediate = stoul(temp_str, &pos, base);
-
-        // Si no se consumió toda la cadena, no es un número válido.
-        return pos == temp_str.size();
-    }
-    catch (...) {
-        // Captura invalid_argument o out_of_range
-        return false;
-    }
-}
-void EnsambladorIA32::agregar_byte(uint8_t byte) {
-    // Siempre avanzamos el contador de posición
-    contador_posicion += 1;
-
-    // Solo en la segunda pasada guardamos el byte real
-    if (!primera_pasada) {
-        codigo_hex.push_back(byte);
-    }
-}
-bool EnsambladorIA32::obtener_reg32(const string& op, uint8_t& reg_code) {
-    auto it = reg32_map.find(op);
-    if (it != reg32_map.end()) {
-        reg_code = it->second;
-        return true;
-    }
-    return false;
-}
-
-
-uint8_t EnsambladorIA32::generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm) {
-    return (mod << 6) | (reg << 3) | rm;
-}
-
-bool EnsambladorIA32::es_etiqueta(const string& s) {
-    // La línea ya está limpia y en mayúsculas
-    return !s.empty() && s.back() == ':';
-}
-
-
-void EnsambladorIA32::procesar_etiqueta(const string& etiqueta_cruda) {
-    string etiqueta = etiqueta_cruda;
-
-    // Si termina con ':' se lo quitamos
-    if (!etiqueta.empty() && etiqueta.back() == ':') {
-        etiqueta.pop_back();
-    }
-
-    // En DOS PASADAS: solo llenar tabla en la primera
-    if (primera_pasada) {
-        tabla_simbolos[etiqueta] = contador_posicion;
-    }
-}
-
-// -----------------------------------------------------------------------------
-// Procesamiento de líneas
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::procesar_linea(string linea) {
-    limpiar_linea(linea);
-    if (linea.empty()) return;
-
-    if (es_etiqueta(linea)) {
-        procesar_etiqueta(linea.substr(0, linea.size() - 1));
-        return;
-    }
-
-    procesar_instruccion(linea);
-}
-
-void EnsambladorIA32::procesar_instruccion(const string& linea) {
-    stringstream ss(linea);
-    string mnem;
-    ss >> mnem;
-
-    string resto;
-    getline(ss, resto);
-    limpiar_linea(resto); // Limpia el resto de la línea (operandos o directivas)
-
-    // Extraemos la directiva/segundo token AQUI.
-    stringstream resto_ss(resto);
-    string directiva_dato;
-    resto_ss >> directiva_dato;
-    limpiar_linea(directiva_dato); // Aseguramos que la directiva esté limpia
-    
-    // --- MANEJO DE DIRECTIVAS SIN CÓDIGO (SECTION, GLOBAL, EQU) ---
-    
-    if (mnem == "SECTION" || mnem == "GLOBAL" || mnem == "EXTERN" || mnem == "BITS" || directiva_dato == "EQU") {
-        // Ignoramos las directivas de NASM y EQU.
-        return; 
-    }
-
-    // --- 2. INSTRUCCIONES IA-32 IMPLEMENTADAS ---
-    if (mnem == "MOV") {
-        procesar_mov(resto);
-    }
-    else if (mnem == "ADD") {
-        procesar_add(resto);
-    }
-    else if (mnem == "SUB") {
-        procesar_sub(resto);
-    }
-    else if (mnem == "CMP") {
-        procesar_cmp(resto);
-    }
-    else if (mnem == "IMUL") {
-        procesar_imul(resto);
-    }
-    else if (mnem == "INC") {
-        procesar_inc(resto);
-    }
-    else if (mnem == "DEC") {
-        procesar_dec(resto);
-    }
-    else if (mnem == "MUL") {
-        procesar_mul(resto);
-    }
-    else if (mnem == "DIV") {
-        procesar_div(resto);
-    }
-    else if (mnem == "IDIV") {
-        procesar_idiv(resto);
-    }
-    else if (mnem == "XOR") {
-        procesar_xor(resto);
-    }
-    else if (mnem == "AND") {
-        procesar_and(resto);
-    }
-    else if (mnem == "OR") {
-        procesar_or(resto);
-    }
-    else if (mnem == "TEST") {
-        procesar_test(resto);
-    }
-    else if (mnem == "MOVZX") {
-        procesar_movzx(resto);
-    }
-    else if (mnem == "XCHG") {
-        procesar_xchg(resto);
-    }
-    else if (mnem == "LEA") {
-        procesar_lea(resto);
-    }
-    else if (mnem == "CALL") {
-        procesar_call(resto);
-    }
-    else if (mnem == "RET") {
-        procesar_ret();
-    }
-    else if (mnem == "PUSH") {
-        procesar_push(resto);
-    }
-    else if (mnem == "POP") {
-        procesar_pop(resto);
-    }
-    else if (mnem == "LOOP") {
-        procesar_loop(resto);
-    }
-    else if (mnem == "JMP") {
-        procesar_jmp(resto);
-    }
-    else if (mnem == "LEAVE") { // NUEVO
-        procesar_leave();
-    }
-    else if (mnem == "JE" || mnem == "JZ" ||
-        mnem == "JNE" || mnem == "JNZ" ||
-        mnem == "JLE" || mnem == "JL" ||
-        mnem == "JA" || mnem == "JAE" ||
-        mnem == "JB" || mnem == "JBE" ||
-        mnem == "JG" || mnem == "JGE") {
-        procesar_condicional(mnem, resto);
-    }
-    else if (mnem == "INT") {
-        uint32_t immediate;
-        if (obtener_inmediato32(resto, immediate) && immediate <= 0xFF) {
-            agregar_byte(0xCD);
-            agregar_byte(static_cast<uint8_t>(immediate));
-        }
-        else {
-            cerr << "Error: Formato de INT invalido o inmediato fuera de rango (0-255): " << resto << endl;
-        }
-    }
-    // --- 3. ETIQUETAS DE DATOS (DD/DB) ---
-    else {
-    // 'mnem' es ETIQUETA, 'directiva_dato' es DD/DB, en resto_ss queda el valor
-    if (directiva_dato == "DD") {
-        procesar_etiqueta(mnem);
-
-    // resto = "5, 2, 8, 1, 9, 3"
-    string valores;
-    getline(resto_ss, valores);   // lo que quede después de "DD"
-    limpiar_linea(valores);
-
-    string token;
-    stringstream vs(valores);
-    while (getline(vs, token, ',')) {
-        limpiar_linea(token);
-        if (token.empty()) continue;
-
-        uint32_t val;
-        if (!obtener_inmediato32(token, val)) {
-            cerr << "Error en DD: valor invalido '" << token << "'\n";
-            val = 0;
-        }
-        agregar_dword(val);
-    }
-    return;
-    } else if (directiva_dato == "DB") {
-        procesar_etiqueta(mnem);
-        string valor_str;
-        resto_ss >> valor_str;
-        uint32_t val = 0;
-        if (!valor_str.empty()) {
-            uint32_t tmp;
-            if (obtener_inmediato32(valor_str, tmp)) val = tmp & 0xFF;
-        }
-        agregar_byte(static_cast<uint8_t>(val));
-        return;
-    }
-        
-        // Si falla todo, es una instrucción o directiva realmente no soportada.
-        cerr << "Advertencia: Mnemónico o directiva no soportada: " << mnem << endl;
-    }
-}
-
-
-// -----------------------------------------------------------------------------
-// ADD, SUB, CMP (generalizado)
-// -----------------------------------------------------------------------------
-void EnsambladorIA32::procesar_binaria(
-    const string& mnem,
-    const string& operandos,
-    uint8_t opcode_rm_reg, // ej: 0x01 (ADD r/m32, r32)
-    uint8_t opcode_reg_rm, // ej: 0x03 (ADD r32, r/m32)
-    uint8_t opcode_eax_imm, // ej: 0x05 (ADD EAX, imm32)
-    uint8_t opcode_imm_general, // ej: 0x81 (ADD r/m32, imm)
-    uint8_t reg_field_extension // ej: 0b000 para ADD, 0b101 para SUB
-) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: Se esperaban 2 operandos para " << mnem << endl;
-        return;
-    }
-
-    uint8_t dest_code = 0, src_code = 0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg = obtener_reg32(src_str, src_code);
-    uint32_t immediate = 0;
-    bool src_is_imm = obtener_inmediato32(src_str, immediate);
-
-    bool dest_is_mem = (!dest_is_reg && ! (dest_str.empty() && obtener_inmediato32(dest_str, immediate)) && dest_str.size()>=2 && dest_str.front()=='[' && dest_str.back()==']');
-    bool src_is_mem = (!src_is_reg && !src_is_imm && src_str.size()>=2 && src_str.front()=='[' && src_str.back()==']');
-    
-    // 1. REG, REG (r/m32, r32)
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(opcode_rm_reg); // ej: 0x01 para ADD, 0x29 para SUB
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code); // MOD=11 (registro), REG=src, R/M=dest
-        agregar_byte(modrm);
-        return;
-    }
-
-    // 2. EAX, INMEDIATO (opcode dedicado)
-    if (dest_is_reg && dest_code == 0b000 && src_is_imm) { // EAX, imm
-        agregar_byte(opcode_eax_imm); // ej: 0x05 para ADD, 0x2D para SUB
-        agregar_dword(immediate);
-        return;
-    }
-
-    // 3. REG, [ETIQUETA] (r32, r/m32)
-    if (dest_is_reg && !src_is_imm) { 
-        agregar_byte(opcode_reg_rm); // ej: 0x03 para ADD, 0x2B para SUB, 0x3B para CMP
-        uint8_t modrm_byte;
-        // es_destino=false porque la memoria es la fuente (ModR/M usa REG=dest_code)
-        if (procesar_mem_sib(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_disp(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return;
-    }
-    
-    // 4. [ETIQUETA], REG (r/m32, r32)
-    if (src_is_reg && !src_is_imm) { 
-        agregar_byte(opcode_rm_reg); // ej: 0x01 para ADD, 0x29 para SUB, 0x39 para CMP
-        uint8_t modrm_byte;
-        // es_destino=true porque la memoria es el destino (ModR/M usa REG=src_code)
-        if (procesar_mem_sib(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_disp(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_simple(dest_str, modrm_byte, src_code, true)) return;
-    }
-
-    // 5. [ETIQUETA], INMEDIATO (81 /extension, imm32)
-    // Usaremos la versión IMM8 (0x83 /extension, imm8) si cabe, ya que el proyecto incluye ejemplos con imm8.
-    if (src_is_imm && dest_is_mem) {
-        uint8_t opcode = opcode_imm_general; // ej: 0x81
-        bool use_imm8 = (immediate <= 0xFF) || (immediate >= 0xFFFFFF80 && immediate <= 0xFFFFFFFF); // Si cabe en 8 bits con extensión de signo
-        if (use_imm8) opcode = 0x83; // Opcode 0x83 para imm8 sign-extended
-        
-        agregar_byte(opcode);
-        uint8_t modrm_byte;
-        if (procesar_mem_sib(dest_str, modrm_byte, reg_field_extension, true)) {
-            if (use_imm8) agregar_byte(static_cast<uint8_t>(immediate & 0xFF)); else agregar_dword(immediate);
-            return;
-        }
-        if (procesar_mem_disp(dest_str, modrm_byte, reg_field_extension, true)) {
-            if (use_imm8) agregar_byte(static_cast<uint8_t>(immediate & 0xFF)); else agregar_dword(immediate);
-            return;
-        }
-        if (procesar_mem_simple(dest_str, modrm_byte, reg_field_extension, true)) {
-            if (use_imm8) agregar_byte(static_cast<uint8_t>(immediate & 0xFF)); else agregar_dword(immediate);
-            return;
-        }
-    } 
-    // 6. REG, INMEDIATO (81 /extension, imm32) - Si no es EAX (ya manejado)
-    if (dest_is_reg && dest_code != 0b000 && src_is_imm) {
-        uint8_t opcode = opcode_imm_general; // ej: 0x81
-        bool use_imm8 = (immediate <= 0xFF && immediate >= 0) || (immediate >= 0xFFFFFF80 && immediate <= 0xFFFFFFFF);
-        if (use_imm8) opcode = 0x83;
-
-        agregar_byte(opcode);
-        uint8_t modrm = generar_modrm(0b11, reg_field_extension, dest_code); // Mod=11 (reg), REG=extensión, R/M=dest
-        agregar_byte(modrm);
-        
-        if (use_imm8) {
-            agregar_byte(static_cast<uint8_t>(immediate & 0xFF));
-        } else {
-            agregar_dword(immediate);
-        }
-        return;
-    }
-
-
-    cerr << "Error de sintaxis o modo no soportado para " << mnem << ": " << operandos << endl;
-}
-// -----------------------------------------------------------------------------
-// ADD, SUB, CMP, IMUL (usando el generalizado)
-// -----------------------------------------------------------------------------
-void EnsambladorIA32::procesar_add(const string& operandos) {
-    // 0x01: ADD r/m32, r32; 0x03: ADD r32, r/m32; 0x05: ADD EAX, imm32
-    // 0x81: ADD r/m32, imm32; Extensión de opcode: /0 (0b000)
-    procesar_binaria("ADD", operandos, 0x01, 0x03, 0x05, 0x81, 0b000);
-}
-
-void EnsambladorIA32::procesar_sub(const string& operandos) {
-    // 0x29: SUB r/m32, r32; 0x2B: SUB r32, r/m32; 0x2D: SUB EAX, imm32
-    // 0x81: SUB r/m32, imm32; Extensión de opcode: /5 (0b101)
-    procesar_binaria("SUB", operandos, 0x29, 0x2B, 0x2D, 0x81, 0b101);
-}
-
-void EnsambladorIA32::procesar_cmp(const string& operandos) {
-    // 0x39: CMP r/m32, r32; 0x3B: CMP r32, r/m32; 0x3D: CMP EAX, imm32
-    // 0x81: CMP r/m32, imm32; Extensión de opcode: /7 (0b111)
-    procesar_binaria("CMP", operandos, 0x39, 0x3B, 0x3D, 0x81, 0b111);
-}
-
-void EnsambladorIA32::procesar_imul(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para IMUL." << endl;
-        return;
-    }
-
-    uint8_t dest_code = 0, src_code = 0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str, src_code);
-
-    // IMUL r32, r/m32  ->  0F AF /r
-    // Para reg,reg usamos MOD = 11, REG = destino, R/M = fuente
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x0F);
-        agregar_byte(0xAF);
-        uint8_t modrm = generar_modrm(0b11, dest_code, src_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para IMUL: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_inc(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code;
-    if (obtener_reg32(op, reg_code)) {
-        // INC r32  ->  40+rd
-        agregar_byte(static_cast<uint8_t>(0x40 + reg_code));
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para INC: " << operandos << endl;
-}
-
-
-void EnsambladorIA32::procesar_dec(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code;
-    if (obtener_reg32(op, reg_code)) {
-        // Forma corta: 48+rd  (DEC r32)
-        // EAX=0 -> 48, ECX=1 -> 49, EDX=2 -> 4A, ...
-        agregar_byte(static_cast<uint8_t>(0x48 + reg_code));
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para DEC: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_push(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-    uint8_t reg_code;
-    
-    // 1. PUSH r32 (50+rd)
-    if (obtener_reg32(op, reg_code)) {
-        agregar_byte(static_cast<uint8_t>(0x50 + reg_code));
-        return;
-    }
-    
-    uint32_t immediate;
-    // 2. PUSH imm32 (68 id) - Maneja 'C', 'B', 'A' y números.
-    if (obtener_inmediato32(op, immediate)) {
-        agregar_byte(0x68); // Opcode 68
-        agregar_dword(immediate);
-        return;
-    }
-
-    // 3. PUSH r/m32 (FF /6) - Maneja [EBP+disp]
-    uint8_t modrm_byte;
-    const uint8_t ext_opcode = 0b110; // Extensión /6
-    
-    // Intentar Base + Desplazamiento
-    if (procesar_mem_disp(op, modrm_byte, ext_opcode, false)) { 
-        agregar_byte(0xFF); // Opcode FF
-        return;
-    }
-    
-    // Intentar Memoria Simple [ETIQUETA]
-    if (procesar_mem_simple(op, modrm_byte, ext_opcode, false)) {
-        agregar_byte(0xFF); // Opcode FF
-        return;
-    }
-    
-    cerr << "Error de sintaxis o modo no soportado para PUSH: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_pop(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code;
-    if (obtener_reg32(op, reg_code)) {
-        // POP r32 -> 58+rd
-        agregar_byte(static_cast<uint8_t>(0x58 + reg_code));
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para POP: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_leave() {
-    // LEAVE -> C9
-    agregar_byte(0xC9);
-}
-
-void EnsambladorIA32::procesar_ret() {
-    // RET -> C3
-    agregar_byte(0xC3);
-}
-
-void EnsambladorIA32::procesar_nop() {
-    // NOP -> 90
-    agregar_byte(0x90);
-}
-
-void EnsambladorIA32::procesar_call(const string& operandos) {
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    agregar_byte(0xE8);  // CALL rel32
-    // La posición del inmediato (disp32) es la posición actual del contador
-    // antes de escribir los 4 bytes del inmediato.
-     if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion;   // primer byte del disp32
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto       = 1; // relativo
-        referencias_pendientes[etiqueta].push_back(ref);
-    }
-
-
-    agregar_dword(0); // placeholder
-}
-
-void EnsambladorIA32::procesar_loop(const string& operandos) {
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    agregar_byte(0xE2); // LOOP rel8
-    // Posición del byte de desplazamiento (rel8) es la posición actual
-   if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion;   // primer (y único) byte del disp8
-        ref.tamano_inmediato = 1;
-        ref.tipo_salto       = 1; // relativo
-        referencias_pendientes[etiqueta].push_back(ref);
-    }
-
-
-    agregar_byte(0x00); // placeholder
-}
-
-bool EnsambladorIA32::procesar_mem_simple(const string& operando,
-                                          uint8_t& modrm_byte,
-                                          const uint8_t reg_code,
-                                          bool es_destino,
-                                          uint8_t op_extension)
-{
-    string op = operando;
-    if (op.size() < 3 || op.front() != '[' || op.back() != ']')
-        return false;
-
-    op = op.substr(1, op.size() - 2);
-    limpiar_linea(op);
-    string etiqueta = op;
-
-    uint8_t mod = 0b00;
-    uint8_t rm  = 0b101;
-    uint8_t reg_field = es_destino ? op_extension : reg_code;
-
-    modrm_byte = generar_modrm(mod, reg_field, rm);
-    agregar_byte(modrm_byte);
-
-    // La posición del disp32 contador_posicion (antes de escribir 4 bytes)
-    if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion; // primer byte del disp32
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto       = 0; // absoluto (dirección)
-        referencias_pendientes[etiqueta].push_back(ref);
-    }
-
-    agregar_dword(0);  // placeholder disp32
-    return true;
-}
-
-
-// -----------------------------------------------------------------------------
-// Saltos
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::procesar_jmp(const string& operandos_in) {
-    string operandos = operandos_in;
-    string op = operandos;
-    limpiar_linea(op);
-    string etiqueta = operandos;
-
-    // Caso 1: etiqueta ya definida (posiblemente en pasada 1 si está antes)
-    if (tabla_simbolos.count(etiqueta)) {
-        int destino = tabla_simbolos[etiqueta];
-
-        // Intentamos calcular como rel8 primero (offset desde siguiente byte)
-        int pos_disp_if_short = contador_posicion + 1; // si ponemos EB xx, el disp está en contador+1
-        int offset_short = destino - pos_disp_if_short;
-
-        if (offset_short >= -128 && offset_short <= 127) {
-            // Salto corto
-            agregar_byte(0xEB); // JMP rel8
-            agregar_byte(static_cast<uint8_t>(offset_short & 0xFF));
-            return;
-        } else {
-            // Salto near rel32
-            agregar_byte(0xE9); // JMP rel32
-
-            // Registrar referencia en PASADA 1 (posición del disp32)
-            if (primera_pasada) {
-                ReferenciaPendiente ref;
-                ref.posicion         = contador_posicion; // primer byte del disp32
-                ref.tamano_inmediato = 4;
-                ref.tipo_salto       = 1; // relativo
-                referencias_pendientes[etiqueta].push_back(ref);
-            }
-
-            agregar_dword(0); // placeholder disp32
-            return;
-        }
-    }
-
-    // Caso 2: etiqueta NO existe aún (forward).
-    // Para simplificar y evitar reensamblados, emitimos aquí la forma NEAR (rel32)
-    // en lugar de asumir salto corto. Esto garantiza que la referencia tenga espacio.
-    agregar_byte(0xE9); // JMP rel32 (forward assumed)
-
-    if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion; // primer byte del disp32
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto       = 1; // relativo
-        referencias_pendientes[etiqueta].push_back(ref);
-    }
-
-    agregar_dword(0); // placeholder rel32
-}
-void EnsambladorIA32::procesar_condicional(const string& mnem,
-                                           const string& operandos_in) {
-    string operandos = operandos_in;
-    limpiar_linea(operandos);
-    string etiqueta = operandos;
-
-    uint8_t opcode;
-    uint8_t opcode_ext = 0;
-    bool uses_two_byte = false;
-
-    // Mapeo a saltos cortos (rel8)
-    if (mnem == "JE" || mnem == "JZ") opcode = 0x74, opcode_ext = 0x84, uses_two_byte = true;
-    else if (mnem == "JNE" || mnem == "JNZ") opcode = 0x75, opcode_ext = 0x85, uses_two_byte = true;
-    else if (mnem == "JLE") opcode = 0x7E, opcode_ext = 0x8E, uses_two_byte = true;
-    else if (mnem == "JL") opcode = 0x7C, opcode_ext = 0x8C, uses_two_byte = true;
-    else if (mnem == "JA") opcode = 0x77, opcode_ext = 0x87, uses_two_byte = true;
-    else if (mnem == "JAE") opcode = 0x73, opcode_ext = 0x83, uses_two_byte = true;
-    else if (mnem == "JB") opcode = 0x72, opcode_ext = 0x82, uses_two_byte = true;
-    else if (mnem == "JBE") opcode = 0x76, opcode_ext = 0x86, uses_two_byte = true;
-    else if (mnem == "JG") opcode = 0x7F, opcode_ext = 0x8F, uses_two_byte = true;
-    else if (mnem == "JGE") opcode = 0x7D, opcode_ext = 0x8D, uses_two_byte = true;
-    else {
-        cerr << "Error: Mnemónico condicional no soportado: " << mnem << endl;
-        return;
-    }
-    // Si la etiqueta ya está en la tabla, intentamos calcular offset
-    if (tabla_simbolos.count(etiqueta)) {
-        int destino = tabla_simbolos[etiqueta];
-        int pos_disp = contador_posicion + 1; // si emitimos short
-        int offset = destino - pos_disp;
-        if (offset >= -128 && offset <= 127) {
-            agregar_byte(opcode);
-            agregar_byte(static_cast<uint8_t>(offset & 0xFF));
-            return;
-      } else if (uses_two_byte) {
-            // emitir opcode 0F 8x + rel32
-            agregar_byte(0x0F);
-            agregar_byte(opcode_ext);
-            
-            // registrar referencia en PASADA 1 apuntando al inicio del disp32
-            if (primera_pasada) {
-                ReferenciaPendiente ref;
-                ref.posicion         = contador_posicion; // primer byte del disp32
-                ref.tamano_inmediato = 4;
-                ref.tipo_salto       = 1; // relativo
-                referencias_pendientes[etiqueta].push_back(ref);
-            }
-
-            agregar_dword(0);
-            return;
-        }
-    }  
-
-    // Si etiqueta no está definida, emitimos versión corta y referencia rel8 pendiente
-   if (uses_two_byte) {
-        agregar_byte(0x0F);
-        agregar_byte(opcode_ext);
-
-        if (primera_pasada) {
-            ReferenciaPendiente ref;
-            ref.posicion         = contador_posicion; // primer byte del disp32
-            ref.tamano_inmediato = 4;
-            ref.tipo_salto       = 1; // relativo
-            referencias_pendientes[etiqueta].push_back(ref);
-        }
-
-        agregar_dword(0);
-        return;
-    }
-
-    // Fallback (no debería llegar aquí)
-    agregar_byte(opcode);
-    if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion;
-        ref.tamano_inmediato = 1;
-        ref.tipo_salto       = 1;
-        referencias_pendientes[etiqueta].push_back(ref);
-    }
-    agregar_byte(0x00);
-}
-
-void EnsambladorIA32::procesar_mul(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code=0;
-    if (obtener_reg32(op, reg_code)) {
-        // MUL r32  -> F7 /4  con MOD=11, REG=100b, R/M=reg
-        agregar_byte(0xF7);
-        uint8_t modrm = generar_modrm(0b11, 0b100, reg_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    // MUL [ETIQUETA]
-    uint8_t modrm_byte;
-    agregar_byte(0xF7);
-    if (procesar_mem_simple(op, modrm_byte, 0, true, 0b100)) {
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para MUL: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_div(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code=0;
-    if (obtener_reg32(op, reg_code)) {
-        // DIV r32 -> F7 /6
-        agregar_byte(0xF7);
-        uint8_t modrm = generar_modrm(0b11, 0b110, reg_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    uint8_t modrm_byte;
-    agregar_byte(0xF7);
-    if (procesar_mem_simple(op, modrm_byte, 0, true, 0b110)) {
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para DIV: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_idiv(const string& operandos) {
-    string op = operandos;
-    limpiar_linea(op);
-
-    uint8_t reg_code=0;
-    if (obtener_reg32(op, reg_code)) {
-        // IDIV r32 -> F7 /7
-        agregar_byte(0xF7);
-        uint8_t modrm = generar_modrm(0b11, 0b111, reg_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    uint8_t modrm_byte;
-    agregar_byte(0xF7);
-    if (procesar_mem_simple(op, modrm_byte, 0, true, 0b111)) {
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para IDIV: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_xor(const string& operandos) {
-    // 31: XOR r/m32, r32; 33: XOR r32, r/m32; 35: XOR EAX, imm32; 81 /6: XOR r/m32, imm32
-    procesar_binaria("XOR", operandos, 0x31, 0x33, 0x35, 0x81, 0b110);
-}
-
-void EnsambladorIA32::procesar_and(const string& operandos) {
-    // 21: AND r/m32, r32; 23: AND r32, r/m32; 25: AND EAX, imm32; 81 /4: AND r/m32, imm32
-    procesar_binaria("AND", operandos, 0x21, 0x23, 0x25, 0x81, 0b100);
-}
-
-void EnsambladorIA32::procesar_or(const string& operandos) {
-    // 09: OR r/m32, r32; 0B: OR r32, r/m32; 0D: OR EAX, imm32; 81 /1: OR r/m32, imm32
-    procesar_binaria("OR", operandos, 0x09, 0x0B, 0x0D, 0x81, 0b001);
-}
-
-void EnsambladorIA32::procesar_test(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para TEST." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str, src_code);
-
-    // TEST r/m32, r32 -> 85 /r
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x85);
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para TEST: " << operandos << endl;
-}
-
-bool EnsambladorIA32::is_mem_simple_label(const string& s) {
-    // Detecta [LABEL] sencillo sin registros, sin '+', '-', '*', ni constantes
-    if (s.size() < 3 || s.front() != '[' || s.back() != ']') return false;
-    string inner = s.substr(1, s.size()-2);
-    limpiar_linea(inner);
-    // si contiene cualquiera de estos símbolos, no es "simple"
-    string forbidden = "+-*[]";
-    for (char c: forbidden) if (inner.find(c) != string::npos) return false;
-    // si contiene nombres de registros, tampoco
-    for (auto &par: reg32_map) {
-    if (inner.find(par.first) != string::npos) return false;
-    }
-    for (auto &par: reg8_map) {
-    if (inner.find(par.first) != string::npos) return false;
-    }
-    // si solo está compuesto por letras, dígitos o '_' lo permitimos
-    // (aceptamos etiquetas alfanuméricas)
-    return true;
-}
-
-void EnsambladorIA32::procesar_mov(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: Se esperaban 2 operandos para MOV." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg = obtener_reg32(src_str, src_code);
-    
-    // 1. MOV REG, REG (89 r/m32, r32)
-    if (dest_is_reg && src_is_reg) {
-        agregar_byte(0x89);
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code); 
-        agregar_byte(modrm);
-        return;
-    }
-
-    uint32_t immediate=0;
-    bool src_is_imm = obtener_inmediato32(src_str, immediate);
-
-    // 2. MOV REG, INMEDIATO (B8+rd)
-    if (dest_is_reg && src_is_imm) {
-        agregar_byte(0xB8 + dest_code);
-        agregar_dword(immediate);
-        return;
-    }
-
-    // --- CASO ESPECIAL MOV ECX, LEN (simulación de constante) ---
-    if (dest_is_reg && src_str == "LEN") {
-        agregar_byte(0xB8 + dest_code); 
-        agregar_dword(6); // Valor simulado para LEN
-        return;
-    }
-
- // 2.5. MOV [ETIQUETA], EAX (Opcode A3) - Usaremos SOLO para [LABEL] simple
-if (src_is_reg && src_code == 0b000 && is_mem_simple_label(dest_str)) {
-    // dest_str viene como "[RESULTADO]" por ejemplo
-    string temp_op = dest_str.substr(1, dest_str.size() - 2); // "RESULTADO"
-
-    agregar_byte(0xA3);  // MOV [disp32], EAX
-
-    // Registrar la referencia en la PRIMERA pasada (antes era en !primera_pasada)
-    if (primera_pasada) {
-        ReferenciaPendiente ref;
-        ref.posicion         = contador_posicion; // donde empieza el disp32
-        ref.tamano_inmediato = 4;
-        ref.tipo_salto       = 0; // 0 = absoluto (dirección)
-        referencias_pendientes[temp_op].push_back(ref);
-    }
-
-    // Reserva 4 bytes (en 2ª pasada escribe 00 00 00 00)
-    agregar_dword(0);
-
-    return;
-}
-
-    
-    // 3. MOV [MEM], REG (89 r/m32, r32). MEMORIA ES DESTINO.
-    if (src_is_reg) {
-        agregar_byte(0x89); 
-        uint8_t modrm_byte;
-        
-        if (procesar_mem_sib(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_disp(dest_str, modrm_byte, src_code, true)) return;
-        if (procesar_mem_simple(dest_str, modrm_byte, src_code, true)) return;
-    }
-
-    // 4. MOV REG, [MEM] (8B r32, r/m32). MEMORIA ES FUENTE.
-    if (dest_is_reg) {
-        agregar_byte(0x8B); // Opcode 8B
-        uint8_t modrm_byte;
-        
-        if (procesar_mem_sib(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_disp(src_str, modrm_byte, dest_code, false)) return;
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return;
-    }
-    
-    // 5. MOV [MEM], INMEDIATO (C7 /0, imm32)
-    if (src_is_imm) {
-        agregar_byte(0xC7); 
-        uint8_t modrm_byte;
-        
-        if (procesar_mem_sib(dest_str, modrm_byte, 0b000, true)) {
-             agregar_dword(immediate);
-             return;
-        }
-
-        if (procesar_mem_disp(dest_str, modrm_byte, 0b000, true)) {
-            agregar_dword(immediate);
-            return;
-        }
-        
-        if (procesar_mem_simple(dest_str, modrm_byte, 0b000, true)) {
-             agregar_dword(immediate);
-             return;
-        }
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para MOV: " << operandos << endl;
-}
-
-// -----------------------------------------------------------------------------
-// Direccionamiento EBP + Desplazamiento [EBP + disp]
-// -----------------------------------------------------------------------------
-bool EnsambladorIA32::procesar_mem_disp(const string& operando, 
-                                        uint8_t& modrm_byte, 
-                                        const uint8_t reg_code, 
-                                        bool es_destino) {
-    
-    string op = operando;
-    if (op.front() != '[' || op.back() != ']') return false;
-
-    op = op.substr(1, op.size() - 2); // Remueve corchetes
-    limpiar_linea(op);
-    
-    // Simplificación: Solo buscamos EBP (o un registro de 32 bits y un desplazamiento)
-    if (op.find("EBP") == string::npos) return false;
-    
-    uint8_t base_code;
-    // Debemos parsear para soportar [EBP+disp]. Asumimos que es EBP (0b101).
-    if (!obtener_reg32("EBP", base_code)) return false; 
-    
-    int displacement = 0;
-    
-    size_t sign_pos = op.find('+');
-    if (sign_pos == string::npos) sign_pos = op.find('-');
-    
-    if (sign_pos != string::npos) {
-        try {
-            displacement = stoi(op.substr(sign_pos));
-        } catch(...) {
-            return false;
-        }
-    }
-    
-    // Elegir MOD según tamaño del desplazamiento
-    uint8_t mod;
-    if (displacement == 0) {
-        // Para [EBP] el encodado MOD=00 con R/M=101 significa disp32
-        // Para representar [EBP] sin disp se usa MOD=01 con disp8=0
-        mod = 0b01;
-    } else if (displacement >= -128 && displacement <= 127) {
-        mod = 0b01; // disp8
-    } else {
-        mod = 0b10; // disp32
-    }
-
-
-    uint8_t rm = base_code; // R/M = EBP (101)
-    uint8_t reg_field = reg_code;
-    
-    modrm_byte = generar_modrm(mod, reg_field, rm);
-    agregar_byte(modrm_byte);
-    
-    if (mod == 0b01) {
-        agregar_byte(static_cast<uint8_t>(displacement & 0xFF));
-    } else if (mod == 0b10) {
-        agregar_dword(static_cast<uint32_t>(displacement));
-    }
-    return true;
-}
-
-void EnsambladorIA32::procesar_movzx(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para MOVZX." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code8=0;
-    bool dest_is_reg32 = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg8   = obtener_reg8(src_str, src_code8);
-
-    if (!dest_is_reg32) {
-        cerr << "Error: MOVZX requiere un registro de 32 bits como destino." << endl;
-        return;
-    }
-
-    // --- MANEJO DE LA SINTAXIS DE MEMORIA (BYTE [DISCOS]) ---
-    // Eliminar la pista de tamaño "BYTE" del operando fuente si existe.
-    size_t byte_pos = src_str.find("BYTE ");
-    if (byte_pos != string::npos) {
-        src_str.erase(byte_pos, 5); // Elimina "BYTE " (5 caracteres)
-        limpiar_linea(src_str);    // Limpia espacios que pudieran quedar (importante)
-    }
-    // ---------------------------------------------------------
-
-    // 1. MOVZX r32, r8 (0F B6 /r)
-    if (src_is_reg8) {
-        agregar_byte(0x0F);
-        agregar_byte(0xB6);
-        uint8_t modrm = generar_modrm(0b11, dest_code, src_code8);
-        agregar_byte(modrm);
-        return;
-    }
-
-    // 2. MOVZX r32, m8 (0F B6 /r) - Maneja [DISCOS]
-    // Ya que limpiamos 'BYTE', src_str ahora solo debe ser '[DISCOS]'
-    { 
-        agregar_byte(0x0F);
-        agregar_byte(0xB6); // Opcode 0F B6 para 8->32
-        
-        uint8_t modrm_byte;
-        
-        // Intentar Memoria Simple [DISCOS]
-        // ModR/M para [ETIQUETA] usa MOD=00, R/M=101, REG=dest_code
-        if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) return; 
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para MOVZX: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_xchg(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para XCHG." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0, src_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    bool src_is_reg  = obtener_reg32(src_str, src_code);
-
-    if (dest_is_reg && src_is_reg) {
-        // XCHG r/m32, r32 -> 87 /r
-        agregar_byte(0x87);
-        uint8_t modrm = generar_modrm(0b11, src_code, dest_code);
-        agregar_byte(modrm);
-        return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para XCHG: " << operandos << endl;
-}
-
-void EnsambladorIA32::procesar_lea(const string& operandos) {
-    string dest_str, src_str;
-    if (!separar_operandos(operandos, dest_str, src_str)) {
-        cerr << "Error de sintaxis: se esperaban 2 operandos para LEA." << endl;
-        return;
-    }
-
-    uint8_t dest_code=0;
-    bool dest_is_reg = obtener_reg32(dest_str, dest_code);
-    if (!dest_is_reg) {
-        cerr << "Error: LEA solo soporta destino registro de 32 bits." << endl;
-        return;
-    }
-
-    // LEA r32, m -> 8D /r
-    agregar_byte(0x8D);
-    uint8_t modrm_byte;
-    if (procesar_mem_sib(src_str, modrm_byte, dest_code, false)) {
-        return;
-    }
-    if (procesar_mem_disp(src_str, modrm_byte, dest_code, false)) {
-        return;
-    }
-    if (procesar_mem_simple(src_str, modrm_byte, dest_code, false)) {
-    return;
-    }
-
-    cerr << "Error de sintaxis o modo no soportado para LEA: " << operandos << endl;
-}
-
-// -----------------------------------------------------------------------------
-// Resolución de referencias pendientes
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::resolver_referencias_pendientes() {
-    for (auto& par : referencias_pendientes) {
-        const string& etiqueta = par.first;
-        auto& lista_refs = par.second;
-
-        if (!tabla_simbolos.count(etiqueta)) {
-            cerr << "Advertencia: Etiqueta no definida '" << etiqueta
-                 << "'. Referencia no resuelta." << endl;
-            continue;
-        }
-
-        int destino = tabla_simbolos[etiqueta];
-
-        for (auto& ref : lista_refs) {
-            int pos = ref.posicion;
-            uint32_t valor_a_parchear = 0;
-
-            if (ref.tipo_salto == 0) {
-                // Referencia absoluta → dirección real de la etiqueta
-                valor_a_parchear = static_cast<uint32_t>(destino);
-            } else {
-                // Relativo → destino - (posición del siguiente byte)
-                int offset = destino - (pos + ref.tamano_inmediato);
-                valor_a_parchear = static_cast<uint32_t>(offset);
-            }
-
-            if (ref.tamano_inmediato == 4) {
-                codigo_hex[pos]     = static_cast<uint8_t>(valor_a_parchear & 0xFF);
-                codigo_hex[pos + 1] = static_cast<uint8_t>((valor_a_parchear >> 8) & 0xFF);
-                codigo_hex[pos + 2] = static_cast<uint8_t>((valor_a_parchear >> 16) & 0xFF);
-                codigo_hex[pos + 3] = static_cast<uint8_t>((valor_a_parchear >> 24) & 0xFF);
-            } else if (ref.tamano_inmediato == 1) {
-                codigo_hex[pos] = static_cast<uint8_t>(valor_a_parchear & 0xFF);
-            }
-        }
-    }
-}
-
-// -----------------------------------------------------------------------------
-// Ensamblado y generación de archivos
-// -----------------------------------------------------------------------------
-
-void EnsambladorIA32::ensamblar(const string& archivo_entrada) {
-    // 1) Leer el archivo SOLO UNA VEZ
-    leer_fuente(archivo_entrada);
-    if (lineas_fuente.empty()) {
-        cerr << "No se leyo ninguna linea de " << archivo_entrada << endl;
-        return;
-    }
-
-    // -----------------------------------------------------------------
-    // PASADA 1: solo construir tabla de símbolos y contar bytes
-    // -----------------------------------------------------------------
-    cout << "=== PASADA 1: construyendo tabla de simbolos ===\n";
-
-    primera_pasada      = true;
-    contador_posicion   = 0;
-    tabla_simbolos.clear();
-    referencias_pendientes.clear();
-    codigo_hex.clear();          
-
-    for (auto linea : lineas_fuente) {
-        procesar_linea(linea);
-    }
-
-    cout << "Fin PASADA 1. Bytes contados = " << contador_posicion << "\n";
-    cout << "Simbolos encontrados:\n";
-    for (const auto& par : tabla_simbolos) {
-        cout << "  " << par.first << " -> " << par.second << "\n";
-    }
-
-    // -----------------------------------------------------------------
-    // PASADA 2: generar el código máquina real
-    // -----------------------------------------------------------------
-    cout << "=== PASADA 2: generando codigo maquina ===\n";
-
-    primera_pasada      = false;
-    contador_posicion   = 0;
-    // NOTA: NO limpiamos referencias_pendientes: las referencias detectadas
-    // en la primera pasada deben conservarse para ser resueltas tras generar bytes.
-    // referencias_pendientes.clear(); // <-- Eliminado intencionalmente
-    codigo_hex.clear();
-
-    for (auto linea : lineas_fuente) {
-        procesar_linea(linea);
-    }
-
-    // Después de generar los bytes en segunda pasada, resolvemos las referencias
-    cout << "Resolviendo referencias pendientes...\n";
-    resolver_referencias_pendientes();
-
-    cout << "Fin PASADA 2. Bytes generados = " << contador_posicion << "\n";
-}
-
-void EnsambladorIA32::generar_hex(const string& archivo_salida) {
-    ofstream f(archivo_salida);
-    if (!f.is_open()) {
-        cerr << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
-        return;
-    }
-
-    f << hex << uppercase << setfill('0');
-    const size_t BYTES_POR_LINEA = 16;
-    for (size_t i = 0; i < codigo_hex.size(); ++i) {
-        f << setw(2) << static_cast<int>(codigo_hex[i]) << ' ';
-        if ((i + 1) % BYTES_POR_LINEA == 0) {
-            f << '\n';
-        }
-    }
-    if (codigo_hex.size() % BYTES_POR_LINEA != 0) {
-        f << '\n';
-    }
-
-    f.close();
-}
-
-void EnsambladorIA32::generar_reportes() {
-    ofstream sym("simbolos.txt");
-    sym << "Tabla de Simbolos:\n";
-    for (const auto& par : tabla_simbolos) {
-        sym << par.first << " -> " << par.second << '\n';
-    }
-    sym.close();
-
-    ofstream refs("referencias.txt");
-    refs << "Tabla de Referencias Pendientes:\n";
-    for (const auto& par : referencias_pendientes) {
-        const string& etiqueta = par.first;
-        const auto& lista = par.second;
-        for (const auto& ref : lista) {
-            refs << "Etiqueta: " << etiqueta
-                << ", Posicion: " << ref.posicion
-                << ", Tamano: " << ref.tamano_inmediato
-                << ", Tipo: " << (ref.tipo_salto == 0 ? "ABSOLUTO" : "RELATIVO")
-                << '\n';
-        }
-    }
-    refs.close();
-}
-
-// -----------------------------------------------------------------------------
-// main de prueba
-// -----------------------------------------------------------------------------
-
-int main() {
-    EnsambladorIA32 ensamblador;
-
-    cout << "Iniciando ensamblado en DOS pasadas (leyendo programa.asm)...\n";
-    ensamblador.ensamblar("programa.asm");   //
-
-    cout << "Generando programa.hex, simbolos.txt y referencias.txt...\n";
-    ensamblador.generar_hex("programa.hex");
-    ensamblador.generar_reportes();
-
-    cout << "Proceso finalizado correctamente. Revisa los archivos generados.\n";
-    return 0;
-}
-
-
-
-
-
-
-
-
+#include "EnsambladorIA32.hpp"
+
+#include <memory>
+
+#include "Paralelo.hpp"
+#include "EnsambladoConstante.hpp"   // sus static_assert comprueban el núcleo compartido al compilar
+#include <cstdint>
+#include <iostream>
+#include <iomanip>
+
+#include <elf.h>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Inicialización
+// -----------------------------------------------------------------------------
+
+//Se inicializa bandera para dos pasadas
+EnsambladorIA32::EnsambladorIA32() : contador_posicion(0), seccion_actual(SEC_TEXT),
+                                     primera_pasada(true), una_pasada(false),
+                                     detallado(true), con_estadisticas(false), tamano_minimo(false),
+                                     alineacion_bucles(0), bucles_alineados(0), hilos(1), errores(0), salida_errores(&cerr) {
+    secciones[SEC_TEXT].nombre = ".text";
+    secciones[SEC_DATA].nombre = ".data";
+    secciones[SEC_BSS].nombre  = ".bss";
+}
+
+void EnsambladorIA32::fijar_base(IdSeccion seccion, uint32_t base) {
+    secciones[seccion].base      = base;
+    secciones[seccion].base_fija = true;
+}
+
+void EnsambladorIA32::usar_hilos(unsigned n) {
+    hilos = (n == 0) ? hilos_disponibles() : n;
+}
+
+//Nueva función para dos pasadas: el archivo se mapea UNA vez y ambas
+//pasadas recorren vistas a ese mapeo
+bool EnsambladorIA32::leer_fuente(const string& archivo) {
+    if (!fuente.abrir(archivo)) {
+        *salida_errores << "No se pudo abrir el archivo: " << archivo << endl;
+        return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Utilidades
+// -----------------------------------------------------------------------------
+
+// Texto original que cubren los tokens [tokens, tokens + n)
+static string_view abarcar(const Token* tokens, size_t n) {
+    if (n == 0) return string_view();
+    const char* inicio = tokens[0].texto.data();
+    const char* fin    = tokens[n - 1].texto.data() + tokens[n - 1].texto.size();
+    return string_view(inicio, static_cast<size_t>(fin - inicio));
+}
+
+static bool es_palabra(const Token& t, string_view palabra) {
+    return t.tipo == T_IDENT && iguales_sin_mayusculas(t.texto, palabra);
+}
+
+static uint32_t leer_le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void escribir_le32(uint8_t* p, uint32_t valor) {
+    p[0] = static_cast<uint8_t>(valor & 0xFF);
+    p[1] = static_cast<uint8_t>((valor >> 8) & 0xFF);
+    p[2] = static_cast<uint8_t>((valor >> 16) & 0xFF);
+    p[3] = static_cast<uint8_t>((valor >> 24) & 0xFF);
+}
+
+// Identificadores de evaluar_expresion(): valor_simbolo()
+struct EnsambladorIA32::ResolverExpresion {
+    EnsambladorIA32& ens;
+    const char* simbolo(string_view nombre, ValorExpresion& v) { return ens.valor_simbolo(nombre, v); }
+    const char* diferir(TipoToken op, const ValorExpresion& a, const ValorExpresion& b, ValorExpresion& r) {
+        return ens.diferir(op, a, b, r);
+    }
+};
+
+// Las etiquetas no distinguen mayúsculas. Cada nombre distinto recibe un id
+// denso que es lo que guarda la IR; tabla_simbolos crece a la par.
+uint32_t EnsambladorIA32::id_simbolo(string_view texto) {
+    uint32_t id = simbolos.internar(texto);
+    if (id == tabla_simbolos.size()) {
+        tabla_simbolos.push_back(SIN_DIRECCION);
+        seccion_simbolo.push_back(SEC_TEXT);
+        ambito_simbolo.push_back(AMBITO_LOCAL);
+        equ_simbolo.push_back(SIN_EQU);
+    }
+    return id;
+}
+
+void EnsambladorIA32::agregar_dword(uint32_t dword) {
+    agregar_byte(static_cast<uint8_t>(dword & 0xFF));
+    agregar_byte(static_cast<uint8_t>((dword >> 8) & 0xFF));
+    agregar_byte(static_cast<uint8_t>((dword >> 16) & 0xFF));
+    agregar_byte(static_cast<uint8_t>((dword >> 24) & 0xFF));
+}
+
+void EnsambladorIA32::agregar_byte(uint8_t byte) {
+    // Solo en la segunda pasada guardamos el byte real (o siempre, en una pasada).
+    // En la PASADA 2 la sección ya tiene su tamaño final y se escribe en su lugar
+    if (emite_bytes()) {
+        if (destino[seccion_actual] != nullptr) destino[seccion_actual][contador_posicion] = byte;
+        else secciones[seccion_actual].bytes.push_back(byte);
+    }
+
+    // Siempre avanzamos el contador de posición
+    contador_posicion += 1;
+}
+
+void EnsambladorIA32::agregar_nops(uint32_t bytes) {
+    while (bytes > 0) {
+        const uint32_t n = min<uint32_t>(bytes, MAX_NOP);
+        for (uint32_t k = 0; k < n; ++k) agregar_byte(NOPS_LARGOS[n - 1][k]);
+        bytes -= n;
+    }
+}
+
+void EnsambladorIA32::procesar_etiqueta(uint32_t simbolo) {
+    // En DOS PASADAS: solo llenar tabla en la primera
+    if (primera_pasada) {
+        tabla_simbolos[simbolo]  = contador_posicion;
+        seccion_simbolo[simbolo] = seccion_actual;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Procesamiento de líneas (PASADA 1: texto -> IR)
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::procesar_linea(string_view linea) {
+    if (!tokenizar_linea(linea, linea_lexica)) {
+        ++errores;
+        *salida_errores << "Error: linea con demasiados tokens (max " << MAX_TOKENS_LINEA << "): "
+             << linea << endl;
+        return;
+    }
+
+    const Token* t = linea_lexica.tokens;
+    size_t n = linea_lexica.num_tokens;
+    if (n == 0) return;
+    simbolo_dolar = SIN_SIMBOLO;
+    ocultos_linea = 0;
+
+    // "NOMBRE EQU valor" (o "NOMBRE: EQU valor"): NOMBRE no es una etiqueta
+    if (n >= 2 && t[0].tipo == T_IDENT) {
+        const size_t k = (t[1].tipo == T_DOS_PUNTOS) ? 2 : 1;
+        if (k < n && es_palabra(t[k], "EQU")) {
+            procesar_equ(t[0], t + k + 1, n - k - 1);
+            return;
+        }
+    }
+
+    // "ETIQUETA:" (opcionalmente seguida de una instrucción)
+    if (n >= 2 && t[0].tipo == T_IDENT && t[1].tipo == T_DOS_PUNTOS) {
+        InstruccionIR ir{};
+        ir.tipo     = IR_ETIQUETA;
+        ir.valor[0] = id_simbolo(t[0].texto);
+        agregar_ir(ir);
+        t += 2;
+        n -= 2;
+        if (n == 0) return;
+    }
+
+    procesar_instruccion(t, n);
+}
+
+void EnsambladorIA32::procesar_instruccion(const Token* t, size_t n) {
+    if (t[0].tipo != T_IDENT) {
+        ++errores;
+        *salida_errores << "Error de sintaxis: " << abarcar(t, n) << endl;
+        return;
+    }
+    string_view mnem = t[0].texto;
+
+    // --- MANEJO DE DIRECTIVAS SIN CÓDIGO (SECTION, GLOBAL, ALIGN) ---
+    if (es_palabra(t[0], "GLOBAL")) {
+        procesar_ambito(AMBITO_GLOBAL, t + 1, n - 1);
+        return;
+    }
+    if (es_palabra(t[0], "EXTERN")) {
+        procesar_ambito(AMBITO_EXTERNO, t + 1, n - 1);
+        return;
+    }
+    if (es_palabra(t[0], "SECTION") || es_palabra(t[0], "SEGMENT")) {
+        procesar_seccion(t + 1, n - 1);
+        return;
+    }
+    if (es_palabra(t[0], "ALIGN")) {
+        procesar_alineacion(t + 1, n - 1);
+        return;
+    }
+    if (es_palabra(t[0], "BITS")) {
+        // Ignoramos las directivas de NASM (EQU ya se trató en procesar_linea).
+        return;
+    }
+
+    // --- 2. INSTRUCCIONES IA-32 (TABLA_OPCODES, búsqueda por hash perfecto) ---
+    size_t num_filas = 0;
+    const FilaOpcode* filas = buscar_filas_opcode(mnem, num_filas);
+    if (filas != nullptr) {
+        if (seccion_actual == SEC_BSS) {
+            ++errores;
+            *salida_errores << "Error: instruccion en .bss: " << abarcar(t, n) << endl;
+            return;
+        }
+        ensamblar_con_tabla(mnem, filas, num_filas, t + 1, n - 1);
+        return;
+    }
+
+    // --- 3. DATOS: "ETIQUETA DD ..." o solo "DD ..." (igual con RESB/RESW/RESD) ---
+    size_t i = 0;
+    if (n >= 2 && (es_palabra(t[1], "DD")   || es_palabra(t[1], "DB") ||
+                   es_palabra(t[1], "RESB") || es_palabra(t[1], "RESW") ||
+                   es_palabra(t[1], "RESD"))) {
+        InstruccionIR ir{};
+        ir.tipo     = IR_ETIQUETA;
+        ir.valor[0] = id_simbolo(mnem);
+        agregar_ir(ir);
+        i = 1;
+    }
+    if (es_palabra(t[i], "DD")) {
+        procesar_datos(4, t + i + 1, n - i - 1);
+        return;
+    }
+    if (es_palabra(t[i], "DB")) {
+        procesar_datos(1, t + i + 1, n - i - 1);
+        return;
+    }
+    if (es_palabra(t[i], "RESB")) {
+        procesar_reserva(1, t + i + 1, n - i - 1);
+        return;
+    }
+    if (es_palabra(t[i], "RESW")) {
+        procesar_reserva(2, t + i + 1, n - i - 1);
+        return;
+    }
+    if (es_palabra(t[i], "RESD")) {
+        procesar_reserva(4, t + i + 1, n - i - 1);
+        return;
+    }
+
+    // Si falla todo, es una instrucción o directiva realmente no soportada.
+    ++errores;
+    *salida_errores << "Advertencia: Mnemónico o directiva no soportada: " << mnem << endl;
+}
+
+// Lista de valores separados por comas: "5, 2, -8, 0FFh, 'A', N*4"
+void EnsambladorIA32::procesar_datos(int tamano, const Token* t, size_t n) {
+    InstruccionIR ir{};
+    ir.tipo     = IR_DATOS;
+    ir.reg[0]   = static_cast<uint8_t>(tamano);
+    ir.valor[0] = static_cast<uint32_t>(datos_ir.size());
+
+    size_t i = 0;
+    while (i < n) {
+        size_t fin = i;
+        while (fin < n && t[fin].tipo != T_COMA) ++fin;
+
+        if (fin > i) {
+            uint32_t val = 0;
+            size_t k = i;
+            bool negativo = (t[k].tipo == T_MENOS);
+            if (negativo) ++k;
+
+            if (k + 1 == fin && t[k].tipo == T_NUMERO) {
+                val = negativo ? (0u - t[k].valor) : t[k].valor;
+            } else {
+                evaluar_constante(t + i, fin - i, val, tamano == 4 ? "DD" : "DB");
+            }
+            datos_ir.push_back(val);
+        }
+        i = fin + 1;
+    }
+
+    ir.valor[1] = static_cast<uint32_t>(datos_ir.size()) - ir.valor[0];
+
+    // En .bss no hay bytes que inicializar: queda como reserva del mismo tamaño
+    if (seccion_actual == SEC_BSS) {
+        *salida_errores << "Advertencia: datos inicializados en .bss (se reserva espacio en ceros): "
+             << abarcar(t, n) << endl;
+        datos_ir.resize(ir.valor[0]);
+        ir.tipo     = IR_RESERVA;
+        ir.valor[0] = ir.valor[1] * static_cast<uint32_t>(tamano);
+        ir.valor[1] = 0;
+    }
+    agregar_ir(ir);
+}
+
+// "RESB 64" / "tabla RESD 1000" / "RESD N*4": espacio sin inicializar
+void EnsambladorIA32::procesar_reserva(int tamano, const Token* t, size_t n) {
+    const char* directiva = (tamano == 1) ? "RESB" : (tamano == 2) ? "RESW" : "RESD";
+    uint32_t cantidad = 0;
+    if (n == 1 && t[0].tipo == T_NUMERO) {
+        cantidad = t[0].valor;
+    } else if (n == 0) {
+        ++errores;
+        *salida_errores << "Error en " << directiva << ": se esperaba una cantidad: " << abarcar(t, n) << endl;
+        return;
+    } else if (!evaluar_constante(t, n, cantidad, directiva)) {
+        return;
+    }
+    InstruccionIR ir{};
+    ir.tipo     = IR_RESERVA;
+    ir.valor[0] = cantidad * static_cast<uint32_t>(tamano);
+    agregar_ir(ir);
+}
+
+// "ALIGN 16" / "ALIGN 16, NOP": la siguiente entrada empieza en un múltiplo
+// de 16 de su sección. En .text (o con ", NOP") se rellena con NOP de varios
+// bytes, en .data con ceros. El relleno depende de la posición: agregar_ir()
+// lo calcula en la PASADA 1 y relajar_saltos() con la disposición final, y
+// la PASADA 2 emite exactamente el que quedó en la IR
+void EnsambladorIA32::procesar_alineacion(const Token* t, size_t n) {
+    const bool con_nop = n == 3 && t[1].tipo == T_COMA && es_palabra(t[2], "NOP");
+    if ((n != 1 && !con_nop) || t[0].tipo != T_NUMERO) {
+        ++errores;
+        *salida_errores << "Error en ALIGN: se esperaba \"ALIGN n\" o \"ALIGN n, NOP\": " << abarcar(t, n) << endl;
+        return;
+    }
+    const uint32_t alineacion = t[0].valor;
+    if (alineacion == 0 || alineacion > 4096 || (alineacion & (alineacion - 1)) != 0) {
+        ++errores;
+        *salida_errores << "Error en ALIGN: la alineacion debe ser una potencia de 2 hasta 4096: "
+             << abarcar(t, n) << endl;
+        return;
+    }
+    InstruccionIR ir{};
+    ir.tipo     = IR_ALINEACION;
+    ir.valor[0] = alineacion;
+    ir.reg[0]   = (con_nop || seccion_actual == SEC_TEXT) ? RELLENO_NOP : RELLENO_CEROS;
+    agregar_ir(ir);
+}
+
+// "SECTION .data": cada sección conserva su contador entre cambios
+void EnsambladorIA32::procesar_seccion(const Token* t, size_t n) {
+    if (n == 0 || t[0].tipo != T_IDENT) {
+        ++errores;
+        *salida_errores << "Error de sintaxis en SECTION: " << abarcar(t, n) << endl;
+        return;
+    }
+    uint8_t seccion;
+    if (iguales_sin_mayusculas(t[0].texto, ".text") || iguales_sin_mayusculas(t[0].texto, ".code")) {
+        seccion = SEC_TEXT;
+    } else if (iguales_sin_mayusculas(t[0].texto, ".data") || iguales_sin_mayusculas(t[0].texto, ".rodata")) {
+        seccion = SEC_DATA;
+    } else if (iguales_sin_mayusculas(t[0].texto, ".bss")) {
+        seccion = SEC_BSS;
+    } else {
+        *salida_errores << "Advertencia: seccion no soportada: " << t[0].texto << endl;
+        return;
+    }
+
+    InstruccionIR ir{};
+    ir.tipo     = IR_SECCION;
+    ir.valor[0] = seccion;
+    agregar_ir(ir);
+}
+
+// "GLOBAL a, b" / "EXTERN c": solo cambia cómo se exporta el símbolo al ELF.
+// Queda en la IR (sin bytes) para que una sesión sepa qué líneas lo declaran
+void EnsambladorIA32::procesar_ambito(AmbitoSimbolo ambito, const Token* t, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        if (t[i].tipo == T_COMA) continue;
+        if (t[i].tipo != T_IDENT) {
+            ++errores;
+            *salida_errores << "Error de sintaxis en " << (ambito == AMBITO_GLOBAL ? "GLOBAL" : "EXTERN")
+                 << ": " << t[i].texto << endl;
+            return;
+        }
+        InstruccionIR ir{};
+        ir.tipo     = IR_AMBITO;
+        ir.valor[0] = id_simbolo(t[i].texto);
+        ir.reg[0]   = ambito;
+        ambito_simbolo[ir.valor[0]] = ambito;
+        agregar_ir(ir);
+    }
+}
+
+// En la PASADA 1 codificar_ir() solo avanza el contador y registra las
+// referencias; así el tamaño sale del mismo código que emitirá los bytes.
+void EnsambladorIA32::agregar_ir(InstruccionIR& ir) {
+    if (ir.tipo == IR_ETIQUETA) procesar_etiqueta(ir.valor[0]);
+    if (ir.tipo == IR_ALINEACION) {
+        ir.valor[1] = relleno_alineacion(ir, contador_posicion);
+        secciones[seccion_actual].alineacion = max(secciones[seccion_actual].alineacion, ir.valor[0]);
+    }
+
+    int antes = contador_posicion;
+    codificar_ir(ir);
+    if (ir.tipo == IR_INSTRUCCION) ir.tamano = static_cast<uint8_t>(contador_posicion - antes);
+    ir.seccion = seccion_actual;
+    if (con_estadisticas && una_pasada) contar(ir, contador_posicion - antes);
+
+    // En una pasada los bytes ya están emitidos: no hace falta guardar la IR
+    if (!una_pasada) programa_ir.push_back(ir);
+}
+
+// --stats: bytes ya definitivos de una entrada de la IR, por manejador
+void EnsambladorIA32::contar(const InstruccionIR& ir, int bytes) {
+    switch (ir.tipo) {
+        case IR_INSTRUCCION:
+            contadores.por_fila[ir.fila]++;
+            contadores.bytes_instruccion += static_cast<uint64_t>(bytes);
+            break;
+        case IR_DATOS:   contadores.bytes_datos   += static_cast<uint64_t>(bytes); break;
+        case IR_RESERVA: contadores.bytes_reserva += static_cast<uint64_t>(bytes); break;
+        case IR_ALINEACION: contadores.bytes_alineacion += static_cast<uint64_t>(bytes); break;
+        default: break;
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+// Análisis de operandos dirigido por TABLA_OPCODES
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::ensamblar_con_tabla(string_view mnem,
+                                          const FilaOpcode* filas,
+                                          size_t num_filas,
+                                          const Token* t,
+                                          size_t n) {
+    // 1. Separar por comas y clasificar operandos (0, 1 o 2)
+    Operando ops[2];
+    int num_ops = 0;
+    bool ok = true;
+
+    size_t coma = 0;
+    while (coma < n && t[coma].tipo != T_COMA) ++coma;
+
+    if (coma < n) {
+        size_t n_src = n - coma - 1;
+        if (coma == 0 || n_src == 0) {
+            ++errores;
+            *salida_errores << "Error de sintaxis: Se esperaban 2 operandos para " << mnem << endl;
+            return;
+        }
+        ok = clasificar_operando(t, coma, ops[0]) &&
+             clasificar_operando(t + coma + 1, n_src, ops[1]);
+        num_ops = 2;
+    } else if (n > 0) {
+        ok = clasificar_operando(t, n, ops[0]);
+        num_ops = 1;
+    }
+
+    // 2. Primera fila cuya firma coincide con los operandos -> IR
+    if (ok && agregar_instruccion(filas, num_filas, ops, num_ops)) return;
+
+    // Un símbolo sin corchetes es destino de salto ("JMP fin") o imm32
+    // ("MOV EAX, msg"): si ninguna fila acepta uno, se prueba el otro. Una
+    // etiqueta como imm32 es una referencia absoluta más; los EQU y '$' ya
+    // marcaron con_expresiones al definirse o nombrarse
+    if (ok) {
+        bool con_simbolo = false;
+        for (int k = 0; k < num_ops; ++k) {
+            if (ops[k].tipo == OP_ETIQUETA || ops[k].tipo == OP_IMM_SIMBOLO) {
+                ops[k].tipo = (ops[k].tipo == OP_ETIQUETA) ? OP_IMM_SIMBOLO : OP_ETIQUETA;
+                con_simbolo = true;
+            }
+        }
+        if (con_simbolo && agregar_instruccion(filas, num_filas, ops, num_ops)) return;
+    }
+
+    ++errores;
+    *salida_errores << "Error de sintaxis o modo no soportado para " << mnem << ": " << abarcar(t, n) << endl;
+}
+
+// Primera de 'filas' cuya firma coincide con los operandos -> IR. Es el
+// punto común del texto y de ConstructorIA32; false si ninguna coincide
+bool EnsambladorIA32::agregar_instruccion(const FilaOpcode* filas, size_t num_filas,
+                                          const Operando* ops, int num_ops) {
+    const FilaOpcode* fila = elegir_fila(filas, num_filas, ops, num_ops);
+    if (fila == nullptr) return false;
+    InstruccionIR ir = armar_ir(*fila, ops, num_ops);
+
+    // Salto: rel8 solo si el destino ya está definido (hacia atrás) y cabe
+    if (fila->cod == C_SALTO) {
+        uint8_t seccion = 0;
+        int destino = destino_salto(ir.valor[0], seccion);
+        if (destino != SIN_DIRECCION && seccion == seccion_actual) {
+            int offset_short = destino - (contador_posicion + 2); // desde el fin de "op rel8"
+            ir.salto_corto = (offset_short >= -128 && offset_short <= 127);
+            ir.valor[1]    = static_cast<uint32_t>(offset_short);
+        }
+    }
+
+    agregar_ir(ir);
+    return true;
+}
+
+bool EnsambladorIA32::clasificar_operando(const Token* t, size_t n, Operando& op) {
+    op = Operando();
+    op.texto = abarcar(t, n);
+
+    if (n == 1) {
+        switch (t[0].tipo) {
+            case T_REG32:  op.tipo = OP_R32; op.reg = t[0].reg; return true;
+            case T_REG8:   op.tipo = OP_R8;  op.reg = t[0].reg; return true;
+            case T_NUMERO: op.tipo = OP_IMM; op.inmediato = t[0].valor; return true;
+            case T_IDENT: {
+                // Un EQU ya conocido y constante es un inmediato; lo demás, un
+                // símbolo: la etiqueta misma (o '$') o el EQU, que se resuelve
+                // después (destino de salto o imm32, según la fila)
+                ValorExpresion v;
+                valor_simbolo(t[0].texto, v);
+                if (v.es_constante()) {
+                    op.tipo = OP_IMM;
+                    op.inmediato = v.constante;
+                } else {
+                    op.tipo = OP_ETIQUETA;
+                    op.inmediato = v.es_etiqueta() ? v.suma : id_simbolo(t[0].texto);
+                }
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    // Inmediato con signo: "-3", "+3"
+    if (n == 2 && (t[0].tipo == T_MENOS || t[0].tipo == T_MAS) && t[1].tipo == T_NUMERO) {
+        op.tipo = OP_IMM;
+        op.inmediato = (t[0].tipo == T_MENOS) ? (0u - t[1].valor) : t[1].valor;
+        return true;
+    }
+
+    // Pista de tamaño: "BYTE [DISCOS]", "DWORD [N]"
+    if (n > 0 && es_palabra(t[0], "BYTE"))  { op.tam_mem = 1; ++t; --n; }
+    else if (n > 0 && es_palabra(t[0], "DWORD")) { op.tam_mem = 4; ++t; --n; }
+
+    if (n >= 3 && t[0].tipo == T_CORCHETE_ABRE && t[n - 1].tipo == T_CORCHETE_CIERRA) {
+        if (const char* error = analizar_memoria(t + 1, n - 2, op.mem)) {
+            ++errores;
+            *salida_errores << "Error: " << error << ": " << op.texto << endl;
+            return false;
+        }
+        op.tipo = OP_MEM;
+        return true;
+    }
+    if (op.tam_mem != 0 || n == 0) return false;
+
+    // Expresión: "4*2", "(1 << 4) | 3", "msg + 4", "$ - inicio"
+    ResolverExpresion resolver{*this};
+    ValorExpresion v;
+    if (const char* error = evaluar_expresion(t, n, resolver, v)) {
+        ++errores;
+        *salida_errores << "Error en expresion (" << error << "): " << op.texto << endl;
+        return false;
+    }
+    if (v.es_constante()) {
+        op.tipo = OP_IMM;
+        op.inmediato = v.constante;
+    } else {
+        op.tipo = OP_IMM_SIMBOLO;
+        op.inmediato = simbolo_valor(v);   // "msg + 4" es un EQU oculto (con_expresiones)
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Direccionamientos de memoria (tokens entre corchetes -> DireccionIR)
+// -----------------------------------------------------------------------------
+
+// analizar_terminos() y armar_direccion() (CodificacionIA32.hpp). La parte
+// constante del desplazamiento va en disp; las etiquetas, en mem.simbolo
+// (una sola, o un EQU oculto si hay una restada). nullptr o el error
+const char* EnsambladorIA32::analizar_memoria(const Token* t, size_t n, DireccionIR& mem) {
+    TerminosMemoria m;
+    ResolverExpresion resolver{*this};
+    if (const char* error = analizar_terminos(t, n, m, resolver)) return error;
+    ValorExpresion simbolo = m.desplazamiento;
+    const bool con_simbolo = !simbolo.es_constante();
+    if (!armar_direccion(m.regs, m.escalas, m.num_regs, con_simbolo, simbolo.constante, mem)) {
+        return MEMORIA_NO_SOPORTADA;
+    }
+    if (con_simbolo) {
+        simbolo.constante = 0;
+        mem.simbolo = simbolo_valor(simbolo);
+    }
+    return nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// EQU y expresiones
+// -----------------------------------------------------------------------------
+// evaluar_expresion() (ExpresionIA32.hpp) pregunta por cada identificador:
+// un EQU ya definido da su valor y cualquier otro nombre es un símbolo (una
+// etiqueta o un EQU de más abajo). Lo que queda con símbolos se resuelve en
+// dos momentos: plegar_expresiones(), tras la PASADA 1, reduce a constante
+// lo que ya no puede cambiar (EQU constantes, diferencias dentro de un
+// tramo sin instrucciones) y rehace la instrucción con la fila más corta;
+// sustituir_equivalencias(), con la disposición final, cambia cada
+// referencia a un EQU por su valor antes de resolver las referencias. En
+// los dos, calcular_diferidas() evalúa primero las operaciones diferidas
+// ("(fin - tabla) / 4") que ya se pueden.
+
+const char* EnsambladorIA32::valor_simbolo(string_view nombre, ValorExpresion& v) {
+    v = ValorExpresion();
+    if (nombre == "$") {
+        // Una etiqueta oculta en la posición de la línea (la misma para todo '$' de la línea)
+        if (simbolo_dolar == SIN_SIMBOLO) {
+            simbolo_dolar = id_simbolo("$ " + to_string(linea_actual + 1));
+            InstruccionIR ir{};
+            ir.tipo     = IR_ETIQUETA;
+            ir.valor[0] = simbolo_dolar;
+            agregar_ir(ir);
+        }
+        v.suma = simbolo_dolar;
+        con_expresiones = true;
+        return nullptr;
+    }
+    if (nombre == "$$") {
+        v.suma = id_simbolo(string("$$ ") + secciones[seccion_actual].nombre);
+        con_expresiones = true;
+        return nullptr;
+    }
+    const uint32_t id = id_simbolo(nombre);
+    if (equ_simbolo[id] != SIN_EQU) v = equivalencias[equ_simbolo[id]].valor;
+    else                            v.suma = id;
+    return nullptr;
+}
+
+// DD/DB/RESx: el valor tiene que ser constante al leer la línea
+bool EnsambladorIA32::evaluar_constante(const Token* t, size_t n, uint32_t& valor, const char* contexto) {
+    ResolverExpresion resolver{*this};
+    ValorExpresion v;
+    const char* error = evaluar_expresion(t, n, resolver, v);
+    if (error == nullptr && !v.es_constante()) error = "el valor no es una constante conocida";
+    if (error != nullptr) {
+        ++errores;
+        *salida_errores << "Error en " << contexto << ": " << error << ": '" << abarcar(t, n) << "'\n";
+        return false;
+    }
+    valor = v.constante;
+    return true;
+}
+
+// "N EQU 10", "LEN EQU $ - MSG", "FIN EQU BUFFER + 64"
+void EnsambladorIA32::procesar_equ(const Token& nombre, const Token* t, size_t n) {
+    ResolverExpresion resolver{*this};
+    ValorExpresion v;
+    const char* error = (n == 0) ? "falta el valor" : evaluar_expresion(t, n, resolver, v);
+    const uint32_t id = id_simbolo(nombre.texto);
+    if (error == nullptr && equ_simbolo[id] != SIN_EQU) error = "EQU repetido";
+    if (error == nullptr && (v.suma == id || v.resta == id)) error = "EQU circular";
+    if (error != nullptr) {
+        ++errores;
+        *salida_errores << "Error en EQU (" << error << "): " << nombre.texto << " EQU " << abarcar(t, n) << endl;
+        return;
+    }
+    definir_equ(id, v);
+}
+
+void EnsambladorIA32::definir_equ(uint32_t simbolo, const ValorExpresion& valor, bool sembrada) {
+    equ_simbolo[simbolo] = static_cast<uint32_t>(equivalencias.size());
+    equivalencias.push_back(Equivalencia{simbolo, valor, sembrada});
+    con_expresiones = true;
+}
+
+// Un símbolo con el valor de 'v' (que no es constante): la etiqueta misma o
+// un EQU oculto de la línea
+uint32_t EnsambladorIA32::simbolo_valor(const ValorExpresion& v) {
+    if (v.es_etiqueta()) return v.suma;
+    const uint32_t id = id_simbolo("= " + to_string(linea_actual + 1) + " " + to_string(ocultos_linea++));
+    definir_equ(id, v);
+    return id;
+}
+
+// Una operación que espera a la disposición: 'r' pasa a nombrarla
+const char* EnsambladorIA32::diferir(TipoToken op, const ValorExpresion& a, const ValorExpresion& b,
+                                     ValorExpresion& r) {
+    diferidas.push_back(ExpresionDiferida{op, a, b});
+    r = ValorExpresion();
+    r.diferida = static_cast<uint32_t>(diferidas.size() - 1);
+    return nullptr;
+}
+
+// Cambia los EQU de 'v' por sus valores, suma las diferidas ya calculadas
+// y resta dos etiquetas de la misma sección (con 'tramo', solo si además
+// están en el mismo tramo: ver plegar_expresiones()). Puede quedar con
+// etiquetas; una diferida sin calcular es un error (el suyo)
+const char* EnsambladorIA32::reducir_valor(ValorExpresion& v, const uint32_t* tramo) const {
+    auto sumar_diferida = [&](ValorExpresion& x) -> const char* {
+        if (x.diferida == SIN_DIFERIDA) return nullptr;
+        const ExpresionDiferida& d = diferidas[x.diferida];
+        if (!d.calculada) return d.error;
+        x.constante += d.valor;
+        x.diferida = SIN_DIFERIDA;
+        return nullptr;
+    };
+    if (const char* error = sumar_diferida(v)) return error;
+    for (int paso = 0;; ++paso) {
+        const bool suma_equ  = v.suma  != SIN_SIMBOLO && equ_simbolo[v.suma]  != SIN_EQU;
+        const bool resta_equ = v.resta != SIN_SIMBOLO && equ_simbolo[v.resta] != SIN_EQU;
+        if (!suma_equ && !resta_equ) break;
+        if (paso == MAX_ANIDAMIENTO_EQU) return "EQU circular o anidado demasiado";
+        ValorExpresion resto = v;
+        ValorExpresion suma, resta;
+        if (suma_equ) {
+            suma = equivalencias[equ_simbolo[v.suma]].valor;
+            resto.suma = SIN_SIMBOLO;
+            if (const char* error = sumar_diferida(suma)) return error;
+        }
+        if (resta_equ) {
+            resta = equivalencias[equ_simbolo[v.resta]].valor;
+            resto.resta = SIN_SIMBOLO;
+            if (const char* error = sumar_diferida(resta)) return error;
+        }
+        if (const char* error = combinar(resto, suma, false)) return error;
+        if (const char* error = combinar(resto, resta, true)) return error;
+        v = resto;
+    }
+    if (v.es_diferencia() && tabla_simbolos[v.suma] != SIN_DIRECCION && tabla_simbolos[v.resta] != SIN_DIRECCION &&
+        seccion_simbolo[v.suma] == seccion_simbolo[v.resta] &&
+        (tramo == nullptr || tramo[v.suma] == tramo[v.resta])) {
+        v.constante += static_cast<uint32_t>(tabla_simbolos[v.suma] - tabla_simbolos[v.resta]);
+        v.suma  = SIN_SIMBOLO;
+        v.resta = SIN_SIMBOLO;
+    }
+    return nullptr;
+}
+
+// Cada diferida cuyos operandos ya son constantes (ver reducir_valor()).
+// Una diferida puede nombrar por un EQU a otra que está más abajo: se
+// recorre hasta que una vuelta no calcula ninguna más
+void EnsambladorIA32::calcular_diferidas(const uint32_t* tramo) {
+    for (ExpresionDiferida& d : diferidas) {
+        d.calculada = false;
+        d.error     = "EQU circular o anidado demasiado";
+    }
+    for (bool progreso = true; progreso;) {
+        progreso = false;
+        for (ExpresionDiferida& d : diferidas) {
+            if (d.calculada) continue;
+            ValorExpresion a = d.a, b = d.b;
+            const char* error = reducir_valor(a, tramo);
+            if (error == nullptr) error = reducir_valor(b, tramo);
+            if (error == nullptr && (!a.es_constante() || !b.es_constante())) {
+                error = (a.diferible() && b.diferible()) ? "resta de una etiqueta de otra seccion o no definida"
+                                                         : "una etiqueta solo admite + y -";
+            }
+            if (error == nullptr) error = operar_constantes(d.op, a.constante, b.constante, d.valor);
+            if (error != nullptr) {
+                d.error = error;
+                continue;
+            }
+            d.calculada = true;
+            progreso    = true;
+        }
+    }
+}
+
+// '$$' de cada sección que se usó: su posición 0
+void EnsambladorIA32::fijar_inicios_seccion() {
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        const uint32_t id = simbolos.buscar(string("$$ ") + secciones[s].nombre);
+        if (id == InternadorSimbolos::SIN_ID) continue;
+        tabla_simbolos[id]  = 0;
+        seccion_simbolo[id] = static_cast<uint8_t>(s);
+    }
+}
+
+// Tras la PASADA 1 (antes de -Os y de relajar): cada inmediato o [..] que
+// nombra un EQU se reduce con lo que ya es definitivo. Dos etiquetas de la
+// misma sección sin una instrucción ni un ALIGN entre ellas (un "tramo")
+// ya no se mueven entre sí: "LEN EQU $ - MSG" sobre un DB es constante. Si
+// queda una constante, la instrucción se vuelve a armar con la primera
+// fila que la acepta (imm8, disp8) como si el valor se hubiera conocido al
+// leerla; si queda una etiqueta, la referencia va directo a ella
+void EnsambladorIA32::plegar_expresiones() {
+    MarcaArena marca(arena);
+    VectorArena<uint32_t> tramo(tabla_simbolos.size(), 0, AsignadorArena<uint32_t>(arena));
+    uint32_t tramo_seccion[NUM_SECCIONES] = {};
+    int total[NUM_SECCIONES] = {};
+    uint8_t sec = SEC_TEXT;
+    for (const InstruccionIR& ir : programa_ir) {
+        if (ir.tipo == IR_SECCION) sec = static_cast<uint8_t>(ir.valor[0]);
+        if (ir.tipo == IR_INSTRUCCION || ir.tipo == IR_ALINEACION) ++tramo_seccion[sec];
+        if (ir.tipo == IR_ETIQUETA) {
+            // --alinear-bucles puede poner relleno antes de una etiqueta de .text
+            if (alineacion_bucles != 0 && sec == SEC_TEXT) ++tramo_seccion[sec];
+            tabla_simbolos[ir.valor[0]]  = total[sec];
+            seccion_simbolo[ir.valor[0]] = sec;
+            tramo[ir.valor[0]]           = tramo_seccion[sec];
+        }
+        total[sec] += tamano_ir(ir);
+    }
+    fijar_inicios_seccion();   // tramo 0: nada antes en su sección
+
+    calcular_diferidas(tramo.data());
+
+    // EQU -> constante, etiqueta + constante o (si no se puede) el mismo EQU
+    auto plegar = [&](uint32_t simbolo, ValorExpresion& v) {
+        v = ValorExpresion();
+        v.suma = simbolo;
+        if (equ_simbolo[simbolo] == SIN_EQU || reducir_valor(v, tramo.data()) != nullptr) return false;
+        return v.resta == SIN_SIMBOLO;
+    };
+
+    for (InstruccionIR& ir : programa_ir) {
+        if (ir.tipo != IR_INSTRUCCION) continue;
+        bool cambio = false;
+        ValorExpresion v;
+        for (int k = 0; k < 2; ++k) {
+            const bool imm = ir.tipo_op[k] == OP_IMM_SIMBOLO;
+            if ((!imm && ir.tipo_op[k] != OP_ETIQUETA) || !plegar(ir.valor[k], v)) continue;
+            if (v.es_constante() && imm) {
+                ir.tipo_op[k] = OP_IMM;
+                ir.valor[k]   = v.constante;
+                cambio = true;
+            } else if (v.suma != SIN_SIMBOLO && v.constante == 0) {
+                ir.valor[k] = v.suma;   // mismo tamaño: solo cambia el destino
+            }
+        }
+        DireccionIR& mem = ir.mem;
+        if (mem.simbolo != SIN_SIMBOLO && plegar(mem.simbolo, v)) {
+            mem.disp    = static_cast<int32_t>(static_cast<uint32_t>(mem.disp) + v.constante);
+            mem.simbolo = v.suma;
+            // Sin etiqueta, armar_direccion() habría evitado EBP como base sin disp
+            if (v.suma == SIN_SIMBOLO && mem.disp == 0 && mem.base == 0b101 && mem.indice != SIN_REG &&
+                mem.indice != 0b100 && mem.escala == 1) {
+                intercambiar(mem.base, mem.indice);
+            }
+            cambio = cambio || v.suma == SIN_SIMBOLO;
+        }
+        if (!cambio) continue;
+
+        const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+        Operando ops[2];
+        const int num_ops = operandos_ir(ir, (fila.op0 == P_M8 || fila.op1 == P_M8) ? 1 : 4, ops);
+        size_t num_filas = 0;
+        const FilaOpcode* filas = buscar_filas_opcode(fila.mnem, num_filas);
+        const FilaOpcode* nueva = elegir_fila(filas, num_filas, ops, num_ops);
+        if (nueva == nullptr) continue;   // la fila de siempre (imm32) sigue sirviendo
+        InstruccionIR armada = armar_ir(*nueva, ops, num_ops);
+        armada.seccion = ir.seccion;
+        armada.tamano  = static_cast<uint8_t>(medir_ir(armada));
+        secciones[ir.seccion].contador += armada.tamano - ir.tamano;
+        ir = armada;
+    }
+}
+
+// Con la disposición final (tras la PASADA 2, o la única): cada referencia a
+// un EQU pasa a ser su etiqueta, con la constante sumada en el hueco, o
+// desaparece si el valor es una constante
+void EnsambladorIA32::sustituir_equivalencias() {
+    if (equivalencias.empty()) return;
+    calcular_diferidas(nullptr);
+    for (const Equivalencia& e : equivalencias) {
+        if (tabla_simbolos[e.simbolo] == SIN_DIRECCION) continue;
+        ++errores;
+        *salida_errores << "Error: '" << simbolos.nombre(e.simbolo) << "' es a la vez EQU y etiqueta" << endl;
+    }
+
+    MarcaArena marca(arena);
+    VectorArena<uint8_t> avisado(tabla_simbolos.size(), 0, AsignadorArena<uint8_t>(arena));   // un error por EQU
+    size_t quedan = 0;
+    for (size_t i = 0; i < referencias_pendientes.size(); ++i) {
+        ReferenciaPendiente ref = referencias_pendientes[i];
+        if (equ_simbolo[ref.simbolo] == SIN_EQU) {
+            referencias_pendientes[quedan++] = ref;
+            continue;
+        }
+        ValorExpresion v;
+        v.suma = ref.simbolo;
+        const char* error = reducir_valor(v, nullptr);
+        if (error == nullptr && v.resta != SIN_SIMBOLO) error = "resta de una etiqueta de otra seccion o no definida";
+        if (error == nullptr && v.es_constante() && ref.tipo_salto != 0) error = "salto a una constante";
+        if (error != nullptr) {
+            if (avisado[ref.simbolo]) continue;
+            avisado[ref.simbolo] = 1;
+            ++errores;
+            const string_view nombre = simbolos.nombre(ref.simbolo);
+            if (simbolo_interno(ref.simbolo)) {
+                *salida_errores << "Error en la expresion de la linea "
+                     << nombre.substr(2, nombre.find(' ', 2) - 2) << ": " << error << endl;
+            } else {
+                *salida_errores << "Error en EQU '" << nombre << "': " << error << endl;
+            }
+            continue;
+        }
+
+        uint8_t* hueco = secciones[ref.seccion].bytes.data() + ref.posicion;
+        if (ref.tamano_inmediato == 4) escribir_le32(hueco, leer_le32(hueco) + v.constante);
+        else                           hueco[0] = static_cast<uint8_t>(hueco[0] + v.constante);
+        if (v.es_constante()) continue;   // el hueco ya tiene el valor
+        ref.simbolo = v.suma;
+        referencias_pendientes[quedan++] = ref;
+    }
+    referencias_pendientes.resize(quedan);
+}
+
+// 'v' de otro ensamblador: sus símbolos pasan por 'id' y sus diferidas por
+// 'diferida' (ya copiadas a las de este)
+template <typename Id, typename Diferida>
+static ValorExpresion trasladar_valor(ValorExpresion v, Id id, Diferida diferida) {
+    if (v.suma     != SIN_SIMBOLO)  v.suma     = id(v.suma);
+    if (v.resta    != SIN_SIMBOLO)  v.resta    = id(v.resta);
+    if (v.diferida != SIN_DIFERIDA) v.diferida = diferida(v.diferida);
+    return v;
+}
+
+// Trabajador de la PASADA 1: los EQU (con nombre) de un bloque anterior,
+// como si sus líneas se hubieran leído antes. De sus diferidas se copian
+// solo las que esos EQU alcanzan (cada una nombra otras anteriores a ella)
+void EnsambladorIA32::sembrar_equivalencias(const EnsambladorIA32& anterior) {
+    auto sembrable = [&](const Equivalencia& e) { return !e.sembrada && !anterior.simbolo_interno(e.simbolo); };
+    auto id = [&](uint32_t simbolo) { return id_simbolo(anterior.simbolos.nombre(simbolo)); };
+
+    MarcaArena marca(arena);
+    VectorArena<uint32_t> copia(anterior.diferidas.size(), SIN_DIFERIDA, AsignadorArena<uint32_t>(arena));
+    auto traducir = [&](uint32_t d) { return copia[d]; };
+    if (!anterior.diferidas.empty()) {
+        const uint32_t USADA = 0;   // marca antes de copiar
+        for (const Equivalencia& e : anterior.equivalencias) {
+            if (sembrable(e) && e.valor.diferida != SIN_DIFERIDA) copia[e.valor.diferida] = USADA;
+        }
+        for (size_t d = anterior.diferidas.size(); d-- > 0;) {
+            if (copia[d] == SIN_DIFERIDA) continue;
+            for (const ValorExpresion* x : {&anterior.diferidas[d].a, &anterior.diferidas[d].b}) {
+                if (x->diferida != SIN_DIFERIDA) copia[x->diferida] = USADA;
+            }
+        }
+        for (size_t d = 0; d < anterior.diferidas.size(); ++d) {
+            if (copia[d] == SIN_DIFERIDA) continue;
+            const ExpresionDiferida& origen = anterior.diferidas[d];
+            diferidas.push_back(ExpresionDiferida{origen.op, trasladar_valor(origen.a, id, traducir),
+                                                  trasladar_valor(origen.b, id, traducir)});
+            copia[d] = static_cast<uint32_t>(diferidas.size() - 1);
+        }
+    }
+
+    for (const Equivalencia& e : anterior.equivalencias) {
+        if (!sembrable(e)) continue;
+        const uint32_t simbolo = id(e.simbolo);
+        if (equ_simbolo[simbolo] != SIN_EQU) continue;
+        definir_equ(simbolo, trasladar_valor(e.valor, id, traducir), true);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Codificación IR -> bytes
+// -----------------------------------------------------------------------------
+
+// Emisor de codificar_instruccion(): la sección actual, con el contador de
+// posición y las referencias de siempre
+struct EnsambladorIA32::EmisorSeccion {
+    EnsambladorIA32& ens;
+    void byte(uint8_t b) { ens.agregar_byte(b); }
+    void dword(uint32_t d) { ens.agregar_dword(d); }
+    void referencia(uint32_t simbolo, int tamano, int tipo_salto) {
+        ens.registrar_referencia(simbolo, tamano, tipo_salto);
+    }
+};
+
+void EnsambladorIA32::codificar_ir(const InstruccionIR& ir) {
+    if (ir.tipo == IR_ETIQUETA || ir.tipo == IR_AMBITO) return;
+
+    if (ir.tipo == IR_SECCION) {
+        cambiar_seccion(static_cast<uint8_t>(ir.valor[0]));
+        return;
+    }
+
+    if (ir.tipo == IR_RESERVA) {
+        // En .bss solo avanza el contador; en otra sección se rellena con ceros
+        if (seccion_actual == SEC_BSS) {
+            contador_posicion += static_cast<int>(ir.valor[0]);
+        } else {
+            for (uint32_t k = 0; k < ir.valor[0]; ++k) agregar_byte(0);
+        }
+        return;
+    }
+
+    if (ir.tipo == IR_ALINEACION) {
+        if (seccion_actual == SEC_BSS) {
+            contador_posicion += static_cast<int>(ir.valor[1]);
+        } else if (ir.reg[0] == RELLENO_NOP) {
+            agregar_nops(ir.valor[1]);
+        } else {
+            for (uint32_t k = 0; k < ir.valor[1]; ++k) agregar_byte(0);
+        }
+        return;
+    }
+
+    if (ir.tipo == IR_DATOS) {
+        const vector<uint32_t>& datos = (datos_codificar != nullptr) ? *datos_codificar : datos_ir;
+        for (uint32_t k = 0; k < ir.valor[1]; ++k) {
+            uint32_t val = datos[ir.valor[0] + k];
+            if (ir.reg[0] == 4) agregar_dword(val);
+            else                agregar_byte(static_cast<uint8_t>(val & 0xFF));
+        }
+        return;
+    }
+
+    EmisorSeccion emisor{*this};
+    codificar_instruccion(emisor, ir);
+}
+
+void EnsambladorIA32::registrar_referencia(uint32_t simbolo, int tamano, int tipo_salto) {
+    // Solo en la pasada que emite bytes: la relajación puede mover las
+    // posiciones de la PASADA 1. La posición es el primer byte del campo a parchear
+    if (emite_bytes()) {
+        ReferenciaPendiente ref;
+        ref.simbolo          = simbolo;
+        ref.seccion          = seccion_actual;
+        ref.posicion         = contador_posicion;
+        ref.tamano_inmediato = tamano;
+        ref.tipo_salto       = tipo_salto;
+        referencias_pendientes.push_back(ref);
+    }
+}
+
+
+// -----------------------------------------------------------------------------
+// Saltos
+// -----------------------------------------------------------------------------
+
+// Dirección del destino de un salto con la disposición de tabla_simbolos:
+// la de la etiqueta, o la de etiqueta + constante si es un EQU que se reduce
+// a eso ("JMP _start + 1", "JMP $ + 2"). SIN_DIRECCION si aún no se conoce
+int EnsambladorIA32::destino_salto(uint32_t simbolo, uint8_t& seccion) const {
+    ValorExpresion v;
+    v.suma = simbolo;
+    if (equ_simbolo[simbolo] != SIN_EQU &&
+        (reducir_valor(v, nullptr) != nullptr || v.suma == SIN_SIMBOLO || v.resta != SIN_SIMBOLO ||
+         v.diferida != SIN_DIFERIDA)) {
+        return SIN_DIRECCION;
+    }
+    if (tabla_simbolos[v.suma] == SIN_DIRECCION) return SIN_DIRECCION;
+    seccion = seccion_simbolo[v.suma];
+    return tabla_simbolos[v.suma] + static_cast<int32_t>(v.constante);
+}
+
+// Relajación iterativa: todo JMP/Jcc empieza en rel8, se recalcula la
+// disposición y solo crecen a rel32 los saltos cuyo desplazamiento no cabe.
+// Como un salto nunca vuelve a encogerse, el proceso siempre converge.
+// Un destino etiqueta + constante es un EQU (oculto si se escribió en la
+// línea): destino_salto() lo reduce con la disposición de cada vuelta
+void EnsambladorIA32::relajar_saltos() {
+    relajacion = EstadisticasRelajacion();
+    const int bytes_antes = total_bytes();
+    int cortos_antes = 0;   // rel8 ya decididos en la PASADA 1 (hacia atrás)
+    bool destinos_equ = false;
+
+    for (InstruccionIR& ir : programa_ir) {
+        if (ir.tipo != IR_INSTRUCCION || TABLA_OPCODES[ir.fila].cod != C_SALTO) continue;
+        const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+        ++relajacion.saltos;
+        if (ir.salto_corto) ++cortos_antes;
+        ir.salto_corto = 1;
+        ir.tamano = tamano_salto(fila, true);
+        destinos_equ = destinos_equ || equ_simbolo[ir.valor[0]] != SIN_EQU;
+    }
+
+    bool cambio = true;
+    int total[NUM_SECCIONES] = {};
+    while (cambio) {
+        cambio = false;
+        ++relajacion.iteraciones;
+
+        // Direcciones de las etiquetas con los tamaños actuales (por sección);
+        // el relleno de cada ALIGN sale de la posición en esta disposición
+        uint8_t sec = SEC_TEXT;
+        for (int& t : total) t = 0;
+        for (InstruccionIR& ir : programa_ir) {
+            if (ir.tipo == IR_SECCION) sec = static_cast<uint8_t>(ir.valor[0]);
+            if (ir.tipo == IR_ALINEACION) {
+                ir.valor[1] = relleno_alineacion(ir, total[sec]);
+                secciones[sec].alineacion = max(secciones[sec].alineacion, ir.valor[0]);
+            }
+            if (ir.tipo == IR_ETIQUETA) {
+                tabla_simbolos[ir.valor[0]]  = total[sec];
+                seccion_simbolo[ir.valor[0]] = sec;
+            }
+            total[sec] += tamano_ir(ir);
+        }
+        if (destinos_equ) calcular_diferidas(nullptr);   // "JMP a + (c - b) / 2"
+
+        // Crecer los saltos cortos que no alcanzan (o cuyo destino no existe
+        // o está en otra sección).
+        // pos avanza con los tamaños de esta iteración, igual que las etiquetas
+        int pos[NUM_SECCIONES] = {};
+        sec = SEC_TEXT;
+        for (InstruccionIR& ir : programa_ir) {
+            if (ir.tipo == IR_SECCION) sec = static_cast<uint8_t>(ir.valor[0]);
+            const int tamano = tamano_ir(ir);
+            if (ir.tipo == IR_INSTRUCCION && ir.salto_corto &&
+                TABLA_OPCODES[ir.fila].cod == C_SALTO) {
+                uint8_t seccion = 0;
+                int destino = destino_salto(ir.valor[0], seccion);
+                int offset  = destino - (pos[sec] + 2);
+                if (destino == SIN_DIRECCION || seccion != sec ||
+                    offset < -128 || offset > 127) {
+                    ir.salto_corto = 0;
+                    ir.tamano = tamano_salto(TABLA_OPCODES[ir.fila], false);
+                    cambio = true;
+                } else {
+                    ir.valor[1] = static_cast<uint32_t>(offset);   // válido si ya no hay cambios
+                }
+            }
+            pos[sec] += tamano;
+        }
+    }
+
+    for (const InstruccionIR& ir : programa_ir) {
+        if (ir.tipo == IR_INSTRUCCION && TABLA_OPCODES[ir.fila].cod == C_SALTO && ir.salto_corto)
+            ++relajacion.cortos;
+    }
+
+    // tabla_simbolos ya quedó con la disposición final
+    for (int s = 0; s < NUM_SECCIONES; ++s) secciones[s].contador = total[s];
+    contador_posicion = total[seccion_actual];
+    relajacion.acortados       = relajacion.cortos - cortos_antes;
+    relajacion.bytes_ahorrados = bytes_antes - total_bytes();
+}
+
+// -----------------------------------------------------------------------------
+// Alineación de bucles (--alinear-bucles)
+// -----------------------------------------------------------------------------
+// Un JMP/Jcc/LOOP cuya etiqueta ya se definió más arriba en su sección
+// cierra un bucle: antes de esa etiqueta va un IR_ALINEACION con NOP, como si
+// el fuente tuviera un ALIGN (antes de la primera si hay varias seguidas).
+// Si ya lo tiene, se respeta. Se inserta en la IR
+// antes de relajar_saltos(), que fija el relleno con la disposición final.
+// LOOP no tiene forma larga: entre un LOOP y su destino no se agrega
+// relleno (una cabecera interna queda sin alinear), porque podría dejarlo
+// fuera de alcance.
+
+void EnsambladorIA32::alinear_bucles() {
+    const size_t n = programa_ir.size();
+    MarcaArena marca(arena);
+    VectorArena<uint32_t> definicion(tabla_simbolos.size(), SIN_SIMBOLO, AsignadorArena<uint32_t>(arena));
+    VectorArena<uint8_t> cabecera(n, 0, AsignadorArena<uint8_t>(arena));
+    // +1 / -1 donde empieza / termina el tramo de un LOOP (suma de prefijos)
+    VectorArena<int32_t> tramo_rel8(n + 1, 0, AsignadorArena<int32_t>(arena));
+    for (size_t i = 0; i < n; ++i) {
+        const InstruccionIR& ir = programa_ir[i];
+        if (ir.tipo == IR_ETIQUETA && definicion[ir.valor[0]] == SIN_SIMBOLO) {
+            definicion[ir.valor[0]] = static_cast<uint32_t>(i);
+        }
+    }
+    for (size_t i = 0; i < n; ++i) {
+        const InstruccionIR& ir = programa_ir[i];
+        if (ir.tipo != IR_INSTRUCCION) continue;
+        const Codificacion cod = TABLA_OPCODES[ir.fila].cod;
+        if (cod != C_SALTO && cod != C_REL8) continue;
+        uint32_t j = definicion[ir.valor[0]];
+        if (j == SIN_SIMBOLO || programa_ir[j].seccion != ir.seccion) continue;
+        if (cod == C_REL8) {
+            // Relleno antes de la entrada k con min < k <= max cae entre los dos
+            ++tramo_rel8[min<size_t>(i, j) + 1];
+            --tramo_rel8[max<size_t>(i, j) + 1];
+        }
+        if (j > i) continue;   // hacia adelante: no cierra un bucle
+        while (j > 0 && programa_ir[j - 1].tipo == IR_ETIQUETA) --j;   // "A: B:" -> antes de A
+        if (j > 0 && programa_ir[j - 1].tipo == IR_ALINEACION) continue;
+        cabecera[j] = 1;
+    }
+    size_t cabeceras = 0;
+    int32_t dentro_rel8 = 0;
+    for (size_t i = 0; i < n; ++i) {
+        dentro_rel8 += tramo_rel8[i];
+        if (!cabecera[i]) continue;
+        if (dentro_rel8 > 0) cabecera[i] = 0;
+        else                 ++cabeceras;
+    }
+    bucles_alineados = static_cast<uint32_t>(cabeceras);
+    if (cabeceras == 0) return;
+
+    InstruccionIR alineacion{};
+    alineacion.tipo     = IR_ALINEACION;
+    alineacion.valor[0] = alineacion_bucles;
+    alineacion.reg[0]   = RELLENO_NOP;
+    alineacion.reg[1]   = static_cast<uint8_t>(min<uint32_t>(255, max<uint32_t>(1, alineacion_bucles / 2 - 1)));
+
+    // La IR se copia una vez con los ALIGN en su lugar. El relleno va en la
+    // línea de la etiqueta: su inicio en inicio_ir_linea no se corre
+    vector<InstruccionIR> nueva;
+    nueva.reserve(n + cabeceras);
+    size_t linea = 0;
+    for (size_t i = 0; i < n; ++i) {
+        for (; linea < inicio_ir_linea.size() && inicio_ir_linea[linea] <= i; ++linea) {
+            inicio_ir_linea[linea] = static_cast<uint32_t>(nueva.size());
+        }
+        if (cabecera[i]) {
+            alineacion.seccion = programa_ir[i].seccion;
+            nueva.push_back(alineacion);
+        }
+        nueva.push_back(programa_ir[i]);
+    }
+    for (; linea < inicio_ir_linea.size(); ++linea) inicio_ir_linea[linea] = static_cast<uint32_t>(nueva.size());
+    programa_ir.swap(nueva);
+}
+
+// -----------------------------------------------------------------------------
+// Tamaño mínimo (-Os)
+// -----------------------------------------------------------------------------
+// Sobre la IR de la PASADA 1, antes de relajar_saltos(): la relajación
+// recalcula todas las direcciones a partir de ir.tamano, así que basta con
+// cambiar la fila (y los operandos) de cada instrucción. Las referencias aún
+// no existen: se registran en la PASADA 2 con la fila nueva.
+
+// Qué hace una instrucción con EFLAGS, para banderas_muertas()
+enum EfectoBanderas : uint8_t {
+    BANDERAS_ESCRIBE,   // las deja todas definidas sin leerlas
+    BANDERAS_PASA,      // no las lee (puede cambiar algunas: INC, MUL...)
+    BANDERAS_LEE        // las lee o el flujo sigue en otro lado
+};
+
+static EfectoBanderas efecto_banderas(string_view mnem) {
+    for (string_view m : { "ADD", "SUB", "CMP", "AND", "OR", "XOR", "TEST" }) {
+        if (mnem == m) return BANDERAS_ESCRIBE;
+    }
+    for (string_view m : { "MOV", "MOVZX", "LEA", "PUSH", "POP", "XCHG", "NOP", "LEAVE",
+                           "INC", "DEC", "MUL", "IMUL", "DIV", "IDIV" }) {
+        if (mnem == m) return BANDERAS_PASA;
+    }
+    return BANDERAS_LEE;   // Jcc, JMP, CALL, RET, INT, LOOP
+}
+
+// En línea recta desde programa_ir[i]: true si alguna instrucción vuelve a
+// escribir las banderas antes de que algo pueda leerlas. Un salto, CALL o
+// RET, datos, un cambio de sección o el final del programa cuentan como
+// lectura (no se sigue el flujo), igual que recorrer más de 64 entradas.
+// Las etiquetas no cortan: lo que llega por ellas no viene de programa_ir[i]
+bool EnsambladorIA32::banderas_muertas(size_t i) const {
+    const size_t fin = min(programa_ir.size(), i + 1 + 64);
+    for (size_t k = i + 1; k < fin; ++k) {
+        const InstruccionIR& ir = programa_ir[k];
+        if (ir.tipo == IR_ETIQUETA || ir.tipo == IR_AMBITO || ir.tipo == IR_ALINEACION) continue;
+        if (ir.tipo != IR_INSTRUCCION) return false;
+        switch (efecto_banderas(TABLA_OPCODES[ir.fila].mnem)) {
+            case BANDERAS_ESCRIBE: return true;
+            case BANDERAS_PASA:    break;
+            case BANDERAS_LEE:     return false;
+        }
+    }
+    return false;
+}
+
+// Bytes de ir con su fila y operandos actuales. Tras la PASADA 1
+// codificar_ir() solo cuenta; el contador vuelve a donde estaba
+int EnsambladorIA32::medir_ir(const InstruccionIR& ir) {
+    const int antes = contador_posicion;
+    codificar_ir(ir);
+    const int bytes = contador_posicion - antes;
+    contador_posicion = antes;
+    return bytes;
+}
+
+// Los operandos de ir otra vez como Operando, para volver a elegir la fila;
+// tam_mem es la pista de tamaño con que se eligió la original
+int EnsambladorIA32::operandos_ir(const InstruccionIR& ir, uint8_t tam_mem, Operando (&ops)[2]) const {
+    int num_ops = 0;
+    for (int k = 0; k < 2; ++k) {
+        ops[k] = Operando();
+        ops[k].tipo      = static_cast<TipoOperando>(ir.tipo_op[k]);
+        ops[k].reg       = ir.reg[k];
+        ops[k].inmediato = ir.valor[k];
+        ops[k].tam_mem   = tam_mem;
+        ops[k].mem       = ir.mem;
+        num_ops += (ops[k].tipo != OP_NINGUNO);
+    }
+    return num_ops;
+}
+
+// La fila más corta de 'mnem' que acepta los operandos de ir (en empate, la
+// primera). tam_mem es la pista de tamaño con que se eligió la fila original.
+// false si ninguna fila de 'mnem' los acepta
+bool EnsambladorIA32::forma_mas_corta(InstruccionIR& ir, string_view mnem, uint8_t tam_mem) {
+    size_t num_filas = 0;
+    const FilaOpcode* filas = buscar_filas_opcode(mnem, num_filas);
+
+    Operando ops[2];
+    const int num_ops = operandos_ir(ir, tam_mem, ops);
+
+    int mejor = -1;
+    InstruccionIR prueba = ir;
+    for (size_t i = 0; i < num_filas; ++i) {
+        const FilaOpcode& fila = filas[i];
+        int ops_fila = (fila.op0 != P_NADA) + (fila.op1 != P_NADA);
+        if (ops_fila != num_ops) continue;
+        if (!coincide_patron(fila.op0, ops[0]) || !coincide_patron(fila.op1, ops[1])) continue;
+
+        prueba.fila = static_cast<uint16_t>(&fila - TABLA_OPCODES);
+        const int bytes = medir_ir(prueba);
+        if (mejor < 0 || bytes < mejor) {
+            mejor = bytes;
+            ir.fila = prueba.fila;
+        }
+    }
+    if (mejor < 0) return false;
+    ir.tamano = static_cast<uint8_t>(mejor);
+    return true;
+}
+
+void EnsambladorIA32::optimizar_tamano() {
+    optimizacion = EstadisticasTamano();
+
+    for (size_t i = 0; i < programa_ir.size(); ++i) {
+        InstruccionIR& ir = programa_ir[i];
+        if (ir.tipo != IR_INSTRUCCION) continue;
+        const FilaOpcode& fila = TABLA_OPCODES[ir.fila];
+        if (fila.cod == C_SALTO || fila.cod == C_REL8 || fila.cod == C_REL32) continue;
+
+        // [x] sin pista que coincidió con P_M8 es de un byte; si no, de 4
+        const uint8_t tam_mem = (fila.op0 == P_M8 || fila.op1 == P_M8) ? 1 : 4;
+        const bool destino_rm = ir.tipo_op[0] == OP_R32 || ir.tipo_op[0] == OP_MEM;
+        const bool con_imm    = ir.tipo_op[1] == OP_IMM;
+        const int32_t imm     = static_cast<int32_t>(ir.valor[1]);
+
+        // Misma operación con otro mnemónico
+        InstruccionIR otra = ir;
+        string_view mnem_otra;
+        ReglaTamano regla = NUM_REGLAS_TAMANO;
+        if (fila.mnem == "MOV" && con_imm && destino_rm && (imm == 0 || imm == -1)) {
+            if (ir.tipo_op[0] == OP_R32 && imm == 0) {
+                mnem_otra = "XOR";
+                otra.tipo_op[1] = OP_R32;
+                otra.reg[1]     = ir.reg[0];
+                otra.valor[1]   = 0;
+                regla = REGLA_MOV_CERO;
+            } else {
+                mnem_otra = (imm == 0) ? "AND" : "OR";
+                regla = REGLA_MOV_AND_OR;
+            }
+        } else if ((fila.mnem == "ADD" || fila.mnem == "SUB") && con_imm && destino_rm &&
+                   (imm == 1 || imm == -1)) {
+            mnem_otra = ((fila.mnem == "ADD") == (imm == 1)) ? "INC" : "DEC";
+            otra.tipo_op[1] = OP_NINGUNO;
+            otra.reg[1]     = 0;
+            otra.valor[1]   = 0;
+            regla = REGLA_INC_DEC;
+        } else if (fila.mnem == "CMP" && con_imm && ir.tipo_op[0] == OP_R32 && imm == 0) {
+            mnem_otra = "TEST";
+            otra.tipo_op[1] = OP_R32;
+            otra.reg[1]     = ir.reg[0];
+            otra.valor[1]   = 0;
+            regla = REGLA_CMP_TEST;
+        }
+
+        InstruccionIR mejor = ir;
+        forma_mas_corta(mejor, fila.mnem, tam_mem);
+
+        // CMP r, 0 y TEST r, r dejan las mismas banderas; las demás no
+        if (regla != NUM_REGLAS_TAMANO && forma_mas_corta(otra, mnem_otra, tam_mem) &&
+            otra.tamano < mejor.tamano && (regla == REGLA_CMP_TEST || banderas_muertas(i))) {
+            mejor = otra;
+        } else {
+            const FilaOpcode& nueva = TABLA_OPCODES[mejor.fila];
+            if (nueva.cod == C_MOFFS)                        regla = REGLA_MOFFS;
+            else if (nueva.tam_imm == 1 && fila.tam_imm == 4) regla = REGLA_INMEDIATO_8;
+            else                                             regla = REGLA_OTRA_FORMA;
+        }
+
+        if (mejor.tamano >= ir.tamano) continue;
+        const int ahorro = ir.tamano - mejor.tamano;
+        optimizacion.instrucciones[regla]++;
+        optimizacion.bytes[regla] += static_cast<uint32_t>(ahorro);
+        secciones[ir.seccion].contador -= ahorro;
+        ir = mejor;
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Secciones
+// -----------------------------------------------------------------------------
+
+void EnsambladorIA32::cambiar_seccion(uint8_t seccion) {
+    secciones[seccion_actual].contador = contador_posicion;
+    seccion_actual    = seccion;
+    contador_posicion = secciones[seccion].contador;
+}
+
+int EnsambladorIA32::total_bytes() const {
+    int total = 0;
+    for (const SeccionEnsamblado& s : secciones) total += s.contador;
+    return total;
+}
+
+// Las bases no fijadas siguen a la sección anterior, alineadas a 4 o a su
+// mayor ALIGN (si no, ALIGN alinearía solo dentro de la sección)
+void EnsambladorIA32::asignar_bases() {
+    uint32_t siguiente = 0;
+    for (SeccionEnsamblado& s : secciones) {
+        const uint32_t alineacion = max<uint32_t>(4, s.alineacion);
+        if (!s.base_fija) s.base = (siguiente + alineacion - 1) & ~(alineacion - 1);
+        siguiente = s.base + static_cast<uint32_t>(s.contador);
+    }
+}
+
+void EnsambladorIA32::reubicar(const uint32_t (&bases)[NUM_SECCIONES]) {
+    int32_t delta[NUM_SECCIONES];
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        delta[s] = static_cast<int32_t>(bases[s] - secciones[s].base);
+    }
+
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        if (tabla_simbolos[ref.simbolo] == SIN_DIRECCION) continue;
+        uint8_t destino = seccion_simbolo[ref.simbolo];
+        int32_t ajuste = (ref.tipo_salto == 0) ? delta[destino]
+                                               : delta[destino] - delta[ref.seccion];
+        if (ajuste == 0) continue;
+        uint8_t* hueco = secciones[ref.seccion].bytes.data() + ref.posicion;
+        if (ref.tamano_inmediato == 4) {
+            escribir_le32(hueco, leer_le32(hueco) + static_cast<uint32_t>(ajuste));
+        } else {
+            hueco[0] = static_cast<uint8_t>(hueco[0] + ajuste);
+        }
+    }
+
+    for (int s = 0; s < NUM_SECCIONES; ++s) secciones[s].base = bases[s];
+    armar_imagen();
+}
+
+bool EnsambladorIA32::buscar_simbolo(string_view nombre, uint32_t& direccion) const {
+    uint32_t id = simbolos.buscar(nombre);
+    if (id == InternadorSimbolos::SIN_ID || tabla_simbolos[id] == SIN_DIRECCION) return false;
+    direccion = direccion_simbolo(id);
+    return true;
+}
+
+// Imagen plana para .hex/.bin: .text desde su base y .data en su dirección
+// (con ceros entre ambas). .bss no ocupa bytes en la salida.
+void EnsambladorIA32::armar_imagen() {
+    const SeccionEnsamblado& texto = secciones[SEC_TEXT];
+    const SeccionEnsamblado& datos = secciones[SEC_DATA];
+
+    codigo_hex.clear();
+    codigo_hex.reserve(texto.bytes.size() + datos.bytes.size() + 3);
+    codigo_hex.insert(codigo_hex.end(), texto.bytes.begin(), texto.bytes.end());
+    if (datos.bytes.empty()) return;
+
+    if (datos.base >= texto.base + texto.bytes.size()) {
+        codigo_hex.resize(datos.base - texto.base, 0);
+    } else {
+        *salida_errores << "Advertencia: .data no queda tras .text; en la imagen plana va a continuacion" << endl;
+    }
+    codigo_hex.insert(codigo_hex.end(), datos.bytes.begin(), datos.bytes.end());
+}
+
+// -----------------------------------------------------------------------------
+// Resolución de referencias pendientes
+// -----------------------------------------------------------------------------
+
+// Cada referencia escribe solo su hueco: los bloques de referencias se
+// resuelven en paralelo y las no definidas se avisan después, en orden
+void EnsambladorIA32::resolver_referencias_pendientes() {
+    const size_t n = referencias_pendientes.size();
+    const size_t bloques = max<size_t>(1, min<size_t>(hilos, n / MIN_REFERENCIAS_BLOQUE));
+    MarcaArena marca(arena);
+    // Índices en referencias_pendientes; cada bloque llena el suyo desde su
+    // hilo, así que estos no pueden salir de la arena
+    VectorArena<vector<uint32_t>> no_definidas(bloques, AsignadorArena<vector<uint32_t>>(arena));
+
+    para_cada_bloque(hilos, bloques, [&](size_t b) {
+        for (size_t i = n * b / bloques; i < n * (b + 1) / bloques; ++i) {
+            if (!resolver_referencia(referencias_pendientes[i])) {
+                no_definidas[b].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    });
+
+    VectorArena<uint8_t> avisado(tabla_simbolos.size(), 0, AsignadorArena<uint8_t>(arena));   // un aviso por etiqueta
+    for (const vector<uint32_t>& bloque : no_definidas) {
+        for (uint32_t i : bloque) {
+            uint32_t simbolo = referencias_pendientes[i].simbolo;
+            // EXTERN: el hueco conserva el sumando y el enlazador lo completa
+            if (tabla_simbolos[simbolo] != SIN_DIRECCION) {
+                avisar_fuera_de_alcance(referencias_pendientes[i]);
+                continue;
+            }
+            if (ambito_simbolo[simbolo] != AMBITO_EXTERNO && !avisado[simbolo]) {
+                avisado[simbolo] = true;
+                ++errores;
+                *salida_errores << "Advertencia: Etiqueta no definida '" << simbolos.nombre(simbolo)
+                     << "'. Referencia no resuelta." << endl;
+            }
+        }
+    }
+}
+
+// false si la etiqueta no está definida o si un hueco de 8 bits (LOOP) no
+// alcanza el destino; en los dos casos el hueco queda como está
+bool EnsambladorIA32::resolver_referencia(const ReferenciaPendiente& ref) {
+    if (tabla_simbolos[ref.simbolo] == SIN_DIRECCION) return false;
+
+    // Dirección absoluta: base de la sección de la etiqueta + desplazamiento
+    int destino = static_cast<int>(direccion_simbolo(ref.simbolo));
+    SeccionEnsamblado& sec = secciones[ref.seccion];
+    uint8_t* hueco = sec.bytes.data() + ref.posicion;
+    uint32_t valor_a_parchear = 0;
+
+    // El hueco ya trae el sumando ([TABLA+ESI*4+8] -> 8); normalmente 0
+    int32_t sumando;
+    if (ref.tamano_inmediato == 4) {
+        sumando = static_cast<int32_t>(leer_le32(hueco));
+    } else {
+        sumando = static_cast<int8_t>(hueco[0]);
+    }
+
+    if (ref.tipo_salto == 0) {
+        // Referencia absoluta → dirección real de la etiqueta
+        valor_a_parchear = static_cast<uint32_t>(destino + sumando);
+    } else {
+        // Relativo → destino - (dirección del siguiente byte)
+        int siguiente = static_cast<int>(sec.base) + ref.posicion + ref.tamano_inmediato;
+        valor_a_parchear = static_cast<uint32_t>(destino + sumando - siguiente);
+    }
+
+    if (ref.tamano_inmediato == 4) {
+        escribir_le32(hueco, valor_a_parchear);
+    } else if (ref.tamano_inmediato == 1) {
+        const int32_t desplazamiento = static_cast<int32_t>(valor_a_parchear);
+        if (ref.tipo_salto != 0 && (desplazamiento < -128 || desplazamiento > 127)) return false;
+        hueco[0] = static_cast<uint8_t>(valor_a_parchear & 0xFF);
+    }
+    return true;
+}
+
+// Un rel8 que la relajación no puede alargar (LOOP) y no llega a su destino
+void EnsambladorIA32::avisar_fuera_de_alcance(const ReferenciaPendiente& ref) {
+    ++errores;
+    *salida_errores << "Error: salto de 8 bits a '" << simbolos.nombre(ref.simbolo) << "' fuera de alcance (-128 a 127) en "
+                    << secciones[ref.seccion].nombre << "+0x" << hex << ref.posicion - 1 << dec << endl;
+}
+
+// -----------------------------------------------------------------------------
+// Ensamblado por bloques (varios hilos)
+// -----------------------------------------------------------------------------
+// PASADA 1: cada bloque de líneas lo analiza un ensamblador trabajador con su
+// propio internador, tabla de datos y contadores locales. Después se internan
+// aquí sus nombres en orden de bloque (los ids quedan iguales que en
+// secuencial) y la IR se copia traduciendo ids. La relajación es la misma.
+// PASADA 2: cada bloque de la IR empieza en una sección y posición que se
+// conocen de antemano (suma de prefijos de sus tamaños), así que se codifica
+// directamente en su lugar del buffer de cada sección.
+
+void EnsambladorIA32::reiniciar_estado() {
+    arena.reiniciar();
+    primera_pasada      = true;
+    contador_posicion   = 0;
+    seccion_actual      = SEC_TEXT;
+    for (SeccionEnsamblado& sec : secciones) {
+        sec.bytes.clear();
+        sec.contador = 0;
+        sec.alineacion = 1;
+    }
+    bucles_alineados = 0;
+    simbolos.limpiar();
+    tabla_simbolos.clear();
+    seccion_simbolo.clear();
+    ambito_simbolo.clear();
+    equ_simbolo.clear();
+    equivalencias.clear();
+    diferidas.clear();
+    con_expresiones = false;
+    referencias_pendientes.clear();
+    codigo_hex.clear();
+    programa_ir.clear();
+    datos_ir.clear();
+    inicio_ir_linea.clear();
+    for (uint8_t*& d : destino) d = nullptr;
+    datos_codificar = nullptr;
+    contadores = ContadoresEnsamblado();
+    optimizacion = EstadisticasTamano();
+    if (con_estadisticas) contadores.por_fila.assign(NUM_FILAS_OPCODES, 0);
+}
+
+// Trabajador de la PASADA 1: líneas [desde, hasta) empezando en 'seccion',
+// con los EQU que dejaron los bloques de 'semillas' (los anteriores)
+void EnsambladorIA32::analizar_bloque(const ArchivoFuente& texto, size_t desde, size_t hasta,
+                                      uint8_t seccion, const vector<const EnsambladorIA32*>& semillas) {
+    reiniciar_estado();
+    errores        = 0;
+    seccion_actual = seccion;
+    for (const EnsambladorIA32* anterior : semillas) sembrar_equivalencias(*anterior);
+    programa_ir.reserve(hasta - desde);
+    if (con_indice_lineas) inicio_ir_linea.reserve(hasta - desde);
+    for (size_t i = desde; i < hasta; ++i) {
+        if (con_indice_lineas) inicio_ir_linea.push_back(static_cast<uint32_t>(programa_ir.size()));
+        linea_actual = i;
+        procesar_linea(texto.linea(i));
+    }
+    cambiar_seccion(seccion_actual);   // guarda el contador de la última sección
+}
+
+// Ids locales de un trabajador -> ids globales; datos_ir local -> global
+static void traducir_ids(InstruccionIR& ir, const vector<uint32_t>& mapa, uint32_t inicio_datos) {
+    switch (ir.tipo) {
+        case IR_ETIQUETA:
+        case IR_AMBITO:
+            ir.valor[0] = mapa[ir.valor[0]];
+            break;
+        case IR_DATOS:
+            ir.valor[0] += inicio_datos;
+            break;
+        case IR_INSTRUCCION:
+            for (int k = 0; k < 2; ++k) {
+                if (ir.tipo_op[k] == OP_ETIQUETA || ir.tipo_op[k] == OP_IMM_SIMBOLO) ir.valor[k] = mapa[ir.valor[k]];
+            }
+            if (ir.mem.simbolo != SIN_SIMBOLO) ir.mem.simbolo = mapa[ir.mem.simbolo];
+            break;
+        default:
+            break;
+    }
+}
+
+void EnsambladorIA32::pasada1_paralela(size_t bloques) {
+    struct Trabajo {
+        EnsambladorIA32 ens;
+        ostringstream mensajes;             // errores del bloque, se imprimen en orden
+        uint8_t seccion_inicial = SEC_TEXT;
+        bool cambia_seccion = false;        // tiene algún SECTION
+        bool con_equ = false;               // define EQU con nombre
+        size_t version = 0;                 // veces que se analizó
+        vector<const EnsambladorIA32*> semillas;   // bloques anteriores con EQU
+        vector<size_t> vistas;              // versión de cada anterior al sembrar (SIN_VERSION: sin EQU)
+        vector<uint32_t> mapa;              // id local -> id global
+        size_t inicio_ir = 0;
+        size_t inicio_datos = 0;
+    };
+    vector<unique_ptr<Trabajo>> trabajos(bloques);
+    const size_t lineas = fuente.num_lineas();
+
+    auto analizar = [&](size_t b) {
+        Trabajo& w = *trabajos[b];
+        w.ens.analizar_bloque(fuente, lineas * b / bloques, lineas * (b + 1) / bloques, w.seccion_inicial,
+                              w.semillas);
+        ++w.version;
+        w.cambia_seccion = any_of(w.ens.programa_ir.begin(), w.ens.programa_ir.end(),
+                                  [](const InstruccionIR& ir) { return ir.tipo == IR_SECCION; });
+        w.con_equ = any_of(w.ens.equivalencias.begin(), w.ens.equivalencias.end(), [&](const Equivalencia& e) {
+            return !e.sembrada && !w.ens.simbolo_interno(e.simbolo);
+        });
+    };
+    for (unique_ptr<Trabajo>& w : trabajos) {
+        w = make_unique<Trabajo>();
+        w->ens.salida_errores    = &w->mensajes;
+        w->ens.con_indice_lineas = con_indice_lineas;
+    }
+
+    // Todos los bloques suponen .text al empezar; los que en realidad empiezan
+    // en otra sección (.bss rechaza instrucciones) se vuelven a analizar
+    para_cada_bloque(hilos, bloques, analizar);
+    vector<size_t> repetir;
+    uint8_t seccion = SEC_TEXT;
+    for (size_t b = 0; b < bloques; ++b) {
+        Trabajo& w = *trabajos[b];
+        if (w.seccion_inicial != seccion) {
+            w.seccion_inicial = seccion;
+            repetir.push_back(b);
+        }
+        if (w.cambia_seccion) seccion = w.ens.seccion_actual;   // no depende de la inicial
+    }
+    for (size_t b : repetir) trabajos[b]->mensajes.str("");
+    para_cada_bloque(hilos, repetir.size(), [&](size_t i) { analizar(repetir[i]); });
+
+    // Un bloque que nombra un EQU de uno anterior se vuelve a analizar con
+    // esos EQU sembrados, como los vería en secuencial. Van por tandas: un
+    // bloque que a su vez define EQU cierra la tanda y los siguientes
+    // esperan a sus valores definitivos
+    constexpr size_t SIN_VERSION = ~size_t(0);
+    auto nombra_equ = [&](size_t b) {
+        const EnsambladorIA32& ens = trabajos[b]->ens;
+        for (size_t a = 0; a < b; ++a) {
+            if (!trabajos[a]->con_equ) continue;
+            const EnsambladorIA32& anterior = trabajos[a]->ens;
+            for (const Equivalencia& e : anterior.equivalencias) {
+                if (e.sembrada || anterior.simbolo_interno(e.simbolo)) continue;
+                if (ens.simbolos.buscar(anterior.simbolos.nombre(e.simbolo)) != InternadorSimbolos::SIN_ID) return true;
+            }
+        }
+        return false;
+    };
+    auto desactualizado = [&](size_t b) {
+        const Trabajo& w = *trabajos[b];
+        if (w.vistas.empty()) return nombra_equ(b);
+        for (size_t a = 0; a < b; ++a) {
+            if ((trabajos[a]->con_equ || w.vistas[a] != SIN_VERSION) && w.vistas[a] != trabajos[a]->version) return true;
+        }
+        return false;
+    };
+    for (;;) {
+        vector<size_t> tanda;
+        for (size_t b = 1; b < bloques; ++b) {
+            if (!desactualizado(b)) continue;
+            tanda.push_back(b);
+            if (trabajos[b]->con_equ) break;
+        }
+        if (tanda.empty()) break;
+        for (size_t b : tanda) {
+            Trabajo& w = *trabajos[b];
+            w.semillas.clear();
+            w.vistas.assign(b, SIN_VERSION);
+            for (size_t a = 0; a < b; ++a) {
+                if (!trabajos[a]->con_equ) continue;
+                w.semillas.push_back(&trabajos[a]->ens);
+                w.vistas[a] = trabajos[a]->version;
+            }
+            w.mensajes.str("");
+        }
+        para_cada_bloque(hilos, tanda.size(), [&](size_t i) { analizar(tanda[i]); });
+    }
+
+    // Internar en orden de bloque = orden de primera aparición en el fuente
+    size_t total_ir = 0, total_datos = 0;
+    for (unique_ptr<Trabajo>& pw : trabajos) {
+        Trabajo& w = *pw;
+        errores += w.ens.errores;
+        *salida_errores << w.mensajes.str();
+
+        w.mapa.resize(w.ens.simbolos.size());
+        for (uint32_t id = 0; id < w.mapa.size(); ++id) {
+            w.mapa[id] = id_simbolo(w.ens.simbolos.nombre(id));
+            // GLOBAL/EXTERN: gana la última directiva, como en secuencial
+            if (w.ens.ambito_simbolo[id] != AMBITO_LOCAL) ambito_simbolo[w.mapa[id]] = w.ens.ambito_simbolo[id];
+        }
+        // Los EQU sembrados ya entraron con el bloque que los define (sus
+        // diferidas copiadas también se agregan, pero nadie las nombra)
+        const uint32_t base_diferidas = static_cast<uint32_t>(diferidas.size());
+        auto id = [&](uint32_t simbolo) { return w.mapa[simbolo]; };
+        auto diferida = [&](uint32_t d) { return base_diferidas + d; };
+        for (const ExpresionDiferida& d : w.ens.diferidas) {
+            diferidas.push_back(ExpresionDiferida{d.op, trasladar_valor(d.a, id, diferida),
+                                                  trasladar_valor(d.b, id, diferida)});
+        }
+        for (const Equivalencia& e : w.ens.equivalencias) {
+            if (!e.sembrada) definir_equ(w.mapa[e.simbolo], trasladar_valor(e.valor, id, diferida));
+        }
+        con_expresiones = con_expresiones || w.ens.con_expresiones;
+        w.inicio_ir    = total_ir;
+        w.inicio_datos = total_datos;
+        total_ir    += w.ens.programa_ir.size();
+        total_datos += w.ens.datos_ir.size();
+        for (int s = 0; s < NUM_SECCIONES; ++s) secciones[s].contador += w.ens.secciones[s].contador;
+    }
+
+    programa_ir.resize(total_ir);
+    datos_ir.resize(total_datos);
+    if (con_indice_lineas) {
+        inicio_ir_linea.resize(lineas + 1);
+        inicio_ir_linea[lineas] = static_cast<uint32_t>(total_ir);
+    }
+    para_cada_bloque(hilos, bloques, [&](size_t b) {
+        Trabajo& w = *trabajos[b];
+        InstruccionIR* ir = programa_ir.data() + w.inicio_ir;
+        for (const InstruccionIR& local : w.ens.programa_ir) {
+            *ir = local;
+            traducir_ids(*ir++, w.mapa, static_cast<uint32_t>(w.inicio_datos));
+        }
+        copy(w.ens.datos_ir.begin(), w.ens.datos_ir.end(), datos_ir.begin() + w.inicio_datos);
+        uint32_t* linea = inicio_ir_linea.data() + lineas * b / bloques;
+        for (uint32_t inicio : w.ens.inicio_ir_linea) *linea++ = inicio + static_cast<uint32_t>(w.inicio_ir);
+        w.ens.reiniciar_estado();   // libera la IR del trabajador en su hilo
+    });
+
+    seccion_actual    = SEC_TEXT;
+    contador_posicion = secciones[SEC_TEXT].contador;
+}
+
+// Trabajador de la PASADA 2 (o el propio ensamblador con un solo bloque):
+// codifica origen.programa_ir[desde, hasta) a partir de 'inicio'
+void EnsambladorIA32::codificar_bloque(const EnsambladorIA32& origen, size_t desde, size_t hasta,
+                                       const PosicionBloque& inicio) {
+    primera_pasada  = false;
+    datos_codificar = &origen.datos_ir;
+    for (int s = 0; s < NUM_SECCIONES; ++s) secciones[s].contador = inicio.contador[s];
+    seccion_actual    = inicio.seccion;
+    contador_posicion = inicio.contador[inicio.seccion];
+
+    for (size_t i = desde; i < hasta; ++i) {
+        const InstruccionIR& ir = origen.programa_ir[i];
+        int antes = contador_posicion;
+        codificar_ir(ir);
+        if (con_estadisticas) contar(ir, contador_posicion - antes);
+    }
+    cambiar_seccion(SEC_TEXT);   // guarda el contador de la última sección
+    datos_codificar = nullptr;
+}
+
+void EnsambladorIA32::pasada2() {
+    const size_t n = programa_ir.size();
+    const size_t bloques = max<size_t>(1, min<size_t>(hilos, n / MIN_LINEAS_BLOQUE));
+
+    // Cada sección con su tamaño final (ya relajado): se escribe en su lugar
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        if (s != SEC_BSS) secciones[s].bytes.resize(static_cast<size_t>(secciones[s].contador));
+        destino[s] = secciones[s].bytes.empty() ? nullptr : secciones[s].bytes.data();
+    }
+
+    // Tamaños de cada bloque: lo que va antes de su primer SECTION (en la
+    // sección con la que empieza) y lo que va después, por sección
+    struct Resumen {
+        int inicial = 0;
+        int por_seccion[NUM_SECCIONES] = {};
+        bool cambia_seccion = false;
+        uint8_t seccion_final = SEC_TEXT;
+    };
+    MarcaArena marca(arena);
+    VectorArena<Resumen> resumen(bloques, AsignadorArena<Resumen>(arena));
+    para_cada_bloque(hilos, bloques, [&](size_t b) {
+        Resumen& r = resumen[b];
+        for (size_t i = n * b / bloques; i < n * (b + 1) / bloques; ++i) {
+            const InstruccionIR& ir = programa_ir[i];
+            if (ir.tipo == IR_SECCION) {
+                r.cambia_seccion = true;
+                r.seccion_final  = static_cast<uint8_t>(ir.valor[0]);
+            } else if (r.cambia_seccion) {
+                r.por_seccion[r.seccion_final] += tamano_ir(ir);
+            } else {
+                r.inicial += tamano_ir(ir);
+            }
+        }
+    });
+
+    VectorArena<PosicionBloque> inicio(bloques, AsignadorArena<PosicionBloque>(arena));
+    PosicionBloque pos{};
+    pos.seccion = SEC_TEXT;
+    for (size_t b = 0; b < bloques; ++b) {
+        inicio[b] = pos;
+        pos.contador[pos.seccion] += resumen[b].inicial;
+        if (resumen[b].cambia_seccion) {
+            for (int s = 0; s < NUM_SECCIONES; ++s) pos.contador[s] += resumen[b].por_seccion[s];
+            pos.seccion = resumen[b].seccion_final;
+        }
+    }
+
+    if (bloques == 1) {
+        codificar_bloque(*this, 0, n, inicio[0]);
+    } else {
+        vector<unique_ptr<EnsambladorIA32>> trabajadores(bloques);
+        para_cada_bloque(hilos, bloques, [&](size_t b) {
+            unique_ptr<EnsambladorIA32> w = make_unique<EnsambladorIA32>();
+            w->con_estadisticas = con_estadisticas;
+            if (con_estadisticas) w->contadores.por_fila.assign(NUM_FILAS_OPCODES, 0);
+            for (int s = 0; s < NUM_SECCIONES; ++s) w->destino[s] = destino[s];
+            w->codificar_bloque(*this, n * b / bloques, n * (b + 1) / bloques, inicio[b]);
+            trabajadores[b] = move(w);
+        });
+
+        // Referencias en orden de bloque: el mismo orden que en secuencial
+        size_t total = 0;
+        for (const unique_ptr<EnsambladorIA32>& w : trabajadores) total += w->referencias_pendientes.size();
+        referencias_pendientes.reserve(total);
+        for (const unique_ptr<EnsambladorIA32>& w : trabajadores) {
+            referencias_pendientes.insert(referencias_pendientes.end(),
+                                          w->referencias_pendientes.begin(), w->referencias_pendientes.end());
+            if (!con_estadisticas) continue;
+            for (size_t f = 0; f < NUM_FILAS_OPCODES; ++f) contadores.por_fila[f] += w->contadores.por_fila[f];
+            contadores.bytes_instruccion += w->contadores.bytes_instruccion;
+            contadores.bytes_datos       += w->contadores.bytes_datos;
+            contadores.bytes_reserva     += w->contadores.bytes_reserva;
+            contadores.bytes_alineacion  += w->contadores.bytes_alineacion;
+        }
+        seccion_actual    = SEC_TEXT;
+        contador_posicion = secciones[SEC_TEXT].contador;
+    }
+
+    for (uint8_t*& d : destino) d = nullptr;
+}
+
+// -----------------------------------------------------------------------------
+// Caché en disco
+// -----------------------------------------------------------------------------
+// La entrada guarda el estado final: por sección base, tamaño y bytes; los
+// símbolos en orden de id (nombre, desplazamiento, sección, ámbito) y las
+// referencias ya resueltas. Con eso generar_hex/bin/elf/reportes escriben
+// lo mismo que tras ensamblar. Los hilos no cambian la salida: no van en la clave
+
+string EnsambladorIA32::opciones_cache() const {
+    string op = identidad_ejecutable() + (una_pasada ? ";una_pasada" : ";dos_pasadas");
+    if (tamano_minimo && !una_pasada) op += ";Os";
+    if (alineacion_bucles != 0 && !una_pasada) op += ";alinear_bucles=" + to_string(alineacion_bucles);
+    for (const SeccionEnsamblado& sec : secciones) {
+        op += ';';
+        op += sec.nombre;
+        op += sec.base_fija ? "=" + to_string(sec.base) : "=auto";
+    }
+    return op;
+}
+
+void EnsambladorIA32::guardar_cache(const ClaveCache& clave) {
+    EscritorCache e;
+    for (const SeccionEnsamblado& sec : secciones) {
+        e.u32(sec.base);
+        e.u32(sec.alineacion);
+        e.u32(static_cast<uint32_t>(sec.contador));
+        e.u32(static_cast<uint32_t>(sec.bytes.size()));
+        e.bytes(sec.bytes.data(), sec.bytes.size());
+    }
+    e.u32(static_cast<uint32_t>(tabla_simbolos.size()));
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        string_view nombre = simbolos.nombre(id);
+        e.u32(static_cast<uint32_t>(nombre.size()));
+        e.bytes(nombre.data(), nombre.size());
+        e.u32(static_cast<uint32_t>(tabla_simbolos[id]));
+        e.u8(seccion_simbolo[id]);
+        e.u8(ambito_simbolo[id]);
+    }
+    e.u32(static_cast<uint32_t>(referencias_pendientes.size()));
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        e.u32(ref.simbolo);
+        e.u8(ref.seccion);
+        e.u32(static_cast<uint32_t>(ref.posicion));
+        e.u8(static_cast<uint8_t>(ref.tamano_inmediato));
+        e.u8(static_cast<uint8_t>(ref.tipo_salto));
+    }
+    if (escribir_entrada_cache(dir_cache, clave, e.datos)) ++cache.guardadas;
+    else *salida_errores << "Advertencia: no se pudo escribir la cache en " << dir_cache << endl;
+}
+
+// false si no hay entrada o está dañada (entonces se ensambla normalmente)
+bool EnsambladorIA32::cargar_cache(const ClaveCache& clave) {
+    EntradaCache entrada;
+    if (!entrada.abrir(dir_cache, clave)) return false;
+    LectorCache l(entrada.contenido(), entrada.tamano_contenido());
+
+    reiniciar_estado();
+    primera_pasada = false;
+    relajacion = EstadisticasRelajacion();
+    bool ok = true;
+    for (SeccionEnsamblado& sec : secciones) {
+        uint32_t contador = 0, n = 0;
+        const uint8_t* bytes = nullptr;
+        ok = ok && l.u32(sec.base) && l.u32(sec.alineacion) && l.u32(contador) && l.u32(n) &&
+             l.bytes(n, bytes);
+        if (!ok) break;
+        sec.contador = static_cast<int>(contador);
+        sec.bytes.assign(bytes, bytes + n);
+    }
+
+    uint32_t num_simbolos = 0;
+    ok = ok && l.u32(num_simbolos);
+    for (uint32_t id = 0; ok && id < num_simbolos; ++id) {
+        uint32_t longitud = 0, desplazamiento = 0;
+        uint8_t seccion = 0, ambito = 0;
+        const uint8_t* nombre = nullptr;
+        ok = l.u32(longitud) && l.bytes(longitud, nombre) && l.u32(desplazamiento) &&
+             l.u8(seccion) && l.u8(ambito) && seccion < NUM_SECCIONES && ambito <= AMBITO_EXTERNO &&
+             id_simbolo(string_view(reinterpret_cast<const char*>(nombre), longitud)) == id;
+        if (!ok) break;
+        tabla_simbolos[id]  = static_cast<int>(desplazamiento);
+        seccion_simbolo[id] = seccion;
+        ambito_simbolo[id]  = ambito;
+    }
+
+    uint32_t num_referencias = 0;
+    ok = ok && l.u32(num_referencias);
+    if (ok) referencias_pendientes.resize(num_referencias);
+    for (ReferenciaPendiente& ref : referencias_pendientes) {
+        uint32_t posicion = 0;
+        uint8_t tamano = 0, tipo = 0;
+        ok = l.u32(ref.simbolo) && l.u8(ref.seccion) && l.u32(posicion) && l.u8(tamano) && l.u8(tipo) &&
+             ref.simbolo < num_simbolos && ref.seccion < NUM_SECCIONES &&
+             posicion + tamano <= secciones[ref.seccion].bytes.size();
+        if (!ok) break;
+        ref.posicion         = static_cast<int>(posicion);
+        ref.tamano_inmediato = tamano;
+        ref.tipo_salto       = tipo;
+    }
+
+    if (!ok || !l.terminado()) {
+        *salida_errores << "Advertencia: entrada de cache danada (" << clave.texto() << "), se ensambla" << endl;
+        reiniciar_estado();
+        return false;
+    }
+    armar_imagen();
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Ensamblado y generación de archivos
+// -----------------------------------------------------------------------------
+
+// Segundos transcurridos desde 'desde'; deja 'desde' en el instante actual
+static double medir(chrono::steady_clock::time_point& desde) {
+    auto ahora = chrono::steady_clock::now();
+    double s = chrono::duration<double>(ahora - desde).count();
+    desde = ahora;
+    return s;
+}
+
+void EnsambladorIA32::ensamblar(const string& archivo_entrada) {
+    // 1) Leer el archivo SOLO UNA VEZ
+    errores = 0;
+    tiempos = TiemposFases();
+    auto t = chrono::steady_clock::now();
+    bool leido = leer_fuente(archivo_entrada);
+    tiempos.lectura = medir(t);
+    if (!leido || fuente.num_lineas() == 0) {
+        // Sin restos del ensamblado anterior (el mismo objeto se reutiliza en --lote)
+        reiniciar_estado();
+        if (leido) *salida_errores << "No se leyo ninguna linea de " << archivo_entrada << endl;
+        else       ++errores;
+        return;
+    }
+
+    // Una sesión incremental necesita la IR: con ella no se usa la caché
+    if (dir_cache.empty() || con_indice_lineas) {
+        ensamblar_fuente();
+        return;
+    }
+    const ClaveCache clave = calcular_clave_cache(fuente.contenido(), opciones_cache());
+    const bool acierto = cargar_cache(clave);
+    tiempos.cache = medir(t);
+    if (acierto) {
+        ++cache.aciertos;
+        if (detallado) cout << "Cache: " << clave.texto() << " (sin pasadas)\n";
+        return;
+    }
+    ++cache.fallos;
+    ensamblar_fuente();
+    if (errores == 0) {
+        t = chrono::steady_clock::now();
+        guardar_cache(clave);
+        tiempos.cache += medir(t);
+    }
+}
+
+void EnsambladorIA32::ensamblar_texto(string_view codigo) {
+    errores = 0;
+    tiempos = TiemposFases();
+    auto t = chrono::steady_clock::now();
+    fuente.usar_texto(codigo);
+    tiempos.lectura = medir(t);
+    ensamblar_fuente();
+}
+
+// Como biblioteca no se escribe nada en cout (ostream sin buffer = descarta)
+static ostream& salida_pasadas(bool detallado) {
+    static ostream nulo(nullptr);
+    return detallado ? cout : nulo;
+}
+
+void EnsambladorIA32::ensamblar_fuente() {
+    ostream& salida = salida_pasadas(detallado);
+
+    // -----------------------------------------------------------------
+    // PASADA 1: solo construir tabla de símbolos y contar bytes
+    // (en modo una pasada también emite los bytes)
+    // -----------------------------------------------------------------
+    if (una_pasada) salida << "=== PASADA UNICA: emitiendo codigo y registrando referencias ===\n";
+    else            salida << "=== PASADA 1: construyendo tabla de simbolos ===\n";
+
+    auto t = chrono::steady_clock::now();
+    reiniciar_estado();
+
+    // Único recorrido del texto: cada línea queda en programa_ir. Con varios
+    // hilos el texto se reparte en bloques (la una pasada es secuencial)
+    const size_t bloques = una_pasada ? 1 : min<size_t>(hilos, fuente.num_lineas() / MIN_LINEAS_BLOQUE);
+    if (bloques > 1) {
+        pasada1_paralela(bloques);
+    } else {
+        if (!una_pasada) programa_ir.reserve(fuente.num_lineas());
+        if (con_indice_lineas) inicio_ir_linea.reserve(fuente.num_lineas() + 1);
+        for (size_t i = 0; i < fuente.num_lineas(); ++i) {
+            if (con_indice_lineas) inicio_ir_linea.push_back(static_cast<uint32_t>(programa_ir.size()));
+            linea_actual = i;
+            procesar_linea(fuente.linea(i));
+        }
+        if (con_indice_lineas) inicio_ir_linea.push_back(static_cast<uint32_t>(programa_ir.size()));
+        cambiar_seccion(SEC_TEXT);   // guarda el contador de la última sección
+    }
+    tiempos.pasada1 = medir(t);
+
+    terminar_ensamblado();
+}
+
+// La PASADA 1 ya dejó la IR (o, en una pasada, los bytes) y los símbolos;
+// de aquí al código final no importa si vino de texto o de ConstructorIA32
+void EnsambladorIA32::terminar_ensamblado() {
+    ostream& salida = salida_pasadas(detallado);
+
+    auto imprimir_tamanos = [this, &salida]() {
+        salida << total_bytes() << " (";
+        for (int s = 0; s < NUM_SECCIONES; ++s) {
+            salida << (s ? ", " : "") << secciones[s].nombre << " " << secciones[s].contador;
+        }
+        salida << ")\n";
+    };
+
+    // Una pasada: toda referencia hacia adelante quedó como hueco; se parchea aquí
+    auto t = chrono::steady_clock::now();
+    if (con_expresiones) fijar_inicios_seccion();
+    if (una_pasada) {
+        asignar_bases();
+        salida << "Resolviendo referencias pendientes...\n";
+        sustituir_equivalencias();
+        resolver_referencias_pendientes();
+        armar_imagen();
+        tiempos.resolucion = medir(t);
+        salida << "Fin PASADA UNICA. Bytes generados = ";
+        imprimir_tamanos();
+        return;
+    }
+
+    salida << "Fin PASADA 1. Bytes contados = ";
+    imprimir_tamanos();
+
+    // EQU y expresiones que ya son constantes: imm8 / disp8 donde quepan
+    if (con_expresiones) plegar_expresiones();
+
+    // -----------------------------------------------------------------
+    // -Os: forma más corta de cada instrucción (antes de fijar direcciones)
+    // -----------------------------------------------------------------
+    if (tamano_minimo) {
+        optimizar_tamano();
+        tiempos.optimizacion = medir(t);
+        salida << "Tamano minimo (-Os): " << optimizacion.bytes_ahorrados() << " bytes ahorrados (";
+        for (int r = 0; r < NUM_REGLAS_TAMANO; ++r) {
+            salida << (r ? ", " : "") << NOMBRES_REGLAS_TAMANO[r] << " " << optimizacion.bytes[r];
+        }
+        salida << ")\n";
+    }
+
+    // -----------------------------------------------------------------
+    // RELAJACIÓN: JMP/Jcc hacia adelante también pueden quedar en rel8
+    // -----------------------------------------------------------------
+    t = chrono::steady_clock::now();
+    if (alineacion_bucles != 0) alinear_bucles();
+    relajar_saltos();
+    tiempos.relajacion = medir(t);
+    if (alineacion_bucles != 0) {
+        salida << "Alineacion de bucles: " << bucles_alineados << " cabeceras a " << alineacion_bucles
+               << " bytes\n";
+    }
+    salida << "Relajacion de saltos: " << relajacion.saltos << " saltos, "
+         << relajacion.cortos << " cortos (rel8), " << relajacion.acortados
+         << " acortados, " << relajacion.bytes_ahorrados << " bytes ahorrados, "
+         << relajacion.iteraciones << " iteraciones\n";
+
+    // Con los tamaños definitivos ya se conocen las bases de cada sección
+    asignar_bases();
+    for (const SeccionEnsamblado& sec : secciones) {
+        salida << "Seccion " << sec.nombre << ": base 0x" << hex << sec.base << dec
+             << ", " << sec.contador << " bytes\n";
+    }
+    salida << "Simbolos encontrados:\n";
+    for (uint32_t id = 0; detallado && id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] == SIN_DIRECCION || simbolo_interno(id)) continue;
+        salida << "  " << simbolos.nombre(id) << " -> " << direccion_simbolo(id) << "\n";
+    }
+
+    // -----------------------------------------------------------------
+    // PASADA 2: generar el código máquina real
+    // -----------------------------------------------------------------
+    salida << "=== PASADA 2: generando codigo maquina ===\n";
+    t = chrono::steady_clock::now();
+
+    // Sin volver al texto: solo codificar la IR de la PASADA 1. Las
+    // referencias se registran aquí, con las posiciones ya relajadas
+    pasada2();
+    tiempos.pasada2 = medir(t);
+
+    // Después de generar los bytes en segunda pasada, resolvemos las referencias
+    salida << "Resolviendo referencias pendientes...\n";
+    sustituir_equivalencias();
+    resolver_referencias_pendientes();
+    armar_imagen();
+    tiempos.resolucion = medir(t);
+
+    salida << "Fin PASADA 2. Bytes generados = ";
+    imprimir_tamanos();
+}
+
+void EnsambladorIA32::generar_hex(const string& archivo_salida) {
+    auto t = chrono::steady_clock::now();
+    ofstream f(archivo_salida, ios::binary);
+    if (!f.is_open()) {
+        *salida_errores << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return;
+    }
+
+    // Mismo formato de siempre ("8B 0D ... " con 16 bytes por línea), pero
+    // armado en un solo buffer y escrito de una vez
+    static const char DIGITOS[] = "0123456789ABCDEF";
+    const size_t BYTES_POR_LINEA = 16;
+    MarcaArena marca(arena);
+    VectorArena<char> buffer{AsignadorArena<char>(arena)};
+    buffer.reserve(codigo_hex.size() * 3 + codigo_hex.size() / BYTES_POR_LINEA + 1);
+    for (size_t i = 0; i < codigo_hex.size(); ++i) {
+        buffer.push_back(DIGITOS[codigo_hex[i] >> 4]);
+        buffer.push_back(DIGITOS[codigo_hex[i] & 0x0F]);
+        buffer.push_back(' ');
+        if ((i + 1) % BYTES_POR_LINEA == 0) {
+            buffer.push_back('\n');
+        }
+    }
+    if (codigo_hex.size() % BYTES_POR_LINEA != 0) {
+        buffer.push_back('\n');
+    }
+
+    f.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+    f.close();
+    tiempos.hex = medir(t);
+}
+
+void EnsambladorIA32::generar_bin(const string& archivo_salida) {
+    auto t = chrono::steady_clock::now();
+    ofstream f(archivo_salida, ios::binary);
+    if (!f.is_open()) {
+        *salida_errores << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+        return;
+    }
+    f.write(reinterpret_cast<const char*>(codigo_hex.data()),
+            static_cast<streamsize>(codigo_hex.size()));
+    f.close();
+    tiempos.bin = medir(t);
+}
+
+// Objeto ELF32 ET_REL con .text, .data y .bss. En el ELF las etiquetas son
+// desplazamientos dentro de su sección, así que cada hueco ya resuelto se
+// reescribe sin la base:
+//   - relativa dentro de la misma sección: no necesita reubicación
+//   - absoluta: R_386_32 contra la sección de la etiqueta (hueco = desp. + sumando)
+//   - relativa a otra sección: R_386_PC32 contra esa sección
+// Las etiquetas no definidas pasan a símbolos externos.
+void EnsambladorIA32::generar_elf(const string& archivo_salida) {
+    auto t = chrono::steady_clock::now();
+    static const uint32_t BANDERAS[NUM_SECCIONES] = {
+        SHF_ALLOC | SHF_EXECINSTR, SHF_ALLOC | SHF_WRITE, SHF_ALLOC | SHF_WRITE
+    };
+    static const uint32_t ALINEACION[NUM_SECCIONES] = { 16, 4, 4 };
+
+    MarcaArena marca(arena);
+    const AsignadorArena<uint8_t> asignador(arena);
+    VectorArena<uint8_t> copia[NUM_SECCIONES] = { VectorArena<uint8_t>(asignador), VectorArena<uint8_t>(asignador),
+                                                 VectorArena<uint8_t>(asignador) };
+    VectorArena<ReubicacionELF> reubicaciones_seccion[NUM_SECCIONES] = {
+        VectorArena<ReubicacionELF>(asignador), VectorArena<ReubicacionELF>(asignador),
+        VectorArena<ReubicacionELF>(asignador)
+    };
+    SeccionELF secciones_elf[NUM_SECCIONES];
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        copia[s].assign(secciones[s].bytes.begin(), secciones[s].bytes.end());
+        secciones_elf[s].nombre     = secciones[s].nombre;
+        secciones_elf[s].banderas   = BANDERAS[s];
+        secciones_elf[s].alineacion = max(ALINEACION[s], secciones[s].alineacion);
+        secciones_elf[s].sin_bits   = (s == SEC_BSS);
+    }
+
+    // Símbolos: definidos (locales o GLOBAL) y los externos que se usan
+    VectorArena<uint32_t> indice_elf(tabla_simbolos.size(), SIN_SIMBOLO, asignador);
+    VectorArena<SimboloELF> simbolos_elf(asignador);
+    auto exportar = [&](uint32_t id) {
+        if (indice_elf[id] != SIN_SIMBOLO) return indice_elf[id];
+        bool definido = tabla_simbolos[id] != SIN_DIRECCION;
+        SimboloELF s;
+        s.nombre  = simbolos.nombre(id);
+        s.valor   = definido ? static_cast<uint32_t>(tabla_simbolos[id]) : 0;
+        s.seccion = definido ? static_cast<uint16_t>(seccion_simbolo[id] + 1) : 0;
+        s.global  = !definido || ambito_simbolo[id] != AMBITO_LOCAL;
+        indice_elf[id] = static_cast<uint32_t>(simbolos_elf.size());
+        simbolos_elf.push_back(s);
+        return indice_elf[id];
+    };
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (simbolo_interno(id)) continue;   // '$', '$$' y expresiones: solo la reubicación de su sección
+        if (tabla_simbolos[id] != SIN_DIRECCION || ambito_simbolo[id] != AMBITO_LOCAL) exportar(id);
+    }
+
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        const uint32_t pos = static_cast<uint32_t>(ref.posicion);
+        uint8_t* hueco = copia[ref.seccion].data() + pos;
+        VectorArena<ReubicacionELF>& reubicaciones = reubicaciones_seccion[ref.seccion];
+        bool definido = tabla_simbolos[ref.simbolo] != SIN_DIRECCION;
+
+        if (definido) {
+            uint8_t destino = seccion_simbolo[ref.simbolo];
+            uint32_t base_destino = secciones[destino].base;
+            if (ref.tipo_salto == 0) {
+                escribir_le32(hueco, leer_le32(hueco) - base_destino);
+                reubicaciones.push_back(ReubicacionELF{pos, destino, REUB_32, true});
+            } else if (destino != ref.seccion) {
+                if (ref.tamano_inmediato != 4) {
+                    ++errores;
+                    *salida_errores << "Error: salto de 8 bits a '" << simbolos.nombre(ref.simbolo) << "' en otra seccion ("
+                         << secciones[destino].nombre << ") no se puede reubicar" << endl;
+                    continue;
+                }
+                // A = desplazamiento + sumando - 4 (el hueco tenía destino - siguiente)
+                escribir_le32(hueco, leer_le32(hueco) - base_destino + secciones[ref.seccion].base + pos);
+                reubicaciones.push_back(ReubicacionELF{pos, destino, REUB_PC32, true});
+            }
+            continue;
+        }
+
+        if (ref.tamano_inmediato != 4) {
+            ++errores;
+            *salida_errores << "Error: salto de 8 bits a simbolo externo '" << simbolos.nombre(ref.simbolo)
+                 << "' no se puede reubicar" << endl;
+            continue;
+        }
+        uint32_t sym = exportar(ref.simbolo);
+        if (ref.tipo_salto == 0) {
+            reubicaciones.push_back(ReubicacionELF{pos, sym, REUB_32, false});
+        } else {
+            // R_386_PC32 = S + A - P, con P = inicio del hueco: A = sumando - 4
+            escribir_le32(hueco, leer_le32(hueco) - 4);
+            reubicaciones.push_back(ReubicacionELF{pos, sym, REUB_PC32, false});
+        }
+    }
+
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        secciones_elf[s].datos  = copia[s].data();
+        secciones_elf[s].tamano = static_cast<uint32_t>(secciones[s].contador);
+        secciones_elf[s].reubicaciones     = reubicaciones_seccion[s].data();
+        secciones_elf[s].num_reubicaciones = static_cast<uint32_t>(reubicaciones_seccion[s].size());
+    }
+    if (!escribir_elf32_rel(archivo_salida, secciones_elf, NUM_SECCIONES,
+                            simbolos_elf.data(), simbolos_elf.size(), arena)) {
+        *salida_errores << "No se pudo abrir archivo de salida: " << archivo_salida << endl;
+    }
+    tiempos.elf = medir(t);
+}
+
+void EnsambladorIA32::generar_reportes() {
+    auto t = chrono::steady_clock::now();
+    ofstream sym("simbolos.txt");
+    sym << "Tabla de Simbolos:\n";
+    for (uint32_t id = 0; id < tabla_simbolos.size(); ++id) {
+        if (tabla_simbolos[id] == SIN_DIRECCION || simbolo_interno(id)) continue;
+        sym << simbolos.nombre(id) << " -> " << direccion_simbolo(id) << '\n';
+    }
+    sym.close();
+
+    ofstream refs("referencias.txt");
+    refs << "Tabla de Referencias Pendientes:\n";
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        refs << "Etiqueta: " << simbolos.nombre(ref.simbolo)
+            << ", Seccion: " << secciones[ref.seccion].nombre
+            << ", Posicion: " << ref.posicion
+            << ", Tamano: " << ref.tamano_inmediato
+            << ", Tipo: " << (ref.tipo_salto == 0 ? "ABSOLUTO" : "RELATIVO")
+            << '\n';
+    }
+    refs.close();
+    tiempos.reportes = medir(t);
+}
+
+// Objeto JSON de una sola línea (los mnemónicos no necesitan escaparse)
+void EnsambladorIA32::generar_estadisticas(ostream& salida) const {
+    const TiemposFases& t = tiempos;
+    const ios::fmtflags formato = salida.flags();
+    const streamsize precision  = salida.precision();
+    salida << fixed << setprecision(6)
+           << "{\"modo\":\"" << (una_pasada ? "una_pasada" : "dos_pasadas") << "\""
+           << ",\"lineas\":" << fuente.num_lineas()
+           << ",\"errores\":" << errores
+           << ",\"tiempos\":{\"leer_fuente\":" << t.lectura
+           << ",\"pasada1\":" << t.pasada1
+           << ",\"optimizacion\":" << t.optimizacion
+           << ",\"relajacion\":" << t.relajacion
+           << ",\"pasada2\":" << t.pasada2
+           << ",\"resolver_referencias\":" << t.resolucion
+           << ",\"generar_hex\":" << t.hex
+           << ",\"generar_bin\":" << t.bin
+           << ",\"generar_elf\":" << t.elf
+           << ",\"generar_reportes\":" << t.reportes
+           << ",\"cache\":" << t.cache << "}";
+    salida << ",\"cache\":{\"aciertos\":" << cache.aciertos
+           << ",\"fallos\":" << cache.fallos
+           << ",\"guardadas\":" << cache.guardadas << "}";
+
+    // Arena desde el último ensamblado: reservas, máximo ocupado a la vez y
+    // bloques pedidos al sistema (0 cuando se reutiliza la del anterior)
+    salida << ",\"arena\":{\"reservas\":" << arena.reservas()
+           << ",\"pico\":" << arena.pico()
+           << ",\"bloques_nuevos\":" << arena.bloques_pedidos()
+           << ",\"capacidad\":" << arena.capacidad() << "}";
+
+    salida << ",\"secciones\":{";
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        salida << (s ? "," : "") << "\"" << secciones[s].nombre << "\":" << secciones[s].contador;
+    }
+    salida << "}";
+
+    // Filas de un mismo mnemónico van juntas en TABLA_OPCODES
+    uint64_t instrucciones = 0;
+    salida << ",\"instrucciones_por_mnemonico\":{";
+    bool primero = true;
+    for (size_t i = 0; i < contadores.por_fila.size();) {
+        string_view mnem = TABLA_OPCODES[i].mnem;
+        uint64_t total = 0;
+        for (; i < contadores.por_fila.size() && TABLA_OPCODES[i].mnem == mnem; ++i) {
+            total += contadores.por_fila[i];
+        }
+        instrucciones += total;
+        if (total == 0) continue;
+        salida << (primero ? "" : ",") << "\"" << mnem << "\":" << total;
+        primero = false;
+    }
+    salida << "},\"instrucciones\":" << instrucciones;
+
+    salida << ",\"bytes_por_manejador\":{\"procesar_instruccion\":" << contadores.bytes_instruccion
+           << ",\"procesar_datos\":" << contadores.bytes_datos
+           << ",\"procesar_reserva\":" << contadores.bytes_reserva
+           << ",\"procesar_alineacion\":" << contadores.bytes_alineacion << "}";
+    salida << ",\"alineacion_bucles\":{\"alineacion\":" << (una_pasada ? 0 : alineacion_bucles)
+           << ",\"cabeceras\":" << bucles_alineados << "}";
+
+    // Referencias por tipo_salto (0 = absoluta, 1 = relativa) y tamaño del hueco
+    uint64_t refs[2][2] = {};
+    for (const ReferenciaPendiente& ref : referencias_pendientes) {
+        refs[ref.tipo_salto != 0][ref.tamano_inmediato == 4]++;
+    }
+    salida << ",\"referencias\":{\"total\":" << referencias_pendientes.size()
+           << ",\"absolutas_8\":" << refs[0][0] << ",\"absolutas_32\":" << refs[0][1]
+           << ",\"relativas_8\":" << refs[1][0] << ",\"relativas_32\":" << refs[1][1] << "}";
+
+    salida << ",\"relajacion\":{\"saltos\":" << relajacion.saltos
+           << ",\"cortos\":" << relajacion.cortos
+           << ",\"acortados\":" << relajacion.acortados
+           << ",\"iteraciones\":" << relajacion.iteraciones
+           << ",\"bytes_ahorrados\":" << relajacion.bytes_ahorrados << "}";
+
+    // -Os: instrucciones cambiadas y bytes ahorrados por regla
+    salida << ",\"tamano_minimo\":{\"activo\":" << (tamano_minimo && !una_pasada ? "true" : "false")
+           << ",\"bytes_ahorrados\":" << optimizacion.bytes_ahorrados() << ",\"reglas\":{";
+    for (int r = 0; r < NUM_REGLAS_TAMANO; ++r) {
+        salida << (r ? "," : "") << "\"" << NOMBRES_REGLAS_TAMANO[r] << "\":{\"instrucciones\":"
+               << optimizacion.instrucciones[r] << ",\"bytes\":" << optimizacion.bytes[r] << "}";
+    }
+    salida << "}}";
+
+    size_t casillas_opcodes = 0;
+    for (const RangoFilas& c : TABLA_HASH_OPCODES.casillas) casillas_opcodes += (c.cantidad != 0);
+    const size_t capacidad = simbolos.capacidad();
+    salida << ",\"tablas_hash\":{\"simbolos\":{\"entradas\":" << simbolos.size()
+           << ",\"casillas\":" << capacidad
+           << ",\"carga\":" << (capacidad ? double(simbolos.size()) / capacidad : 0.0)
+           << ",\"sondeo_maximo\":" << simbolos.sondeo_maximo() << "}"
+           << ",\"opcodes\":{\"entradas\":" << casillas_opcodes
+           << ",\"casillas\":" << TAM_HASH
+           << ",\"carga\":" << double(casillas_opcodes) / TAM_HASH << "}}";
+    salida << "}\n";
+    salida.flags(formato);
+    salida.precision(precision);
+}
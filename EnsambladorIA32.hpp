@@ -1,140 +1,395 @@
-#ifndef ENSAMBLADOR_IA32_HPP
-#define ENSAMBLADOR_IA32_HPP
-
-#include <iostream>
-#include <fstream>
-#include <sstream>
-#include <string>
-#include <vector>
-#include <unordered_map>
-#include <algorithm>
-#include <iomanip>
-#include <cstdint>
-
-using namespace std;
-
-// --- ESTRUCTURAS DE DATOS ---
-struct ReferenciaPendiente {
-    int posicion;          // Posición en codigo_hex donde va el parche
-    int tamano_inmediato;  // 1 o 4 (byte o dword)
-    int tipo_salto;        // 0 = absoluto, 1 = relativo
-};
-
-class EnsambladorIA32 {
-public:
-    // Constructor
-    EnsambladorIA32();
-
-    // Ensamblado en dos pasadas
-    void ensamblar(const string& archivo_entrada);
-
-    // Resolver referencias (relativas/absolutas)
-    void resolver_referencias_pendientes();
-
-    // Generar código máquina en hexadecimal
-    void generar_hex(const string& archivo_salida);
-
-    // Generar reportes de tablas
-    void generar_reportes();
-
-private:
-    // --- ESTADO DEL ENSAMBLADOR ---
-    int contador_posicion;           // Location Counter
-    bool primera_pasada;             // true = 1ª pasada, false = 2ª pasada
-    vector<string> lineas_fuente;    // Líneas crudas del programa.asm
-
-    // Tablas de ensamblado
-    unordered_map<string, int> tabla_simbolos; 
-    unordered_map<string, vector<ReferenciaPendiente>> referencias_pendientes;
-    vector<uint8_t> codigo_hex;     
-
-    // Mapas para codificación de registros
-    unordered_map<string, uint8_t> reg32_map; 
-    unordered_map<string, uint8_t> reg8_map;  
-
-    // --- FUNCIONES DE SOPORTE ---
-    void inicializar_mapas();
-    void leer_fuente(const string& archivo);     // Lee archivo a lineas_fuente
-    void limpiar_linea(string& linea);
-    bool es_etiqueta(const string& s);
-    void procesar_etiqueta(const string& etiqueta_cruda);
-    void procesar_linea(string linea);
-    void procesar_instruccion(const string& linea);
-
-    // Separar "dest, src"
-    bool separar_operandos(const string& linea_operandos,
-                           string& dest_str,
-                           string& src_str);
-
-    // [LABEL] simple (sin +, sin registros)
-    bool is_mem_simple_label(const string& op);
-
-    // --- UTILIDADES DE CODIFICACIÓN ---
-    uint8_t generar_modrm(uint8_t mod, uint8_t reg, uint8_t rm);
-    void agregar_byte(uint8_t byte);
-    void agregar_dword(uint32_t dword);
-
-    bool obtener_reg32(const string& op, uint8_t& reg_code);
-    bool obtener_reg8(const string& op, uint8_t& reg_code);
-    bool obtener_inmediato32(const string& str, uint32_t& immediate);
-
-    // Direccionamientos de memoria
-    bool procesar_mem_simple(const string& operando,
-                             uint8_t& modrm_byte,
-                             const uint8_t reg_code,
-                             bool es_destino,
-                             uint8_t op_extension = 0);
-
-    bool procesar_mem_sib(const string& operando,
-                          uint8_t& modrm_byte,
-                          const uint8_t reg_code,
-                          bool es_destino);
-
-    bool procesar_mem_disp(const string& operando,
-                           uint8_t& modrm_byte,
-                           const uint8_t reg_code,
-                           bool es_destino);
-
-    // --- FUNCIONES DE PROCESAMIENTO DE INSTRUCCIONES ---
-    void procesar_mov(const string& operandos);
-    void procesar_add(const string& operandos);
-    void procesar_sub(const string& operandos);
-    void procesar_cmp(const string& operandos);
-    void procesar_imul(const string& operandos);
-    void procesar_inc(const string& operandos);
-    void procesar_dec(const string& operandos);
-    void procesar_mul(const string& operandos);
-    void procesar_div(const string& operandos);
-    void procesar_idiv(const string& operandos);
-    void procesar_xor(const string& operandos);
-    void procesar_and(const string& operandos);
-    void procesar_or(const string& operandos);
-    void procesar_test(const string& operandos);
-    void procesar_movzx(const string& operandos);
-    void procesar_xchg(const string& operandos);
-    void procesar_lea(const string& operandos);
-    void procesar_call(const string& operandos);
-    void procesar_loop(const string& operandos);
-    void procesar_push(const string& operandos);
-    void procesar_pop(const string& operandos);
-    void procesar_leave();
-    void procesar_ret();
-    void procesar_nop();
-    void procesar_jmp(const string& operandos);
-    void procesar_condicional(const string& mnem, const string& operandos);
-
-    // Binaria genérica: ADD / SUB / CMP / AND / OR / XOR
-    void procesar_binaria(const string& mnem,
-                          const string& operandos,
-                          uint8_t opcode_rm_reg,
-                          uint8_t opcode_reg_rm,
-                          uint8_t opcode_eax_imm,
-                          uint8_t opcode_imm_general,
-                          uint8_t reg_field_extension);
-};
-
-#endif // ENSAMBLADOR_IA32_HPP
-
-
-
-
+#ifndef ENSAMBLADOR_IA32_HPP
+#define ENSAMBLADOR_IA32_HPP
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include <iomanip>
+#include <cstdint>
+#include <string_view>
+#include <chrono>
+
+#include "TablaOpcodes.hpp"
+#include "AnalizadorLexico.hpp"
+#include "CodificacionIA32.hpp"
+#include "ArchivoFuente.hpp"
+#include "RepresentacionIntermedia.hpp"
+#include "InternadorSimbolos.hpp"
+#include "EscritorELF.hpp"
+#include "CacheEnsamblado.hpp"
+#include "ArenaEnsamblado.hpp"
+
+using namespace std;
+
+// Dirección de una etiqueta aún no definida
+inline constexpr int SIN_DIRECCION = -1;
+
+// Visibilidad de un símbolo en el objeto ELF
+enum AmbitoSimbolo : uint8_t {
+    AMBITO_LOCAL,      // etiqueta propia del archivo
+    AMBITO_GLOBAL,     // GLOBAL nombre
+    AMBITO_EXTERNO     // EXTERN nombre (se resuelve al enlazar)
+};
+
+// --- ESTRUCTURAS DE DATOS ---
+struct ReferenciaPendiente {
+    uint32_t simbolo;      // id de la etiqueta referida
+    uint8_t seccion;       // IdSeccion donde está el hueco
+    int posicion;          // Posición dentro de esa sección donde va el parche
+    int tamano_inmediato;  // 1 o 4 (byte o dword)
+    int tipo_salto;        // 0 = absoluto, 1 = relativo
+};
+
+// "NOMBRE EQU expresion": el valor se evalúa al leer la línea con lo que ya
+// se conoce; las etiquetas (y los EQU de más abajo) quedan como símbolos y
+// se resuelven con la disposición final. Los inmediatos y [..] que nombran
+// un EQU llevan una referencia a él, como a una etiqueta
+struct Equivalencia {
+    uint32_t simbolo;          // id del nombre
+    ValorExpresion valor;
+    bool sembrada = false;     // trabajador: viene de un bloque anterior (no se fusiona)
+};
+
+inline constexpr uint32_t SIN_EQU = 0xFFFFFFFFu;
+
+// "(fin - tabla) / 4": una operación con etiquetas que da una constante
+// cuando se conoce la disposición. Los operandos pueden nombrar EQU y otras
+// diferidas; calcular_diferidas() deja el resultado (o el motivo) aquí
+struct ExpresionDiferida {
+    TipoToken op;
+    ValorExpresion a, b;
+    bool calculada = false;
+    uint32_t valor = 0;
+    const char* error = "expresion sin calcular";   // por qué no se pudo calcular
+};
+
+// Resultado de la relajación de saltos (entre la PASADA 1 y la PASADA 2)
+struct EstadisticasRelajacion {
+    int saltos      = 0;   // JMP/Jcc analizados
+    int cortos      = 0;   // quedaron en rel8
+    int acortados   = 0;   // eran rel32 en la PASADA 1 y pasaron a rel8
+    int iteraciones = 0;   // recorridos hasta converger
+    int bytes_ahorrados = 0;
+};
+
+// Reglas de -Os (usar_tamano_minimo): cada instrucción pasa a la
+// codificación equivalente más corta. Las que cambian el mnemónico solo se
+// aplican si las banderas que dejan quedan muertas (ver banderas_muertas)
+enum ReglaTamano : uint8_t {
+    REGLA_MOV_CERO,      // MOV r32, 0          -> XOR r32, r32
+    REGLA_MOV_AND_OR,    // MOV r/m32, 0 / -1   -> AND / OR r/m32, imm8
+    REGLA_INC_DEC,       // ADD / SUB r/m32, ±1 -> INC / DEC r/m32
+    REGLA_CMP_TEST,      // CMP r32, 0          -> TEST r32, r32 (mismas banderas)
+    REGLA_INMEDIATO_8,   // otra fila del mnemónico con imm8 (ADD EAX, 5 -> 83; PUSH 5 -> 6A)
+    REGLA_MOFFS,         // MOV EAX, [dirección] -> A1
+    REGLA_OTRA_FORMA,    // cualquier otra fila más corta del mismo mnemónico
+    NUM_REGLAS_TAMANO
+};
+
+inline constexpr const char* NOMBRES_REGLAS_TAMANO[NUM_REGLAS_TAMANO] = {
+    "mov_cero", "mov_and_or", "inc_dec", "cmp_test", "inmediato_8", "moffs", "otra_forma"
+};
+
+struct EstadisticasTamano {
+    uint32_t instrucciones[NUM_REGLAS_TAMANO] = {};
+    uint32_t bytes[NUM_REGLAS_TAMANO] = {};   // ahorrados por la regla
+    uint32_t bytes_ahorrados() const {
+        uint32_t total = 0;
+        for (uint32_t b : bytes) total += b;
+        return total;
+    }
+};
+
+// Tiempo de cada fase del último ensamblado, en segundos (0 si no se hizo)
+struct TiemposFases {
+    double lectura    = 0;   // mmap + índice de líneas
+    double pasada1    = 0;   // texto -> IR (en una pasada también emite bytes)
+    double optimizacion = 0; // -Os (antes de la relajación)
+    double relajacion = 0;   // JMP/Jcc rel8 / rel32
+    double pasada2    = 0;   // IR -> bytes
+    double resolucion = 0;   // parcheo de referencias + imagen plana
+    double hex        = 0;   // generar_hex
+    double bin        = 0;   // generar_bin
+    double elf        = 0;   // generar_elf
+    double reportes   = 0;   // generar_reportes
+    double cache      = 0;   // clave + cargar la entrada (o guardarla tras ensamblar)
+};
+
+// Uso de la caché en disco (usar_cache); se acumula entre ensamblados
+struct EstadisticasCache {
+    uint64_t aciertos  = 0;   // salida cargada de la caché, sin pasadas
+    uint64_t fallos    = 0;   // se ensambló (y se guardó si no hubo errores)
+    uint64_t guardadas = 0;
+};
+
+// Contadores de --stats: solo se llenan con usar_estadisticas(true), en la
+// pasada que emite los bytes
+struct ContadoresEnsamblado {
+    vector<uint32_t> por_fila;        // instrucciones por fila de TABLA_OPCODES
+    uint64_t bytes_instruccion = 0;   // procesar_instruccion
+    uint64_t bytes_datos       = 0;   // procesar_datos (DD/DB)
+    uint64_t bytes_reserva     = 0;   // procesar_reserva (RESB/RESW/RESD)
+    uint64_t bytes_alineacion  = 0;   // relleno de ALIGN y de --alinear-bucles
+};
+
+// Sección en construcción: bytes, contador de posición y dirección de carga
+struct SeccionEnsamblado {
+    const char* nombre = "";
+    vector<uint8_t> bytes;     // vacío en .bss
+    int contador = 0;          // location counter propio (= tamaño al terminar)
+    uint32_t base = 0;         // dirección de la sección
+    bool base_fija = false;    // false = va a continuación de la anterior
+    uint32_t alineacion = 1;   // el mayor de sus ALIGN: la base y el ELF se alinean a él
+};
+
+class EnsambladorIA32 {
+    friend class SesionEnsamblado;       // edición incremental sobre la IR ya ensamblada
+    friend class AnalizadorRendimiento;  // bloques básicos y bucles sobre la IR (solo lectura)
+    friend class EmuladorIA32;           // secciones y etiquetas de .text para ejecutar el programa
+    friend class ConstructorIA32;        // PASADA 1 desde llamadas en lugar de texto
+
+public:
+    // Constructor
+    EnsambladorIA32();
+
+    // Ensamblado en dos pasadas (o en una, ver usar_una_pasada)
+    void ensamblar(const string& archivo_entrada);
+
+    // Igual, pero el fuente es un texto en memoria (sin archivo)
+    void ensamblar_texto(string_view codigo);
+
+    // Errores del último ensamblado (incluye mnemónicos no soportados y
+    // etiquetas no definidas que no son EXTERN)
+    int num_errores() const { return errores; }
+
+    // false = sin mensajes de progreso en cout (uso como biblioteca)
+    void usar_salida_detallada(bool activar) { detallado = activar; }
+
+    // Dónde van errores y advertencias (por omisión cerr)
+    void usar_salida_errores(ostream& salida) { salida_errores = &salida; }
+
+    // Modo de una pasada: emite bytes al analizar y parchea todo al final
+    void usar_una_pasada(bool activar) { una_pasada = activar; }
+
+    // -Os: entre la PASADA 1 y la relajación cada instrucción toma su
+    // codificación equivalente más corta (ver ReglaTamano). Sin efecto en
+    // una pasada: los bytes ya se emitieron al analizar
+    void usar_tamano_minimo(bool activar) { tamano_minimo = activar; }
+
+    // Alinea a 'alineacion' bytes (potencia de 2; 0 = no) cada etiqueta a
+    // la que vuelve un JMP/Jcc/LOOP posterior, como un ALIGN con NOP de
+    // hasta alineacion / 2 - 1 bytes. Sin efecto en una pasada
+    void usar_alinear_bucles(uint32_t alineacion) { alineacion_bucles = alineacion; }
+
+    // Hilos para las pasadas y la resolución (0 = todos los núcleos). La
+    // salida es idéntica a la de un hilo; en una pasada se ignora.
+    void usar_hilos(unsigned n);
+
+    // Caché en disco para ensamblar(archivo): con el mismo fuente y las
+    // mismas opciones se cargan bytes, símbolos y referencias sin ninguna
+    // pasada. Solo se guardan ensamblados sin errores ni advertencias. "" = sin caché
+    void usar_cache(const string& directorio) { dir_cache = directorio; }
+    const EstadisticasCache& estadisticas_cache() const { return cache; }
+
+    // Dirección de carga de una sección (por omisión: .text en 0 y las
+    // demás a continuación, alineadas a 4)
+    void fijar_base(IdSeccion seccion, uint32_t base);
+
+    // Mueve el programa ya resuelto a nuevas bases: corrige las referencias
+    // absolutas (y las relativas entre secciones) sin volver a ensamblar
+    void reubicar(const uint32_t (&bases)[NUM_SECCIONES]);
+
+    // Resultado por sección y búsqueda de etiquetas (dirección absoluta)
+    const vector<uint8_t>& bytes_seccion(IdSeccion seccion) const { return secciones[seccion].bytes; }
+    uint32_t tamano_seccion(IdSeccion seccion) const { return static_cast<uint32_t>(secciones[seccion].contador); }
+    bool buscar_simbolo(string_view nombre, uint32_t& direccion) const;
+
+    // Resolver referencias (relativas/absolutas)
+    void resolver_referencias_pendientes();
+
+    // Generar código máquina en hexadecimal
+    void generar_hex(const string& archivo_salida);
+
+    // Imagen plana (.bin) y objeto reubicable ELF32 para ld -m elf_i386
+    void generar_bin(const string& archivo_salida);
+    void generar_elf(const string& archivo_salida);
+
+    // Generar reportes de tablas
+    void generar_reportes();
+
+    // Estadísticas de la última relajación de saltos
+    const EstadisticasRelajacion& estadisticas_relajacion() const { return relajacion; }
+
+    // Instrucciones y bytes ahorrados por cada regla de -Os en el último ensamblado
+    const EstadisticasTamano& estadisticas_tamano() const { return optimizacion; }
+
+    // Tiempos por fase del último ensamblado y de cada generar_*
+    const TiemposFases& tiempos_fases() const { return tiempos; }
+
+    // Contadores por mnemónico / manejador (--stats); cuestan un incremento por línea
+    void usar_estadisticas(bool activar) { con_estadisticas = activar; }
+
+    // Tiempos, contadores, referencias por tipo y tamaño y carga de las
+    // tablas hash del último ensamblado, como un objeto JSON
+    void generar_estadisticas(ostream& salida) const;
+    size_t num_lineas() const { return fuente.num_lineas(); }
+
+private:
+    // --- ESTADO DEL ENSAMBLADOR ---
+    int contador_posicion;           // Location Counter de la sección actual
+    uint8_t seccion_actual;          // IdSeccion en la que se emite
+    bool primera_pasada;             // true = 1ª pasada, false = 2ª pasada
+    bool una_pasada;                 // true = la 1ª pasada ya emite los bytes (sin 2ª)
+    bool detallado;                  // true = progreso y símbolos en cout
+    bool con_estadisticas;           // true = llenar contadores (--stats)
+    bool tamano_minimo;              // true = -Os antes de la relajación
+    uint32_t alineacion_bucles;      // --alinear-bucles (0 = no)
+    uint32_t bucles_alineados;       // cabeceras de bucle alineadas en el último ensamblado
+    unsigned hilos;                  // hilos para los bloques (1 = secuencial)
+    int errores;                     // errores del último ensamblado
+    ostream* salida_errores;         // cerr; en un trabajador, su propio buffer
+    ArchivoFuente fuente;            // programa.asm mapeado + índice de líneas
+    string dir_cache;                // "" = sin caché
+    EstadisticasCache cache;
+    ArenaEnsamblado arena;           // auxiliares de resolución y generar_*; se vacía en reiniciar_estado()
+
+    // Tablas de ensamblado (indexadas por id de símbolo)
+    InternadorSimbolos simbolos;                       // nombre <-> id
+    vector<int> tabla_simbolos;                        // id -> desplazamiento en su sección, SIN_DIRECCION si no definida
+    vector<uint8_t> seccion_simbolo;                   // id -> IdSeccion de la etiqueta
+    vector<uint8_t> ambito_simbolo;                    // id -> AmbitoSimbolo
+    vector<uint32_t> equ_simbolo;                      // id -> índice en equivalencias, SIN_EQU si no es un EQU
+    vector<Equivalencia> equivalencias;                // EQU en orden de definición (también los ocultos)
+    vector<ExpresionDiferida> diferidas;               // ValorExpresion::diferida -> operación
+    vector<ReferenciaPendiente> referencias_pendientes; // huecos a parchear, en orden de emisión
+    SeccionEnsamblado secciones[NUM_SECCIONES];
+    vector<uint8_t> codigo_hex;                        // imagen plana: .text y .data en sus direcciones
+    uint8_t* destino[NUM_SECCIONES] = {};              // PASADA 2: buffer de cada sección ya dimensionado
+
+    // Representación intermedia: la PASADA 1 la llena, la PASADA 2 la codifica
+    vector<InstruccionIR> programa_ir;
+    vector<uint32_t> datos_ir;                   // valores de DD/DB
+    bool con_indice_lineas = false;              // llenar inicio_ir_linea (SesionEnsamblado)
+    vector<uint32_t> inicio_ir_linea;            // línea -> primera entrada de programa_ir (+ total al final)
+    const vector<uint32_t>* datos_codificar = nullptr;   // trabajador: datos_ir del principal
+    bool con_expresiones = false;                // hubo EQU (también ocultos) o '$' (SesionEnsamblado reensambla)
+
+    EstadisticasRelajacion relajacion;
+    EstadisticasTamano optimizacion;
+    TiemposFases tiempos;
+    ContadoresEnsamblado contadores;
+
+    // Tokens de la línea en proceso (arreglo fijo, se reutiliza)
+    LineaLexica linea_lexica;
+
+    // Símbolos ocultos (con un espacio: no pueden salir del texto). '$' es la
+    // etiqueta "$ <línea>", '$$' la etiqueta "$$ <sección>" en la posición 0
+    // y un inmediato o [..] con una expresión no constante, el EQU
+    // "= <línea> <n>". La línea es la del fuente: igual con varios hilos
+    size_t linea_actual = 0;
+    uint32_t simbolo_dolar = SIN_SIMBOLO;        // '$' de la línea en proceso
+    uint32_t ocultos_linea = 0;                  // EQU ocultos de la línea en proceso
+
+    // --- FUNCIONES DE SOPORTE ---
+    bool leer_fuente(const string& archivo);     // Mapea el archivo en fuente
+    void ensamblar_fuente();                     // Pasadas sobre fuente ya cargado
+    void terminar_ensamblado();                  // lo que sigue a la PASADA 1: -Os, relajación, PASADA 2...
+    uint32_t id_simbolo(string_view texto);      // Internar nombre y asegurar su casilla
+    void procesar_etiqueta(uint32_t simbolo);
+    void procesar_linea(string_view linea);
+    void procesar_instruccion(const Token* tokens, size_t num_tokens);
+    void procesar_datos(int tamano, const Token* tokens, size_t num_tokens);
+    void procesar_ambito(AmbitoSimbolo ambito, const Token* tokens, size_t num_tokens);
+    void procesar_seccion(const Token* tokens, size_t num_tokens);
+    void procesar_reserva(int tamano, const Token* tokens, size_t num_tokens);
+    void procesar_alineacion(const Token* tokens, size_t num_tokens);
+    void procesar_equ(const Token& nombre, const Token* tokens, size_t num_tokens);
+    void agregar_ir(InstruccionIR& ir);          // Cuenta bytes y guarda en programa_ir
+    void relajar_saltos();                       // JMP/Jcc: rel8 donde quepa (sobre la IR)
+    int destino_salto(uint32_t simbolo, uint8_t& seccion) const;   // etiqueta o EQU = etiqueta + k
+    void alinear_bucles();                       // IR_ALINEACION antes de cada destino de un salto hacia atrás
+    void optimizar_tamano();                     // -Os sobre la IR, antes de relajar_saltos()
+    bool banderas_muertas(size_t i) const;       // nadie lee EFLAGS tras programa_ir[i]
+    bool forma_mas_corta(InstruccionIR& ir, string_view mnem, uint8_t tam_mem);
+    int medir_ir(const InstruccionIR& ir);       // bytes de ir sin emitir nada
+    void contar(const InstruccionIR& ir, int bytes);  // --stats
+    void reiniciar_estado();                     // tablas vacías antes de la PASADA 1
+
+    // --- EQU Y EXPRESIONES (ExpresionIA32.hpp) ---
+    static constexpr int MAX_ANIDAMIENTO_EQU = 64;
+    struct ResolverExpresion;                    // identificadores de evaluar_expresion()
+    const char* valor_simbolo(string_view nombre, ValorExpresion& v);
+    bool evaluar_constante(const Token* tokens, size_t num_tokens, uint32_t& valor, const char* contexto);
+    void definir_equ(uint32_t simbolo, const ValorExpresion& valor, bool sembrada = false);
+    uint32_t simbolo_valor(const ValorExpresion& v);   // etiqueta sola o un EQU oculto con el valor
+    const char* diferir(TipoToken op, const ValorExpresion& a, const ValorExpresion& b, ValorExpresion& r);
+    const char* reducir_valor(ValorExpresion& v, const uint32_t* tramo) const;   // sin EQU y con lo ya conocido
+    void calcular_diferidas(const uint32_t* tramo);
+    void fijar_inicios_seccion();                // '$$' de cada sección en su posición 0
+    void plegar_expresiones();                   // EQU ya constantes -> imm8 / disp8 (tras la PASADA 1)
+    void sustituir_equivalencias();              // referencias a un EQU -> constante o etiqueta + sumando
+    void sembrar_equivalencias(const EnsambladorIA32& anterior);   // trabajador: EQU de un bloque anterior
+    bool simbolo_interno(uint32_t id) const { return simbolos.nombre(id).find(' ') != string_view::npos; }
+
+    // --- CACHÉ EN DISCO ---
+    string opciones_cache() const;               // lo que además del fuente cambia la salida
+    bool cargar_cache(const ClaveCache& clave);  // estado final desde la entrada
+    void guardar_cache(const ClaveCache& clave);
+
+    // --- VARIOS HILOS: bloques de líneas / de IR ---
+    static constexpr size_t MIN_LINEAS_BLOQUE      = 16384;   // menos no compensa un hilo
+    static constexpr size_t MIN_REFERENCIAS_BLOQUE = 16384;
+    struct PosicionBloque {
+        uint8_t seccion;                         // sección con la que empieza el bloque
+        int contador[NUM_SECCIONES];             // posición de cada sección al empezar
+    };
+    void pasada1_paralela(size_t bloques);
+    void analizar_bloque(const ArchivoFuente& texto, size_t desde, size_t hasta, uint8_t seccion,
+                         const vector<const EnsambladorIA32*>& semillas);
+    void pasada2();
+    void codificar_bloque(const EnsambladorIA32& origen, size_t desde, size_t hasta,
+                          const PosicionBloque& inicio);
+    bool resolver_referencia(const ReferenciaPendiente& ref);
+    void avisar_fuera_de_alcance(const ReferenciaPendiente& ref);
+
+    // --- SECCIONES ---
+    void cambiar_seccion(uint8_t seccion);       // guarda/recupera el contador de cada sección
+    void asignar_bases();                        // bases no fijadas, una tras otra
+    uint32_t direccion_simbolo(uint32_t id) const { return secciones[seccion_simbolo[id]].base + tabla_simbolos[id]; }
+    int total_bytes() const;                     // suma de los contadores de todas las secciones
+    void armar_imagen();                         // secciones -> codigo_hex
+
+    // --- ANÁLISIS: texto -> IR (solo PASADA 1) ---
+    void ensamblar_con_tabla(string_view mnem, const FilaOpcode* filas, size_t num_filas,
+                             const Token* tokens, size_t num_tokens);
+    bool agregar_instruccion(const FilaOpcode* filas, size_t num_filas, const Operando* ops, int num_ops);
+    bool clasificar_operando(const Token* tokens, size_t num_tokens, Operando& op);
+    int operandos_ir(const InstruccionIR& ir, uint8_t tam_mem, Operando (&ops)[2]) const;   // IR -> Operando
+
+    // Direccionamiento de memoria: tokens entre corchetes -> DireccionIR
+    // ([etiqueta + base + indice*escala + disp], en cualquier orden)
+    const char* analizar_memoria(const Token* tokens, size_t num_tokens, DireccionIR& mem);
+
+    // --- CODIFICACIÓN: IR -> bytes (ambas pasadas) ---
+    // Las instrucciones pasan por codificar_instruccion() (CodificacionIA32.hpp)
+    // con un EmisorSeccion: bytes en la sección actual y referencias pendientes
+    struct EmisorSeccion;
+    void codificar_ir(const InstruccionIR& ir);
+    void registrar_referencia(uint32_t simbolo, int tamano, int tipo_salto);
+
+    // --- UTILIDADES DE CODIFICACIÓN ---
+    void agregar_byte(uint8_t byte);
+    void agregar_dword(uint32_t dword);
+    void agregar_nops(uint32_t bytes);           // NOPS_LARGOS, los más largos primero
+    bool emite_bytes() const { return !primera_pasada || una_pasada; }
+};
+
+#endif // ENSAMBLADOR_IA32_HPP
+
+
+
+
@@ -0,0 +1,187 @@
+#include "EscritorELF.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#include <elf.h>
+
+using namespace std;
+
+// Tabla de cadenas ELF: empieza con '\0' y cada nombre termina en '\0'
+static uint32_t agregar_cadena(VectorArena<char>& tabla, string_view s, string_view prefijo = "") {
+    uint32_t indice = static_cast<uint32_t>(tabla.size());
+    tabla.insert(tabla.end(), prefijo.begin(), prefijo.end());
+    tabla.insert(tabla.end(), s.begin(), s.end());
+    tabla.push_back('\0');
+    return indice;
+}
+
+static uint32_t alinear(uint32_t valor, uint32_t alineacion) {
+    return (valor + alineacion - 1) & ~(alineacion - 1);
+}
+
+bool escribir_elf32_rel(const string& ruta,
+                        const SeccionELF* secciones, size_t num_secciones,
+                        const SimboloELF* simbolos, size_t num_simbolos,
+                        ArenaEnsamblado& arena) {
+    const uint32_t num_usuario = static_cast<uint32_t>(num_secciones);
+    MarcaArena marca(arena);
+    const AsignadorArena<char> asignador(arena);
+
+    // --- .symtab: nulo, símbolos de sección, locales y luego globales ---
+    VectorArena<char> strtab(1, '\0', asignador);
+    VectorArena<Elf32_Sym> symtab(1, Elf32_Sym{}, asignador);
+    symtab.reserve(1 + num_usuario + num_simbolos);
+
+    for (uint32_t s = 0; s < num_usuario; ++s) {
+        Elf32_Sym sym{};
+        sym.st_info  = ELF32_ST_INFO(STB_LOCAL, STT_SECTION);
+        sym.st_shndx = static_cast<Elf32_Half>(s + 1);
+        symtab.push_back(sym);
+    }
+
+    VectorArena<uint32_t> indice_simbolo(num_simbolos, 0, asignador);
+    for (int pasada_global = 0; pasada_global < 2; ++pasada_global) {
+        for (size_t i = 0; i < num_simbolos; ++i) {
+            const SimboloELF& s = simbolos[i];
+            if (s.global != (pasada_global == 1)) continue;
+            Elf32_Sym sym{};
+            sym.st_name  = agregar_cadena(strtab, s.nombre);
+            sym.st_value = s.valor;
+            sym.st_info  = ELF32_ST_INFO(s.global ? STB_GLOBAL : STB_LOCAL, STT_NOTYPE);
+            sym.st_shndx = s.seccion == 0 ? SHN_UNDEF : s.seccion;
+            indice_simbolo[i] = static_cast<uint32_t>(symtab.size());
+            symtab.push_back(sym);
+        }
+    }
+    uint32_t primer_global = static_cast<uint32_t>(symtab.size());
+    for (uint32_t i = 0; i < symtab.size(); ++i) {
+        if (ELF32_ST_BIND(symtab[i].st_info) == STB_GLOBAL) { primer_global = i; break; }
+    }
+
+    // --- .rel.<sección> ---
+    VectorArena<VectorArena<Elf32_Rel>> rels(asignador);
+    rels.reserve(num_usuario);
+    for (uint32_t s = 0; s < num_usuario; ++s) {
+        rels.emplace_back(asignador);
+        rels[s].reserve(secciones[s].num_reubicaciones);
+        for (uint32_t i = 0; i < secciones[s].num_reubicaciones; ++i) {
+            const ReubicacionELF& r = secciones[s].reubicaciones[i];
+            uint32_t sym = r.contra_seccion ? r.simbolo + 1 : indice_simbolo[r.simbolo];
+            uint32_t tipo = (r.tipo == REUB_PC32) ? R_386_PC32 : R_386_32;
+            rels[s].push_back(Elf32_Rel{r.posicion, ELF32_R_INFO(sym, tipo)});
+        }
+    }
+
+    // --- Cabeceras de sección: nulo, usuario, .rel.*, .symtab, .strtab, .shstrtab ---
+    VectorArena<char> shstrtab(1, '\0', asignador);
+    VectorArena<Elf32_Shdr> shdr(1, Elf32_Shdr{}, asignador);
+    VectorArena<pair<const void*, uint32_t>> contenido(1, {nullptr, 0}, asignador);
+    shdr.reserve(2 * num_usuario + 4);
+    contenido.reserve(2 * num_usuario + 4);
+
+    for (uint32_t s = 0; s < num_usuario; ++s) {
+        const SeccionELF& sec = secciones[s];
+        Elf32_Shdr h{};
+        h.sh_name      = agregar_cadena(shstrtab, sec.nombre);
+        h.sh_type      = sec.sin_bits ? SHT_NOBITS : SHT_PROGBITS;
+        h.sh_flags     = sec.banderas;
+        h.sh_size      = sec.tamano;
+        h.sh_addralign = sec.alineacion;
+        shdr.push_back(h);
+        contenido.push_back({sec.datos, sec.sin_bits ? 0u : sec.tamano});
+    }
+
+    const uint32_t idx_symtab = static_cast<uint32_t>(shdr.size()) +
+        static_cast<uint32_t>(count_if(rels.begin(), rels.end(),
+                                       [](const VectorArena<Elf32_Rel>& v) { return !v.empty(); }));
+
+    for (uint32_t s = 0; s < num_usuario; ++s) {
+        if (rels[s].empty()) continue;
+        Elf32_Shdr h{};
+        h.sh_name      = agregar_cadena(shstrtab, secciones[s].nombre, ".rel");
+        h.sh_type      = SHT_REL;
+        h.sh_size      = static_cast<uint32_t>(rels[s].size() * sizeof(Elf32_Rel));
+        h.sh_link      = idx_symtab;
+        h.sh_info      = s + 1;
+        h.sh_addralign = 4;
+        h.sh_entsize   = sizeof(Elf32_Rel);
+        shdr.push_back(h);
+        contenido.push_back({rels[s].data(), h.sh_size});
+    }
+
+    Elf32_Shdr h_sym{};
+    h_sym.sh_name      = agregar_cadena(shstrtab, ".symtab");
+    h_sym.sh_type      = SHT_SYMTAB;
+    h_sym.sh_size      = static_cast<uint32_t>(symtab.size() * sizeof(Elf32_Sym));
+    h_sym.sh_link      = idx_symtab + 1;
+    h_sym.sh_info      = primer_global;
+    h_sym.sh_addralign = 4;
+    h_sym.sh_entsize   = sizeof(Elf32_Sym);
+    shdr.push_back(h_sym);
+    contenido.push_back({symtab.data(), h_sym.sh_size});
+
+    Elf32_Shdr h_str{};
+    h_str.sh_name      = agregar_cadena(shstrtab, ".strtab");
+    h_str.sh_type      = SHT_STRTAB;
+    h_str.sh_size      = static_cast<uint32_t>(strtab.size());
+    h_str.sh_addralign = 1;
+    shdr.push_back(h_str);
+    contenido.push_back({strtab.data(), h_str.sh_size});
+
+    Elf32_Shdr h_shstr{};
+    h_shstr.sh_name      = agregar_cadena(shstrtab, ".shstrtab");
+    h_shstr.sh_type      = SHT_STRTAB;
+    h_shstr.sh_size      = static_cast<uint32_t>(shstrtab.size());
+    h_shstr.sh_addralign = 1;
+    shdr.push_back(h_shstr);
+    contenido.push_back({shstrtab.data(), h_shstr.sh_size});
+
+    // --- Disposición en el archivo ---
+    uint32_t desplazamiento = sizeof(Elf32_Ehdr);
+    for (size_t i = 1; i < shdr.size(); ++i) {
+        desplazamiento = alinear(desplazamiento, shdr[i].sh_addralign);
+        shdr[i].sh_offset = desplazamiento;
+        if (shdr[i].sh_type != SHT_NOBITS) desplazamiento += shdr[i].sh_size;
+    }
+    const uint32_t inicio_shdr = alinear(desplazamiento, 4);
+
+    Elf32_Ehdr eh{};
+    memcpy(eh.e_ident, ELFMAG, SELFMAG);
+    eh.e_ident[EI_CLASS]   = ELFCLASS32;
+    eh.e_ident[EI_DATA]    = ELFDATA2LSB;
+    eh.e_ident[EI_VERSION] = EV_CURRENT;
+    eh.e_type      = ET_REL;
+    eh.e_machine   = EM_386;
+    eh.e_version   = EV_CURRENT;
+    eh.e_shoff     = inicio_shdr;
+    eh.e_ehsize    = sizeof(Elf32_Ehdr);
+    eh.e_shentsize = sizeof(Elf32_Shdr);
+    eh.e_shnum     = static_cast<Elf32_Half>(shdr.size());
+    eh.e_shstrndx  = static_cast<Elf32_Half>(shdr.size() - 1);
+
+    // --- Escritura: un write por sección ---
+    ofstream f(ruta, ios::binary);
+    if (!f.is_open()) return false;
+
+    static const char ceros[16] = {};
+    uint32_t escrito = 0;
+    auto escribir = [&](const void* datos, uint32_t tamano, uint32_t en) {
+        while (escrito < en) {
+            uint32_t n = min<uint32_t>(en - escrito, sizeof(ceros));
+            f.write(ceros, n);
+            escrito += n;
+        }
+        if (tamano != 0) f.write(static_cast<const char*>(datos), tamano);
+        escrito += tamano;
+    };
+
+    escribir(&eh, sizeof(eh), 0);
+    for (size_t i = 1; i < shdr.size(); ++i) {
+        escribir(contenido[i].first, contenido[i].second, shdr[i].sh_offset);
+    }
+    escribir(shdr.data(), static_cast<uint32_t>(shdr.size() * sizeof(Elf32_Shdr)), inicio_shdr);
+
+    return static_cast<bool>(f);
+}
@@ -0,0 +1,57 @@
+#ifndef ESCRITOR_ELF_HPP
+#define ESCRITOR_ELF_HPP
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ArenaEnsamblado.hpp"
+
+// -----------------------------------------------------------------------------
+// Objeto reubicable ELF32 (ET_REL, EM_386)
+// -----------------------------------------------------------------------------
+// El ensamblador entrega secciones ya codificadas, sus símbolos y las
+// reubicaciones (tipo REL: el sumando va escrito en el propio hueco). Aquí
+// solo se arman las cabeceras, .symtab/.strtab, una .rel.<sección> por
+// sección que lo necesite y .shstrtab. Cada sección se escribe con un único
+// write sobre el archivo. Las tablas que se arman salen de la arena del
+// ensamblador y se liberan al volver.
+
+enum TipoReubicacion : uint8_t {
+    REUB_32   = 1,   // R_386_32:   S + A
+    REUB_PC32 = 2    // R_386_PC32: S + A - P
+};
+
+struct ReubicacionELF {
+    uint32_t posicion;      // desplazamiento del hueco dentro de la sección
+    uint32_t simbolo;       // índice en la lista de símbolos, o de sección si contra_seccion
+    uint8_t  tipo;          // TipoReubicacion
+    bool     contra_seccion;
+};
+
+struct SeccionELF {
+    std::string_view nombre;         // ".text", ".data", ...
+    const uint8_t*   datos = nullptr;
+    uint32_t         tamano = 0;
+    uint32_t         banderas = 0;   // SHF_ALLOC | SHF_WRITE | SHF_EXECINSTR
+    uint32_t         alineacion = 1;
+    bool             sin_bits = false;   // SHT_NOBITS (.bss): ocupa tamano solo en memoria
+    const ReubicacionELF* reubicaciones = nullptr;
+    uint32_t         num_reubicaciones = 0;
+};
+
+struct SimboloELF {
+    std::string_view nombre;
+    uint32_t valor;         // desplazamiento dentro de su sección
+    uint16_t seccion;       // 1.. = índice en secciones + 1, 0 = no definido
+    bool     global;
+};
+
+// false si no se pudo escribir el archivo
+bool escribir_elf32_rel(const std::string& ruta,
+                        const SeccionELF* secciones, size_t num_secciones,
+                        const SimboloELF* simbolos, size_t num_simbolos,
+                        ArenaEnsamblado& arena);
+
+#endif // ESCRITOR_ELF_HPP
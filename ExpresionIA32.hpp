@@ -0,0 +1,248 @@
+#ifndef EXPRESION_IA32_HPP
+#define EXPRESION_IA32_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "AnalizadorLexico.hpp"
+#include "RepresentacionIntermedia.hpp"
+
+// -----------------------------------------------------------------------------
+// Expresiones constantes (constexpr)
+// -----------------------------------------------------------------------------
+// "4*2", "(1 << 4) | 3", "fin - inicio", "tabla + 8", "$ - msg": operadores
+// | & << >> + - * / (de menor a mayor precedencia), signo y paréntesis. El
+// valor es una constante más, a lo sumo, una etiqueta sumada y otra restada;
+// una etiqueta suelta solo admite + y -, y "x - x" se anula. Una diferencia
+// de etiquetas es una constante que se conoce con la disposición: con
+// cualquier operador ("(fin - tabla) / 4") queda como una diferida, una
+// operación que se calcula después. Quién es cada identificador (un EQU ya
+// conocido, una etiqueta, '$') y dónde van las diferidas lo decide un
+// Resolver con:
+//   const char* simbolo(std::string_view nombre, ValorExpresion& v);
+//   const char* diferir(TipoToken op, const ValorExpresion& a,
+//                       const ValorExpresion& b, ValorExpresion& r);
+// que devuelven nullptr o el mensaje de error. Lo usan el ensamblador (con
+// su tabla de símbolos) y ensamblar_constante() (sin etiquetas en los valores).
+
+inline constexpr uint32_t SIN_DIFERIDA = 0xFFFFFFFFu;
+
+struct ValorExpresion {
+    uint32_t constante = 0;
+    uint32_t suma      = SIN_SIMBOLO;    // id de la etiqueta sumada
+    uint32_t resta     = SIN_SIMBOLO;    // id de la etiqueta restada
+    uint32_t diferida  = SIN_DIFERIDA;   // índice de una operación sumada (del Resolver)
+    constexpr bool es_constante() const {
+        return suma == SIN_SIMBOLO && resta == SIN_SIMBOLO && diferida == SIN_DIFERIDA;
+    }
+    constexpr bool es_etiqueta() const {   // una etiqueta (o símbolo) sola, sin nada sumado
+        return suma != SIN_SIMBOLO && resta == SIN_SIMBOLO && diferida == SIN_DIFERIDA && constante == 0;
+    }
+    constexpr bool es_diferencia() const { return suma != SIN_SIMBOLO && resta != SIN_SIMBOLO; }
+    // Constante una vez conocida la disposición: sin una etiqueta suelta
+    constexpr bool diferible() const { return (suma == SIN_SIMBOLO) == (resta == SIN_SIMBOLO); }
+};
+
+// x op y entre constantes (sin signo, como NASM); nullptr o el error
+constexpr const char* operar_constantes(TipoToken op, uint32_t x, uint32_t y, uint32_t& r) {
+    switch (op) {
+        case T_MAS:       r = x + y; break;
+        case T_MENOS:     r = x - y; break;
+        case T_POR:       r = x * y; break;
+        case T_DIV:
+            if (y == 0) return "division por cero";
+            r = x / y;
+            break;
+        case T_DESPL_IZQ: r = (y >= 32) ? 0 : x << y; break;
+        case T_DESPL_DER: r = (y >= 32) ? 0 : x >> y; break;
+        case T_Y:         r = x & y; break;
+        case T_O:         r = x | y; break;
+        default:          return "operador invalido";
+    }
+    return nullptr;
+}
+
+// a + b (o a - b) sobre 'a' sin las diferidas (las suma sumar()); error
+// si quedan dos etiquetas sumadas o restadas
+constexpr const char* combinar(ValorExpresion& a, ValorExpresion b, bool restar) {
+    if (restar) {
+        const uint32_t s = b.suma;
+        b.suma  = b.resta;
+        b.resta = s;
+        b.constante = 0u - b.constante;
+    }
+    a.constante += b.constante;
+    if (b.suma != SIN_SIMBOLO) {
+        if (a.resta == b.suma)           a.resta = SIN_SIMBOLO;
+        else if (a.suma == SIN_SIMBOLO)  a.suma = b.suma;
+        else                             return "dos etiquetas sumadas";
+    }
+    if (b.resta != SIN_SIMBOLO) {
+        if (a.suma == b.resta)           a.suma = SIN_SIMBOLO;
+        else if (a.resta == SIN_SIMBOLO) a.resta = b.resta;
+        else                             return "dos etiquetas restadas";
+    }
+    return nullptr;
+}
+
+// a + b (o a - b) sobre 'a', con a lo sumo una diferida sumada en el
+// resultado: una restada o dos pasan a ser otra. Una diferencia que no se
+// puede combinar ("msg + (fin - inicio)") también pasa a ser una diferida
+template <typename Resolver>
+constexpr const char* sumar(ValorExpresion& a, ValorExpresion b, bool restar, Resolver& resolver) {
+    const ValorExpresion cero;
+    ValorExpresion r = a;
+    const char* error = combinar(r, b, restar);
+    if (error != nullptr) {
+        if (!a.es_diferencia() && !b.es_diferencia()) return error;
+        if (a.es_diferencia()) {
+            if (const char* e = resolver.diferir(T_MAS, cero, a, a)) return e;
+        }
+        if (b.es_diferencia()) {
+            if (const char* e = resolver.diferir(T_MAS, cero, b, b)) return e;
+        }
+        r = a;
+        if (const char* e = combinar(r, b, restar)) return e;
+    }
+    if (b.diferida != SIN_DIFERIDA) {
+        ValorExpresion d;
+        d.diferida = b.diferida;
+        if (restar) {
+            if (const char* e = resolver.diferir(T_MENOS, cero, d, d)) return e;
+        }
+        if (a.diferida != SIN_DIFERIDA) {
+            ValorExpresion c;
+            c.diferida = a.diferida;
+            if (const char* e = resolver.diferir(T_MAS, c, d, d)) return e;
+        }
+        r.diferida = d.diferida;
+    }
+    a = r;
+    return nullptr;
+}
+
+// a op b sobre 'a'. Entre constantes se calcula ya; con etiquetas, + y -
+// van por sumar() y los demás operadores, sobre diferencias, pasan a ser
+// una diferida ("(fin - tabla) / 4"). Una etiqueta suelta solo admite + y -
+template <typename Resolver>
+constexpr const char* operar(TipoToken op, ValorExpresion& a, const ValorExpresion& b, Resolver& resolver) {
+    if (op == T_MAS || op == T_MENOS) return sumar(a, b, op == T_MENOS, resolver);
+    if (a.es_constante() && b.es_constante()) return operar_constantes(op, a.constante, b.constante, a.constante);
+    if (!a.diferible() || !b.diferible()) return "una etiqueta solo admite + y -";
+    return resolver.diferir(op, a, b, a);
+}
+
+// Recursivo por niveles de precedencia; los paréntesis anidan a lo sumo
+// MAX_PARENTESIS (la línea ya tiene a lo sumo MAX_TOKENS_LINEA tokens)
+template <typename Resolver>
+class EvaluadorExpresion {
+public:
+    constexpr EvaluadorExpresion(const Token* tokens, size_t num_tokens, Resolver& r)
+        : t(tokens), n(num_tokens), resolver(r) {}
+
+    constexpr const char* evaluar(ValorExpresion& v) {
+        v = ValorExpresion();
+        if (const char* error = binaria(0, v)) return error;
+        if (i != n) return t[i].tipo == T_PAREN_CIERRA ? "')' sin abrir" : "falta un operador en la expresion";
+        return nullptr;
+    }
+
+private:
+    static constexpr int NIVELES = 5;
+    static constexpr int MAX_PARENTESIS = 16;
+
+    const Token* t;
+    size_t n;
+    Resolver& resolver;
+    size_t i = 0;
+    int parentesis = 0;
+
+    // 0 = |, 1 = &, 2 = << >>, 3 = + -, 4 = * /; -1 si no es un operador binario
+    static constexpr int nivel(TipoToken tipo) {
+        switch (tipo) {
+            case T_O:         return 0;
+            case T_Y:         return 1;
+            case T_DESPL_IZQ:
+            case T_DESPL_DER: return 2;
+            case T_MAS:
+            case T_MENOS:     return 3;
+            case T_POR:
+            case T_DIV:       return 4;
+            default:          return -1;
+        }
+    }
+
+    constexpr const char* binaria(int nivel_actual, ValorExpresion& v) {
+        if (nivel_actual == NIVELES) return unaria(v);
+        if (const char* error = binaria(nivel_actual + 1, v)) return error;
+        while (i < n && nivel(t[i].tipo) == nivel_actual) {
+            const TipoToken op = t[i++].tipo;
+            ValorExpresion b;
+            if (const char* error = binaria(nivel_actual + 1, b)) return error;
+            if (const char* error = operar(op, v, b, resolver)) return error;
+        }
+        return nullptr;
+    }
+
+    constexpr const char* unaria(ValorExpresion& v) {
+        if (i < n && (t[i].tipo == T_MAS || t[i].tipo == T_MENOS)) {
+            const bool negativo = (t[i++].tipo == T_MENOS);
+            ValorExpresion b;
+            if (const char* error = unaria(b)) return error;
+            v = ValorExpresion();
+            return operar(negativo ? T_MENOS : T_MAS, v, b, resolver);
+        }
+        return primaria(v);
+    }
+
+    constexpr const char* primaria(ValorExpresion& v) {
+        if (i == n) return "falta un operando en la expresion";
+        const Token& k = t[i++];
+        switch (k.tipo) {
+            case T_NUMERO:
+                v = ValorExpresion();
+                v.constante = k.valor;
+                return nullptr;
+            case T_IDENT:
+                return resolver.simbolo(k.texto, v);
+            case T_PAREN_ABRE: {
+                if (++parentesis > MAX_PARENTESIS) return "demasiados parentesis anidados";
+                if (const char* error = binaria(0, v)) return error;
+                if (i == n || t[i].tipo != T_PAREN_CIERRA) return "falta ')'";
+                ++i;
+                --parentesis;
+                return nullptr;
+            }
+            case T_REG32:
+            case T_REG8:
+                return "registro dentro de una expresion";
+            default:
+                return "operando invalido en la expresion";
+        }
+    }
+};
+
+template <typename Resolver>
+constexpr const char* evaluar_expresion(const Token* t, size_t n, Resolver& resolver, ValorExpresion& v) {
+    EvaluadorExpresion<Resolver> e(t, n, resolver);
+    return e.evaluar(v);
+}
+
+// El fin de un término de [..]: el primer + o - fuera de paréntesis que va
+// tras un operando (así "4*-2" y "-(a+b)" quedan enteros)
+constexpr size_t fin_termino(const Token* t, size_t i, size_t n) {
+    int profundidad = 0;
+    for (size_t j = i; j < n; ++j) {
+        const TipoToken tipo = t[j].tipo;
+        if (tipo == T_PAREN_ABRE) ++profundidad;
+        else if (tipo == T_PAREN_CIERRA) --profundidad;
+        else if (profundidad == 0 && j > i && (tipo == T_MAS || tipo == T_MENOS)) {
+            const TipoToken previo = t[j - 1].tipo;
+            if (previo == T_NUMERO || previo == T_IDENT || previo == T_PAREN_CIERRA || previo == T_REG32) return j;
+        }
+    }
+    return n;
+}
+
+#endif // EXPRESION_IA32_HPP
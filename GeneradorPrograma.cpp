@@ -0,0 +1,227 @@
+#include "GeneradorPrograma.hpp"
+
+#include <fstream>
+#include <iterator>
+
+#include "TablaOpcodes.hpp"
+
+using namespace std;
+
+// xorshift32: la misma secuencia con cualquier compilador y biblioteca
+struct Aleatorio {
+    uint32_t estado;
+    uint32_t siguiente() {
+        estado ^= estado << 13;
+        estado ^= estado >> 17;
+        estado ^= estado << 5;
+        return estado;
+    }
+    uint32_t menor(uint32_t n) { return siguiente() % n; }
+};
+
+static const char* const REG32[8] = { "EAX", "ECX", "EDX", "EBX", "ESP", "EBP", "ESI", "EDI" };
+static const char* const REG8[8]  = { "AL", "CL", "DL", "BL", "AH", "CH", "DH", "BH" };
+
+static constexpr uint32_t TABLAS_INICIALES = 4;
+static constexpr uint32_t VALORES_TABLA    = 8;
+
+class Generador {
+public:
+    Generador(ofstream& f, size_t objetivo, uint32_t semilla)
+        : archivo(f), objetivo(objetivo), azar{semilla != 0 ? semilla : 1} {
+        buffer.reserve(TAM_BUFFER + 256);
+    }
+
+    void generar(ResultadoGenerador& resultado) {
+        cabecera();
+        while (lineas + pendientes() + 1 < objetivo) cuerpo();
+        while (pendientes() > 0) etiqueta();
+        linea("    INT 0x80");
+        volcar();
+        resultado.lineas = lineas;
+        resultado.bytes  = bytes;
+    }
+
+private:
+    static constexpr size_t TAM_BUFFER = 1 << 20;
+
+    ofstream& archivo;
+    size_t objetivo;
+    Aleatorio azar;
+    string buffer;
+    string texto;                  // línea en construcción
+    size_t lineas = 0;
+    size_t bytes  = 0;
+    uint32_t etiquetas = 0;        // L0 .. L{etiquetas-1} ya definidas
+    int64_t max_referida = -1;     // mayor L referida (hacia adelante)
+    uint32_t tablas = 0;           // T0 .. T{tablas-1}
+
+    size_t pendientes() const {
+        return max_referida >= etiquetas ? static_cast<size_t>(max_referida - etiquetas + 1) : 0;
+    }
+
+    void linea(const string& s) {
+        buffer += s;
+        buffer += '\n';
+        bytes += s.size() + 1;
+        ++lineas;
+        if (buffer.size() >= TAM_BUFFER) volcar();
+    }
+
+    void volcar() {
+        archivo.write(buffer.data(), static_cast<streamsize>(buffer.size()));
+        buffer.clear();
+    }
+
+    // Número en alguno de los formatos que acepta el analizador léxico
+    string numero(uint32_t v) {
+        static const char* const HEX = "0123456789ABCDEF";
+        switch (azar.menor(3)) {
+            case 0: return to_string(v);
+            case 1: {
+                string s = "0x";
+                for (int d = 28; d >= 0; d -= 4) s += HEX[(v >> d) & 0xF];
+                return s;
+            }
+            default: {
+                string s = "0";                       // "0FFh": empieza con dígito
+                for (int d = 28; d >= 0; d -= 4) s += HEX[(v >> d) & 0xF];
+                return s + "h";
+            }
+        }
+    }
+
+    void tabla_dd() {
+        texto = "T" + to_string(tablas++) + " DD ";
+        for (uint32_t i = 0; i < VALORES_TABLA; ++i) {
+            if (i) texto += ", ";
+            if (azar.menor(4) == 0) texto += "-" + to_string(azar.menor(1000));
+            else texto += numero(azar.siguiente());
+        }
+        linea(texto);
+    }
+
+    void cabecera() {
+        linea("; Programa sintetico de benchmark (" + to_string(objetivo) + " lineas)");
+        linea("BITS 32");
+        linea("GLOBAL _start");
+        linea("SECTION .data");
+        linea("valor DD 0");
+        linea("bytes DB 1, 2, 'A', 0FFh");
+        for (uint32_t i = 0; i < TABLAS_INICIALES; ++i) tabla_dd();
+        linea("SECTION .bss");
+        linea("buffer RESD 256");
+        linea("SECTION .text");
+        linea("_start:");
+    }
+
+    void etiqueta() {
+        linea("L" + to_string(etiquetas++) + ":");
+    }
+
+    // Destino de salto: atrás (ya definida) o adelante, cerca (rel8) o lejos (rel32)
+    string destino() {
+        uint32_t e;
+        if (etiquetas > 0 && azar.menor(2) == 0) {
+            uint32_t atras = 1 + azar.menor(etiquetas < 20 ? etiquetas : 20);
+            e = etiquetas - atras;
+        } else {
+            uint32_t adelante = azar.menor(5) != 0 ? azar.menor(2) : 2 + azar.menor(40);
+            e = etiquetas + adelante;
+            // No pasarse del total de líneas por tener que definir las etiquetas al final
+            size_t nuevas = (e > max_referida) ? e - max_referida : 0;
+            if (lineas + 1 + pendientes() + nuevas + 1 > objetivo) {
+                if (etiquetas == 0) return "";
+                e = etiquetas - 1;
+            }
+            if (static_cast<int64_t>(e) > max_referida) max_referida = e;
+        }
+        return "L" + to_string(e);
+    }
+
+    string memoria32() {
+        switch (azar.menor(9)) {
+            case 0:  return "[valor]";
+            case 1:  return "DWORD [valor]";
+            case 2:  return "[T" + to_string(azar.menor(tablas)) + "+ESI*4]";
+            case 3:  return "[T" + to_string(azar.menor(tablas)) + "+ECX*4+" + to_string(4 * azar.menor(VALORES_TABLA)) + "]";
+            case 4:  return "[EBP-" + to_string(4 + 4 * azar.menor(16)) + "]";
+            case 5:  return "[ESP+" + to_string(4 * azar.menor(8)) + "]";
+            case 6:  return "[EBX+ESI*4]";
+            case 7:  return "[EDX+EDI*" + to_string(1 << azar.menor(4)) + "-" + to_string(4 * azar.menor(64)) + "]";
+            default: return "[EBP+" + to_string(8 + 4 * azar.menor(4)) + "]";
+        }
+    }
+
+    string memoria8() {
+        switch (azar.menor(3)) {
+            case 0:  return "BYTE [bytes+EDI*1]";
+            case 1:  return "[bytes]";
+            default: return "BYTE [EBP-1]";
+        }
+    }
+
+    string operando(PatronOperando p) {
+        switch (p) {
+            case P_R32:   return REG32[azar.menor(8)];
+            case P_EAX:   return "EAX";
+            case P_R8:    return REG8[azar.menor(8)];
+            case P_M32:   return memoria32();
+            case P_M8:    return memoria8();
+            case P_RM32:  return azar.menor(2) ? REG32[azar.menor(8)] : memoria32();
+            case P_IMM:   return azar.menor(3) ? numero(azar.siguiente()) : "-" + to_string(azar.menor(100000));
+            case P_IMM8S: return to_string(static_cast<int>(azar.menor(256)) - 128);
+            case P_IMM8U: return numero(azar.menor(256));
+            case P_MOFFS: return "[valor]";
+            case P_ETIQ:  return destino();
+            case P_NADA:  return "";
+        }
+        return "";
+    }
+
+    void instruccion() {
+        const FilaOpcode& f = TABLA_OPCODES[azar.menor(static_cast<uint32_t>(size(TABLA_OPCODES)))];
+
+        // LOOP es rel8 y solo hacia atrás: se apunta a sí misma (en la misma línea)
+        if (f.cod == C_REL8) {
+            texto = "L" + to_string(etiquetas) + ": " + string(f.mnem) + " L" + to_string(etiquetas);
+            ++etiquetas;
+            linea(texto);
+            return;
+        }
+
+        string a = operando(f.op0);
+        if (f.op0 == P_ETIQ && a.empty()) { linea("    NOP"); return; }
+        string b = operando(f.op1);
+
+        texto = "    ";
+        texto += f.mnem;
+        if (!a.empty()) texto += " " + a;
+        if (!b.empty()) texto += ", " + b;
+        if (azar.menor(16) == 0) texto += "   ; comentario";
+        linea(texto);
+    }
+
+    void cuerpo() {
+        uint32_t r = azar.menor(512);
+        if (r == 0 && lineas + 3 + pendientes() + 1 <= objetivo) {
+            // Tabla nueva en .data y vuelta a .text
+            linea("SECTION .data");
+            tabla_dd();
+            linea("SECTION .text");
+        } else if (r < 64) {
+            etiqueta();
+        } else {
+            instruccion();
+        }
+    }
+};
+
+bool generar_programa_sintetico(const string& ruta, size_t lineas, uint32_t semilla,
+                                ResultadoGenerador& resultado) {
+    ofstream f(ruta, ios::binary);
+    if (!f.is_open()) return false;
+    Generador g(f, lineas, semilla);
+    g.generar(resultado);
+    return static_cast<bool>(f);
+}
@@ -0,0 +1,28 @@
+#ifndef GENERADOR_PROGRAMA_HPP
+#define GENERADOR_PROGRAMA_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+
+// -----------------------------------------------------------------------------
+// Generador de programas sintéticos (benchmark)
+// -----------------------------------------------------------------------------
+// Escribe un .asm de exactamente N líneas, siempre el mismo para la misma
+// semilla. Las instrucciones salen de las filas de TABLA_OPCODES (operandos
+// armados según el patrón de cada fila), de modo que toda forma que acepte
+// el ensamblador aparece en la mezcla. Incluye etiquetas con saltos hacia
+// atrás y hacia adelante (cortos y largos), CALL, LOOP, tablas DD/DB en
+// .data intercaladas con .text y reservas en .bss. No deja etiquetas sin
+// definir: el fuente ensambla sin errores.
+
+struct ResultadoGenerador {
+    size_t lineas = 0;
+    size_t bytes  = 0;
+};
+
+// false si no se pudo escribir el archivo
+bool generar_programa_sintetico(const std::string& ruta, size_t lineas, uint32_t semilla,
+                                ResultadoGenerador& resultado);
+
+#endif // GENERADOR_PROGRAMA_HPP
@@ -0,0 +1,82 @@
+#include "InternadorSimbolos.hpp"
+
+#include "TablaOpcodes.hpp"
+
+using namespace std;
+
+// FNV-1a sobre los caracteres en mayúsculas (igual que las etiquetas)
+static inline uint32_t hash_simbolo(string_view s) {
+    uint32_t h = 2166136261u;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(a_mayuscula(c));
+        h *= 16777619u;
+    }
+    return h;
+}
+
+// Casilla del nombre, o la casilla libre donde iría
+size_t InternadorSimbolos::ranura(string_view nombre_buscado, uint32_t h) const {
+    const size_t mascara = casillas.size() - 1;
+    size_t i = h & mascara;
+    while (true) {
+        uint32_t c = casillas[i];
+        if (c == 0) return i;
+        uint32_t id = c - 1;
+        if (hashes[id] == h && iguales_sin_mayusculas(nombre(id), nombre_buscado)) return i;
+        i = (i + 1) & mascara;
+    }
+}
+
+// Duplica la tabla; se mantiene a lo sumo a la mitad de ocupación
+void InternadorSimbolos::crecer() {
+    size_t capacidad = casillas.empty() ? 1024 : casillas.size() * 2;
+    casillas.assign(capacidad, 0);
+    const size_t mascara = capacidad - 1;
+    for (uint32_t id = 0; id < inicio.size(); ++id) {
+        size_t i = hashes[id] & mascara;
+        while (casillas[i] != 0) i = (i + 1) & mascara;
+        casillas[i] = id + 1;
+    }
+}
+
+uint32_t InternadorSimbolos::internar(string_view texto) {
+    if ((inicio.size() + 1) * 2 > casillas.size()) crecer();
+
+    uint32_t h = hash_simbolo(texto);
+    size_t i = ranura(texto, h);
+    if (casillas[i] != 0) return casillas[i] - 1;
+
+    uint32_t id = static_cast<uint32_t>(inicio.size());
+    inicio.push_back(static_cast<uint32_t>(arena.size()));
+    longitud.push_back(static_cast<uint32_t>(texto.size()));
+    hashes.push_back(h);
+    arena.insert(arena.end(), texto.begin(), texto.end());
+    casillas[i] = id + 1;
+    return id;
+}
+
+uint32_t InternadorSimbolos::buscar(string_view texto) const {
+    if (casillas.empty()) return SIN_ID;
+    size_t i = ranura(texto, hash_simbolo(texto));
+    return casillas[i] != 0 ? casillas[i] - 1 : SIN_ID;
+}
+
+size_t InternadorSimbolos::sondeo_maximo() const {
+    const size_t mascara = casillas.size() - 1;
+    size_t maximo = 0;
+    for (size_t i = 0; i < casillas.size(); ++i) {
+        if (casillas[i] == 0) continue;
+        size_t ideal = hashes[casillas[i] - 1] & mascara;
+        size_t distancia = (i - ideal) & mascara;
+        if (distancia + 1 > maximo) maximo = distancia + 1;
+    }
+    return maximo;
+}
+
+void InternadorSimbolos::limpiar() {
+    arena.clear();
+    inicio.clear();
+    longitud.clear();
+    hashes.clear();
+    casillas.clear();
+}
@@ -0,0 +1,52 @@
+#ifndef INTERNADOR_SIMBOLOS_HPP
+#define INTERNADOR_SIMBOLOS_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Internador de símbolos: nombre -> id denso de 32 bits
+// -----------------------------------------------------------------------------
+// Los nombres se guardan, uno tras otro, en una sola arena de bytes con la
+// grafía de su primera aparición (el ELF necesita "_start", no "_START").
+// La búsqueda no distingue mayúsculas y usa direccionamiento abierto (sondeo
+// lineal) sobre una tabla de potencia de 2 que guarda id + 1 (0 = casilla
+// libre). Con el id las demás tablas del ensamblador son vectores planos
+// indexados por id.
+
+class InternadorSimbolos {
+public:
+    // Id del nombre (sin distinguir mayúsculas); lo crea si no existe
+    uint32_t internar(std::string_view nombre);
+
+    // Id del nombre o SIN_ID si nunca se internó
+    uint32_t buscar(std::string_view nombre) const;
+
+    // Nombre con su primera grafía. La vista deja de ser válida al internar otro nombre.
+    std::string_view nombre(uint32_t id) const {
+        return std::string_view(arena.data() + inicio[id], longitud[id]);
+    }
+
+    size_t size() const { return inicio.size(); }
+    size_t capacidad() const { return casillas.size(); }
+
+    // Casillas recorridas por la búsqueda más larga (1 = sin colisiones)
+    size_t sondeo_maximo() const;
+    void limpiar();
+
+    static constexpr uint32_t SIN_ID = 0xFFFFFFFFu;
+
+private:
+    std::vector<char>     arena;      // bytes de todos los nombres
+    std::vector<uint32_t> inicio;     // id -> desplazamiento en arena
+    std::vector<uint32_t> longitud;   // id -> longitud del nombre
+    std::vector<uint32_t> hashes;     // id -> hash (para crecer sin recalcular)
+    std::vector<uint32_t> casillas;   // tabla abierta: id + 1, 0 = libre
+
+    size_t ranura(std::string_view nombre, uint32_t h) const;
+    void crecer();
+};
+
+#endif // INTERNADOR_SIMBOLOS_HPP
@@ -0,0 +1,81 @@
+#include "LoteEnsamblado.hpp"
+
+#include <utility>
+
+using namespace std;
+
+string base_salida(const string& archivo) {
+    const size_t n = archivo.size();
+    if (n > 4 && iguales_sin_mayusculas(string_view(archivo).substr(n - 4), ".asm")) return archivo.substr(0, n - 4);
+    return archivo;
+}
+
+LoteEnsamblado::LoteEnsamblado(unsigned hilos, Configurar configurar_, AlTerminar al_terminar_)
+    : configurar(move(configurar_)), al_terminar(move(al_terminar_)) {
+    if (hilos == 0) hilos = 1;
+    grupo.reserve(hilos);
+    for (unsigned i = 0; i < hilos; ++i) grupo.emplace_back(&LoteEnsamblado::trabajar, this);
+}
+
+LoteEnsamblado::~LoteEnsamblado() {
+    cerrar();
+}
+
+void LoteEnsamblado::agregar(string archivo) {
+    {
+        lock_guard<mutex> l(m_cola);
+        cola.push_back(move(archivo));
+    }
+    hay_trabajo.notify_one();
+}
+
+void LoteEnsamblado::cerrar() {
+    {
+        lock_guard<mutex> l(m_cola);
+        if (cerrado && grupo.empty()) return;
+        cerrado = true;
+    }
+    hay_trabajo.notify_all();
+    for (thread& h : grupo) h.join();
+    grupo.clear();
+}
+
+// Cada hilo: un ensamblador y un buffer de mensajes para todos sus archivos
+void LoteEnsamblado::trabajar() {
+    EnsambladorIA32 ens;
+    ostringstream mensajes;
+    ens.usar_salida_detallada(false);
+    ens.usar_hilos(1);   // el paralelismo es entre archivos
+    if (configurar) configurar(ens);
+    ens.usar_salida_errores(mensajes);
+
+    ResultadoLote r;
+    while (true) {
+        {
+            unique_lock<mutex> l(m_cola);
+            hay_trabajo.wait(l, [this] { return cerrado || !cola.empty(); });
+            if (cola.empty()) return;   // cerrado y sin nada pendiente
+            r.archivo = move(cola.front());
+            cola.pop_front();
+        }
+
+        auto t = chrono::steady_clock::now();
+        mensajes.str(string());
+        ens.ensamblar(r.archivo);
+        if (ens.num_lineas() > 0) {   // no se pudo leer o estaba vacío: sin salidas
+            const string base = base_salida(r.archivo);
+            ens.generar_hex(base + ".hex");
+            ens.generar_bin(base + ".bin");
+            ens.generar_elf(base + ".o");
+        }
+        r.segundos = chrono::duration<double>(chrono::steady_clock::now() - t).count();
+        r.errores  = ens.num_errores();
+        r.bytes    = ens.tamano_seccion(SEC_TEXT) + ens.tamano_seccion(SEC_DATA) + ens.tamano_seccion(SEC_BSS);
+        r.mensajes = mensajes.str();
+
+        lock_guard<mutex> l(m_resultados);
+        ++terminados;
+        if (r.errores != 0) ++con_errores;
+        if (al_terminar) al_terminar(r);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef LOTE_ENSAMBLADO_HPP
+#define LOTE_ENSAMBLADO_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Ensamblado por lotes
+// -----------------------------------------------------------------------------
+// Un grupo de hilos, cada uno con su propio EnsambladorIA32 que se reutiliza
+// de un archivo al siguiente: reiniciar_estado() vacía las tablas sin soltar
+// su memoria, así que tras los primeros archivos ya no se reserva nada. Los
+// archivos llegan con agregar() (de una lista o de stdin a medida que se
+// leen) y cada uno escribe <base>.hex, <base>.bin y <base>.o junto al fuente
+// (<base> = la ruta sin ".asm"). Los resultados se entregan en el orden en
+// que terminan, no en el que llegaron.
+
+struct ResultadoLote {
+    string archivo;
+    int errores = 0;
+    uint32_t bytes = 0;       // .text + .data + .bss
+    double segundos = 0;      // ensamblar + escribir las salidas
+    string mensajes;          // errores y advertencias del ensamblador
+};
+
+class LoteEnsamblado {
+public:
+    using Configurar = function<void(EnsambladorIA32&)>;        // opciones de cada ensamblador
+    using AlTerminar = function<void(const ResultadoLote&)>;    // nunca se llama en paralelo
+
+    LoteEnsamblado(unsigned hilos, Configurar configurar, AlTerminar al_terminar);
+    ~LoteEnsamblado();
+
+    LoteEnsamblado(const LoteEnsamblado&) = delete;
+    LoteEnsamblado& operator=(const LoteEnsamblado&) = delete;
+
+    void agregar(string archivo);
+
+    // Espera a que se ensamble todo lo agregado y termina los hilos
+    void cerrar();
+
+    // Válidos tras cerrar()
+    size_t archivos() const { return terminados; }
+    size_t archivos_con_errores() const { return con_errores; }
+
+private:
+    Configurar configurar;
+    AlTerminar al_terminar;
+
+    mutex m_cola;
+    condition_variable hay_trabajo;
+    deque<string> cola;
+    bool cerrado = false;
+
+    mutex m_resultados;                  // serializa al_terminar y los contadores
+    size_t terminados = 0;
+    size_t con_errores = 0;
+
+    vector<thread> grupo;
+
+    void trabajar();
+};
+
+// "a/b.asm" -> "a/b"; sin ".asm" la ruta queda igual
+string base_salida(const string& archivo);
+
+#endif // LOTE_ENSAMBLADO_HPP
@@ -0,0 +1,42 @@
+#ifndef PARALELO_HPP
+#define PARALELO_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// -----------------------------------------------------------------------------
+// Reparto de bloques entre hilos
+// -----------------------------------------------------------------------------
+// Lanza min(hilos, bloques) hilos que toman índices de bloque de un contador
+// atómico hasta agotarlos; f(bloque) no debe escribir fuera de su bloque.
+// Con un solo hilo (o un solo bloque) todo corre en el hilo que llama.
+
+inline unsigned hilos_disponibles() {
+    unsigned n = std::thread::hardware_concurrency();
+    return n == 0 ? 1 : n;
+}
+
+template <typename F>
+void para_cada_bloque(unsigned hilos, size_t bloques, F&& f) {
+    if (hilos <= 1 || bloques <= 1) {
+        for (size_t b = 0; b < bloques; ++b) f(b);
+        return;
+    }
+
+    std::atomic<size_t> siguiente{0};
+    auto trabajar = [&]() {
+        for (size_t b = siguiente++; b < bloques; b = siguiente++) f(b);
+    };
+
+    const size_t extra = std::min<size_t>(hilos, bloques) - 1;
+    std::vector<std::thread> grupo;
+    grupo.reserve(extra);
+    for (size_t i = 0; i < extra; ++i) grupo.emplace_back(trabajar);
+    trabajar();   // el hilo que llama también trabaja
+    for (std::thread& h : grupo) h.join();
+}
+
+#endif // PARALELO_HPP
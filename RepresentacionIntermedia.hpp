@@ -0,0 +1,79 @@
+#ifndef REPRESENTACION_INTERMEDIA_HPP
+#define REPRESENTACION_INTERMEDIA_HPP
+
+#include <cstdint>
+
+// -----------------------------------------------------------------------------
+// Representación intermedia (IR) producida por la PASADA 1
+// -----------------------------------------------------------------------------
+// Cada línea útil del fuente se analiza una sola vez y queda como una entrada
+// de tamaño fijo en un arreglo contiguo. La PASADA 2 ya no toca el texto:
+// recorre este arreglo y solo emite bytes.
+
+inline constexpr uint8_t  SIN_REG     = 0xFF;
+inline constexpr uint32_t SIN_SIMBOLO = 0xFFFFFFFFu;
+
+// Operando de memoria ya analizado: [simbolo + base + indice*escala + disp]
+struct DireccionIR {
+    uint8_t  base    = SIN_REG;
+    uint8_t  indice  = SIN_REG;
+    uint8_t  escala  = 1;            // 1, 2, 4 u 8
+    int32_t  disp    = 0;
+    uint32_t simbolo = SIN_SIMBOLO;  // id en nombres_simbolo
+};
+
+// Secciones del programa; cada una lleva su propio contador de posición
+enum IdSeccion : uint8_t {
+    SEC_TEXT,
+    SEC_DATA,
+    SEC_BSS,          // solo reserva espacio: no ocupa bytes en la salida
+    NUM_SECCIONES
+};
+
+enum TipoIR : uint8_t {
+    IR_INSTRUCCION,   // fila de TABLA_OPCODES + operandos
+    IR_ETIQUETA,      // definición de etiqueta (valor[0] = id de símbolo)
+    IR_DATOS,         // DD/DB: valor[0] = inicio en datos_ir, valor[1] = cantidad
+    IR_SECCION,       // SECTION: valor[0] = IdSeccion
+    IR_RESERVA,       // RESB/RESW/RESD: valor[0] = bytes reservados
+    IR_AMBITO,        // GLOBAL/EXTERN: valor[0] = id de símbolo, reg[0] = AmbitoSimbolo
+    IR_ALINEACION     // ALIGN: valor[0] = alineación, valor[1] = relleno con la disposición
+                      // actual, reg[0] = RellenoAlineacion, reg[1] = relleno máximo (0 = sin límite)
+};
+
+// Con qué bytes se rellena un ALIGN (en .bss solo avanza el contador)
+enum RellenoAlineacion : uint8_t {
+    RELLENO_CEROS,
+    RELLENO_NOP       // NOP de varios bytes (NOPS_LARGOS)
+};
+
+struct InstruccionIR {
+    uint8_t     tipo;         // TipoIR
+    uint8_t     tamano;       // bytes de la instrucción (calculado en la PASADA 1)
+    uint16_t    fila;         // índice en TABLA_OPCODES
+    uint8_t     tipo_op[2];   // TipoOperando de cada operando
+    uint8_t     reg[2];       // registro (OP_R32 / OP_R8); en IR_DATOS reg[0] = 1 o 4
+    uint32_t    valor[2];     // inmediato (OP_IMM) o id de símbolo (OP_ETIQUETA / OP_IMM_SIMBOLO)
+    DireccionIR mem;          // a lo sumo un operando de memoria por instrucción
+    uint8_t     salto_corto;  // C_SALTO: 1 = rel8 (decidido en la PASADA 1); valor[1] = desplazamiento rel8
+    uint8_t     seccion;      // IdSeccion donde queda la entrada (en IR_SECCION, la nueva)
+};
+
+// Relleno de un IR_ALINEACION que empieza en 'posicion' de su sección. Si
+// pasa del máximo no se alinea (así un bucle no paga 15 NOP por 1 byte)
+inline uint32_t relleno_alineacion(const InstruccionIR& ir, int posicion) {
+    const uint32_t alineacion = ir.valor[0];
+    const uint32_t relleno = (alineacion - static_cast<uint32_t>(posicion) % alineacion) % alineacion;
+    return (ir.reg[1] != 0 && relleno > ir.reg[1]) ? 0 : relleno;
+}
+
+// Bytes que ocupa una entrada con la decisión de salto (y de relleno) actual
+inline int tamano_ir(const InstruccionIR& ir) {
+    if (ir.tipo == IR_DATOS) return static_cast<int>(ir.valor[1]) * ir.reg[0];
+    if (ir.tipo == IR_RESERVA) return static_cast<int>(ir.valor[0]);
+    if (ir.tipo == IR_ALINEACION) return static_cast<int>(ir.valor[1]);
+    if (ir.tipo != IR_INSTRUCCION) return 0;
+    return ir.tamano;
+}
+
+#endif // REPRESENTACION_INTERMEDIA_HPP
@@ -0,0 +1,575 @@
+#include "SesionEnsamblado.hpp"
+
+#include <chrono>
+#include <iterator>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Utilidades
+// -----------------------------------------------------------------------------
+
+static uint32_t leer_le32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void escribir_le32(uint8_t* p, uint32_t valor) {
+    p[0] = static_cast<uint8_t>(valor & 0xFF);
+    p[1] = static_cast<uint8_t>((valor >> 8) & 0xFF);
+    p[2] = static_cast<uint8_t>((valor >> 16) & 0xFF);
+    p[3] = static_cast<uint8_t>((valor >> 24) & 0xFF);
+}
+
+static bool es_salto(const InstruccionIR& ir) {
+    return ir.tipo == IR_INSTRUCCION && TABLA_OPCODES[ir.fila].cod == C_SALTO;
+}
+
+// v[desde, desde + cantidad) pasa a ser [primero, ultimo)
+template <typename T, typename It>
+static void reemplazar_tramo(vector<T>& v, size_t desde, size_t cantidad, It primero, It ultimo) {
+    const size_t n = static_cast<size_t>(distance(primero, ultimo));
+    const size_t comun = min(n, cantidad);
+    copy(primero, next(primero, static_cast<ptrdiff_t>(comun)), v.begin() + desde);
+    if (n > cantidad) {
+        v.insert(v.begin() + desde + comun, next(primero, static_cast<ptrdiff_t>(comun)), ultimo);
+    } else {
+        v.erase(v.begin() + desde + comun, v.begin() + desde + cantidad);
+    }
+}
+
+// v[desde, desde + cantidad) pasa a ser n copias de 'valor'
+template <typename T>
+static void rellenar_tramo(vector<T>& v, size_t desde, size_t cantidad, size_t n, T valor) {
+    const size_t comun = min(n, cantidad);
+    fill(v.begin() + desde, v.begin() + desde + comun, valor);
+    if (n > cantidad) v.insert(v.begin() + desde + comun, n - cantidad, valor);
+    else              v.erase(v.begin() + desde + comun, v.begin() + desde + cantidad);
+}
+
+// "a\nb\n" -> {"a", "b"}; "" -> {}
+static vector<string_view> dividir_lineas(string_view texto) {
+    vector<string_view> lineas;
+    size_t inicio = 0;
+    while (inicio < texto.size()) {
+        size_t fin = texto.find('\n', inicio);
+        if (fin == string_view::npos) fin = texto.size();
+        lineas.push_back(texto.substr(inicio, fin - inicio));
+        inicio = fin + 1;
+    }
+    return lineas;
+}
+
+// -----------------------------------------------------------------------------
+// Apertura y reensamblado completo
+// -----------------------------------------------------------------------------
+
+SesionEnsamblado::SesionEnsamblado() {
+    ens.usar_salida_detallada(false);
+    ens.con_indice_lineas = true;
+}
+
+// Las líneas editadas se vuelven a analizar sin -Os ni alineación de
+// bucles: la sesión los apaga para que el resultado sea siempre el de
+// ensamblar el texto completo
+bool SesionEnsamblado::abrir(const string& archivo) {
+    ens.usar_una_pasada(false);
+    ens.usar_tamano_minimo(false);
+    ens.usar_alinear_bucles(0);
+    ens.inicio_ir_linea.clear();
+    ens.ensamblar(archivo);
+    textos.clear();
+    fijar_lineas();
+    indexar();
+    return abierta;
+}
+
+bool SesionEnsamblado::abrir_texto(string_view codigo) {
+    ens.usar_una_pasada(false);
+    ens.usar_tamano_minimo(false);
+    ens.usar_alinear_bucles(0);
+    ens.ensamblar_texto(codigo);
+    textos.clear();
+    fijar_lineas();
+    indexar();
+    return abierta;
+}
+
+void SesionEnsamblado::fijar_lineas() {
+    lineas.resize(ens.fuente.num_lineas());
+    for (size_t i = 0; i < lineas.size(); ++i) lineas[i] = ens.fuente.linea(i);
+}
+
+string SesionEnsamblado::texto() const {
+    size_t bytes = 0;
+    for (string_view l : lineas) bytes += l.size() + 1;
+    string t;
+    t.reserve(bytes);
+    for (string_view l : lineas) {
+        t += l;
+        t += '\n';
+    }
+    return t;
+}
+
+void SesionEnsamblado::reensamblar() {
+    const string t = texto();
+    ens.ensamblar_texto(t);
+    textos.clear();
+    fijar_lineas();
+    indexar();
+}
+
+// Posición de cada entrada y primera referencia que emite: las referencias
+// están en orden de emisión, así que se reparten recorriendo ambas listas
+void SesionEnsamblado::indexar() {
+    const vector<InstruccionIR>& ir = ens.programa_ir;
+    const vector<ReferenciaPendiente>& refs = ens.referencias_pendientes;
+    abierta = ens.inicio_ir_linea.size() == lineas.size() + 1;
+    if (!abierta) return;
+
+    const size_t n = ir.size();
+    posicion.resize(n);
+    primera_ref.resize(n + 1);
+    int contador[NUM_SECCIONES] = {};
+    size_t r = 0;
+    for (size_t i = 0; i < n; ++i) {
+        primera_ref[i] = static_cast<uint32_t>(r);
+        if (ir[i].tipo == IR_SECCION) {
+            posicion[i] = contador[ir[i].valor[0]];
+            continue;
+        }
+        const uint8_t s = ir[i].seccion;
+        posicion[i] = contador[s];
+        contador[s] += tamano_ir(ir[i]);
+        while (r < refs.size() && refs[r].seccion == s && refs[r].posicion < contador[s]) ++r;
+    }
+    primera_ref[n] = static_cast<uint32_t>(r);
+
+    const size_t simbolos = ens.tabla_simbolos.size();
+    definiciones.assign(simbolos, 0);
+    duplicadas = false;
+    for (bool& a : con_alineacion) a = false;
+    for (const InstruccionIR& e : ir) {
+        if (e.tipo == IR_ETIQUETA && ++definiciones[e.valor[0]] > 1) duplicadas = true;
+        if (e.tipo == IR_ALINEACION) con_alineacion[e.seccion] = true;
+    }
+    marca.assign(simbolos, 0);
+    anterior.assign(simbolos, -1);
+    marca_ventana.assign(simbolos, 0);
+    posicion_ventana.assign(simbolos, 0);
+}
+
+// -----------------------------------------------------------------------------
+// Edición
+// -----------------------------------------------------------------------------
+
+bool SesionEnsamblado::reemplazar_lineas(size_t desde, size_t cantidad, string_view texto_nuevo) {
+    auto t = chrono::steady_clock::now();
+    edicion = EstadisticasEdicion();
+    if (!abierta || desde > lineas.size() || cantidad > lineas.size() - desde) {
+        *ens.salida_errores << "Edicion fuera de rango: lineas " << desde << " a " << desde + cantidad
+                            << " de " << lineas.size() << endl;
+        return false;
+    }
+
+    textos.push_back(make_unique<string>(texto_nuevo));
+    const vector<string_view> nuevas = dividir_lineas(*textos.back());
+    reemplazar_tramo(lineas, desde, cantidad, nuevas.begin(), nuevas.end());
+    edicion.lineas_analizadas = nuevas.size();
+
+    ens.errores = 0;
+    edicion.incremental = editar(desde, cantidad, nuevas);
+    if (!edicion.incremental) reensamblar();
+    edicion.segundos = chrono::duration<double>(chrono::steady_clock::now() - t).count();
+    return true;
+}
+
+// PASADA 1 de las líneas nuevas como si estuvieran en 'seccion' / 'inicio'.
+// La IR principal se aparta un momento para que agregar_ir() llene 'ir'
+void SesionEnsamblado::analizar(const vector<string_view>& nuevas, uint8_t seccion, int inicio,
+                                vector<InstruccionIR>& ir, vector<uint32_t>& inicio_linea,
+                                ostream& mensajes) {
+    int contador[NUM_SECCIONES];
+    for (int s = 0; s < NUM_SECCIONES; ++s) contador[s] = ens.secciones[s].contador;
+    ostream* salida = ens.salida_errores;
+
+    swap(ens.programa_ir, ir);
+    ens.salida_errores    = &mensajes;
+    ens.primera_pasada    = true;
+    ens.seccion_actual    = seccion;
+    ens.contador_posicion = inicio;
+    for (string_view linea : nuevas) {
+        inicio_linea.push_back(static_cast<uint32_t>(ens.programa_ir.size()));
+        ens.procesar_linea(linea);
+    }
+    swap(ens.programa_ir, ir);
+
+    for (int s = 0; s < NUM_SECCIONES; ++s) ens.secciones[s].contador = contador[s];
+    ens.salida_errores    = salida;
+    ens.primera_pasada    = false;
+    ens.seccion_actual    = SEC_TEXT;
+    ens.contador_posicion = ens.secciones[SEC_TEXT].contador;
+}
+
+// Guarda la dirección que tenía el símbolo antes de esta edición
+void SesionEnsamblado::marcar(uint32_t simbolo) {
+    if (marca[simbolo] == marca_actual) return;
+    marca[simbolo]    = marca_actual;
+    anterior[simbolo] = (ens.tabla_simbolos[simbolo] == SIN_DIRECCION)
+                        ? -1 : static_cast<int64_t>(ens.direccion_simbolo(simbolo));
+}
+
+int SesionEnsamblado::tamano_entrada(const Ventana& v, size_t i) const {
+    const InstruccionIR& ir = ens.programa_ir[i];
+    if (es_salto(ir)) return tamano_salto(TABLA_OPCODES[ir.fila], v.corto[i - v.desde]);
+    return tamano_ir(ir);
+}
+
+// Agranda la ventana hasta tener MARGEN bytes de la sección a cada lado de
+// lo que cambió (o hasta donde la sección no tiene más bytes)
+bool SesionEnsamblado::extender_ventana(Ventana& v, uint8_t seccion, int total_anterior) {
+    const vector<InstruccionIR>& ir = ens.programa_ir;
+    bool extendida = false;
+    while (v.desde > 0 && v.inicio > 0 && v.inicio > v.cambio_desde - MARGEN) {
+        const InstruccionIR& e = ir[--v.desde];
+        v.ref_desde = primera_ref[v.desde];
+        extendida = true;
+        if (e.seccion != seccion) continue;
+        v.inicio = posicion[v.desde];
+        v.tamano_anterior += tamano_ir(e);
+        v.tamano          += tamano_ir(e);
+        if (e.tipo == IR_ETIQUETA) marcar(e.valor[0]);
+    }
+    while (v.hasta < ir.size() && v.inicio + v.tamano < v.cambio_hasta + MARGEN &&
+           v.inicio + v.tamano_anterior < total_anterior) {
+        const InstruccionIR& e = ir[v.hasta++];
+        v.ref_hasta = primera_ref[v.hasta];
+        extendida = true;
+        if (e.seccion != seccion) continue;
+        v.tamano_anterior += tamano_ir(e);
+        v.tamano          += tamano_ir(e);
+        if (e.tipo == IR_ETIQUETA) marcar(e.valor[0]);
+    }
+    return extendida;
+}
+
+// La misma relajación que relajar_saltos() (todo rel8 y crecer lo que no
+// cabe), limitada a la ventana: fuera de ella las etiquetas de la sección
+// conservan su posición si van antes o se corren lo que cambió la ventana
+void SesionEnsamblado::relajar_ventana(Ventana& v, uint8_t seccion, size_t inicio_nuevas,
+                                       size_t fin_nuevas) {
+    const vector<InstruccionIR>& ir = ens.programa_ir;
+    const size_t n = v.hasta - v.desde;
+    v.corto.assign(n, 0);
+    v.desplazamiento.assign(n, 0);
+    v.posiciones.assign(n, 0);
+    v.saltos = 0;
+    for (size_t k = 0; k < n; ++k) {
+        const InstruccionIR& e = ir[v.desde + k];
+        if (!es_salto(e)) continue;
+        if (e.seccion == seccion) {
+            v.corto[k] = 1;
+            ++v.saltos;
+        } else {
+            v.corto[k] = e.salto_corto;   // otra sección: no se mueve
+        }
+    }
+
+    const int fin_anterior = v.inicio + v.tamano_anterior;
+    bool cambio = true;
+    while (cambio) {
+        cambio = false;
+        ++marca_ventana_actual;
+        int pos = v.inicio;
+        for (size_t k = 0; k < n; ++k) {
+            const InstruccionIR& e = ir[v.desde + k];
+            if (e.seccion != seccion) continue;
+            v.posiciones[k] = pos;
+            if (e.tipo == IR_ETIQUETA) {
+                marca_ventana[e.valor[0]]    = marca_ventana_actual;
+                posicion_ventana[e.valor[0]] = pos;
+            }
+            pos += tamano_entrada(v, v.desde + k);
+        }
+        v.tamano = pos - v.inicio;
+        const int delta = v.tamano - v.tamano_anterior;
+
+        for (size_t k = 0; k < n; ++k) {
+            const InstruccionIR& e = ir[v.desde + k];
+            if (e.seccion != seccion || !v.corto[k] || !es_salto(e)) continue;
+            const uint32_t id = e.valor[0];
+            bool definido = true;
+            int destino = 0;
+            if (marca_ventana[id] == marca_ventana_actual) {
+                destino = posicion_ventana[id];
+            } else if (definiciones[id] > 0 && ens.seccion_simbolo[id] == seccion) {
+                destino = ens.tabla_simbolos[id];
+                if (destino >= fin_anterior) destino += delta;
+            } else {
+                definido = false;
+            }
+            int offset = destino - (v.posiciones[k] + 2);
+            if (!definido || offset < -128 || offset > 127) {
+                v.corto[k] = 0;
+                cambio = true;
+            } else {
+                v.desplazamiento[k] = static_cast<uint32_t>(offset);
+            }
+        }
+    }
+
+    // Lo que cambió de tamaño: las líneas nuevas (aunque no tengan bytes) y
+    // los saltos que quedaron distinto que antes
+    v.cambio_desde = v.inicio + v.tamano;
+    v.cambio_hasta = v.inicio;
+    auto abarcar = [&v](int desde, int hasta) {
+        v.cambio_desde = min(v.cambio_desde, desde);
+        v.cambio_hasta = max(v.cambio_hasta, hasta);
+    };
+    int pos = v.inicio;
+    for (size_t k = 0; k < n; ++k) {
+        const size_t i = v.desde + k;
+        if (i == inicio_nuevas) abarcar(pos, pos);
+        const InstruccionIR& e = ir[i];
+        if (e.seccion != seccion) continue;
+        const int tamano = tamano_entrada(v, i);
+        if ((i >= inicio_nuevas && i < fin_nuevas) || tamano != tamano_ir(e)) abarcar(pos, pos + tamano);
+        pos += tamano;
+    }
+    if (fin_nuevas == v.hasta) abarcar(pos, pos);
+}
+
+bool SesionEnsamblado::editar(size_t desde, size_t cantidad, const vector<string_view>& nuevas) {
+    if (duplicadas) return false;   // cuál definición vale depende del texto completo
+    if (ens.con_expresiones) return false;   // un EQU o '$' puede depender de cualquier línea
+    vector<InstruccionIR>& ir = ens.programa_ir;
+    const size_t a = ens.inicio_ir_linea[desde];
+    const size_t b = ens.inicio_ir_linea[desde + cantidad];
+    for (size_t i = a; i < b; ++i) {
+        if (ir[i].tipo == IR_SECCION || ir[i].tipo == IR_AMBITO) return false;
+    }
+
+    // Sección y posición donde empiezan las líneas editadas
+    const uint8_t seccion = (a > 0) ? ir[a - 1].seccion : static_cast<uint8_t>(SEC_TEXT);
+    const int inicio      = (a > 0) ? posicion[a - 1] + tamano_ir(ir[a - 1]) : 0;
+    const int total_anterior = ens.secciones[seccion].contador;
+    if (con_alineacion[seccion]) return false;
+
+    ++marca_actual;
+    int tamano_anterior = 0;
+    vector<uint32_t> quitadas;
+    for (size_t i = a; i < b; ++i) {
+        tamano_anterior += tamano_ir(ir[i]);
+        if (ir[i].tipo != IR_ETIQUETA) continue;
+        marcar(ir[i].valor[0]);
+        --definiciones[ir[i].valor[0]];
+        quitadas.push_back(ir[i].valor[0]);
+    }
+
+    vector<InstruccionIR> nueva;
+    vector<uint32_t> inicio_nuevas;
+    ostringstream mensajes;
+    analizar(nuevas, seccion, inicio, nueva, inicio_nuevas, mensajes);
+    if (ens.con_expresiones) return false;   // las líneas nuevas traen EQU o expresiones
+
+    const size_t simbolos = ens.tabla_simbolos.size();
+    definiciones.resize(simbolos, 0);
+    marca.resize(simbolos, 0);
+    anterior.resize(simbolos, -1);
+    marca_ventana.resize(simbolos, 0);
+    posicion_ventana.resize(simbolos, 0);
+
+    // Una etiqueta nueva no estaba definida (si no, queda duplicada) y una
+    // quitada no puede seguir definida en otra línea
+    ++marca_ventana_actual;
+    for (const InstruccionIR& e : nueva) {
+        if (e.tipo == IR_SECCION || e.tipo == IR_ALINEACION) return false;
+        if (e.tipo != IR_ETIQUETA) continue;
+        const uint32_t id = e.valor[0];
+        if (marca[id] != marca_actual) {
+            marca[id]    = marca_actual;
+            anterior[id] = -1;
+        }
+        if (++definiciones[id] > 1) return false;
+        marca_ventana[id] = marca_ventana_actual;
+    }
+    for (uint32_t id : quitadas) {
+        if (definiciones[id] > 0 && marca_ventana[id] != marca_ventana_actual) return false;
+    }
+
+    // --- IR, posiciones, referencias por entrada e índice de líneas ---
+    const size_t n_anterior = b - a, n_nuevo = nueva.size();
+    reemplazar_tramo(ir, a, n_anterior, nueva.begin(), nueva.end());
+    rellenar_tramo(posicion, a, n_anterior, n_nuevo, inicio);
+    const uint32_t ref_a = primera_ref[a], ref_b = primera_ref[b];
+    rellenar_tramo(primera_ref, a, n_anterior, n_nuevo, ref_a);
+    for (uint32_t& i : inicio_nuevas) i += static_cast<uint32_t>(a);
+    vector<uint32_t>& lineas_ir = ens.inicio_ir_linea;
+    reemplazar_tramo(lineas_ir, desde, cantidad, inicio_nuevas.begin(), inicio_nuevas.end());
+    const uint32_t delta_ir = static_cast<uint32_t>(n_nuevo - n_anterior);   // módulo 2^32
+    for (size_t l = desde + nuevas.size(); l < lineas_ir.size(); ++l) lineas_ir[l] += delta_ir;
+
+    // --- Relajación en la ventana, agrandándola hasta que lo que cambió
+    // quede a MARGEN bytes de sus bordes ---
+    Ventana v;
+    v.desde = a;
+    v.hasta = a + n_nuevo;
+    v.inicio = inicio;
+    v.tamano_anterior = tamano_anterior;
+    v.ref_desde = ref_a;
+    v.ref_hasta = ref_b;
+    v.tamano = 0;
+    for (size_t i = a; i < v.hasta; ++i) v.tamano += tamano_ir(ir[i]);
+    v.cambio_desde = inicio;
+    v.cambio_hasta = inicio + v.tamano;
+    do {
+        extender_ventana(v, seccion, total_anterior);
+        if (v.tamano_anterior == 0 && v.hasta - v.desde != ir.size()) return false;   // sección vacía
+        relajar_ventana(v, seccion, a, a + n_nuevo);
+    } while (extender_ventana(v, seccion, total_anterior));   // más grande: relajar otra vez
+
+    *ens.salida_errores << mensajes.str();
+    aplicar_ventana(v, seccion);
+    return true;
+}
+
+// Escribe la ventana relajada: IR, bytes y referencias de la ventana, corre
+// lo que sigue en la sección y reparchea las referencias que lo necesitan
+void SesionEnsamblado::aplicar_ventana(const Ventana& v, uint8_t seccion) {
+    vector<InstruccionIR>& ir = ens.programa_ir;
+    vector<ReferenciaPendiente>& refs = ens.referencias_pendientes;
+    const int delta        = v.tamano - v.tamano_anterior;
+    const int fin_anterior = v.inicio + v.tamano_anterior;
+
+    for (size_t k = 0; k < v.hasta - v.desde; ++k) {
+        InstruccionIR& e = ir[v.desde + k];
+        if (e.seccion != seccion) continue;
+        posicion[v.desde + k] = v.posiciones[k];
+        if (!es_salto(e)) continue;
+        e.salto_corto = v.corto[k];
+        e.tamano      = tamano_salto(TABLA_OPCODES[e.fila], v.corto[k]);
+        if (v.corto[k]) e.valor[1] = v.desplazamiento[k];
+    }
+    for (size_t i = v.hasta; i < ir.size(); ++i) {
+        if (ir[i].seccion == seccion) posicion[i] += delta;
+    }
+
+    // Etiquetas: las de la ventana en su lugar nuevo, las quitadas sin
+    // dirección y las que siguen en la sección corridas
+    for (uint32_t id = 0; id < ens.tabla_simbolos.size(); ++id) {
+        int& dir = ens.tabla_simbolos[id];
+        if (marca_ventana[id] == marca_ventana_actual) {
+            dir = posicion_ventana[id];
+            ens.seccion_simbolo[id] = seccion;
+        } else if (definiciones[id] == 0) {
+            dir = SIN_DIRECCION;
+        } else if (dir != SIN_DIRECCION && ens.seccion_simbolo[id] == seccion && dir >= fin_anterior) {
+            marcar(id);   // antes de correrla (las bases todavía son las de antes)
+            dir += delta;
+        }
+    }
+
+    // --- Bytes: hueco del tamaño nuevo y la ventana codificada en su lugar ---
+    SeccionEnsamblado& sec = ens.secciones[seccion];
+    if (seccion != SEC_BSS) {
+        rellenar_tramo(sec.bytes, static_cast<size_t>(v.inicio), static_cast<size_t>(v.tamano_anterior),
+                       static_cast<size_t>(v.tamano), uint8_t{0});
+    }
+    sec.contador += delta;
+    for (int s = 0; s < NUM_SECCIONES; ++s) {
+        ens.destino[s] = ens.secciones[s].bytes.empty() ? nullptr : ens.secciones[s].bytes.data();
+    }
+
+    const size_t ref_desde = v.ref_desde, ref_hasta = v.ref_hasta;
+    vector<ReferenciaPendiente> nuevas;
+    swap(refs, nuevas);
+    for (size_t i = v.desde; i < v.hasta; ++i) {
+        primera_ref[i] = static_cast<uint32_t>(ref_desde + refs.size());
+        if (ir[i].tipo == IR_SECCION) continue;
+        ens.seccion_actual    = ir[i].seccion;
+        ens.contador_posicion = posicion[i];
+        ens.codificar_ir(ir[i]);
+    }
+    swap(refs, nuevas);
+    for (uint8_t*& d : ens.destino) d = nullptr;
+    ens.seccion_actual    = SEC_TEXT;
+    ens.contador_posicion = ens.secciones[SEC_TEXT].contador;
+
+    reemplazar_tramo(refs, ref_desde, ref_hasta - ref_desde, nuevas.begin(), nuevas.end());
+    const size_t ref_fin = ref_desde + nuevas.size();
+    const uint32_t delta_refs = static_cast<uint32_t>(ref_fin - ref_hasta);   // módulo 2^32
+    for (size_t i = v.hasta; i < primera_ref.size(); ++i) primera_ref[i] += delta_refs;
+    for (size_t k = ref_fin; k < refs.size(); ++k) {
+        if (refs[k].seccion == seccion) refs[k].posicion += delta;
+    }
+
+    // --- Bases (las que siguen a la sección editada se corren) ---
+    uint32_t base_anterior[NUM_SECCIONES];
+    for (int s = 0; s < NUM_SECCIONES; ++s) base_anterior[s] = ens.secciones[s].base;
+    ens.asignar_bases();
+
+    // --- Referencias: las de la ventana tienen el sumando en el hueco; las
+    // demás ya estaban resueltas y se corrigen solo si cambió su destino o,
+    // siendo relativas, la distancia ---
+    vector<uint32_t> sin_definir;
+    for (size_t k = 0; k < refs.size(); ++k) {
+        const ReferenciaPendiente& ref = refs[k];
+        if (k >= ref_desde && k < ref_fin) {
+            if (!ens.resolver_referencia(ref)) {
+                if (ens.tabla_simbolos[ref.simbolo] == SIN_DIRECCION) sin_definir.push_back(ref.simbolo);
+                else                                                  ens.avisar_fuera_de_alcance(ref);
+            }
+            ++edicion.referencias_parcheadas;
+            continue;
+        }
+
+        const uint32_t id = ref.simbolo;
+        const int dir = ens.tabla_simbolos[id];
+        const uint8_t sec_destino = ens.seccion_simbolo[id];
+        const int64_t destino = (dir == SIN_DIRECCION) ? -1 : int64_t{ens.secciones[sec_destino].base} + dir;
+        int64_t destino_anterior;
+        if (marca[id] == marca_actual) {
+            destino_anterior = anterior[id];
+        } else if (dir == SIN_DIRECCION) {
+            destino_anterior = -1;
+        } else {
+            destino_anterior = int64_t{base_anterior[sec_destino]} + dir;
+        }
+
+        const bool relativo = ref.tipo_salto != 0;
+        const int64_t siguiente = int64_t{ens.secciones[ref.seccion].base} + ref.posicion + ref.tamano_inmediato;
+        const int64_t siguiente_anterior = int64_t{base_anterior[ref.seccion]} + ref.posicion + ref.tamano_inmediato
+                                           - ((ref.seccion == seccion && k >= ref_fin) ? delta : 0);
+        if (destino == destino_anterior && (!relativo || destino < 0 || siguiente == siguiente_anterior)) continue;
+
+        uint8_t* hueco = ens.secciones[ref.seccion].bytes.data() + ref.posicion;
+        int64_t valor = (ref.tamano_inmediato == 4) ? int64_t{static_cast<int32_t>(leer_le32(hueco))}
+                                                    : int64_t{static_cast<int8_t>(hueco[0])};
+        if (destino_anterior >= 0) valor -= destino_anterior - (relativo ? siguiente_anterior : 0);   // sumando
+        if (destino >= 0) valor += destino - (relativo ? siguiente : 0);
+        else              sin_definir.push_back(id);
+
+        if (ref.tamano_inmediato == 4) {
+            escribir_le32(hueco, static_cast<uint32_t>(valor));
+        } else if (relativo && destino >= 0 && (valor < -128 || valor > 127)) {
+            ens.avisar_fuera_de_alcance(ref);   // el hueco conserva el desplazamiento anterior
+        } else {
+            hueco[0] = static_cast<uint8_t>(valor & 0xFF);
+        }
+        ++edicion.referencias_parcheadas;
+    }
+
+    ++marca_ventana_actual;   // una advertencia por etiqueta
+    for (uint32_t id : sin_definir) {
+        if (ens.ambito_simbolo[id] == AMBITO_EXTERNO || marca_ventana[id] == marca_ventana_actual) continue;
+        marca_ventana[id] = marca_ventana_actual;
+        ++ens.errores;
+        *ens.salida_errores << "Advertencia: Etiqueta no definida '" << ens.simbolos.nombre(id)
+                            << "'. Referencia no resuelta." << endl;
+    }
+    ens.armar_imagen();
+
+    edicion.entradas_codificadas = v.hasta - v.desde;
+    edicion.saltos_relajados     = v.saltos;
+    edicion.delta_bytes          = delta;
+}
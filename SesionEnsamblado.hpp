@@ -0,0 +1,122 @@
+#ifndef SESION_ENSAMBLADO_HPP
+#define SESION_ENSAMBLADO_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "EnsambladorIA32.hpp"
+
+// -----------------------------------------------------------------------------
+// Sesión de ensamblado incremental
+// -----------------------------------------------------------------------------
+// Ensambla una vez y conserva la IR, la posición de cada entrada y qué
+// referencias emitió. reemplazar_lineas() cambia un rango de líneas y solo:
+//   - analiza las líneas nuevas (PASADA 1 en la sección y posición donde van),
+//   - relaja los saltos de una ventana alrededor de la edición (MARGEN bytes
+//     a cada lado, más si algún salto de la ventana cambió de tamaño cerca
+//     del borde: fuera de ella ningún rel8 puede dejar de caber ni empezar a),
+//   - recodifica esa ventana y corre lo que sigue en su sección,
+//   - reparchea las referencias cuyo destino o hueco se movió.
+// El resultado es el mismo que ensamblar el texto editado desde cero. Los
+// ids de símbolo nuevos van al final, así que el orden de los símbolos en el
+// ELF puede diferir. Desplazar la IR, los bytes y las posiciones que siguen
+// es lineal (memmove y sumas), pero no se vuelve a tocar el texto.
+//
+// Si la edición agrega o quita SECTION, quita GLOBAL/EXTERN, escribe en una
+// sección que estaba vacía o que tiene (o tendría) ALIGN, o hay (o queda) una
+// etiqueta definida dos veces, se vuelve a ensamblar el texto completo (ver
+// EstadisticasEdicion::incremental): un ALIGN cambia de tamaño con cualquier
+// corrimiento de lo que tiene antes. La sesión no usa -Os ni --alinear-bucles.
+
+struct EstadisticasEdicion {
+    bool incremental = false;         // false = se reensambló todo el texto
+    size_t lineas_analizadas = 0;     // líneas nuevas pasadas por la PASADA 1
+    size_t entradas_codificadas = 0;  // entradas de la IR en la ventana
+    size_t saltos_relajados = 0;      // JMP/Jcc de la ventana
+    size_t referencias_parcheadas = 0;
+    int delta_bytes = 0;              // cambio de tamaño de la sección editada
+    double segundos = 0;
+};
+
+class SesionEnsamblado {
+public:
+    SesionEnsamblado();
+
+    // Para fijar bases, hilos o la salida detallada antes de abrir
+    EnsambladorIA32& ensamblador() { return ens; }
+    const EnsambladorIA32& ensamblador() const { return ens; }
+
+    // Ensamblado completo (siempre en dos pasadas); false si no hay sesión
+    bool abrir(const string& archivo);
+    bool abrir_texto(string_view codigo);
+
+    // Reemplaza las líneas [desde, desde + cantidad) por las de 'texto' (un
+    // '\n' final no agrega una línea vacía; texto vacío = borrar). false si
+    // el rango no existe. num_errores() del ensamblador pasa a contar solo
+    // los errores de las líneas nuevas y las etiquetas que quedaron sin definir
+    bool reemplazar_lineas(size_t desde, size_t cantidad, string_view texto);
+
+    size_t num_lineas() const { return lineas.size(); }
+    const EstadisticasEdicion& ultima_edicion() const { return edicion; }
+
+    // Texto actual con todas las ediciones aplicadas
+    string texto() const;
+
+private:
+    static constexpr int MARGEN = 256;   // > rel8 (127) + instrucción más larga
+
+    EnsambladorIA32 ens;
+    bool abierta = false;
+    EstadisticasEdicion edicion;
+
+    vector<int> posicion;                // entrada de la IR -> desplazamiento en su sección
+    vector<uint32_t> primera_ref;        // entrada -> primera referencia que emite (+ total)
+    vector<uint32_t> definiciones;       // símbolo -> etiquetas que lo definen
+    bool duplicadas = false;             // alguna etiqueta definida más de una vez
+    bool con_alineacion[NUM_SECCIONES] = {};   // la sección tiene algún ALIGN
+
+    // Por símbolo, válidos si su marca es la de la edición / ventana en curso
+    uint32_t marca_actual = 0;
+    vector<uint32_t> marca;              // tocado por la edición: 'anterior' vale
+    vector<int64_t> anterior;            // dirección absoluta antes de editar (-1 = no definida)
+    uint32_t marca_ventana_actual = 0;
+    vector<uint32_t> marca_ventana;      // definido dentro de la ventana
+    vector<int> posicion_ventana;        // su desplazamiento nuevo
+
+    // Líneas actuales: vistas a ens.fuente o a textos de ediciones
+    vector<string_view> lineas;
+    vector<unique_ptr<string>> textos;
+
+    // Ventana [desde, hasta) de la IR ya editada. Solo cambian de tamaño sus
+    // entradas de la sección editada; las de otras secciones quedan igual
+    struct Ventana {
+        size_t desde, hasta;
+        int inicio;                      // posición de la ventana en la sección (no cambia)
+        int tamano_anterior;             // bytes que ocupaba antes de la edición
+        int tamano;                      // bytes con las decisiones de 'corto'
+        size_t ref_desde, ref_hasta;     // referencias que emitía (índices de antes)
+        vector<uint8_t> corto;           // decisión rel8 de cada entrada
+        vector<uint32_t> desplazamiento; // rel8 de los saltos cortos
+        vector<int> posiciones;          // posición nueva de cada entrada
+        int cambio_desde, cambio_hasta;  // bytes que cambiaron de tamaño (o la edición)
+        size_t saltos;
+    };
+
+    void indexar();
+    void reensamblar();
+    void fijar_lineas();
+    bool editar(size_t desde, size_t cantidad, const vector<string_view>& nuevas);
+    void analizar(const vector<string_view>& lineas, uint8_t seccion, int inicio,
+                  vector<InstruccionIR>& ir, vector<uint32_t>& inicio_linea, ostream& mensajes);
+    void marcar(uint32_t simbolo);
+    void relajar_ventana(Ventana& v, uint8_t seccion, size_t inicio_nuevas, size_t fin_nuevas);
+    bool extender_ventana(Ventana& v, uint8_t seccion, int total_anterior);
+    void aplicar_ventana(const Ventana& v, uint8_t seccion);
+    int tamano_entrada(const Ventana& v, size_t i) const;
+};
+
+#endif // SESION_ENSAMBLADO_HPP
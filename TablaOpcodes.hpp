@@ -0,0 +1,290 @@
+#ifndef TABLA_OPCODES_HPP
+#define TABLA_OPCODES_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+// -----------------------------------------------------------------------------
+// Tabla estática de opcodes IA-32
+// -----------------------------------------------------------------------------
+// Cada fila describe UNA forma de una instrucción: el mnemónico, la firma de
+// operandos (r32,r32 / r32,imm / r32,m32 / m32,imm ...) y cómo se codifica.
+// Las filas de un mismo mnemónico van juntas y en orden de preferencia: el
+// codificador genérico usa la primera cuya firma coincide con los operandos.
+// Agregar una instrucción = agregar filas aquí. Las filas marcadas "solo -Os"
+// van detrás de una más general que siempre coincide antes: sin -Os la
+// salida no cambia, y optimizar_tamano() las elige cuando son más cortas.
+
+// Patrón que debe cumplir cada operando de la fila
+enum PatronOperando : uint8_t {
+    P_NADA,     // sin operando
+    P_R32,      // registro de 32 bits
+    P_EAX,      // solo EAX (formas cortas 05 / 2D / A3 ...)
+    P_R8,       // registro de 8 bits
+    P_M32,      // memoria sin pista de tamaño o con DWORD
+    P_M8,       // memoria sin pista de tamaño o con BYTE
+    P_RM32,     // registro de 32 bits o memoria de 32 bits
+    P_IMM,      // inmediato de 32 bits
+    P_IMM8S,    // inmediato que cabe en 8 bits con signo (-128..127)
+    P_IMM8U,    // inmediato sin signo de 8 bits (0..255)
+    P_ETIQ,     // etiqueta sin corchetes (saltos, CALL, LOOP)
+    P_MOFFS     // [ETIQUETA + disp] o [disp], sin registros (MOV moffs32)
+};
+
+// Forma de codificación de la fila
+enum Codificacion : uint8_t {
+    C_SOLO_OPCODE,   // opcode (+ inmediato si tam_imm > 0)
+    C_MAS_REG,       // opcode + rd del operando 0 (INC, DEC, PUSH, POP, MOV r32,imm)
+    C_MODRM_RM_REG,  // ModR/M con R/M = operando 0, REG = operando 1
+    C_MODRM_REG_RM,  // ModR/M con REG = operando 0, R/M = operando 1
+    C_MODRM_EXT,     // ModR/M con REG = /ext, R/M = operando 0
+    C_MOFFS,         // opcode + disp32 absoluto del operando de memoria
+    C_REL8,          // opcode + rel8 (LOOP)
+    C_REL32,         // opcode + rel32 (CALL)
+    C_SALTO          // corto: opcode rel8 / near: [prefijo] ext rel32
+};
+
+struct FilaOpcode {
+    std::string_view mnem;
+    PatronOperando   op0;
+    PatronOperando   op1;
+    Codificacion     cod;
+    uint8_t          prefijo;   // 0x0F en opcodes de dos bytes, 0 si no hay
+    uint8_t          opcode;
+    uint8_t          ext;       // /digit en C_MODRM_EXT, opcode near en C_SALTO
+    uint8_t          tam_imm;   // bytes de inmediato al final: 0, 1 o 4
+};
+
+// Para C_SALTO el prefijo solo acompaña a la forma near (0F 8x rel32).
+inline constexpr FilaOpcode TABLA_OPCODES[] = {
+    // --- MOV ---
+    {"MOV",   P_MOFFS, P_EAX,   C_MOFFS,        0x00, 0xA3, 0,     0},
+    {"MOV",   P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x89, 0,     0},
+    {"MOV",   P_R32,   P_IMM,   C_MAS_REG,      0x00, 0xB8, 0,     4},
+    {"MOV",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x8B, 0,     0},
+    {"MOV",   P_M32,   P_IMM,   C_MODRM_EXT,    0x00, 0xC7, 0b000, 4},
+    {"MOV",   P_EAX,   P_MOFFS, C_MOFFS,        0x00, 0xA1, 0,     0},   // solo -Os
+
+    // --- Binarias: r/m32,r32 / r32,m32 / EAX,imm32 / r/m32,imm8 / r/m32,imm32 ---
+    {"ADD",   P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x01, 0,     0},
+    {"ADD",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x03, 0,     0},
+    {"ADD",   P_EAX,   P_IMM,   C_SOLO_OPCODE,  0x00, 0x05, 0,     4},
+    {"ADD",   P_RM32,  P_IMM8S, C_MODRM_EXT,    0x00, 0x83, 0b000, 1},
+    {"ADD",   P_RM32,  P_IMM,   C_MODRM_EXT,    0x00, 0x81, 0b000, 4},
+
+    {"SUB",   P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x29, 0,     0},
+    {"SUB",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x2B, 0,     0},
+    {"SUB",   P_EAX,   P_IMM,   C_SOLO_OPCODE,  0x00, 0x2D, 0,     4},
+    {"SUB",   P_RM32,  P_IMM8S, C_MODRM_EXT,    0x00, 0x83, 0b101, 1},
+    {"SUB",   P_RM32,  P_IMM,   C_MODRM_EXT,    0x00, 0x81, 0b101, 4},
+
+    {"CMP",   P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x39, 0,     0},
+    {"CMP",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x3B, 0,     0},
+    {"CMP",   P_EAX,   P_IMM,   C_SOLO_OPCODE,  0x00, 0x3D, 0,     4},
+    {"CMP",   P_RM32,  P_IMM8S, C_MODRM_EXT,    0x00, 0x83, 0b111, 1},
+    {"CMP",   P_RM32,  P_IMM,   C_MODRM_EXT,    0x00, 0x81, 0b111, 4},
+
+    {"AND",   P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x21, 0,     0},
+    {"AND",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x23, 0,     0},
+    {"AND",   P_EAX,   P_IMM,   C_SOLO_OPCODE,  0x00, 0x25, 0,     4},
+    {"AND",   P_RM32,  P_IMM8S, C_MODRM_EXT,    0x00, 0x83, 0b100, 1},
+    {"AND",   P_RM32,  P_IMM,   C_MODRM_EXT,    0x00, 0x81, 0b100, 4},
+
+    {"OR",    P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x09, 0,     0},
+    {"OR",    P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x0B, 0,     0},
+    {"OR",    P_EAX,   P_IMM,   C_SOLO_OPCODE,  0x00, 0x0D, 0,     4},
+    {"OR",    P_RM32,  P_IMM8S, C_MODRM_EXT,    0x00, 0x83, 0b001, 1},
+    {"OR",    P_RM32,  P_IMM,   C_MODRM_EXT,    0x00, 0x81, 0b001, 4},
+
+    {"XOR",   P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x31, 0,     0},
+    {"XOR",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x33, 0,     0},
+    {"XOR",   P_EAX,   P_IMM,   C_SOLO_OPCODE,  0x00, 0x35, 0,     4},
+    {"XOR",   P_RM32,  P_IMM8S, C_MODRM_EXT,    0x00, 0x83, 0b110, 1},
+    {"XOR",   P_RM32,  P_IMM,   C_MODRM_EXT,    0x00, 0x81, 0b110, 4},
+
+    // --- Otras de dos operandos ---
+    {"TEST",  P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x85, 0,     0},
+    {"XCHG",  P_RM32,  P_R32,   C_MODRM_RM_REG, 0x00, 0x87, 0,     0},
+    {"IMUL",  P_R32,   P_RM32,  C_MODRM_REG_RM, 0x0F, 0xAF, 0,     0},
+    {"MOVZX", P_R32,   P_R8,    C_MODRM_REG_RM, 0x0F, 0xB6, 0,     0},
+    {"MOVZX", P_R32,   P_M8,    C_MODRM_REG_RM, 0x0F, 0xB6, 0,     0},
+    {"LEA",   P_R32,   P_M32,   C_MODRM_REG_RM, 0x00, 0x8D, 0,     0},
+
+    // --- Un operando ---
+    {"INC",   P_R32,   P_NADA,  C_MAS_REG,      0x00, 0x40, 0,     0},
+    {"INC",   P_M32,   P_NADA,  C_MODRM_EXT,    0x00, 0xFF, 0b000, 0},
+    {"DEC",   P_R32,   P_NADA,  C_MAS_REG,      0x00, 0x48, 0,     0},
+    {"DEC",   P_M32,   P_NADA,  C_MODRM_EXT,    0x00, 0xFF, 0b001, 0},
+    {"MUL",   P_RM32,  P_NADA,  C_MODRM_EXT,    0x00, 0xF7, 0b100, 0},
+    {"DIV",   P_RM32,  P_NADA,  C_MODRM_EXT,    0x00, 0xF7, 0b110, 0},
+    {"IDIV",  P_RM32,  P_NADA,  C_MODRM_EXT,    0x00, 0xF7, 0b111, 0},
+    {"PUSH",  P_R32,   P_NADA,  C_MAS_REG,      0x00, 0x50, 0,     0},
+    {"PUSH",  P_IMM,   P_NADA,  C_SOLO_OPCODE,  0x00, 0x68, 0,     4},
+    {"PUSH",  P_M32,   P_NADA,  C_MODRM_EXT,    0x00, 0xFF, 0b110, 0},
+    {"PUSH",  P_IMM8S, P_NADA,  C_SOLO_OPCODE,  0x00, 0x6A, 0,     1},   // solo -Os
+    {"POP",   P_R32,   P_NADA,  C_MAS_REG,      0x00, 0x58, 0,     0},
+    {"POP",   P_M32,   P_NADA,  C_MODRM_EXT,    0x00, 0x8F, 0b000, 0},
+    {"INT",   P_IMM8U, P_NADA,  C_SOLO_OPCODE,  0x00, 0xCD, 0,     1},
+
+    // --- Sin operandos ---
+    {"LEAVE", P_NADA,  P_NADA,  C_SOLO_OPCODE,  0x00, 0xC9, 0,     0},
+    {"RET",   P_NADA,  P_NADA,  C_SOLO_OPCODE,  0x00, 0xC3, 0,     0},
+    {"NOP",   P_NADA,  P_NADA,  C_SOLO_OPCODE,  0x00, 0x90, 0,     0},
+
+    // --- Control de flujo ---
+    {"CALL",  P_ETIQ,  P_NADA,  C_REL32,        0x00, 0xE8, 0,     0},
+    {"LOOP",  P_ETIQ,  P_NADA,  C_REL8,         0x00, 0xE2, 0,     0},
+    {"JMP",   P_ETIQ,  P_NADA,  C_SALTO,        0x00, 0xEB, 0xE9,  0},
+    {"JE",    P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x74, 0x84,  0},
+    {"JZ",    P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x74, 0x84,  0},
+    {"JNE",   P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x75, 0x85,  0},
+    {"JNZ",   P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x75, 0x85,  0},
+    {"JLE",   P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x7E, 0x8E,  0},
+    {"JL",    P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x7C, 0x8C,  0},
+    {"JG",    P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x7F, 0x8F,  0},
+    {"JGE",   P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x7D, 0x8D,  0},
+    {"JA",    P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x77, 0x87,  0},
+    {"JAE",   P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x73, 0x83,  0},
+    {"JB",    P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x72, 0x82,  0},
+    {"JBE",   P_ETIQ,  P_NADA,  C_SALTO,        0x0F, 0x76, 0x86,  0},
+};
+
+inline constexpr size_t NUM_FILAS_OPCODES = sizeof(TABLA_OPCODES) / sizeof(TABLA_OPCODES[0]);
+
+// Bytes de un C_SALTO: EB / 7x rel8 o [0F] E9 / 8x rel32
+inline constexpr uint8_t tamano_salto(const FilaOpcode& fila, bool corto) {
+    return corto ? 2 : static_cast<uint8_t>((fila.prefijo != 0) + 1 + 4);
+}
+
+// -----------------------------------------------------------------------------
+// NOP de varios bytes (recomendados por Intel para rellenar código)
+// -----------------------------------------------------------------------------
+// NOPS_LARGOS[n - 1] es UNA instrucción de n bytes: 90, 66 90 y desde 3
+// bytes NOP r/m32 (0F 1F /0) con el direccionamiento que da el largo. ALIGN
+// rellena con las más largas posibles: menos instrucciones que decodificar
+// que una tira de 90.
+
+inline constexpr uint8_t MAX_NOP = 9;
+
+inline constexpr uint8_t NOPS_LARGOS[MAX_NOP][MAX_NOP] = {
+    {0x90},
+    {0x66, 0x90},
+    {0x0F, 0x1F, 0x00},                                        // NOP [EAX]
+    {0x0F, 0x1F, 0x40, 0x00},                                  // NOP [EAX + 0]
+    {0x0F, 0x1F, 0x44, 0x00, 0x00},                            // NOP [EAX + EAX*1 + 0]
+    {0x66, 0x0F, 0x1F, 0x44, 0x00, 0x00},
+    {0x0F, 0x1F, 0x80, 0x00, 0x00, 0x00, 0x00},                // NOP [EAX + 0] (disp32)
+    {0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},          // NOP [EAX + EAX*1 + 0] (disp32)
+    {0x66, 0x0F, 0x1F, 0x84, 0x00, 0x00, 0x00, 0x00, 0x00},
+};
+
+// -----------------------------------------------------------------------------
+// Registros (el índice es el código que va en ModR/M / +rd)
+// -----------------------------------------------------------------------------
+
+inline constexpr std::string_view NOMBRES_REG32[8] = {
+    "EAX", "ECX", "EDX", "EBX", "ESP", "EBP", "ESI", "EDI"
+};
+
+inline constexpr std::string_view NOMBRES_REG8[8] = {
+    "AL", "CL", "DL", "BL", "AH", "CH", "DH", "BH"
+};
+
+// -----------------------------------------------------------------------------
+// Comparación sin distinguir mayúsculas (la fuente no se convierte)
+// -----------------------------------------------------------------------------
+
+constexpr char a_mayuscula(char c) {
+    return (c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c;
+}
+
+constexpr bool iguales_sin_mayusculas(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a_mayuscula(a[i]) != a_mayuscula(b[i])) return false;
+    }
+    return true;
+}
+
+// -----------------------------------------------------------------------------
+// Hash perfecto en tiempo de compilación: mnemónico -> rango de filas
+// -----------------------------------------------------------------------------
+// La semilla se busca con constexpr hasta que ningún par de mnemónicos
+// colisiona en las TAM_HASH casillas; así una búsqueda es un hash y una
+// sola comparación de cadenas.
+
+inline constexpr size_t TAM_HASH  = 128;
+inline constexpr int    BITS_HASH = 7;   // TAM_HASH = 1 << BITS_HASH
+
+constexpr uint32_t hash_mnemonico(std::string_view s, uint32_t semilla) {
+    uint32_t h = semilla;
+    for (char c : s) {
+        h ^= static_cast<uint8_t>(a_mayuscula(c));
+        h *= 16777619u;   // FNV-1a
+    }
+    return h >> (32 - BITS_HASH);
+}
+
+struct RangoFilas {
+    uint16_t inicio;
+    uint16_t cantidad;   // 0 = casilla vacía
+};
+
+struct TablaHashOpcodes {
+    uint32_t   semilla;
+    bool       perfecta;
+    RangoFilas casillas[TAM_HASH];
+};
+
+constexpr bool probar_semilla(uint32_t semilla, TablaHashOpcodes& t) {
+    for (size_t i = 0; i < TAM_HASH; ++i) t.casillas[i] = RangoFilas{0, 0};
+
+    for (size_t i = 0; i < NUM_FILAS_OPCODES; ++i) {
+        std::string_view m = TABLA_OPCODES[i].mnem;
+        RangoFilas& c = t.casillas[hash_mnemonico(m, semilla)];
+
+        if (c.cantidad == 0) {
+            c = RangoFilas{static_cast<uint16_t>(i), 1};
+        } else if (TABLA_OPCODES[c.inicio].mnem == m && c.inicio + c.cantidad == i) {
+            c.cantidad++;           // fila contigua del mismo mnemónico
+        } else {
+            return false;           // colisión o filas no agrupadas
+        }
+    }
+    return true;
+}
+
+constexpr TablaHashOpcodes construir_tabla_hash() {
+    TablaHashOpcodes t{};
+    uint32_t semilla = 2166136261u;   // base FNV-1a
+    for (int intento = 0; intento < 100000; ++intento) {
+        if (probar_semilla(semilla, t)) {
+            t.semilla  = semilla;
+            t.perfecta = true;
+            return t;
+        }
+        semilla += 0x9E3779B9u;
+    }
+    t.perfecta = false;
+    return t;
+}
+
+inline constexpr TablaHashOpcodes TABLA_HASH_OPCODES = construir_tabla_hash();
+static_assert(TABLA_HASH_OPCODES.perfecta,
+              "No se encontro hash perfecto para TABLA_OPCODES (¿filas de un mnemonico separadas?)");
+
+// Devuelve la primera fila del mnemónico (en cualquier caja) y su cantidad,
+// o nullptr si no existe.
+constexpr const FilaOpcode* buscar_filas_opcode(std::string_view mnem, size_t& cantidad) {
+    const RangoFilas& c =
+        TABLA_HASH_OPCODES.casillas[hash_mnemonico(mnem, TABLA_HASH_OPCODES.semilla)];
+    if (c.cantidad == 0 || !iguales_sin_mayusculas(TABLA_OPCODES[c.inicio].mnem, mnem)) {
+        cantidad = 0;
+        return nullptr;
+    }
+    cantidad = c.cantidad;
+    return &TABLA_OPCODES[c.inicio];
+}
+
+#endif // TABLA_OPCODES_HPP
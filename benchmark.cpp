@@ -0,0 +1,655 @@
+#include "EnsambladorIA32.hpp"
+#include "ConstructorIA32.hpp"
+#include "GeneradorPrograma.hpp"
+#include "LoteEnsamblado.hpp"
+#include "Paralelo.hpp"
+#include "SesionEnsamblado.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Benchmark del ensamblador
+// -----------------------------------------------------------------------------
+// Uso: ./benchmark [--lineas N]... [--repeticiones R] [--una-pasada] [-Os]
+//                  [--dir DIRECTORIO] [--etiqueta TEXTO] [--semilla S]
+//                  [--hilos N] [--escalado] [--ediciones K] [--lote N]
+//                  [--constructor N]
+//
+// Por cada tamaño (por omisión 10K, 1M y 10M líneas) genera un programa
+// sintético determinista y lo ensambla en un proceso hijo (fork), para que
+// el pico de RSS de cada tamaño sea solo suyo. Cada resultado es una línea
+// JSON en stdout; comparar dos commits = comparar sus archivos .jsonl.
+// De las R repeticiones se informa la de menor tiempo total.
+//
+// --escalado repite cada tamaño con 1, 2, 4, ... hasta --hilos (por omisión
+// todos los núcleos). "huella" es un hash de .text + .data: debe ser la
+// misma para cualquier cantidad de hilos. Cada hijo la devuelve por un pipe
+// y, si difiere de la de 1 hilo, el benchmark termina con código 1.
+//
+// --ediciones K abre además una SesionEnsamblado con el programa y hace K
+// ediciones (insertar un JMP en una línea al azar y volver a borrarlo),
+// informando su latencia media y máxima. Al terminar el programa es el
+// original, así que "huella_sesion" debe ser igual a "huella" (salvo con -Os,
+// que la sesión no aplica).
+//
+// --lote N genera N programas de LINEAS_LOTE líneas y los ensambla con
+// LoteEnsamblado (un ensamblador reutilizado por hilo), comparado con un
+// EnsambladorIA32 nuevo por archivo. Sin --lineas, solo se mide el lote.
+//
+// --constructor N arma un programa de N instrucciones de dos formas: como
+// texto que se pasa a ensamblar_texto(), y con llamadas a ConstructorIA32.
+// Las dos salen de la misma plantilla (emitir_programa), así que el flujo
+// de instrucciones es idéntico y "huella_texto" = "huella_constructor".
+// t_pasada1_* compara el análisis de texto con las llamadas tipadas; el
+// resto de las fases es el mismo código en los dos casos.
+//
+// -Os ensambla con usar_tamano_minimo: "bytes_ahorrados_os" es lo que quitó
+// esa pasada (sin contar los saltos que además quedaron en rel8).
+
+struct Opciones {
+    vector<size_t> tamanos;
+    int repeticiones = 1;
+    bool una_pasada = false;
+    bool tamano_minimo = false;
+    string dir = ".";
+    string etiqueta;
+    uint32_t semilla = 12345;
+    unsigned hilos = 1;
+    bool escalado = false;
+    uint32_t ediciones = 0;
+    uint32_t lote = 0;
+    uint32_t constructor = 0;
+};
+
+static constexpr size_t LINEAS_LOTE = 200;
+
+struct Medicion {
+    TiemposFases fases;
+    double escritura = 0;
+    double total = 0;
+    int errores = 0;
+    uint32_t bytes_codigo = 0;
+    uint32_t huella = 0;
+    EstadisticasRelajacion relajacion;
+    uint32_t bytes_ahorrados_os = 0;
+};
+
+// FNV-1a de los bytes de .text y .data
+static uint32_t huella_codigo(const EnsambladorIA32& ens) {
+    uint32_t h = 2166136261u;
+    for (IdSeccion s : { SEC_TEXT, SEC_DATA }) {
+        for (uint8_t b : ens.bytes_seccion(s)) {
+            h ^= b;
+            h *= 16777619u;
+        }
+    }
+    return h;
+}
+
+static double segundos_desde(chrono::steady_clock::time_point t0) {
+    return chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+}
+
+// Un ensamblado completo como lo hace main: leer, pasadas y escribir salidas
+static Medicion medir_ensamblado(const Opciones& op, unsigned hilos, const string& fuente,
+                                const string& prefijo) {
+    Medicion m;
+    EnsambladorIA32 ens;
+    ens.usar_salida_detallada(false);
+    ens.usar_una_pasada(op.una_pasada);
+    ens.usar_tamano_minimo(op.tamano_minimo);
+    ens.usar_hilos(hilos);
+
+    auto t0 = chrono::steady_clock::now();
+    ens.ensamblar(fuente);
+    auto t1 = chrono::steady_clock::now();
+    ens.generar_hex(prefijo + ".hex");
+    ens.generar_bin(prefijo + ".bin");
+    ens.generar_elf(prefijo + ".o");
+
+    m.escritura    = segundos_desde(t1);
+    m.total        = segundos_desde(t0);
+    m.fases        = ens.tiempos_fases();
+    m.errores      = ens.num_errores();
+    m.relajacion   = ens.estadisticas_relajacion();
+    m.bytes_codigo = ens.tamano_seccion(SEC_TEXT) + ens.tamano_seccion(SEC_DATA);
+    m.huella       = huella_codigo(ens);
+    m.bytes_ahorrados_os = ens.estadisticas_tamano().bytes_ahorrados();
+    return m;
+}
+
+struct MedicionEdiciones {
+    double apertura = 0;
+    double media = 0;
+    double maxima = 0;
+    uint32_t incrementales = 0;
+    uint32_t huella = 0;
+};
+
+// Pares insertar/borrar sobre una sesión: latencia de cada reemplazar_lineas()
+static MedicionEdiciones medir_ediciones(const Opciones& op, unsigned hilos, const string& fuente) {
+    MedicionEdiciones m;
+    SesionEnsamblado sesion;
+    sesion.ensamblador().usar_hilos(hilos);
+    auto t0 = chrono::steady_clock::now();
+    sesion.abrir(fuente);
+    m.apertura = segundos_desde(t0);
+
+    uint32_t estado = op.semilla;
+    const size_t lineas = sesion.num_lineas();
+    size_t linea = 0;
+    double total = 0;
+    for (uint32_t k = 0; k < op.ediciones; ++k) {
+        if (k % 2 == 0) {
+            estado ^= estado << 13;
+            estado ^= estado >> 17;
+            estado ^= estado << 5;
+            linea = (lineas > 21) ? 20 + estado % (lineas - 21) : lineas;   // pasado el encabezado
+            sesion.reemplazar_lineas(linea, 0, "    JMP L0");
+        } else {
+            sesion.reemplazar_lineas(linea, 1, "");
+        }
+        const EstadisticasEdicion& e = sesion.ultima_edicion();
+        total += e.segundos;
+        m.maxima = max(m.maxima, e.segundos);
+        m.incrementales += e.incremental;
+    }
+    if (op.ediciones % 2 != 0) sesion.reemplazar_lineas(linea, 1, "");   // volver al original
+    m.media  = total / op.ediciones;
+    m.huella = huella_codigo(sesion.ensamblador());
+    return m;
+}
+
+// -----------------------------------------------------------------------------
+// --constructor: el mismo programa como texto y como llamadas
+// -----------------------------------------------------------------------------
+
+// Mismos métodos que ConstructorIA32, pero escribe el fuente equivalente
+class EscritorTexto {
+public:
+    string texto;
+
+    Etiqueta etiqueta(string_view nombre) {
+        nombres.emplace_back(nombre);
+        return Etiqueta{static_cast<uint32_t>(nombres.size() - 1)};
+    }
+    Etiqueta nueva_etiqueta() { return etiqueta("L" + to_string(anonimas++)); }
+    void definir(Etiqueta e) { texto += nombres[e.id]; texto += ":\n"; }
+    void global(Etiqueta e)  { texto += "GLOBAL "; texto += nombres[e.id]; texto += '\n'; }
+    void seccion(IdSeccion s) {
+        static const char* const NOMBRES[NUM_SECCIONES] = { ".text", ".data", ".bss" };
+        texto += "SECTION ";
+        texto += NOMBRES[s];
+        texto += '\n';
+    }
+    void dd(initializer_list<uint32_t> valores) {
+        texto += "    DD ";
+        for (const uint32_t* v = valores.begin(); v != valores.end(); ++v) {
+            if (v != valores.begin()) texto += ", ";
+            numero(*v);
+        }
+        texto += '\n';
+    }
+    void reservar_bytes(uint32_t bytes) { texto += "    RESB "; numero(bytes); texto += '\n'; }
+
+    template <typename A, typename B> void mov(A a, B b)   { dos("MOV", a, b); }
+    template <typename A, typename B> void add(A a, B b)   { dos("ADD", a, b); }
+    template <typename A, typename B> void sub(A a, B b)   { dos("SUB", a, b); }
+    template <typename A, typename B> void cmp(A a, B b)   { dos("CMP", a, b); }
+    template <typename A, typename B> void and_(A a, B b)  { dos("AND", a, b); }
+    template <typename A, typename B> void xor_(A a, B b)  { dos("XOR", a, b); }
+    template <typename A, typename B> void imul(A a, B b)  { dos("IMUL", a, b); }
+    template <typename A, typename B> void movzx(A a, B b) { dos("MOVZX", a, b); }
+    template <typename A, typename B> void lea(A a, B b)   { dos("LEA", a, b); }
+    template <typename A> void inc(A a)  { uno("INC", a); }
+    template <typename A> void dec(A a)  { uno("DEC", a); }
+    template <typename A> void push(A a) { uno("PUSH", a); }
+    template <typename A> void pop(A a)  { uno("POP", a); }
+    void int_(uint32_t n)                { uno("INT", n); }
+    void call(Etiqueta e)                { uno("CALL", e); }
+    void jmp(Etiqueta e)                 { uno("JMP", e); }
+    void ret()                           { texto += "    RET\n"; }
+    void jcc(CondicionSalto cc, Etiqueta e) {
+        static const char* const NOMBRES[] = { "JE", "JNE", "JLE", "JL", "JG", "JGE", "JA", "JAE", "JB", "JBE" };
+        uno(NOMBRES[cc], e);
+    }
+
+private:
+    vector<string> nombres;
+    uint32_t anonimas = 0;
+
+    void numero(int64_t v) {
+        char buf[24];
+        texto.append(buf, to_chars(buf, buf + sizeof(buf), v).ptr);
+    }
+    void escribir(Reg32 r)    { texto += NOMBRES_REG32[r.codigo]; }
+    void escribir(Reg8 r)     { texto += NOMBRES_REG8[r.codigo]; }
+    void escribir(int32_t v)  { numero(v); }
+    void escribir(uint32_t v) { numero(v); }
+    void escribir(Etiqueta e) { texto += nombres[e.id]; }
+    void escribir(const Memoria& m) {
+        if (m.tam == 1) texto += "BYTE ";
+        if (m.tam == 4) texto += "DWORD ";
+        texto += '[';
+        bool primero = true;
+        if (m.simbolo != SIN_SIMBOLO) { texto += nombres[m.simbolo]; primero = false; }
+        for (int k = 0; k < m.num_regs; ++k) {
+            if (!primero) texto += '+';
+            texto += NOMBRES_REG32[m.regs[k]];
+            if (m.escalas[k] != 1) { texto += '*'; numero(m.escalas[k]); }
+            primero = false;
+        }
+        const int32_t disp = static_cast<int32_t>(m.disp);
+        if (disp != 0 || primero) {
+            if (disp < 0) texto += '-';
+            else if (!primero) texto += '+';
+            numero(disp < 0 ? -static_cast<int64_t>(disp) : disp);
+        }
+        texto += ']';
+    }
+    template <typename A> void uno(const char* mnem, A a) {
+        texto += "    ";
+        texto += mnem;
+        texto += ' ';
+        escribir(a);
+        texto += '\n';
+    }
+    template <typename A, typename B> void dos(const char* mnem, A a, B b) {
+        texto += "    ";
+        texto += mnem;
+        texto += ' ';
+        escribir(a);
+        texto += ", ";
+        escribir(b);
+        texto += '\n';
+    }
+};
+
+// Programa de 'instrucciones' instrucciones: memoria con base, índice y
+// etiqueta, inmediatos de 8 y 32 bits, saltos hacia atrás y hacia adelante y
+// CALL a una subrutina. Siempre el mismo para la misma semilla
+template <typename Destino>
+static void emitir_programa(Destino& a, uint32_t instrucciones, uint32_t semilla) {
+    uint32_t estado = semilla != 0 ? semilla : 1;
+    auto azar = [&estado](uint32_t n) {
+        estado ^= estado << 13;
+        estado ^= estado >> 17;
+        estado ^= estado << 5;
+        return estado % n;
+    };
+    static constexpr Reg32 REGS[] = { EAX, ECX, EDX, EBX, EBP, ESI, EDI };
+    auto reg = [&]() { return REGS[azar(7)]; };
+
+    const Etiqueta inicio = a.etiqueta("_start");
+    const Etiqueta tabla  = a.etiqueta("tabla");
+    const Etiqueta valor  = a.etiqueta("valor");
+    const Etiqueta buffer = a.etiqueta("buffer");
+    const Etiqueta rutina = a.etiqueta("rutina");
+    a.global(inicio);
+    a.seccion(SEC_DATA);
+    a.definir(tabla);
+    a.dd({ 1, 2, 3, 5, 8, 13, 21, 0xFFFFFFFFu });
+    a.definir(valor);
+    a.dd({ 0 });
+    a.seccion(SEC_BSS);
+    a.definir(buffer);
+    a.reservar_bytes(4096);
+    a.seccion(SEC_TEXT);
+    a.definir(rutina);
+    a.add(EAX, ECX);
+    a.ret();
+    a.definir(inicio);
+
+    Etiqueta atras = inicio;      // última etiqueta definida
+    Etiqueta adelante;            // referida y aún sin definir
+    bool hay_adelante = false;
+    for (uint32_t i = 0; i < instrucciones; ++i) {
+        const int32_t imm8 = static_cast<int32_t>(azar(256)) - 128;
+        const int32_t imm32 = static_cast<int32_t>(azar(0x7FFFFFFF)) - 0x3FFFFFFF;
+        switch (azar(20)) {
+            case 0:  a.mov(reg(), reg()); break;
+            case 1:  a.mov(reg(), mem(EBP, -4 * static_cast<int32_t>(1 + azar(32)))); break;
+            case 2:  a.mov(mem(tabla, ESI, 4, 4 * static_cast<int32_t>(azar(8))), reg()); break;
+            case 3:  a.mov(reg(), imm32); break;
+            case 4:  a.add(reg(), imm8); break;
+            case 5:  a.add(reg(), mem(EBX, ESI, 4)); break;
+            case 6:  a.sub(dword_ptr(mem(valor)), imm32); break;
+            case 7:  a.cmp(reg(), imm8); break;
+            case 8:  a.cmp(mem(EBP, 8), reg()); break;
+            case 9:  a.and_(reg(), imm32); break;
+            case 10: a.xor_(reg(), reg()); break;
+            case 11: a.inc(reg()); break;
+            case 12: a.dec(mem(buffer, EDI, 4)); break;
+            case 13: a.lea(reg(), mem(EDX, EDI, 1 << azar(4), -static_cast<int32_t>(azar(1000)))); break;
+            case 14: a.imul(reg(), reg()); break;
+            case 15: a.movzx(reg(), byte_ptr(mem(EBP, -1))); break;
+            case 16: a.push(reg()); a.pop(reg()); break;
+            case 17: a.call(rutina); break;
+            case 18:
+                if (azar(2) == 0) {
+                    a.jcc(static_cast<CondicionSalto>(azar(10)), atras);
+                } else {
+                    if (!hay_adelante) { adelante = a.nueva_etiqueta(); hay_adelante = true; }
+                    if (azar(4) == 0) a.jmp(adelante);
+                    else a.jcc(static_cast<CondicionSalto>(azar(10)), adelante);
+                }
+                break;
+            default:
+                atras = hay_adelante ? adelante : a.nueva_etiqueta();
+                hay_adelante = false;
+                a.definir(atras);
+                break;
+        }
+    }
+    if (hay_adelante) a.definir(adelante);
+    a.mov(EAX, 1);
+    a.int_(0x80);
+}
+
+struct MedicionConstructor {
+    double generar_texto = 0;        // emitir_programa -> string
+    double texto = 0;                // ensamblar_texto
+    double constructor = 0;          // emitir_programa -> ConstructorIA32 + terminar
+    double pasada1_texto = 0, pasada1_constructor = 0;
+    size_t bytes_fuente = 0;
+    uint32_t bytes_codigo = 0;
+    uint32_t huella_texto = 0, huella_constructor = 0;
+    int errores = 0;
+};
+
+static MedicionConstructor medir_constructor(const Opciones& op, unsigned hilos) {
+    MedicionConstructor m;
+    EnsambladorIA32 ens;
+    ens.usar_salida_detallada(false);
+    ens.usar_una_pasada(op.una_pasada);
+    ens.usar_tamano_minimo(op.tamano_minimo);
+    ens.usar_hilos(hilos);
+
+    auto t0 = chrono::steady_clock::now();
+    EscritorTexto escritor;
+    emitir_programa(escritor, op.constructor, op.semilla);
+    m.generar_texto = segundos_desde(t0);
+    m.bytes_fuente = escritor.texto.size();
+
+    t0 = chrono::steady_clock::now();
+    ens.ensamblar_texto(escritor.texto);
+    m.texto = segundos_desde(t0);
+    m.pasada1_texto = ens.tiempos_fases().pasada1;
+    m.huella_texto = huella_codigo(ens);
+    m.errores = ens.num_errores();
+
+    t0 = chrono::steady_clock::now();
+    ConstructorIA32 a(ens);
+    emitir_programa(a, op.constructor, op.semilla);
+    m.errores += a.terminar();
+    m.constructor = segundos_desde(t0);
+    m.pasada1_constructor = ens.tiempos_fases().pasada1;
+    m.huella_constructor = huella_codigo(ens);
+    m.bytes_codigo = ens.tamano_seccion(SEC_TEXT) + ens.tamano_seccion(SEC_DATA);
+    return m;
+}
+
+// Proceso hijo: repeticiones del par texto / constructor (el mínimo de cada uno)
+static int ejecutar_constructor(const Opciones& op, unsigned hilos) {
+    MedicionConstructor mejor;
+    for (int r = 0; r < op.repeticiones; ++r) {
+        const MedicionConstructor m = medir_constructor(op, hilos);
+        if (r == 0) { mejor = m; continue; }
+        mejor.generar_texto = min(mejor.generar_texto, m.generar_texto);
+        mejor.texto = min(mejor.texto, m.texto);
+        mejor.constructor = min(mejor.constructor, m.constructor);
+        mejor.pasada1_texto = min(mejor.pasada1_texto, m.pasada1_texto);
+        mejor.pasada1_constructor = min(mejor.pasada1_constructor, m.pasada1_constructor);
+        mejor.errores += m.errores;
+    }
+    if (mejor.huella_texto != mejor.huella_constructor) ++mejor.errores;
+
+    printf("{\"etiqueta\":\"%s\",\"modo\":\"constructor\",\"hilos\":%u,\"instrucciones\":%u,"
+           "\"bytes_fuente\":%zu,\"bytes_codigo\":%u,\"errores\":%d,\"repeticiones\":%d,"
+           "\"t_generar_texto\":%.6f,\"t_texto\":%.6f,\"t_constructor\":%.6f,"
+           "\"t_pasada1_texto\":%.6f,\"t_pasada1_constructor\":%.6f,"
+           "\"instrucciones_por_s_texto\":%.0f,\"instrucciones_por_s_constructor\":%.0f,"
+           "\"huella_texto\":\"%08x\",\"huella_constructor\":\"%08x\"}\n",
+           op.etiqueta.c_str(), hilos, op.constructor, mejor.bytes_fuente, mejor.bytes_codigo,
+           mejor.errores, op.repeticiones, mejor.generar_texto, mejor.texto, mejor.constructor,
+           mejor.pasada1_texto, mejor.pasada1_constructor,
+           op.constructor / mejor.texto, op.constructor / mejor.constructor,
+           mejor.huella_texto, mejor.huella_constructor);
+    fflush(stdout);
+    return mejor.errores == 0 ? 0 : 1;
+}
+
+static void borrar_salidas_lote(const vector<string>& archivos) {
+    for (const string& a : archivos) {
+        const string base = base_salida(a);
+        for (const char* ext : { ".hex", ".bin", ".o" }) remove((base + ext).c_str());
+    }
+}
+
+// Proceso hijo: el lote con 'hilos' y la línea base de un ensamblador nuevo por archivo
+static int ejecutar_lote(const Opciones& op, unsigned hilos, const vector<string>& archivos,
+                         size_t bytes_fuente) {
+    auto t0 = chrono::steady_clock::now();
+    for (const string& a : archivos) {
+        EnsambladorIA32 ens;
+        ens.usar_salida_detallada(false);
+        ens.ensamblar(a);
+        const string base = base_salida(a);
+        ens.generar_hex(base + ".hex");
+        ens.generar_bin(base + ".bin");
+        ens.generar_elf(base + ".o");
+    }
+    const double t_nuevo = segundos_desde(t0);
+    borrar_salidas_lote(archivos);   // las dos variantes crean sus salidas desde cero
+
+    t0 = chrono::steady_clock::now();
+    LoteEnsamblado lote(hilos, nullptr, nullptr);
+    for (const string& a : archivos) lote.agregar(a);
+    lote.cerrar();
+    const double t_lote = segundos_desde(t0);
+    borrar_salidas_lote(archivos);
+
+    printf("{\"etiqueta\":\"%s\",\"modo\":\"lote\",\"hilos\":%u,\"archivos\":%zu,\"lineas_por_archivo\":%zu,"
+           "\"bytes_fuente\":%zu,\"errores\":%zu,\"t_nuevo\":%.6f,\"t_lote\":%.6f,"
+           "\"archivos_por_s_nuevo\":%.1f,\"archivos_por_s\":%.1f}\n",
+           op.etiqueta.c_str(), hilos, archivos.size(), LINEAS_LOTE, bytes_fuente,
+           lote.archivos_con_errores(), t_nuevo, t_lote,
+           archivos.size() / t_nuevo, archivos.size() / t_lote);
+    fflush(stdout);
+    return lote.archivos_con_errores() == 0 ? 0 : 1;
+}
+
+// Proceso hijo: repeticiones de un tamaño y una línea JSON con el resultado.
+// La huella va además a 'fd_huella' para que main() compare las cantidades de hilos
+static int ejecutar_tamano(const Opciones& op, unsigned hilos, const string& fuente,
+                           const ResultadoGenerador& gen, int fd_huella) {
+    const string prefijo = op.dir + "/bench_" + to_string(gen.lineas);
+    Medicion mejor;
+    for (int r = 0; r < op.repeticiones; ++r) {
+        Medicion m = medir_ensamblado(op, hilos, fuente, prefijo);
+        if (r == 0 || m.total < mejor.total) mejor = m;
+    }
+    remove((prefijo + ".hex").c_str());
+    remove((prefijo + ".bin").c_str());
+    remove((prefijo + ".o").c_str());
+
+    struct rusage uso;
+    getrusage(RUSAGE_SELF, &uso);   // ru_maxrss en KiB (Linux)
+
+    const TiemposFases& f = mejor.fases;
+    printf("{\"etiqueta\":\"%s\",\"modo\":\"%s\",\"hilos\":%u,\"lineas\":%zu,\"bytes_fuente\":%zu,"
+           "\"bytes_codigo\":%u,\"errores\":%d,\"repeticiones\":%d,"
+           "\"t_lectura\":%.6f,\"t_pasada1\":%.6f,\"t_optimizacion\":%.6f,\"t_relajacion\":%.6f,\"t_pasada2\":%.6f,"
+           "\"t_resolucion\":%.6f,\"t_escritura\":%.6f,\"t_total\":%.6f,"
+           "\"lineas_por_s\":%.0f,\"bytes_por_s\":%.0f,\"rss_pico_kb\":%ld,"
+           "\"saltos\":%d,\"saltos_cortos\":%d,\"iteraciones_relajacion\":%d,\"bytes_ahorrados_os\":%u,"
+           "\"huella\":\"%08x\"}\n",
+           op.etiqueta.c_str(), op.una_pasada ? "una_pasada" : "dos_pasadas", hilos,
+           gen.lineas, gen.bytes, mejor.bytes_codigo, mejor.errores, op.repeticiones,
+           f.lectura, f.pasada1, f.optimizacion, f.relajacion, f.pasada2, f.resolucion, mejor.escritura, mejor.total,
+           gen.lineas / mejor.total, gen.bytes / mejor.total, uso.ru_maxrss,
+           mejor.relajacion.saltos, mejor.relajacion.cortos, mejor.relajacion.iteraciones,
+           mejor.bytes_ahorrados_os, mejor.huella);
+    if (op.ediciones > 0) {
+        const MedicionEdiciones e = medir_ediciones(op, hilos, fuente);
+        printf("{\"etiqueta\":\"%s\",\"modo\":\"ediciones\",\"hilos\":%u,\"lineas\":%zu,\"ediciones\":%u,"
+               "\"ediciones_incrementales\":%u,\"t_apertura\":%.6f,\"t_edicion_media\":%.6f,"
+               "\"t_edicion_max\":%.6f,\"huella_sesion\":\"%08x\"}\n",
+               op.etiqueta.c_str(), hilos, gen.lineas, op.ediciones, e.incrementales,
+               e.apertura, e.media, e.maxima, e.huella);
+        if (!op.tamano_minimo && e.huella != mejor.huella) ++mejor.errores;   // la sesión no usa -Os
+    }
+    fflush(stdout);
+    if (write(fd_huella, &mejor.huella, sizeof(mejor.huella)) != sizeof(mejor.huella)) ++mejor.errores;
+    return mejor.errores == 0 ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    Opciones op;
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        uint32_t n = 0;
+        if (arg == "--una-pasada") {
+            op.una_pasada = true;
+        } else if (arg == "-Os") {
+            op.tamano_minimo = true;
+        } else if (arg == "--escalado") {
+            op.escalado = true;
+        } else if ((arg == "--lineas" || arg == "--repeticiones" || arg == "--semilla" ||
+                    arg == "--hilos" || arg == "--ediciones" || arg == "--lote" ||
+                    arg == "--constructor") && i + 1 < argc) {
+            if (!leer_numero(argv[++i], n) || n == 0) {
+                cerr << "Valor invalido para " << arg << ": " << argv[i] << endl;
+                return 1;
+            }
+            if (arg == "--lineas") op.tamanos.push_back(n);
+            else if (arg == "--repeticiones") op.repeticiones = static_cast<int>(n);
+            else if (arg == "--hilos") op.hilos = n;
+            else if (arg == "--ediciones") op.ediciones = n;
+            else if (arg == "--lote") op.lote = n;
+            else if (arg == "--constructor") op.constructor = n;
+            else op.semilla = n;
+        } else if (arg == "--dir" && i + 1 < argc) {
+            op.dir = argv[++i];
+        } else if (arg == "--etiqueta" && i + 1 < argc) {
+            op.etiqueta = argv[++i];
+        } else {
+            cerr << "Opcion desconocida: " << arg << endl;
+            return 1;
+        }
+    }
+    if (op.tamanos.empty() && op.lote == 0 && op.constructor == 0) op.tamanos = { 10000, 1000000, 10000000 };
+    if (op.escalado && op.hilos == 1) op.hilos = hilos_disponibles();
+
+    // Cantidades de hilos a medir: solo --hilos, o 1, 2, 4, ... hasta --hilos
+    vector<unsigned> cantidades;
+    if (op.escalado) {
+        for (unsigned h = 1; h < op.hilos; h *= 2) cantidades.push_back(h);
+    }
+    cantidades.push_back(op.hilos);
+
+    int fallos = 0;
+    for (size_t tamano : op.tamanos) {
+        const string fuente = op.dir + "/bench_" + to_string(tamano) + ".asm";
+        ResultadoGenerador gen;
+        if (!generar_programa_sintetico(fuente, tamano, op.semilla, gen)) {
+            cerr << "No se pudo generar " << fuente << endl;
+            return 1;
+        }
+
+        bool hay_huella = false;
+        uint32_t huella_un_hilo = 0;   // la de la primera cantidad (1 hilo con --escalado)
+        for (unsigned hilos : cantidades) {
+            int tubo[2];
+            if (pipe(tubo) != 0) {
+                cerr << "pipe fallo" << endl;
+                return 1;
+            }
+            pid_t hijo = fork();
+            if (hijo < 0) {
+                cerr << "fork fallo" << endl;
+                return 1;
+            }
+            if (hijo == 0) {
+                close(tubo[0]);
+                _exit(ejecutar_tamano(op, hilos, fuente, gen, tubo[1]));
+            }
+            close(tubo[1]);
+            uint32_t huella = 0;
+            const bool leida = read(tubo[0], &huella, sizeof(huella)) == sizeof(huella);
+            close(tubo[0]);
+
+            int estado = 0;
+            waitpid(hijo, &estado, 0);
+            if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0 || !leida) {
+                cerr << "Benchmark de " << tamano << " lineas (" << hilos << " hilos) fallo" << endl;
+                ++fallos;
+            } else if (!hay_huella) {
+                hay_huella = true;
+                huella_un_hilo = huella;
+            } else if (huella != huella_un_hilo) {
+                cerr << "Benchmark de " << tamano << " lineas: la huella con " << hilos
+                     << " hilos no es la de " << cantidades.front() << " (ver \"huella\")" << endl;
+                ++fallos;
+            }
+        }
+        remove(fuente.c_str());
+    }
+
+    if (op.lote > 0) {
+        vector<string> archivos;
+        size_t bytes = 0;
+        for (uint32_t i = 0; i < op.lote; ++i) {
+            archivos.push_back(op.dir + "/lote_" + to_string(i) + ".asm");
+            ResultadoGenerador gen;
+            if (!generar_programa_sintetico(archivos.back(), LINEAS_LOTE, op.semilla + i, gen)) {
+                cerr << "No se pudo generar " << archivos.back() << endl;
+                return 1;
+            }
+            bytes += gen.bytes;
+        }
+        for (unsigned hilos : cantidades) {
+            pid_t hijo = fork();
+            if (hijo < 0) {
+                cerr << "fork fallo" << endl;
+                return 1;
+            }
+            if (hijo == 0) _exit(ejecutar_lote(op, hilos, archivos, bytes));
+
+            int estado = 0;
+            waitpid(hijo, &estado, 0);
+            if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+                cerr << "Benchmark de lote (" << hilos << " hilos) fallo" << endl;
+                ++fallos;
+            }
+        }
+        for (const string& a : archivos) remove(a.c_str());
+    }
+
+    if (op.constructor > 0) {
+        for (unsigned hilos : cantidades) {
+            pid_t hijo = fork();
+            if (hijo < 0) {
+                cerr << "fork fallo" << endl;
+                return 1;
+            }
+            if (hijo == 0) _exit(ejecutar_constructor(op, hilos));
+
+            int estado = 0;
+            waitpid(hijo, &estado, 0);
+            if (!WIFEXITED(estado) || WEXITSTATUS(estado) != 0) {
+                cerr << "Benchmark del constructor (" << hilos << " hilos) fallo" << endl;
+                ++fallos;
+            }
+        }
+    }
+    return fallos == 0 ? 0 : 1;
+}
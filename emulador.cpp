@@ -0,0 +1,82 @@
+#include "EnsambladorIA32.hpp"
+#include "EmuladorIA32.hpp"
+
+#include <cstdlib>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// Emulador: ensambla y ejecuta sin un proceso de 32 bits
+// -----------------------------------------------------------------------------
+// Uso: ./emulador [--entrada ETIQUETA] [--limite N] [--pila BYTES] [--json]
+//                 [-Os] [--alinear-bucles N] [archivo.asm]
+//
+// El programa escribe con write(1/2) en stdout/stderr; el informe (conteos
+// por etiqueta y por opcode) va después a stderr, como texto o como una
+// línea JSON con --json. Sale con el estado de exit(); 0 si volvió de la
+// entrada o salió de .text, 1 si hubo un error o se alcanzó --limite.
+
+int main(int argc, char* argv[]) {
+    string archivo = "programa.asm";
+    string etiqueta = "_start";
+    uint64_t limite = 0;
+    uint32_t bytes_pila = 1u << 20;
+    bool json = false;
+    bool tamano_minimo = false;
+    uint32_t alineacion_bucles = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--entrada" && i + 1 < argc) {
+            etiqueta = argv[++i];
+        } else if (arg == "--limite" && i + 1 < argc) {
+            char* fin = nullptr;
+            limite = strtoull(argv[++i], &fin, 0);
+            if (fin == argv[i] || *fin != '\0') {
+                cerr << "Limite invalido: " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--pila" && i + 1 < argc) {
+            if (!leer_numero(argv[++i], bytes_pila) || bytes_pila < 16) {
+                cerr << "Tamano de pila invalido: " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--json") {
+            json = true;
+        } else if (arg == "-Os") {
+            tamano_minimo = true;
+        } else if (arg == "--alinear-bucles" && i + 1 < argc) {
+            if (!leer_numero(argv[++i], alineacion_bucles) || alineacion_bucles == 0 || alineacion_bucles > 4096 ||
+                (alineacion_bucles & (alineacion_bucles - 1)) != 0) {
+                cerr << "Alineacion invalida (potencia de 2 hasta 4096): " << argv[i] << endl;
+                return 1;
+            }
+        } else {
+            archivo = arg;
+        }
+    }
+
+    EnsambladorIA32 ensamblador;
+    ensamblador.usar_salida_detallada(false);
+    ensamblador.usar_tamano_minimo(tamano_minimo);
+    ensamblador.usar_alinear_bucles(alineacion_bucles);
+    ensamblador.ensamblar(archivo);
+
+    EmuladorIA32 emulador;
+    if (!emulador.cargar(ensamblador, etiqueta, bytes_pila)) {
+        cerr << "Emulador: " << archivo << " no se ensamblo sin errores" << endl;
+        return 1;
+    }
+
+    const ResultadoEmulacion r = emulador.ejecutar(limite);
+    cout.flush();
+    if (json) emulador.escribir_json(cerr, r);
+    else emulador.escribir_informe(cerr, r);
+
+    switch (r.fin) {
+        case FIN_EXIT:           return static_cast<int>(r.estado & 0xFF);
+        case FIN_RETORNO:
+        case FIN_FUERA_DE_TEXTO: return 0;
+        default:                 return 1;
+    }
+}
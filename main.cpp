@@ -0,0 +1,233 @@
+#include "EnsambladorIA32.hpp"
+#include "AnalizadorRendimiento.hpp"
+#include "CodigoJIT.hpp"
+#include "LoteEnsamblado.hpp"
+#include "Paralelo.hpp"
+
+#include <cstdio>
+
+using namespace std;
+
+// -----------------------------------------------------------------------------
+// main de prueba
+// -----------------------------------------------------------------------------
+
+// --jit ETIQUETA: ensambla en memoria, llama a ETIQUETA y muestra EAX
+static int ejecutar_jit(const string& archivo, const string& etiqueta) {
+    ifstream f(archivo, ios::binary);
+    if (!f.is_open()) {
+        cerr << "No se pudo abrir el archivo: " << archivo << endl;
+        return 1;
+    }
+    string codigo((istreambuf_iterator<char>(f)), istreambuf_iterator<char>());
+
+    CodigoJIT jit;
+    if (!jit.cargar(codigo)) return 1;
+    cout << "JIT: " << etiqueta << " cargada en " << jit.direccion(etiqueta) << "\n";
+
+    if (!EJECUCION_NATIVA_IA32) {
+        cerr << "JIT: el codigo IA-32 solo se ejecuta en un proceso de 32 bits (compilar con -m32)" << endl;
+        return 1;
+    }
+    auto f_jit = jit.funcion<uint32_t (*)()>(etiqueta);
+    if (f_jit == nullptr) {
+        cerr << "JIT: etiqueta no encontrada: " << etiqueta << endl;
+        return 1;
+    }
+    cout << "JIT: EAX = " << f_jit() << "\n";
+    return 0;
+}
+
+// Opciones que valen para cada ensamblador (uno solo o los del lote)
+struct OpcionesEnsamblador {
+    bool una_pasada = false;
+    bool tamano_minimo = false;
+    uint32_t alineacion_bucles = 0;
+    bool base_fija[NUM_SECCIONES] = {};
+    uint32_t base[NUM_SECCIONES] = {};
+    uint32_t hilos = 1;
+    string dir_cache;
+
+    void aplicar(EnsambladorIA32& ens) const {
+        ens.usar_una_pasada(una_pasada);
+        ens.usar_tamano_minimo(tamano_minimo);
+        ens.usar_alinear_bucles(alineacion_bucles);
+        for (int s = 0; s < NUM_SECCIONES; ++s) {
+            if (base_fija[s]) ens.fijar_base(static_cast<IdSeccion>(s), base[s]);
+        }
+        ens.usar_cache(dir_cache);
+    }
+};
+
+// Comillas y barras escapadas para una cadena JSON
+static string json(const string& s) {
+    string r;
+    for (char c : s) {
+        if (c == '"' || c == '\\') r += '\\';
+        if (static_cast<unsigned char>(c) < 0x20) c = ' ';
+        r += c;
+    }
+    return r;
+}
+
+// --lote: los archivos de la línea de comandos, o sin ninguno (o "-") una
+// ruta por línea de stdin, que se encolan a medida que llegan. Una línea
+// JSON por archivo en cuanto termina y un resumen con archivos/s al final
+static int ejecutar_lote(const OpcionesEnsamblador& op, const vector<string>& archivos) {
+    const unsigned hilos = (op.hilos == 0) ? hilos_disponibles() : op.hilos;
+    auto t0 = chrono::steady_clock::now();
+    LoteEnsamblado lote(
+        hilos, [&op](EnsambladorIA32& ens) { op.aplicar(ens); },
+        [](const ResultadoLote& r) {
+            if (!r.mensajes.empty()) {
+                istringstream lineas(r.mensajes);
+                for (string l; getline(lineas, l);) cerr << r.archivo << ": " << l << '\n';
+            }
+            printf("{\"archivo\":\"%s\",\"errores\":%d,\"bytes\":%u,\"segundos\":%.6f}\n",
+                   json(r.archivo).c_str(), r.errores, r.bytes, r.segundos);
+            fflush(stdout);
+        });
+
+    if (archivos.empty() || (archivos.size() == 1 && archivos[0] == "-")) {
+        for (string l; getline(cin, l);) {
+            if (!l.empty() && l.back() == '\r') l.pop_back();
+            if (!l.empty()) lote.agregar(move(l));
+        }
+    } else {
+        for (const string& a : archivos) lote.agregar(a);
+    }
+    lote.cerrar();
+
+    const double segundos = chrono::duration<double>(chrono::steady_clock::now() - t0).count();
+    printf("{\"archivos\":%zu,\"con_errores\":%zu,\"hilos\":%u,\"segundos\":%.6f,\"archivos_por_s\":%.1f}\n",
+           lote.archivos(), lote.archivos_con_errores(), hilos, segundos,
+           segundos > 0 ? lote.archivos() / segundos : 0.0);
+    return lote.archivos_con_errores() == 0 ? 0 : 1;
+}
+
+static void uso(ostream& salida) {
+    salida << "Uso: ./ensamblador [--una-pasada] [-Os] [--base-text N] [--base-data N] [--base-bss N]\n"
+              "                   [--hilos N] [--alinear-bucles N] [--jit ETIQUETA] [--stats] [--cache DIR]\n"
+              "                   [--analisis] [archivo.asm]\n"
+              "     ./ensamblador --lote [opciones] [archivo.asm... | -]\n";
+}
+
+int main(int argc, char* argv[]) {
+    OpcionesEnsamblador op;
+    vector<string> archivos;
+
+    string etiqueta_jit;
+    bool estadisticas = false;
+    bool analisis = false;
+    bool lote = false;
+
+    // Uso: ver uso()
+    // --hilos 0 = todos los núcleos; en --lote, cuántos archivos a la vez
+    // -Os: forma más corta de cada instrucción (solo en dos pasadas)
+    // --alinear-bucles N: NOP antes de cada cabecera de bucle hasta un múltiplo de N
+    // --cache DIR: si el fuente y las opciones ya se ensamblaron, la salida sale de DIR
+    // --analisis: ciclos por iteración, presión por puerto y cadena crítica de
+    //             cada bucle (necesita la IR: no usa la caché ni va con --una-pasada)
+    // Con --stats stdout queda solo para el JSON de estadísticas
+    // Sale con 1 si el fuente no se puede leer o el ensamblado tuvo errores
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--una-pasada") {
+            op.una_pasada = true;
+        } else if (arg == "-Os") {
+            op.tamano_minimo = true;
+        } else if ((arg == "--base-text" || arg == "--base-data" || arg == "--base-bss") && i + 1 < argc) {
+            uint32_t base = 0;
+            if (!leer_numero(argv[++i], base)) {
+                cerr << "Base invalida para " << arg << ": " << argv[i] << endl;
+                return 1;
+            }
+            IdSeccion sec = (arg == "--base-text") ? SEC_TEXT : (arg == "--base-data") ? SEC_DATA : SEC_BSS;
+            op.base[sec]      = base;
+            op.base_fija[sec] = true;
+        } else if (arg == "--hilos" && i + 1 < argc) {
+            if (!leer_numero(argv[++i], op.hilos)) {
+                cerr << "Cantidad de hilos invalida: " << argv[i] << endl;
+                return 1;
+            }
+        } else if (arg == "--alinear-bucles" && i + 1 < argc) {
+            uint32_t n = 0;
+            if (!leer_numero(argv[++i], n) || n == 0 || n > 4096 || (n & (n - 1)) != 0) {
+                cerr << "Alineacion invalida (potencia de 2 hasta 4096): " << argv[i] << endl;
+                return 1;
+            }
+            op.alineacion_bucles = n;
+        } else if (arg == "--stats") {
+            estadisticas = true;
+        } else if (arg == "--analisis") {
+            analisis = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            op.dir_cache = argv[++i];
+        } else if (arg == "--lote") {
+            lote = true;
+        } else if (arg == "--jit" && i + 1 < argc) {
+            etiqueta_jit = argv[++i];
+        } else if (arg == "--help" || arg == "-h") {
+            uso(cout);
+            return 0;
+        } else if (arg.size() > 1 && arg[0] == '-') {
+            // Opción desconocida o sin su valor ("-" solo es stdin en --lote)
+            cerr << "Opcion invalida: " << arg << "\n";
+            uso(cerr);
+            return 1;
+        } else {
+            archivos.push_back(arg);
+        }
+    }
+
+    if (lote) return ejecutar_lote(op, archivos);
+    if (analisis) {
+        if (op.una_pasada) {
+            cerr << "--analisis necesita la IR de dos pasadas: no va con --una-pasada" << endl;
+            return 1;
+        }
+        op.dir_cache.clear();
+    }
+
+    const string archivo = archivos.empty() ? "programa.asm" : archivos.back();
+    if (!etiqueta_jit.empty()) return ejecutar_jit(archivo, etiqueta_jit);
+    if (!ifstream(archivo).is_open()) {
+        // Sin ensamblar: no se pisan los programa.* de un ensamblado anterior
+        cerr << "No se pudo abrir el archivo: " << archivo << endl;
+        return 1;
+    }
+
+    EnsambladorIA32 ensamblador;
+    op.aplicar(ensamblador);
+    ensamblador.usar_hilos(op.hilos);
+    if (estadisticas) {
+        ensamblador.usar_estadisticas(true);
+        ensamblador.usar_salida_detallada(false);
+    }
+    ostream nulo(nullptr);
+    ostream& salida = estadisticas ? nulo : cout;
+
+    salida << "Iniciando ensamblado (leyendo " << archivo << ")...\n";
+    ensamblador.ensamblar(archivo);
+
+    salida << "Generando programa.hex, programa.bin, programa.o, simbolos.txt y referencias.txt...\n";
+    ensamblador.generar_hex("programa.hex");
+    ensamblador.generar_bin("programa.bin");
+    ensamblador.generar_elf("programa.o");
+    ensamblador.generar_reportes();
+
+    if (estadisticas) ensamblador.generar_estadisticas(cout);
+
+    if (analisis) {
+        AnalizadorRendimiento analizador;
+        analizador.analizar(ensamblador);
+        analizador.escribir_informe(estadisticas ? cerr : cout);
+    }
+
+    if (ensamblador.num_errores() > 0) {
+        cerr << "Proceso finalizado con " << ensamblador.num_errores() << " error(es).\n";
+        return 1;
+    }
+    salida << "Proceso finalizado correctamente. Revisa los archivos generados.\n";
+    return 0;
+}